@@ -17,62 +17,187 @@
 // UART for GPS (Hardware USART0)
 #define GPS_UART_ID         UART_ID_0 // Maps to HW USART0
 #define GPS_UART_BAUD       9600UL    // Standard GPS NMEA baud rate
-#define GPS_UART_RX_BUFFER_SIZE 256   // Buffer size for incoming NMEA sentences
+#define GPS_UART_RX_BUFFER_SIZE 256   // Buffer size for incoming NMEA sentences / UBX frames
+#define HW_UART0_RX_BUFFER_SIZE GPS_UART_RX_BUFFER_SIZE // ~22 ms of headroom at 115200 baud
+
+// u-blox UBX mode: at startup the receiver is switched to GPS_UBX_BAUD with
+// NAV-PVT output only. Receivers that never answer in UBX keep NMEA at GPS_UART_BAUD.
+#define GPS_USE_UBX         1         // Set to 0 for NMEA-only receivers
+#define GPS_UBX_BAUD        115200UL  // Baud rate requested from the receiver
+#define GPS_UBX_RATE_HZ     5         // NAV-PVT solution rate (1-10 Hz)
+#define GPS_UBX_SWITCH_DELAY_MS   100 // Time for CFG-PRT to go out at the old baud rate
+#define GPS_UBX_DETECT_TIMEOUT_MS 2000 // No UBX frame within this time: fall back to NMEA
+// Warm start: the last good fix is kept in EEPROM and sent to the receiver as
+// UBX-MGA-INI-POS_LLH at start-up (u-blox M8 and later, UBX mode only).
+#define GPS_FIX_HINT_ACCURACY_M   50000UL // Claimed error of the cached fix (the bike may have been moved)
+#define GPS_FIX_HINT_MOVE_M       2000   // Cached fix replaced once the bike is this far from it...
+#define GPS_FIX_HINT_INTERVAL_MS  300000UL // ...checked at most this often (EEPROM wear)
 
 // UART for BLE (HC-05/06 style) Module
 #define BLE_UART_ID         UART_ID_1 // Assigns ID for BLE communication channel
 #define BLE_UART_BAUD       115200UL  // Baud rate for BLE communication
 #define BLE_UART_TX_BUFFER_SIZE 128   // Transmit buffer size for BLE UART
 #define BLE_UART_RX_BUFFER_SIZE 64    // Buffer for incoming BLE responses/data
+#define SW_UART1_TX_BUFFER_SIZE BLE_UART_TX_BUFFER_SIZE
+#define SW_UART1_RX_BUFFER_SIZE BLE_UART_RX_BUFFER_SIZE
 
 // I2C (Hardware TWI)
 #define MAIN_I2C_ID         I2C_ID_0 // Maps to HW TWI
-#define I2C_CLOCK_SPEED     100000UL // 100 kHz standard I2C speed
+#define I2C_CLOCK_SPEED     400000UL // 400 kHz fast mode (IMU FIFO bursts)
+#define I2C_QUEUE_SIZE      4        // Requests queued behind the one on the bus
+#define I2C_TIMEOUT_MS      20       // A transaction still running after this is aborted and the bus recovered
 
 // --- Pin Definitions (ATmega328P QFP32 package mapping) ---
 // These map symbolic names to actual MCU pins based on the schematic.
+// Values are hal_gpio pin identifiers, GPIO_PIN(port, bit) from hal/gpio.h.
 
 // Port D Pins
-#define UART0_RXD_PIN       PD0 // Pin 2 (QFP32) - Used by GPS_UART_ID
-#define UART0_TXD_PIN       PD1 // Pin 3 (QFP32) - Used by GPS_UART_ID
-#define LEFT_SIGNAL_PIN     PD2 // Pin 4 (QFP32) - External Interrupt INT0 capable
-#define RIGHT_SIGNAL_PIN    PD3 // Pin 5 (QFP32) - External Interrupt INT1 capable
-#define SPEED_SENSOR_PIN    PD4 // Pin 6 (QFP32) - Pin Change Interrupt PCINT20 capable
+#define UART0_RXD_PIN       GPIO_PIN(GPIO_PORT_D, PD0) // Pin 2 (QFP32) - Used by GPS_UART_ID
+#define UART0_TXD_PIN       GPIO_PIN(GPIO_PORT_D, PD1) // Pin 3 (QFP32) - Used by GPS_UART_ID
+#define LEFT_SIGNAL_PIN     GPIO_PIN(GPIO_PORT_D, PD2) // Pin 4 (QFP32) - External Interrupt INT0 capable
+#define RIGHT_SIGNAL_PIN    GPIO_PIN(GPIO_PORT_D, PD3) // Pin 5 (QFP32) - External Interrupt INT1 capable
+#define SPEED_SENSOR_PIN    GPIO_PIN(GPIO_PORT_D, PD4) // Pin 6 (QFP32) - Pin Change Interrupt PCINT20 capable
+#define DEBUG_TX_PORT       PORTD // PD7, Pin 11 (QFP32) - Software UART TX for logs (LOG_TO_DEBUG_PIN)
+#define DEBUG_TX_DDR        DDRD
+#define DEBUG_TX_BIT        PD7
 
 // Port C Pins
-#define BATTERY_SENSE_PIN   PC0 // Pin 23 (QFP32) - ADC Channel 0
-#define I2C_SDA_PIN         PC4 // Pin 27 (QFP32) - Hardware TWI SDA
-#define I2C_SCL_PIN         PC5 // Pin 28 (QFP32) - Hardware TWI SCL
+#define BATTERY_SENSE_PIN   GPIO_PIN(GPIO_PORT_C, PC0) // Pin 23 (QFP32) - ADC Channel 0
+#define I2C_SDA_PIN         GPIO_PIN(GPIO_PORT_C, PC4) // Pin 27 (QFP32) - Hardware TWI SDA
+#define I2C_SCL_PIN         GPIO_PIN(GPIO_PORT_C, PC5) // Pin 28 (QFP32) - Hardware TWI SCL
 
 // Port B Pins (Example for Software UART for BLE)
-#define BLE_SW_UART_RX_PIN  PB0 // Pin 14 (QFP32) - Example pin for Software UART RX
-#define BLE_SW_UART_TX_PIN  PB1 // Pin 15 (QFP32) - Example pin for Software UART TX
+#define BLE_SW_UART_RX_PIN  GPIO_PIN(GPIO_PORT_B, PB0) // Pin 14 (QFP32) - Example pin for Software UART RX
+#define BLE_SW_UART_TX_PIN  GPIO_PIN(GPIO_PORT_B, PB1) // Pin 15 (QFP32) - Example pin for Software UART TX
 
 // --- Module Configuration ---
 
 // Battery Monitor (using ADC on BATTERY_SENSE_PIN)
 // Assumes a voltage divider: Vin --- R1 --- (ADC_PIN) --- R2 --- GND
-#define BATTERY_R1_OHMS     10000.0f // Resistor R1 value in Ohms
-#define BATTERY_R2_OHMS     2200.0f  // Resistor R2 value in Ohms
-#define BATTERY_ADC_VREF_MV 3300.0f  // ADC reference voltage (from 3.3V regulator) in millivolts
-#define BATTERY_ADC_MAX_VALUE 1023   // Max value for 10-bit ADC
+// R1, R2 and VREF are defaults, calibrated at run time (Persistent Settings below).
+#define BATTERY_R1_OHMS     10000UL  // Resistor R1 value in Ohms
+#define BATTERY_R2_OHMS     2200UL   // Resistor R2 value in Ohms
+#define BATTERY_ADC_VREF_MV 3300UL   // ADC reference voltage (from 3.3V regulator) in millivolts
+#define BATTERY_ADC_MAX_VALUE 4092   // Full scale of the oversampled 12-bit reading (hal/adc.h)
+#define BATTERY_ADC_CHANNEL 0        // ADC0 = BATTERY_SENSE_PIN
+#define ADC_FILTER_SHIFT    4        // Moving average over ~16 decimated readings (~256 ms), rejects ignition noise
+
+// IMU (MPU-6050 class on the I2C bus). Mounted flat with X toward the front
+// wheel and Y to the left; samples are batched in the sensor FIFO.
+#define ENABLE_IMU              1
+#define IMU_I2C_ADDRESS         0x68 // AD0 low
+#define IMU_SAMPLE_RATE_HZ      50   // FIFO fill rate (1 kHz / (1 + SMPLRT_DIV))
+#define IMU_POLL_INTERVAL_MS    100  // FIFO drain period: 5 samples (60 bytes) per burst
+#define IMU_FIFO_BURST_SAMPLES  8    // Largest burst read at once (12 bytes per sample)
+#define IMU_LEAN_GAIN_SHIFT     5    // Gyro roll pulled toward the reference by 1/32 per sample
+#define IMU_BIAS_SHIFT          6    // Gyro bias learned while stationary, alpha = 1/64
+#define IMU_RETRY_INTERVAL_MS   1000 // After a failed FIFO read, retry this often (logged once)
 
 // Navigation Logic
-#define NAV_UPDATE_INTERVAL_MS 1000 // How often navigation logic recalculates (milliseconds)
-#define SPEED_SMOOTHING_FACTOR 0.5f // Factor for exponential moving average of speed
+#define NAV_UPDATE_INTERVAL_MS 50   // Guidance recalculated at 20 Hz, dead reckoning between fixes
+#define SPEED_SMOOTHING_SHIFT  1    // Speed EMA alpha = 1 / 2^shift (1 = 0.5)
+// Guidance is also recomputed on every new GPS fix (see process_communication() in main.c).
+
+// Dead reckoning: position is propagated from speed (wheel sensor, else GPS)
+// and the last GPS course, and pulled toward each fix with a fixed gain.
+#define ENABLE_DEAD_RECKONING   1    // 0 to use raw fixes only
+#define NAV_DR_GAIN_SHIFT       1    // Fix correction gain = 1 / 2^shift of the prediction error
+#define NAV_DR_SNAP_M           50   // Prediction further than this from a fix is dropped
+#define NAV_DR_MAX_COAST_MS     3000 // Keep guiding this long after the fix is lost (tunnels)
+#define NAV_DR_MIN_SPEED_KMH_X10 30  // Below 3 km/h the GPS course is noise: hold position
+#define ROUTE_OFF_ROUTE_M       40  // Distance from the route segment that counts as off route
+#define ROUTE_ARRIVE_RADIUS_M   20  // Distance to the last point that counts as arrived
+#define ROUTE_MAX_ADVANCE_PER_FIX 3 // Segments the cursor may skip per update (short segments at speed)
+
+// External Memory (AT24CM02 class serial EEPROM on the I2C header, see ext_flash.c)
+#define EXT_FLASH_I2C_ADDRESS    0x50     // A2 low; the block select bits A17/A16 follow
+#define EXT_FLASH_SIZE_BYTES     262144UL // 2 Mbit
+#define EXT_FLASH_PAGE_SIZE      256
+#define EXT_FLASH_WRITE_CYCLE_MS 10       // Worst-case internal write time
+
+// Ride Trace (input capture and playback, see ride_trace.h). A 9600 baud NMEA
+// ride takes about 1 KB per second, so the memory holds around four minutes.
+#define RIDE_TRACE_BUFFER_SIZE   256 // RAM staging between the inputs and the memory (power of two)
+
+// Persistent Settings (EEPROM below the route store, see settings.h). The
+// calibration and STATUS_* interval values in this file are the defaults; the
+// phone changes them with BLE_MSG_CONFIG_SET.
+#define SETTINGS_EEPROM_BASE    0    // Settings, 2 copies (util/persist.h)
+#define SETTINGS_SAVE_DELAY_MS  2000 // Saved this long after the last change, so a burst writes once
+#define GPS_FIX_EEPROM_BASE     64   // Last known fix, 4 copies, for the receiver warm start
+
+// Route Store (EEPROM). Consecutive route points must be less than ~20 km apart.
+#define ROUTE_STORE_EEPROM_BASE 128 // Bytes below this hold the settings and the cached GPS fix
 
 // BLE Communication Protocol
 #define BLE_PACKET_START_BYTE   0xAA
 #define BLE_PACKET_END_BYTE     0x55
-#define BLE_STATUS_UPDATE_INTERVAL_MS 500 // How often to send status updates (milliseconds)
 
-// Signal Detection
-#define SIGNAL_DEBOUNCE_TIME_MS 50 // Debounce time for turn signal inputs (milliseconds)
+// Status Publisher (change-driven updates, see status_publisher.c)
+// Turn signal changes are sent on the next loop iteration with no rate limit.
+#define STATUS_SPEED_MIN_INTERVAL_MS   200   // Speed changes sent at most at 5 Hz
+#define STATUS_BATTERY_INTERVAL_MS     10000 // Battery sampled and sent (if changed) every 10 s
+#define STATUS_NAV_MIN_INTERVAL_MS     100   // Distance-only nav changes sent at most at 10 Hz
+#define STATUS_KEYFRAME_INTERVAL_MS    5000  // Full status + nav resend so the display can recover
+#define STATUS_HEARTBEAT_INTERVAL_MS   1000  // BLE_MSG_HEARTBEAT after this long with nothing sent (display liveness)
+#define OTA_RELAY_IDLE_MS              5000  // Display update abandoned after this long without OTA frames
+
+// Link Quality (display ACKs of the sequenced frames, see link_quality.h)
+// A degraded link doubles the speed, nav and keyframe intervals above, a poor one quadruples them.
+#define LINK_ACK_TIMEOUT_MS         2000 // Frames sent but no ACK for this long: link poor
+#define LINK_ALIVE_TIMEOUT_MS       5000 // No ACK for this long: display disconnected (heartbeats probe)
+#define LINK_RETRANSMIT_MIN_MS      150  // Critical frame unacknowledged this long (or 2x RTT) is resent
+#define LINK_RETRANSMIT_MAX         3    // Resends per maneuver change
+#define LINK_DEGRADED_LOSS_PERMILLE 50   // Smoothed loss from which the link counts as degraded
+#define LINK_POOR_LOSS_PERMILLE     200  // ... and as poor
+#define LINK_DEGRADED_RTT_MS        300  // Smoothed RTT from which the link counts as degraded
+
+// Signal Detection (edge capture on INT0/INT1, see signal_detector.c)
+#define SIGNAL_DEBOUNCE_TIME_MS 50 // Edges closer than this to the last accepted one are bounce
+#define SIGNAL_BLINK_MIN_PERIOD_MS 250  // Faster flashing (PWM-dimmed running light) counts as steady
+#define SIGNAL_BLINK_MAX_PERIOD_MS 1500 // No new flash within this time: blinker off, or lit steadily
+#define SIGNAL_HAZARD_SYNC_MS      100  // Left and right flashing within this of each other = hazard
+
+// Wheel Speed Sensor (Hall, open collector, on SPEED_SENSOR_PIN)
+#define ENABLE_SPEED_SENSOR          1    // 0 if no sensor is fitted (GPS speed only)
+#define SPEED_WHEEL_CIRCUMFERENCE_MM 1950 // Rolling circumference of the sensed wheel
+#define SPEED_PULSES_PER_REV         1    // Magnets (or targets) per wheel revolution
+#define SPEED_MIN_PERIOD_US          2000 // Pulses closer than this are noise (~350 km/h at 1 per rev)
+#define SPEED_TIMEOUT_MS             2500 // No pulse for this long: wheel stopped (below ~3 km/h)
+#define SPEED_TYRE_CROWN_RADIUS_MM   60   // Tyre cross-section radius: leaning shrinks the rolling radius; 0 = no correction
+
+// Task Scheduler (see tasks_init() in main.c)
+#define SCHEDULER_MAX_TASKS         8  // Size of the static task table
+#define COMM_POLL_INTERVAL_MS       5  // Fallback UART drain period; GPS RX also wakes the task
+#define STATUS_PUBLISH_INTERVAL_MS  20 // How often the status publisher checks for due fields
+
+// Power Management (idle sleep between tasks is always on)
+#define ENABLE_PARKED_SLEEP         1        // 1 to power down while parked
+#define PARKED_TIMEOUT_MS           300000UL // No movement and no signals for 5 minutes
+#define PARKED_SPEED_KMH            3        // Speed (wheel or GPS) below this counts as stationary
+#define POWER_CHECK_INTERVAL_MS     1000     // Parked detection period
+#define POWER_STATS_INTERVAL_MS     60000    // Duty-cycle statistics log period
 
 // --- Feature Flags ---
+// The Makefile's build profiles (PROFILE=release|debug|bench) set ENABLE_LOGGING,
+// LOG_LEVEL and ENABLE_PERF_COUNTERS on the command line; these are the defaults.
+#ifndef ENABLE_LOGGING
 #define ENABLE_LOGGING          1      // 1 to enable logging, 0 to disable
+#endif
+#ifndef LOG_LEVEL
 #define LOG_LEVEL               LOG_LEVEL_INFO // Default log level (DEBUG, INFO, WARN, ERROR)
+#endif
 #define LOG_UART_ID             BLE_UART_ID // Send logs over BLE UART (or GPS_UART_ID for debug)
 #define LOG_UART_BAUD           BLE_UART_BAUD
+#define LOG_TOKENIZED           1      // 1: binary records decoded by host_tools/diagnostics.py, 0: printf text
+#define LOG_QUEUE_SIZE          128    // Tokenized record queue in bytes (power of two)
+#define LOG_TO_DEBUG_PIN        0      // 1: logs go out on DEBUG_TX_BIT (Timer2 software UART), not BLE
+#define LOG_DEBUG_BAUD          38400UL
+#define LOG_BUDGET_BYTES_PER_S  400    // Log bytes per second allowed on the link (0 = no limit)
+#define LOG_BUDGET_BURST_BYTES  128    // Log bytes that may go out at once after a quiet spell
+#ifndef ENABLE_PERF_COUNTERS
+#define ENABLE_PERF_COUNTERS    0      // 1: Timer1 section timing and counters, read with diagnostics.py --stats
+#endif
+#define ENABLE_RIDE_TRACE       0      // 1: input capture/playback on the external memory (diagnostics.py --trace)
 
 #endif // CONFIG_H
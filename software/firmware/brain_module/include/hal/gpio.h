@@ -4,15 +4,24 @@
 /**
  * @file hal_gpio.h
  * @brief Hardware Abstraction Layer for General Purpose Input/Output pins for ATmega328P.
+ * Pins are identified by GPIO_PIN(port, bit) values (see config.h). Interrupt
+ * callbacks run in interrupt context, from the INT0/INT1 and PCINT0..2 vectors
+ * owned by this module.
  */
 
 #include <stdint.h>
 #include <stdbool.h>
 
-// Define symbolic names for pins, mapping to MCU-specific identifiers if necessary.
-// For simplicity here, we use the definitions from config.h directly.
 #include "config.h" // Include pin definitions
 
+// Pin identifiers: port in the upper nibble, bit number (PD2 etc.) in the lower one.
+#define GPIO_PORT_B 0
+#define GPIO_PORT_C 1
+#define GPIO_PORT_D 2
+#define GPIO_PIN(port, bit)  ((uint8_t)(((port) << 4) | (bit)))
+#define GPIO_PIN_PORT(pin)   ((uint8_t)((pin) >> 4))
+#define GPIO_PIN_BIT(pin)    ((uint8_t)((pin) & 0x07))
+
 // GPIO Pin Modes
 typedef enum {
     GPIO_MODE_INPUT,          // High-impedance input
@@ -30,7 +39,7 @@ typedef enum {
     GPIO_INT_PIN_CHANGE      // Interrupt on pin change (for PCINT) - edge determined by reading pin state
 } gpio_interrupt_edge_t;
 
-// Callback function pointer type for GPIO interrupts
+// Callback function pointer type for GPIO interrupts (called from the ISR, keep it short)
 typedef void (*gpio_interrupt_callback_t)(uint8_t pin); // Pass pin number to callback
 
 /**
@@ -65,6 +74,8 @@ void hal_gpio_toggle(uint8_t pin);
  * @brief Configures an external or pin change interrupt for a GPIO pin.
  * Associates a callback function to be executed when the interrupt occurs.
  * Note: Pin must be capable of generating the specified interrupt type (INTx or PCINTx).
+ * Edge types other than GPIO_INT_PIN_CHANGE need INT0 (PD2) or INT1 (PD3);
+ * pin change works on every port pin and calls back on both edges.
  * @param pin The pin identifier (e.g., LEFT_SIGNAL_PIN, SPEED_SENSOR_PIN).
  * @param edge The edge or condition that triggers the interrupt.
  * @param callback The function to call when the interrupt occurs.
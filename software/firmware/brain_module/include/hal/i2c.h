@@ -4,6 +4,21 @@
 /**
  * @file hal_i2c.h
  * @brief Hardware Abstraction Layer for I2C (TWI) communication on ATmega328P.
+ *
+ * Transfers run from the TWI interrupt: the caller fills an i2c_request_t and
+ * queues it with hal_i2c_submit(), and the request goes out on the bus while
+ * the main loop carries on. Each request is one transaction: an optional
+ * register/memory address prefix and data written, then, if rx_length is
+ * non-zero, a repeated START and a read. That covers register writes, burst
+ * reads and write-then-read without a STOP in between. On completion the
+ * status is stored in the request and the callback, if any, runs in the ISR.
+ *
+ * A transaction still running after I2C_TIMEOUT_MS (a slave holding SDA low,
+ * a lost interrupt) is aborted by hal_i2c_service(), which clocks the bus free
+ * and re-initializes the TWI; call it from the main loop.
+ *
+ * The blocking functions below are wrappers that submit and wait, for
+ * start-up code that has nothing better to do.
  */
 
 #include <stdint.h>
@@ -29,9 +44,63 @@ typedef enum {
     I2C_ERROR_ARB_LOST,     // Arbitration Lost
     I2C_ERROR_TIMEOUT,
     I2C_ERROR_BUS_BUSY,
-    I2C_ERROR_UNKNOWN
+    I2C_ERROR_UNKNOWN,
+    I2C_PENDING             // Queued or on the bus
 } i2c_status_t;
 
+/**
+ * @brief Completion callback, called from the TWI interrupt (or from
+ * hal_i2c_service() after a timeout) with interrupts disabled. Keep it short;
+ * it may submit the next request, e.g. to chain a read after a count read.
+ */
+typedef void (*i2c_callback_t)(i2c_status_t status, void *context);
+
+/**
+ * @brief One bus transaction. Owned by the caller and must stay valid, along
+ * with its buffers, until status leaves I2C_PENDING.
+ */
+typedef struct i2c_request {
+    uint8_t address;          // 7-bit slave address
+    uint8_t prefix_length;    // 0..2 bytes of prefix sent first
+    uint8_t prefix[2];        // Register or memory address, in bus order
+    const uint8_t *tx_data;   // Written after the prefix
+    uint16_t tx_length;
+    uint8_t *rx_data;         // Read after a repeated START when rx_length > 0
+    uint16_t rx_length;
+    i2c_callback_t callback;  // Optional
+    void *context;            // Passed to the callback
+    volatile i2c_status_t status;
+} i2c_request_t;
+
+/**
+ * @brief Prepares a write of length bytes to a register.
+ */
+static inline void hal_i2c_prepare_write_register(i2c_request_t *req, uint8_t device_address, uint8_t reg_address,
+                                                  const uint8_t *data, uint16_t length) {
+    req->address = device_address;
+    req->prefix_length = 1;
+    req->prefix[0] = reg_address;
+    req->tx_data = data;
+    req->tx_length = length;
+    req->rx_data = NULL;
+    req->rx_length = 0;
+}
+
+/**
+ * @brief Prepares a burst read of length bytes starting at a register
+ * (register address written, repeated START, read).
+ */
+static inline void hal_i2c_prepare_read_register(i2c_request_t *req, uint8_t device_address, uint8_t reg_address,
+                                                 uint8_t *data, uint16_t length) {
+    req->address = device_address;
+    req->prefix_length = 1;
+    req->prefix[0] = reg_address;
+    req->tx_data = NULL;
+    req->tx_length = 0;
+    req->rx_data = data;
+    req->rx_length = length;
+}
+
 /**
  * @brief Initializes the I2C peripheral (Hardware TWI).
  * Configures the clock speed and enables the TWI module.
@@ -41,35 +110,58 @@ typedef enum {
 void hal_i2c_init(i2c_id_t i2c_id, uint32_t clock_speed);
 
 /**
- * @brief Writes data to an I2C slave device.
- * Handles START, slave address + W, data bytes, and STOP conditions.
- * This is a blocking implementation.
+ * @brief Queues a transaction; it starts at once if the bus is idle.
+ * Fill in the transfer fields (and callback/context) first; status is set here.
+ * @param i2c_id The I2C peripheral identifier.
+ * @param req The request; not copied.
+ * @return false if the queue is full (I2C_QUEUE_SIZE) or the request is
+ *         invalid; the request is untouched then and may be retried.
+ */
+bool hal_i2c_submit(i2c_id_t i2c_id, i2c_request_t *req);
+
+/**
+ * @brief Returns true while a transaction is on the bus or queued.
+ */
+bool hal_i2c_is_busy(i2c_id_t i2c_id);
+
+/**
+ * @brief Aborts a transaction that has run past I2C_TIMEOUT_MS, recovers the
+ * bus and moves on to the next request. Call periodically from the main loop.
+ */
+void hal_i2c_service(i2c_id_t i2c_id);
+
+/**
+ * @brief Writes data to an I2C slave device (START, SLA+W, data, STOP).
+ * Blocking: submits and waits. Call with interrupts enabled.
  * @param i2c_id The I2C peripheral identifier.
  * @param device_address The 7-bit address of the slave device.
  * @param data Pointer to the data buffer to write.
  * @param length Number of bytes to write.
- * @param stop True to generate a STOP condition after writing, false to keep bus active (for repeated START).
  * @return I2C_OK on success, or an i2c_status_t error code on failure.
  */
-i2c_status_t hal_i2c_write(i2c_id_t i2c_id, uint8_t device_address, const uint8_t *data, size_t length, bool stop);
+i2c_status_t hal_i2c_write(i2c_id_t i2c_id, uint8_t device_address, const uint8_t *data, size_t length);
 
 /**
- * @brief Reads data from an I2C slave device.
- * Handles START, slave address + R, data bytes (with ACK/NACK), and STOP conditions.
- * This is a blocking implementation.
+ * @brief Reads data from an I2C slave device (START, SLA+R, data, STOP).
+ * Blocking: submits and waits. Call with interrupts enabled.
  * @param i2c_id The I2C peripheral identifier.
  * @param device_address The 7-bit address of the slave device.
  * @param data Pointer to the buffer where read data will be stored.
  * @param length Number of bytes to read.
- * @param stop True to generate a STOP condition after reading, false to keep bus active.
  * @return I2C_OK on success, or an i2c_status_t error code on failure.
  */
-i2c_status_t hal_i2c_read(i2c_id_t i2c_id, uint8_t device_address, uint8_t *data, size_t length, bool stop);
+i2c_status_t hal_i2c_read(i2c_id_t i2c_id, uint8_t device_address, uint8_t *data, size_t length);
+
+/**
+ * @brief Writes tx_length bytes, then reads rx_length bytes after a repeated
+ * START, as one transaction. Blocking.
+ * @return I2C_OK on success, or an i2c_status_t error code on failure.
+ */
+i2c_status_t hal_i2c_write_read(i2c_id_t i2c_id, uint8_t device_address, const uint8_t *tx_data, size_t tx_length,
+                                uint8_t *rx_data, size_t rx_length);
 
 /**
- * @brief Writes data to a specific register of an I2C device.
- * Combines a write operation (for the register address) followed by another write (for the data).
- * Uses a repeated START condition if the device supports it.
+ * @brief Writes data to a specific register of an I2C device. Blocking.
  * @param i2c_id The I2C peripheral identifier.
  * @param device_address The 7-bit address of the slave device.
  * @param reg_address The address of the register to write to.
@@ -80,8 +172,8 @@ i2c_status_t hal_i2c_read(i2c_id_t i2c_id, uint8_t device_address, uint8_t *data
 i2c_status_t hal_i2c_write_register(i2c_id_t i2c_id, uint8_t device_address, uint8_t reg_address, const uint8_t *data, size_t length);
 
 /**
- * @brief Reads data from a specific register of an I2C device.
- * Performs a write operation (for the register address) followed by a repeated START and a read operation.
+ * @brief Reads data from a specific register of an I2C device. Blocking.
+ * Writes the register address, then a repeated START and the read.
  * @param i2c_id The I2C peripheral identifier.
  * @param device_address The 7-bit address of the slave device.
  * @param reg_address The address of the register to read from.
@@ -101,8 +193,9 @@ i2c_status_t hal_i2c_read_register(i2c_id_t i2c_id, uint8_t device_address, uint
 bool hal_i2c_probe(i2c_id_t i2c_id, uint8_t device_address);
 
 /**
- * @brief Resets the I2C peripheral in case of bus lock-up.
- * Attempts to force STOP/START conditions or re-initializes the hardware.
+ * @brief Recovers a stuck bus: clocks SCL until a slave holding SDA lets go,
+ * sends a STOP and re-initializes the TWI. Fails the transaction in progress,
+ * if any, with I2C_ERROR_TIMEOUT; queued requests go out afterwards.
  * @param i2c_id The I2C peripheral identifier.
  */
 void hal_i2c_reset(i2c_id_t i2c_id);
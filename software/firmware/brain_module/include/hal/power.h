@@ -0,0 +1,64 @@
+#ifndef HAL_POWER_H
+#define HAL_POWER_H
+
+/**
+ * @file hal_power.h
+ * @brief Hardware Abstraction Layer for sleep modes and power accounting on ATmega328P.
+ * IDLE sleep is used between scheduler tasks (UART, Timer0 and pin interrupts
+ * all wake it). Power-down is used while the bike is parked, with the watchdog,
+ * INT0/INT1 (turn signals) and PCINT20 (speed sensor) as wake sources.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+// Why the MCU left power-down sleep.
+typedef enum {
+    POWER_WAKE_WATCHDOG, // Periodic watchdog wake, nothing else happened
+    POWER_WAKE_PIN       // A configured wake pin changed (rider activity)
+} power_wake_t;
+
+// Time accounting since the last hal_power_reset_stats().
+typedef struct {
+    uint32_t total_ms;  // Wall time covered by these statistics
+    uint32_t idle_ms;   // Time spent in IDLE sleep between tasks
+    uint32_t deep_ms;   // Time spent in power-down (parked)
+    uint32_t wakeups;   // Number of IDLE sleeps entered
+    uint8_t duty_pct;   // Awake (CPU running) share of total_ms, 0..100
+} power_stats_t;
+
+/**
+ * @brief Turns off clocks to unused peripherals and resets the statistics.
+ * Call after the HAL peripherals have been initialized.
+ */
+void hal_power_init(void);
+
+/**
+ * @brief Sleeps in IDLE mode until the next interrupt.
+ * Must be called with interrupts disabled, after checking that no work is due;
+ * interrupts are re-enabled atomically with entering sleep, so a wake event
+ * arriving after the check cannot be missed. Returns with interrupts enabled.
+ */
+void hal_power_idle(void);
+
+/**
+ * @brief Sleeps in power-down mode until a wake pin changes or the watchdog fires.
+ * Timer0 and the UART stop, so the tick is advanced by the watchdog period on
+ * return. The BLE/GPS UARTs lose any byte that arrives during this sleep.
+ * @return The wake reason.
+ */
+power_wake_t hal_power_deep_sleep(void);
+
+/**
+ * @brief Copies the time accounting, computing total_ms and duty_pct.
+ * @param stats Destination structure.
+ */
+void hal_power_get_stats(power_stats_t *stats);
+
+/**
+ * @brief Restarts the time accounting from now.
+ */
+void hal_power_reset_stats(void);
+
+#endif // HAL_POWER_H
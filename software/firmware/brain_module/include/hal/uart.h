@@ -24,6 +24,18 @@ typedef enum {
 // The callback receives the UART ID and the received data byte.
 typedef void (*uart_rx_callback_t)(uart_id_t uart_id, uint8_t data);
 
+// Callback function pointer type for TX-empty notification.
+// Called from interrupt context once the last queued byte has left the shift register.
+typedef void (*uart_tx_empty_callback_t)(uart_id_t uart_id);
+
+// Line error and buffer counters, accumulated by the RX interrupt.
+typedef struct {
+    uint16_t overrun_errors; // Hardware data overrun (DOR): a byte arrived before UDR was read
+    uint16_t framing_errors; // Stop bit not found (FE)
+    uint16_t parity_errors;  // Parity mismatch (UPE)
+    uint16_t rx_dropped;     // Byte received but the RX ring buffer was full
+} uart_stats_t;
+
 /**
  * @brief Initializes a UART peripheral (Hardware or Software).
  * Configures baud rate, frame format, and enables the peripheral.
@@ -35,22 +47,56 @@ typedef void (*uart_rx_callback_t)(uart_id_t uart_id, uint8_t data);
  */
 void hal_uart_init(uart_id_t uart_id, uint32_t baud_rate, uint8_t data_bits, uint8_t stop_bits, uint8_t parity);
 
+/**
+ * @brief Changes the baud rate of an initialized UART.
+ * Buffers, callbacks and the frame format are kept. Bytes still shifting out
+ * are corrupted, so wait for hal_uart_tx_idle() first.
+ * @param uart_id The UART peripheral identifier.
+ * @param baud_rate The new baud rate.
+ */
+void hal_uart_set_baud(uart_id_t uart_id, uint32_t baud_rate);
+
 /**
  * @brief Sends a single byte over UART (blocking).
- * Waits until the UART transmit buffer is ready before sending.
+ * Waits until there is room in the transmit ring buffer, then queues the byte.
+ * With interrupts disabled the byte is written straight to the hardware instead.
  * @param uart_id The UART peripheral identifier.
  * @param data The byte to send.
  */
 void hal_uart_put_char(uart_id_t uart_id, uint8_t data);
 
 /**
- * @brief Sends a buffer of data over UART (blocking).
- * Transmits each byte sequentially using hal_uart_put_char.
+ * @brief Queues a buffer of data for transmission (non-blocking).
+ * Copies as much as fits into the transmit ring buffer and returns immediately;
+ * the UDRE interrupt drains it in the background.
  * @param uart_id The UART peripheral identifier.
  * @param buffer Pointer to the data buffer.
  * @param length Number of bytes to send.
+ * @return The number of bytes actually queued (less than length if the buffer filled up).
+ */
+size_t hal_uart_write(uart_id_t uart_id, const uint8_t *buffer, size_t length);
+
+/**
+ * @brief Returns the free space in the transmit ring buffer.
+ * @param uart_id The UART peripheral identifier.
+ * @return Number of bytes hal_uart_write() can currently queue without truncation.
+ */
+size_t hal_uart_tx_space(uart_id_t uart_id);
+
+/**
+ * @brief Checks whether all queued data has been transmitted.
+ * @param uart_id The UART peripheral identifier.
+ * @return true if the transmit buffer is empty and the last byte has left the shift register.
+ */
+bool hal_uart_tx_idle(uart_id_t uart_id);
+
+/**
+ * @brief Registers a callback invoked when the transmitter becomes idle.
+ * The callback runs in interrupt context after the last queued byte is sent.
+ * @param uart_id The UART peripheral identifier.
+ * @param callback The function to call, or NULL to disable the notification.
  */
-void hal_uart_write(uart_id_t uart_id, const uint8_t *buffer, size_t length);
+void hal_uart_set_tx_empty_callback(uart_id_t uart_id, uart_tx_empty_callback_t callback);
 
 /**
  * @brief Receives a single byte from UART (blocking).
@@ -79,15 +125,32 @@ bool hal_uart_data_available(uart_id_t uart_id);
 size_t hal_uart_read(uart_id_t uart_id, uint8_t *buffer, size_t length);
 
 /**
- * @brief Enables the UART Receive Complete interrupt.
- * Registers a callback function to be called when a byte is received.
+ * @brief Returns the longest contiguous run of received bytes without copying.
+ * Lets parsers work directly on the RX ring; release the bytes with hal_uart_rx_consume().
+ * @param uart_id The UART peripheral identifier.
+ * @param data Receives a pointer to the oldest unread byte.
+ * @return Number of contiguous bytes available (0 if none). Call again after consuming to get wrapped data.
+ */
+size_t hal_uart_rx_span(uart_id_t uart_id, const uint8_t **data);
+
+/**
+ * @brief Releases bytes obtained with hal_uart_rx_span().
+ * @param uart_id The UART peripheral identifier.
+ * @param length Number of bytes processed; must not exceed the span returned.
+ */
+void hal_uart_rx_consume(uart_id_t uart_id, size_t length);
+
+/**
+ * @brief Registers a callback for received bytes.
+ * The RX interrupt is always active and always fills the receive ring buffer;
+ * the callback is additionally invoked, in interrupt context, for each byte.
  * @param uart_id The UART peripheral identifier.
  * @param callback The function to call when a byte is received via interrupt.
  */
 void hal_uart_enable_rx_interrupt(uart_id_t uart_id, uart_rx_callback_t callback);
 
 /**
- * @brief Disables the UART Receive Complete interrupt.
+ * @brief Unregisters the RX callback. Bytes keep flowing into the ring buffer.
  * @param uart_id The UART peripheral identifier.
  */
 void hal_uart_disable_rx_interrupt(uart_id_t uart_id);
@@ -99,4 +162,17 @@ void hal_uart_disable_rx_interrupt(uart_id_t uart_id);
  */
 void hal_uart_flush_rx_buffer(uart_id_t uart_id);
 
+/**
+ * @brief Copies the line error and buffer counters.
+ * @param uart_id The UART peripheral identifier.
+ * @param stats Pointer to the structure receiving the counters.
+ */
+void hal_uart_get_stats(uart_id_t uart_id, uart_stats_t *stats);
+
+/**
+ * @brief Resets the line error and buffer counters to zero.
+ * @param uart_id The UART peripheral identifier.
+ */
+void hal_uart_clear_stats(uart_id_t uart_id);
+
 #endif // HAL_UART_H
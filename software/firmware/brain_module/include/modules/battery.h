@@ -5,6 +5,8 @@
  * @file battery.h
  * @brief Interface for the Battery Monitoring module.
  * Provides functions to read and interpret the battery voltage level.
+ * Readings are sampled and filtered in the background (hal/adc.h); the
+ * getters return the latest value immediately.
  */
 
 #include <stdint.h>
@@ -17,9 +19,8 @@
 void battery_monitor_init(void);
 
 /**
- * @brief Reads the raw sensor value related to battery voltage.
- * This is typically an ADC reading before conversion and calibration.
- * @return The raw sensor reading (e.g., 10-bit ADC value). Returns specific error value if read fails.
+ * @brief Returns the latest filtered ADC reading of the battery divider.
+ * @return 12-bit reading (0..BATTERY_ADC_MAX_VALUE), before conversion to millivolts.
  */
 uint16_t battery_monitor_read_raw(void);
 
@@ -31,8 +32,7 @@ uint16_t battery_monitor_get_voltage_mv(void);
 
 /**
  * @brief Estimates the battery charge level as a percentage.
- * This calculation is based on the measured voltage and typically requires
- * a voltage-to-percentage mapping specific to the battery chemistry.
+ * Interpolated from a 12 V lead-acid resting-voltage table in flash.
  * @return Battery level percentage (0-100).
  */
 uint8_t battery_monitor_get_level_percent(void);
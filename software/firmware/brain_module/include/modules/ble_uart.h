@@ -4,8 +4,8 @@
 /**
  * @file ble_uart.h
  * @brief Interface for BLE UART communication module.
- * Provides functions to send formatted data packets over a UART link
- * intended for a Bluetooth Low Energy module (like HC-05/06).
+ * Provides functions to send framed binary messages (see ble_protocol.h) over a
+ * UART link intended for a Bluetooth Low Energy module (like HC-05/06).
  */
 
 #include <stdint.h>
@@ -28,36 +28,89 @@ void ble_uart_init(void);
 bool ble_uart_send_data(const uint8_t *data, size_t length);
 
 /**
- * @brief Sends a formatted navigation update message over BLE UART.
- * Encapsulates navigation instructions and distance into a defined protocol format.
- * @param instruction A string describing the navigation maneuver (e.g., "Turn left").
- * @param distance Distance to the maneuver (e.g., in meters).
- * @return true if the message was successfully formatted and sent/queued, false otherwise.
+ * @brief Sends a BLE_MSG_NAV_UPDATE frame over BLE UART.
+ * NAV, STATUS and FIELD updates are sequenced frames (see link_quality.h).
+ * @param maneuver The next maneuver (nav_maneuver_t value).
+ * @param arg The maneuver argument (roundabout exit number, otherwise 0).
+ * @param distance Distance to the maneuver in meters.
+ * @param critical Ask the display for an immediate ACK, so a loss can be detected and resent.
+ * @return true if the frame was successfully encoded and sent/queued, false otherwise.
  */
-bool ble_uart_send_nav_update(const char* instruction, uint16_t distance);
+bool ble_uart_send_nav_update(uint8_t maneuver, uint8_t arg, uint16_t distance, bool critical);
 
 /**
- * @brief Sends a formatted status update message over BLE UART.
- * Encapsulates system status information (battery, signals, speed) into a defined protocol format.
+ * @brief Sends a BLE_MSG_STATUS_UPDATE frame over BLE UART.
+ * Encapsulates system status information (battery, signals, speed) as fixed-width fields.
  * @param battery_voltage_mv Current battery voltage in millivolts.
  * @param signal_status Current status of turn signals (e.g., using signal_state_t enum).
  * @param speed_kmh Current speed in kilometers per hour.
- * @return true if the message was successfully formatted and sent/queued, false otherwise.
+ * @return true if the frame was successfully encoded and sent/queued, false otherwise.
  */
 bool ble_uart_send_status_update(uint16_t battery_voltage_mv, uint8_t signal_status, uint8_t speed_kmh);
 
+/**
+ * @brief Sends a BLE_MSG_FIELD_UPDATE frame carrying only the flagged status fields.
+ * @param field_mask Combination of BLE_FIELD_* bits selecting which fields to send.
+ * @param battery_voltage_mv Battery voltage in millivolts (sent if BLE_FIELD_BATTERY is set).
+ * @param signal_status Turn signal state (sent if BLE_FIELD_SIGNAL is set).
+ * @param speed_kmh Speed in km/h (sent if BLE_FIELD_SPEED is set).
+ * @return true if the frame was successfully encoded and sent/queued, false otherwise.
+ */
+bool ble_uart_send_field_update(uint8_t field_mask, uint16_t battery_voltage_mv, uint8_t signal_status, uint8_t speed_kmh);
+
+/**
+ * @brief Wraps a payload in a protocol frame and sends it as is (no sequence number).
+ * @param msg_id Message identifier (ble_msg_id_t).
+ * @param payload Payload bytes (may be NULL if length is 0).
+ * @param length Number of payload bytes, at most BLE_PROTO_MAX_PAYLOAD.
+ * @return true if the frame was successfully encoded and sent/queued, false otherwise.
+ */
+bool ble_uart_send_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length);
+
+/**
+ * @brief Sends a BLE_MSG_HEARTBEAT frame (sequence number only).
+ * @return true if the frame was successfully encoded and sent/queued, false otherwise.
+ */
+bool ble_uart_send_heartbeat(void);
+
+/**
+ * @brief Sends a BLE_MSG_ROUTE_ACK to the phone.
+ * @param next_index Index of the next route point the brain expects.
+ * @param status Result of the last route message (ble_route_status_t).
+ * @return true if the frame was successfully encoded and sent/queued, false otherwise.
+ */
+bool ble_uart_send_route_ack(uint16_t next_index, uint8_t status);
+
+// Receives every valid binary frame arriving from the phone.
+typedef void (*ble_uart_frame_handler_t)(uint8_t msg_id, const uint8_t *payload, uint8_t length);
+
+/**
+ * @brief Registers the handler for binary frames received from the phone.
+ * @param handler Function to call per frame, or NULL to drop frames.
+ */
+void ble_uart_set_frame_handler(ble_uart_frame_handler_t handler);
+
 /**
  * @brief Processes a single character received from the BLE UART.
  * This function should be called for each byte received from the BLE module's UART.
- * It handles buffering, message framing, and parsing of incoming data or responses.
+ * Binary protocol frames are passed to the registered frame handler; text
+ * lines from the module itself (e.g. CONNECT/DISCONNECT) update the link state.
  * @param received_char The character received from the BLE UART.
  */
 void ble_uart_process_char(uint8_t received_char);
 
 /**
- * @brief Checks the current connection status of the BLE module.
- * @return true if the module is believed to be connected to a peer device, false otherwise.
- *         Note: Status might be based on parsed messages or status pins.
+ * @brief Reports the frames from the phone that the parser has dropped so far.
+ * @param crc_errors Receives the CRC mismatch count (may be NULL).
+ * @param framing_errors Receives the bad length / missing END count (may be NULL).
+ */
+void ble_uart_get_parser_errors(uint16_t *crc_errors, uint16_t *framing_errors);
+
+/**
+ * @brief Returns the connection state the BLE module last reported.
+ * This is the radio link only; whether the display is listening comes from
+ * its ACKs (link_quality_is_connected()).
+ * @return true after a CONNECT line, false after DISCONNECT (and initially).
  */
 bool ble_uart_is_connected(void);
 
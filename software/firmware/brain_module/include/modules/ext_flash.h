@@ -0,0 +1,54 @@
+#ifndef MODULES_EXT_FLASH_H
+#define MODULES_EXT_FLASH_H
+
+/**
+ * @file ext_flash.h
+ * @brief Interface for the external I2C serial memory on the I2C header.
+ * Written for AT24CM02 class parts (2 Mbit EEPROM, byte addressed, 256-byte
+ * pages): address bits above 16 go in the device address, and every write
+ * is followed by an internal write cycle of EXT_FLASH_WRITE_CYCLE_MS during
+ * which the part ignores the bus. Writes are queued on the I2C bus and return
+ * at once; the next access fails with busy until the transfer and the cycle
+ * are over, so callers never wait on it.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define EXT_FLASH_WRITE_MAX 32 // Bytes per ext_flash_write() (copied to the driver's transfer buffer)
+
+/**
+ * @brief Probes for the memory. Call after hal_i2c_init().
+ * @return true if the part answered.
+ */
+bool ext_flash_init(void);
+
+/**
+ * @brief Returns true if the memory answered at init.
+ */
+bool ext_flash_is_present(void);
+
+/**
+ * @brief Returns true while the last write is on the bus or its cycle is
+ * still running. Logs a write that failed on the bus.
+ */
+bool ext_flash_is_busy(void);
+
+/**
+ * @brief Queues a write within one page; the write cycle follows it.
+ * @param address Byte address; address + length must not cross a page boundary.
+ * @param data Bytes to write (copied).
+ * @param length 1..EXT_FLASH_WRITE_MAX bytes.
+ * @return false if busy, not present, the arguments are invalid or the I2C
+ *         queue is full. A bus failure after that is only logged.
+ */
+bool ext_flash_write(uint32_t address, const uint8_t *data, uint8_t length);
+
+/**
+ * @brief Reads consecutive bytes (may cross pages, not the 64 KB blocks).
+ * @return false if busy, not present, out of range or the bus failed.
+ */
+bool ext_flash_read(uint32_t address, uint8_t *data, size_t length);
+
+#endif // MODULES_EXT_FLASH_H
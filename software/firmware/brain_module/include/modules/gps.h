@@ -3,8 +3,9 @@
 
 /**
  * @file gps.h
- * @brief GPS Module Interface for parsing NMEA sentences.
+ * @brief GPS Module Interface for parsing NMEA sentences and u-blox UBX frames.
  * Handles communication with a GPS receiver via UART and provides structured data.
+ * All values are fixed point; the driver uses no floating point.
  */
 
 #include <stdint.h>
@@ -13,11 +14,11 @@
 
 // Structure to hold parsed GPS data
 typedef struct {
-    // Time
+    // Time (UTC)
     uint8_t hour;
     uint8_t minute;
     uint8_t second;
-    uint16_t millisecond; // Often available in RMC/GGA
+    uint16_t millisecond; // From the fractional seconds in RMC/GGA
 
     // Date
     uint8_t day;
@@ -25,31 +26,38 @@ typedef struct {
     uint16_t year;
 
     // Position
-    float latitude;     // Degrees (positive N, negative S)
-    float longitude;    // Degrees (positive E, negative W)
-    float altitude_msl; // Altitude above mean sea level (meters)
+    int32_t latitude_e6;  // Micro-degrees (positive N, negative S)
+    int32_t longitude_e6; // Micro-degrees (positive E, negative W)
+    int32_t altitude_cm;  // Altitude above mean sea level (centimeters, from GGA)
 
     // Movement
-    float speed_knots;  // Speed over ground (knots)
-    float speed_kmh;    // Speed over ground (km/h)
-    float course_deg;   // Course over ground (degrees true)
+    uint16_t speed_kmh_x10;   // Speed over ground (0.1 km/h)
+    uint16_t course_deg_x100; // Course over ground (0.01 degrees true, 0..35999)
 
     // Fix Quality
     uint8_t fix_quality; // 0=Invalid, 1=GPS fix, 2=DGPS fix, etc. (from GGA)
+    uint8_t fix_mode;    // 1=No fix, 2=2D, 3=3D (from GSA)
     bool fix_valid;      // True if fix_quality > 0 and data is considered reliable
     uint8_t satellites_tracked; // Number of satellites used in fix (from GGA)
+    uint16_t hdop_x100;  // Horizontal dilution of precision (GGA/GSA)
+    uint16_t pdop_x100;  // Position dilution of precision (GSA)
+    uint16_t vdop_x100;  // Vertical dilution of precision (GSA)
 
     // Raw NMEA sentence flags (optional, for debugging)
     bool seen_gga;
     bool seen_rmc;
-    // Add flags for other sentences if parsed (e.g., GSA, GSV)
+    bool seen_vtg;
+    bool seen_gsa;
+    bool seen_pvt; // UBX NAV-PVT
 
 } gps_data_t;
 
 /**
  * @brief Initializes the GPS module.
  * Sets up the underlying UART communication (using GPS_UART_ID from config.h)
- * and initializes the NMEA parser state.
+ * and initializes the parser state. With GPS_USE_UBX it also asks the receiver
+ * to switch to GPS_UBX_BAUD; gps_poll() completes the negotiation and hands the
+ * receiver the fix cached in EEPROM, if any, for a warm start.
  */
 void gps_init(void);
 
@@ -57,7 +65,10 @@ void gps_init(void);
  * @brief Processes incoming characters from the GPS UART.
  * This function should be called frequently with each byte received from the
  * GPS receiver (e.g., from a UART RX interrupt or polling loop).
- * It builds and parses NMEA sentences ($GPGGA, $GPRMC, etc.).
+ * Sentences (RMC, GGA, VTG, GSA from any talker) are checksummed and decoded
+ * as the characters arrive; nothing is buffered and the per-byte cost is constant.
+ * UBX frames (sync 0xB5 0x62) are recognised in the same stream.
+ * Decoded values only become visible once the sentence checksum has matched.
  * @param received_char The character received from the GPS UART.
  */
 void gps_process_char(uint8_t received_char);
@@ -65,33 +76,57 @@ void gps_process_char(uint8_t received_char);
 /**
  * @brief Checks if a complete and valid set of GPS data has been received and parsed.
  * Typically checks if essential sentences like RMC and/or GGA have been updated.
+ * Safe to call while the parser runs in an ISR.
  * @return true if new, valid data is available since the last call to gps_get_data, false otherwise.
  */
 bool gps_is_data_available(void);
 
 /**
  * @brief Retrieves the latest parsed GPS data.
- * Copies the internal GPS data structure to the provided pointer.
+ * Copies a consistent image of the internal GPS data structure (retried if a
+ * sentence was published mid-copy, so interrupts stay enabled). Callers that
+ * only need the speed, fix or position should use the accessors below.
  * @param data Pointer to a gps_data_t structure where the latest data will be copied.
  * @return true if the copied data represents a valid fix (gps_data.fix_valid is true), false otherwise.
- *         This function may also reset the "data available" flag internally.
+ *         gps_is_data_available() returns false until the next update.
  */
 bool gps_get_data(gps_data_t *data);
 
+/**
+ * @brief Runs the protocol negotiation with the receiver.
+ * Call periodically (every few milliseconds) from the main loop. In UBX mode
+ * it finishes the baud rate switch and falls back to NMEA if the receiver
+ * never answers in UBX. Also refreshes the cached fix used for the warm start
+ * (GPS_FIX_HINT_* in config.h).
+ */
+void gps_poll(void);
+
+/**
+ * @brief Reports whether the receiver is streaming UBX NAV-PVT.
+ * @return true in UBX mode, false while negotiating or when using NMEA.
+ */
+bool gps_is_ubx_active(void);
+
+/**
+ * @brief Checks whether the latest data holds a valid fix.
+ */
+bool gps_has_fix(void);
+
 /**
  * @brief Gets the current speed reading from the GPS data.
  * Convenience function to access the speed directly.
- * @return Speed in km/h if the fix is valid, or 0.0f (or a negative value) if invalid.
+ * @return Speed in 0.1 km/h if the fix is valid, or 0 if invalid.
  */
-float gps_get_speed_kmh(void);
+uint16_t gps_get_speed_kmh_x10(void);
 
 /**
  * @brief Gets the current location (latitude and longitude).
  * Convenience function to access location directly.
- * @param latitude Pointer to store latitude in degrees.
- * @param longitude Pointer to store longitude in degrees.
- * @return true if the location data is valid (fix is valid), false otherwise.
+ * @param latitude_e6 Pointer to store latitude in micro-degrees.
+ * @param longitude_e6 Pointer to store longitude in micro-degrees.
+ * @return true if the location data is valid (fix is valid), false otherwise
+ *         (both are set to 0 then).
  */
-bool gps_get_location(float *latitude, float *longitude);
+bool gps_get_location(int32_t *latitude_e6, int32_t *longitude_e6);
 
 #endif // MODULES_GPS_H
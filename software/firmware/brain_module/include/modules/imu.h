@@ -0,0 +1,51 @@
+#ifndef MODULES_IMU_H
+#define MODULES_IMU_H
+
+/**
+ * @file imu.h
+ * @brief Interface for the 6-axis IMU (MPU-6050 class) on the I2C bus.
+ * The sensor samples into its on-chip FIFO at IMU_SAMPLE_RATE_HZ; each poll
+ * drains the FIFO in one burst read and updates the heading rate and lean
+ * angle estimates from the batch. The reads run in the background on the
+ * I2C queue, so a poll works on the batch fetched after the previous poll:
+ * the estimates trail the sensor by one IMU_POLL_INTERVAL_MS.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Detects and configures the IMU and starts its FIFO.
+ * Call after hal_i2c_init(). Leaves the module inactive if no IMU answers.
+ */
+void imu_init(void);
+
+/**
+ * @brief Returns true if an IMU was found and configured.
+ */
+bool imu_is_present(void);
+
+/**
+ * @brief Updates the estimates from the last fetched batch and queues the
+ * next FIFO read. Call every IMU_POLL_INTERVAL_MS.
+ * @param speed_kmh_x10 Current speed, for the lean reference and for
+ *        learning the gyro bias while stationary.
+ */
+void imu_poll(uint16_t speed_kmh_x10);
+
+/**
+ * @brief Returns the heading rate over the last drained batch.
+ * Yaw rate about the vertical, with the lean angle taken out.
+ * @return 0.01 degrees per second, positive clockwise (turning right).
+ */
+int16_t imu_get_heading_rate_cdps(void);
+
+/**
+ * @brief Returns the lean angle estimate.
+ * Gyro roll, pulled toward v * yaw rate / g while moving (the accelerometer
+ * cannot see lean in a balanced turn) and toward the gravity vector when stopped.
+ * @return 0.01 degrees, positive leaning right.
+ */
+int16_t imu_get_lean_cdeg(void);
+
+#endif // MODULES_IMU_H
@@ -0,0 +1,108 @@
+#ifndef MODULES_LINK_QUALITY_H
+#define MODULES_LINK_QUALITY_H
+
+/**
+ * @file link_quality.h
+ * @brief Delivery tracking for the frames sent to the Display Module.
+ *
+ * Every NAV, STATUS and FIELD update carries a sequence number (ble_protocol.h).
+ * The display answers with BLE_MSG_LINK_ACK: the newest sequence number it
+ * received, which of the 7 before it arrived, and how many frames it has
+ * received in total. From that this module keeps:
+ * - loss: frames sent minus frames received over each ACK interval, smoothed;
+ * - round-trip time: measured on frames sent with BLE_SEQ_ACK_REQUEST, which
+ *   the display acknowledges at once;
+ * - the fate of the last critical frame (a maneuver change), so the status
+ *   publisher can resend it if it was lost;
+ * - a quality level the publisher uses to stretch its send intervals.
+ *
+ * Until the first ACK arrives (or with a display that never sends one) the
+ * level is LINK_QUALITY_UNKNOWN and the publisher behaves as on a good link.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    LINK_QUALITY_UNKNOWN,  // No ACK seen yet
+    LINK_QUALITY_GOOD,
+    LINK_QUALITY_DEGRADED, // Loss or RTT above the LINK_DEGRADED_* thresholds
+    LINK_QUALITY_POOR      // Heavy loss, or the display stopped acknowledging
+} link_quality_level_t;
+
+typedef struct {
+    uint32_t frames_sent;     // Sequenced frames queued
+    uint32_t frames_received; // Frames the display reported receiving
+    uint32_t frames_lost;     // Frames the ACKs showed missing
+    uint16_t retransmits;     // Lost critical frames resent (link_quality_on_retransmit())
+    uint16_t rtt_ms;          // Smoothed round-trip time (0 until measured)
+    uint16_t loss_permille;   // Smoothed loss rate
+    uint8_t level;            // link_quality_level_t
+} link_quality_stats_t;
+
+/**
+ * @brief Resets the counters and the sequence number.
+ */
+void link_quality_init(void);
+
+/**
+ * @brief Returns the seq byte for the next sequenced frame (BLE_SEQ_OFS).
+ * Does not consume it: call link_quality_on_sent() once the frame is queued.
+ * @param critical Ask the display for an immediate ACK and track delivery.
+ */
+uint8_t link_quality_next_seq(bool critical);
+
+/**
+ * @brief Consumes the sequence number after a frame was queued.
+ * @param critical As passed to link_quality_next_seq().
+ * @param now_ms Current system time.
+ */
+void link_quality_on_sent(bool critical, uint32_t now_ms);
+
+/**
+ * @brief Applies a BLE_MSG_LINK_ACK payload from the display.
+ */
+void link_quality_on_ack(const uint8_t *payload, uint8_t length, uint32_t now_ms);
+
+/**
+ * @brief Reports, once, that the last critical frame was lost.
+ * True if an ACK showed it missing, or none confirmed it within the
+ * retransmit timeout (twice the RTT, at least LINK_RETRANSMIT_MIN_MS).
+ */
+bool link_quality_critical_lost(uint32_t now_ms);
+
+/**
+ * @brief Counts a resend of a lost critical frame, once it was queued.
+ * Call in addition to link_quality_on_sent().
+ */
+void link_quality_on_retransmit(void);
+
+/**
+ * @brief Forgets the ACKs received so far for the connection state, after the
+ * BLE module reported a disconnect.
+ */
+void link_quality_on_disconnect(void);
+
+/**
+ * @brief Decides whether the display is listening.
+ * Connected while its ACKs keep coming (one within LINK_ALIVE_TIMEOUT_MS
+ * since the last disconnect). Until the first ACK ever, for displays that do
+ * not acknowledge, the BLE module's own state decides.
+ * @param transport_up The BLE module reports a connection (ble_uart_is_connected()).
+ * @param now_ms Current system time.
+ */
+bool link_quality_is_connected(bool transport_up, uint32_t now_ms);
+
+/**
+ * @brief Current quality level (link_quality_level_t).
+ * Drops to LINK_QUALITY_POOR when ACKs stop for LINK_ACK_TIMEOUT_MS while
+ * frames are being sent.
+ */
+link_quality_level_t link_quality_get_level(uint32_t now_ms);
+
+/**
+ * @brief Copies the counters.
+ */
+void link_quality_get_stats(link_quality_stats_t *stats);
+
+#endif // MODULES_LINK_QUALITY_H
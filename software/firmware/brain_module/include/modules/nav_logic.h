@@ -0,0 +1,82 @@
+#ifndef MODULES_NAV_LOGIC_H
+#define MODULES_NAV_LOGIC_H
+
+/**
+ * @file nav_logic.h
+ * @brief Navigation Logic Module Interface.
+ * Follows the rider along the route held by the route store and produces the
+ * next maneuver, the distance to it and the bearing to the next route point.
+ * Matching keeps a cursor on the current route segment, so each update only
+ * looks at that segment and the one after it. Between fixes the position is
+ * dead-reckoned from the speed and the last course.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "modules/gps.h"
+#include "modules/signal.h"
+#include "nav_maneuver.h"
+
+/**
+ * @brief Initializes the navigation state. Call after route_store_init().
+ */
+void nav_logic_init(void);
+
+/**
+ * @brief Supplies the latest GPS fix and corrects the position estimate with it.
+ * @param data The fix, or NULL if the fix was lost. Guidance coasts on dead
+ *             reckoning until NAV_DR_MAX_COAST_MS after the last valid fix,
+ *             whether or not invalid fixes arrive in between.
+ */
+void nav_logic_set_gps_data(const gps_data_t *data);
+
+/**
+ * @brief Supplies the current speed (smoothed internally) for dead reckoning.
+ * Call before every nav_logic_update(); the wheel speed is preferred over GPS.
+ * @param speed_kmh_x10 Speed in 0.1 km/h.
+ */
+void nav_logic_set_speed(uint16_t speed_kmh_x10);
+
+/**
+ * @brief Supplies the heading rate, which turns the dead-reckoned course between fixes.
+ * @param rate_cdps 0.01 degrees per second, positive clockwise (0 without an IMU).
+ */
+void nav_logic_set_heading_rate(int16_t rate_cdps);
+
+/**
+ * @brief Supplies the turn signal state.
+ * @param signals Current signal state.
+ */
+void nav_logic_set_signal_state(signal_state_t signals);
+
+/**
+ * @brief Propagates the position estimate, recalculates guidance and publishes it.
+ * Call on every new GPS fix and every NAV_UPDATE_INTERVAL_MS.
+ */
+void nav_logic_update(void);
+
+/**
+ * @brief Returns the current maneuver code.
+ * @return A nav_maneuver_t value.
+ */
+uint8_t nav_logic_get_maneuver(void);
+
+/**
+ * @brief Returns the argument of the current maneuver.
+ * @return Roundabout exit number, otherwise 0.
+ */
+uint8_t nav_logic_get_maneuver_arg(void);
+
+/**
+ * @brief Returns the distance along the route to the next maneuver.
+ * @return Distance in meters (saturates at 65535).
+ */
+uint16_t nav_logic_get_distance_to_next(void);
+
+/**
+ * @brief Returns the bearing from the current position to the next route point.
+ * @return Degrees clockwise from true north (0..359).
+ */
+uint16_t nav_logic_get_bearing_deg(void);
+
+#endif // MODULES_NAV_LOGIC_H
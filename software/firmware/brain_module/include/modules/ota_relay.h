@@ -0,0 +1,38 @@
+#ifndef MODULES_OTA_RELAY_H
+#define MODULES_OTA_RELAY_H
+
+/**
+ * @file ota_relay.h
+ * @brief Relays a Display Module firmware update from the phone.
+ * BLE_MSG_OTA_BEGIN / DATA / END from the phone go to the display as
+ * BLE_MSG_BOOT_BEGIN / DATA / END, and the display bootloader's BLE_MSG_BOOT_ACK
+ * comes back as BLE_MSG_OTA_ACK (see ble_protocol.h). The phone does the
+ * flow control; the relay only forwards, so a frame the link cannot take is
+ * dropped and recovered by the bootloader's resend requests.
+ *
+ * While an update runs the status publisher stays quiet, so the link carries
+ * nothing else. The update counts as over when the bootloader reports
+ * BLE_OTA_DONE, or after OTA_RELAY_IDLE_MS without OTA traffic.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Forwards an OTA frame in the right direction.
+ * Suitable for the BLE UART frame handler, ahead of the other consumers.
+ * @param msg_id Message identifier (ble_msg_id_t).
+ * @param payload Frame payload.
+ * @param length Payload length in bytes.
+ * @param now_ms Current system time.
+ * @return true if the frame belonged to an update (and was forwarded or dropped).
+ */
+bool ota_relay_handle_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length, uint32_t now_ms);
+
+/**
+ * @brief Checks whether an update is running.
+ * @param now_ms Current system time.
+ */
+bool ota_relay_is_active(uint32_t now_ms);
+
+#endif // MODULES_OTA_RELAY_H
@@ -0,0 +1,126 @@
+#ifndef MODULES_RIDE_TRACE_H
+#define MODULES_RIDE_TRACE_H
+
+/**
+ * @file ride_trace.h
+ * @brief Capture and playback of the Brain Module's inputs (ENABLE_RIDE_TRACE).
+ *
+ * Capture timestamps the raw GPS UART bytes, every turn signal edge (before
+ * the debounce) and every wheel pulse (before the noise filter), and streams
+ * them to the external memory (ext_flash.h). Playback feeds a capture back
+ * through gps_process_char(), signal_detector_inject_edge() and
+ * speed_sensor_inject_pulse() in place of the live inputs, in real time or
+ * faster, so a ride can be rerun as often as needed with the profiling
+ * counters (util/perf.h) running.
+ *
+ * Memory layout: a header at address 0, then the records.
+ *   header: "HVT1" | length (u32, record bytes; 0xFFFFFFFF if the capture was cut short)
+ *   record: tag (u8) | delta (varint) | payload
+ *     tag bits 7..6 are the type, bits 5..0 its argument:
+ *       GPS    (0): argument = byte count - 1, payload = the UART bytes
+ *       SIGNAL (1): bit 0 = side (signal_side_t), bit 1 = lit
+ *       SPEED  (2): one wheel pulse
+ *       END    (3): end of the trace (an erased 0xFF reads as END too)
+ *     delta: time since the previous record in RIDE_TRACE_TICK_US units,
+ *       7 bits per byte, low bits first, bit 7 set on all but the last byte.
+ *
+ * Playback clocks signal edges and wheel pulses onto the live timer, scaled
+ * by the speed factor: above 1x the detector sees faster blinking and the
+ * wheel speed reads higher by the same factor. GPS fixes carry their own
+ * time. A lamp already lit when the capture started replays as dark.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "config.h"         // For ENABLE_RIDE_TRACE
+#include "modules/signal.h" // For signal_side_t
+
+#ifndef ENABLE_RIDE_TRACE
+#define ENABLE_RIDE_TRACE 0
+#endif
+
+#define RIDE_TRACE_TICK_US     4 // Timestamp unit (the resolution of hal_timer_micros())
+#define RIDE_TRACE_SPEED_MAX   0 // Playback speed factor: feed records as fast as they read
+
+typedef enum {
+    RIDE_TRACE_IDLE,
+    RIDE_TRACE_CAPTURE,  // Recording (also while the last records are being written out)
+    RIDE_TRACE_PLAYBACK
+} ride_trace_mode_t;
+
+#if ENABLE_RIDE_TRACE
+
+/**
+ * @brief Probes the external memory. Call after hal_i2c_init().
+ */
+void ride_trace_init(void);
+
+/**
+ * @brief Starts a capture, replacing the stored trace.
+ * @return false if no memory is fitted or a capture or playback is running.
+ */
+bool ride_trace_start_capture(void);
+
+/**
+ * @brief Starts replaying the stored trace in place of the live inputs.
+ * @param speed 1 for real time, N for N times faster, RIDE_TRACE_SPEED_MAX
+ *        for as fast as the records read from the memory.
+ * @return false if there is no valid trace or a capture or playback is running.
+ */
+bool ride_trace_start_playback(uint8_t speed);
+
+/**
+ * @brief Ends a capture (the rest is written out by ride_trace_poll()) or a playback.
+ */
+void ride_trace_stop(void);
+
+/**
+ * @brief Returns what the module is doing.
+ */
+ride_trace_mode_t ride_trace_get_mode(void);
+
+/**
+ * @brief Returns the number of records lost since the capture started.
+ * Records are dropped when the staging buffer is full; any drop makes the
+ * trace diverge from the ride.
+ */
+uint16_t ride_trace_get_dropped(void);
+
+/**
+ * @brief Records GPS UART bytes as they are drained. Main loop context.
+ */
+void ride_trace_record_gps(const uint8_t *data, size_t length);
+
+/**
+ * @brief Records a raw turn signal edge. Called from the edge ISR.
+ */
+void ride_trace_record_signal(signal_side_t side, bool lit);
+
+/**
+ * @brief Records a wheel pulse. Called from the pin change ISR.
+ */
+void ride_trace_record_speed_pulse(void);
+
+/**
+ * @brief Writes captured records out, or feeds the records that are due.
+ * Call with the GPS drain (every COMM_POLL_INTERVAL_MS at most).
+ */
+void ride_trace_poll(void);
+
+#else // Ride trace compiled out
+
+static inline void ride_trace_init(void) {}
+static inline bool ride_trace_start_capture(void) { return false; }
+static inline bool ride_trace_start_playback(uint8_t speed) { (void)speed; return false; }
+static inline void ride_trace_stop(void) {}
+static inline ride_trace_mode_t ride_trace_get_mode(void) { return RIDE_TRACE_IDLE; }
+static inline uint16_t ride_trace_get_dropped(void) { return 0; }
+static inline void ride_trace_record_gps(const uint8_t *data, size_t length) { (void)data; (void)length; }
+static inline void ride_trace_record_signal(signal_side_t side, bool lit) { (void)side; (void)lit; }
+static inline void ride_trace_record_speed_pulse(void) {}
+static inline void ride_trace_poll(void) {}
+
+#endif // ENABLE_RIDE_TRACE
+
+#endif // MODULES_RIDE_TRACE_H
@@ -0,0 +1,66 @@
+#ifndef MODULES_ROUTE_STORE_H
+#define MODULES_ROUTE_STORE_H
+
+/**
+ * @file route_store.h
+ * @brief Persistent store for the active route.
+ * The phone app loads a route over BLE as a list of maneuver points
+ * (BLE_MSG_ROUTE_BEGIN / POINTS / END, see ble_protocol.h). Points are kept in
+ * EEPROM and read back one at a time, so navigation only holds a small window
+ * of the route in RAM. A route survives power cycles until it is replaced.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nav_maneuver.h"
+
+// One route point, as stored (BLE_ROUTE_PT_LEN bytes in EEPROM).
+typedef struct {
+    int32_t lat_e6;   // Micro-degrees
+    int32_t lon_e6;   // Micro-degrees
+    uint8_t maneuver; // nav_maneuver_t to perform at this point (NONE for shape points)
+    uint8_t arg;      // Maneuver argument (e.g. roundabout exit number)
+} route_point_t;
+
+/**
+ * @brief Loads the stored route header from EEPROM.
+ * An invalid or partially written route is treated as no route.
+ */
+void route_store_init(void);
+
+/**
+ * @brief Handles a route message received from the phone.
+ * Suitable as the BLE UART frame handler; other message IDs are ignored.
+ * @param msg_id Message identifier (ble_msg_id_t).
+ * @param payload Frame payload.
+ * @param length Payload length in bytes.
+ */
+void route_store_handle_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length);
+
+/**
+ * @brief Advances pending EEPROM writes and sends the resulting acknowledgements.
+ * Non-blocking; call every few milliseconds.
+ */
+void route_store_poll(void);
+
+/**
+ * @brief Returns the number of points in the active route.
+ * @return Point count, or 0 if there is no complete route (including while loading).
+ */
+uint16_t route_store_get_count(void);
+
+/**
+ * @brief Returns a counter that changes whenever the active route changes.
+ * Lets navigation notice a new route without a callback.
+ */
+uint8_t route_store_get_revision(void);
+
+/**
+ * @brief Reads one point of the active route.
+ * @param index Point index (0 .. count-1).
+ * @param point Destination.
+ * @return false if the index is out of range or there is no route.
+ */
+bool route_store_get_point(uint16_t index, route_point_t *point);
+
+#endif // MODULES_ROUTE_STORE_H
@@ -0,0 +1,66 @@
+#ifndef MODULES_SETTINGS_H
+#define MODULES_SETTINGS_H
+
+/**
+ * @file settings.h
+ * @brief Persistent settings: calibration and publishing intervals that can
+ * change without a rebuild.
+ *
+ * The values in config.h are the defaults. settings_init() loads the saved
+ * copy from EEPROM (util/persist.h) into RAM once at start-up; modules read
+ * it through settings_get(). The phone changes a value with
+ * BLE_MSG_CONFIG_SET under a ble_config_key_t key (ble_protocol.h), and the
+ * RAM copy is saved SETTINGS_SAVE_DELAY_MS after the last change, so a burst
+ * of changes costs one EEPROM write. Keys of the Display Module are relayed
+ * to it. Modules that derive a constant from a setting (the battery scale,
+ * the wheel speed numerator) recompute it when settings_get_revision() changes.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint16_t battery_r1_ohms;        // Battery divider, upper resistor
+    uint16_t battery_r2_ohms;        // Battery divider, lower resistor
+    uint16_t battery_vref_mv;        // ADC reference
+    uint16_t wheel_circumference_mm; // Rolling circumference of the sensed wheel
+    uint16_t status_speed_ms;        // Minimum interval between speed updates
+    uint16_t status_nav_ms;          // Minimum interval between distance-only nav updates
+    uint16_t status_keyframe_ms;     // Full status + nav resend period
+    uint16_t status_battery_ms;      // Battery sampling and update period
+    uint16_t status_heartbeat_ms;    // Heartbeat after this long with nothing sent
+    uint8_t wheel_pulses_per_rev;    // Magnets per wheel revolution
+    uint8_t speed_smoothing_shift;   // Speed EMA alpha = 1 / 2^shift
+    uint8_t signal_debounce_ms;      // Turn signal edge lock-out
+} settings_t;
+
+/**
+ * @brief Loads the saved settings, or the config.h defaults if there are none.
+ * Call before the modules that read settings are initialized.
+ */
+void settings_init(void);
+
+/**
+ * @brief Returns the current settings (always valid, the defaults until settings_init()).
+ */
+const settings_t *settings_get(void);
+
+/**
+ * @brief Returns a counter that changes whenever a setting changes.
+ */
+uint8_t settings_get_revision(void);
+
+/**
+ * @brief Handles BLE_MSG_CONFIG_SET/GET from the phone and the display's
+ * BLE_MSG_DISPLAY_CONFIG_VALUE answers; relays display keys.
+ * @return true if the frame was a settings message.
+ */
+bool settings_handle_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length, uint32_t now_ms);
+
+/**
+ * @brief Saves changed settings once SETTINGS_SAVE_DELAY_MS has passed since
+ * the last change. Call periodically, along with persist_poll().
+ */
+void settings_poll(uint32_t now_ms);
+
+#endif // MODULES_SETTINGS_H
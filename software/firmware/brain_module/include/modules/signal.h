@@ -0,0 +1,80 @@
+#ifndef MODULES_SIGNAL_H
+#define MODULES_SIGNAL_H
+
+/**
+ * @file signal.h
+ * @brief Interface for the Turn Signal Detector module.
+ * The indicator lines interrupt on every edge (INT0/INT1); the ISR debounces
+ * and timestamps the transitions. The getters classify each side from those
+ * timestamps when called, so nothing polls the pins.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Combined turn signal state, as sent to the display (BLE_FIELD_SIGNAL).
+typedef enum {
+    SIGNAL_STATE_OFF = 0,
+    SIGNAL_STATE_LEFT = 1,
+    SIGNAL_STATE_RIGHT = 2,
+    SIGNAL_STATE_HAZARD = 3
+} signal_state_t;
+
+// Indicator side.
+typedef enum {
+    SIGNAL_SIDE_LEFT = 0,
+    SIGNAL_SIDE_RIGHT = 1
+} signal_side_t;
+
+// What one indicator line is doing, judged from its edge periods.
+typedef enum {
+    SIGNAL_MODE_OFF,      // Dark, or last flash longer than SIGNAL_BLINK_MAX_PERIOD_MS ago
+    SIGNAL_MODE_BLINKING, // Flashing at a turn signal rate (the lit phase of the first flash included)
+    SIGNAL_MODE_STEADY    // Lit without flashing, or flickering too fast (running light, failed flasher)
+} signal_mode_t;
+
+typedef void (*signal_edge_handler_t)(void);
+
+/**
+ * @brief Configures the signal inputs and their edge interrupts.
+ * Call after hal_timer_init(); global interrupts must be enabled for capture.
+ */
+void signal_detector_init(void);
+
+/**
+ * @brief Registers a function called from the ISR on every accepted edge.
+ * Typically used to wake the task that publishes the signal state.
+ * @param handler Function to call, or NULL.
+ */
+void signal_detector_set_edge_handler(signal_edge_handler_t handler);
+
+/**
+ * @brief Returns the combined turn signal state.
+ * A side must be blinking to count; both sides blinking in phase is hazard.
+ * @return Current signal state.
+ */
+signal_state_t signal_detector_get_state(void);
+
+/**
+ * @brief Returns what one indicator line is doing.
+ * @param side Indicator side.
+ * @return Current mode of that side.
+ */
+signal_mode_t signal_detector_get_mode(signal_side_t side);
+
+/**
+ * @brief Switches both sides between the indicator pins and injected edges.
+ * While on, pin edges are ignored and both sides start dark (ride_trace.h playback).
+ * Switching back picks up the live pin levels on the next read.
+ */
+void signal_detector_set_replay(bool enabled);
+
+/**
+ * @brief Feeds one edge while replay is on, as the edge ISR would see it.
+ * @param side Indicator side.
+ * @param lit New level (true = lamp on).
+ * @param at_ms Time of the edge on hal_timer_millis(); at or before now.
+ */
+void signal_detector_inject_edge(signal_side_t side, bool lit, uint32_t at_ms);
+
+#endif // MODULES_SIGNAL_H
@@ -0,0 +1,62 @@
+#ifndef MODULES_SPEED_H
+#define MODULES_SPEED_H
+
+/**
+ * @file speed.h
+ * @brief Interface for the wheel speed sensor.
+ * A Hall sensor on SPEED_SENSOR_PIN pulses once per magnet pass. The pin
+ * change ISR timestamps each pulse with the microsecond timer, and the speed
+ * is computed from the last pulse period when read, so it updates with every
+ * wheel revolution instead of with the GPS fix rate.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Configures the sensor input and its pin change interrupt.
+ * Call after hal_timer_init(). Does nothing if ENABLE_SPEED_SENSOR is 0.
+ */
+void speed_sensor_init(void);
+
+/**
+ * @brief Returns true once the sensor has measured a pulse period.
+ * Until then (or if no sensor is fitted) callers should use the GPS speed.
+ */
+bool speed_sensor_is_present(void);
+
+/**
+ * @brief Returns the wheel speed.
+ * While the next pulse is overdue the elapsed time is used as the period, so
+ * the value decays when the wheel slows down; it is 0 after SPEED_TIMEOUT_MS.
+ * @return Speed in 0.1 km/h.
+ */
+uint16_t speed_sensor_get_speed_kmh_x10(void);
+
+/**
+ * @brief Sets the lean angle the speed is corrected for: leaned over, the tyre
+ * rolls on a smaller radius (SPEED_TYRE_CROWN_RADIUS_MM) and the wheel turns
+ * faster than the road speed. Call with every new lean estimate (imu.h).
+ * @param lean_cdeg Lean in 0.01 degrees, either side.
+ */
+void speed_sensor_set_lean_cdeg(int16_t lean_cdeg);
+
+/**
+ * @brief Returns the number of pulses counted since init (wraps).
+ * One pulse is SPEED_WHEEL_CIRCUMFERENCE_MM / SPEED_PULSES_PER_REV of travel.
+ */
+uint16_t speed_sensor_get_pulse_count(void);
+
+/**
+ * @brief Switches between the sensor pin and injected pulses (ride_trace.h playback).
+ * Either way the period is measured afresh from the next two pulses.
+ */
+void speed_sensor_set_replay(bool enabled);
+
+/**
+ * @brief Feeds one pulse while replay is on, as the pin change ISR would see it.
+ * @param at_us Time of the pulse on hal_timer_micros(); at or before now.
+ */
+void speed_sensor_inject_pulse(uint32_t at_us);
+
+#endif // MODULES_SPEED_H
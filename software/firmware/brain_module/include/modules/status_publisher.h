@@ -0,0 +1,63 @@
+#ifndef MODULES_STATUS_PUBLISHER_H
+#define MODULES_STATUS_PUBLISHER_H
+
+/**
+ * @file status_publisher.h
+ * @brief Change-driven publisher for the status and navigation data sent to the Display Module.
+ * Producers push their latest values; the publisher remembers what was last sent
+ * and transmits only the fields that changed, each subject to its own rate limit
+ * (settings.h; the defaults are STATUS_*_INTERVAL_MS in config.h). A periodic keyframe resends everything
+ * so the display can recover after a dropout. Lost maneuver changes are resent,
+ * and the intervals stretch while the link is degraded (see link_quality.h).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Initializes the publisher state.
+ * Marks every field as unsent so the first update produces a keyframe.
+ */
+void status_publisher_init(void);
+
+/**
+ * @brief Sets the current turn signal state.
+ * A change is sent on the next call to status_publisher_update() with no rate limit.
+ * @param signal_status Current signal state (signal_state_t value).
+ */
+void status_publisher_set_signal(uint8_t signal_status);
+
+/**
+ * @brief Sets the current speed.
+ * @param speed_kmh Current speed in km/h.
+ */
+void status_publisher_set_speed(uint8_t speed_kmh);
+
+/**
+ * @brief Sets the current battery voltage.
+ * @param battery_mv Battery voltage in millivolts.
+ */
+void status_publisher_set_battery(uint16_t battery_mv);
+
+/**
+ * @brief Sets the current maneuver and the distance to it.
+ * Maneuver changes are sent immediately; distance-only changes are rate limited.
+ * @param maneuver The next maneuver (nav_maneuver_t value).
+ * @param arg The maneuver argument (roundabout exit number, otherwise 0).
+ * @param distance_m Distance to the next maneuver in meters.
+ */
+void status_publisher_set_nav(uint8_t maneuver, uint8_t arg, uint16_t distance_m);
+
+/**
+ * @brief Forces a full keyframe (status + nav) on the next update.
+ * Used when the display asks to resync (BLE_MSG_KEYFRAME_REQUEST).
+ */
+void status_publisher_request_keyframe(void);
+
+/**
+ * @brief Sends whatever is due. Call once per main loop iteration.
+ * @param now_ms Current system time in milliseconds.
+ */
+void status_publisher_update(uint32_t now_ms);
+
+#endif // MODULES_STATUS_PUBLISHER_H
@@ -0,0 +1,30 @@
+#ifndef PERF_SECTIONS_H
+#define PERF_SECTIONS_H
+
+/**
+ * @file perf_sections.h
+ * @brief Brain Module profiling sections and counters (see util/perf.h).
+ * Report order follows list order; names are what diagnostics.py prints.
+ */
+
+#define PERF_SECTIONS(X) \
+    X(GPS_CHAR,       "gps_char")      /* gps_process_char(), per byte */ \
+    X(NMEA_SENTENCE,  "nmea_sentence") /* Checksum check and commit of a sentence */ \
+    X(NAV_UPDATE,     "nav_update")    /* nav_logic_update() */ \
+    X(BLE_SEND,       "ble_send")      /* ble_uart_send_*(): encode and queue a frame */
+
+#define PERF_COUNTERS(X) \
+    X(MAIN_LOOP,      "main_loop")     /* Super-loop passes in the report window */ \
+    X(GPS_OVERRUN,    "gps_overrun")   /* GPS UART overruns plus RX ring drops, since boot */ \
+    X(BLE_OVERRUN,    "ble_overrun")   /* BLE UART overruns plus RX ring drops, since boot */ \
+    X(NMEA_CHECKSUM,  "nmea_checksum") /* Sentences dropped for a bad checksum */ \
+    X(NMEA_OVERFLOW,  "nmea_overflow") /* Sentences dropped for exceeding the buffer */ \
+    X(BLE_CRC,        "ble_crc")       /* Phone frames dropped for a bad CRC, since boot */ \
+    X(BLE_FRAMING,    "ble_framing")   /* Phone frames dropped for a bad length or END, since boot */ \
+    X(TRACE_DROP,     "trace_drop")    /* Ride trace records lost in the current capture */ \
+    X(LINK_SENT,      "link_sent")     /* Sequenced frames sent to the display, since boot */ \
+    X(LINK_LOST,      "link_lost")     /* Of those, reported missing by the display's ACKs */ \
+    X(LINK_RETX,      "link_retx")     /* Maneuver changes found lost and resent */ \
+    X(LINK_RTT,       "link_rtt_ms")   /* Smoothed round-trip time of critical frames */
+
+#endif // PERF_SECTIONS_H
@@ -7,14 +7,20 @@
 #include "modules/ble_uart.h" // Use the module header file name
 #include "hal/uart.h"
 #include "util/logger.h"
-#include <stdio.h>  // For snprintf
-#include <string.h> // For strlen, memcpy
+#include "ble_protocol.h" // Shared binary frame format
+#include "link_mux.h"
+#include "hal/timer.h"
+#include "modules/link_quality.h"
+#include "util/perf.h"
+#include <string.h> // For strstr
 
 // --- Defines ---
-#define BLE_CMD_BUFFER_SIZE 128 // Max size for formatted commands/data packets
+#define BLE_CMD_BUFFER_SIZE 128 // Max size for text responses from the BLE module
 
 // --- Internal State ---
-static bool ble_connected = false; // Placeholder connection status
+static bool ble_connected = false; // From the module's CONNECT/DISCONNECT lines
+static ble_parser_t rx_parser;     // Binary frames from the phone
+static ble_uart_frame_handler_t frame_handler = NULL;
 
 // --- Helper Functions ---
 
@@ -22,13 +28,48 @@ static bool ble_connected = false; // Placeholder connection status
 static bool send_packet(const uint8_t *packet, size_t length) {
     if (length == 0) return false;
 
-    // Add framing or encoding if required by the communication protocol.
-    // For this example, send raw data.
-    hal_uart_write(BLE_UART_ID, packet, length);
+    // Data channel: queued whole or not at all, ahead of any log output.
+    if (!link_mux_send(LINK_CHANNEL_DATA, packet, length)) {
+        log_warn("BLE: TX buffer full, dropped %d byte frame", length);
+        return false;
+    }
     log_debug("BLE: Sent %d bytes", length);
     return true; // Indicate success
 }
 
+// Wrap a payload in a protocol frame and send it.
+static bool send_frame(ble_msg_id_t msg_id, const uint8_t *payload, uint8_t length) {
+    PERF_SCOPE(BLE_SEND);
+    uint8_t frame[BLE_PROTO_MAX_FRAME];
+    size_t frame_len = ble_frame_encode(frame, sizeof(frame), msg_id, payload, length);
+    if (frame_len == 0) {
+        log_error("BLE UART: Failed to encode frame 0x%02X (%u bytes)", msg_id, length);
+        return false;
+    }
+    return send_packet(frame, frame_len);
+}
+
+// Send a sequenced frame; payload[BLE_SEQ_OFS] is filled in here.
+static bool send_sequenced(ble_msg_id_t msg_id, uint8_t *payload, uint8_t length, bool critical) {
+    payload[BLE_SEQ_OFS] = link_quality_next_seq(critical);
+    if (!send_frame(msg_id, payload, length)) {
+        return false; // Sequence number not used: the display sees no gap
+    }
+    link_quality_on_sent(critical, hal_timer_millis());
+    return true;
+}
+
+// True if token appears in line as a word start: "DISCONNECT" does not contain the token "CONNECT".
+static bool line_has_token(const char *line, const char *token) {
+    for (const char *p = line; (p = strstr(p, token)) != NULL; ++p) {
+        char before = (p == line) ? ' ' : p[-1];
+        if (!((before >= 'A' && before <= 'Z') || (before >= 'a' && before <= 'z'))) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // --- Public API Implementation ---
 
 void ble_uart_init(void) {
@@ -40,47 +81,82 @@ void ble_uart_init(void) {
     // This might involve sending specific AT commands to configure the module.
 
     ble_connected = false; // Assume not connected initially
+    ble_parser_init(&rx_parser);
     log_info("BLE UART: Initialized on UART %d.", BLE_UART_ID);
 }
 
 bool ble_uart_send_data(const uint8_t *data, size_t length) {
+    PERF_SCOPE(BLE_SEND);
     log_debug("BLE UART: Sending raw data (%d bytes)", length);
     return send_packet(data, length);
 }
 
-bool ble_uart_send_nav_update(const char* instruction, uint16_t distance) {
-    char buffer[BLE_CMD_BUFFER_SIZE];
+bool ble_uart_send_nav_update(uint8_t maneuver, uint8_t arg, uint16_t distance, bool critical) {
+    uint8_t payload[BLE_NAV_LEN];
 
-    // Format the navigation update message (example format: "NAV:Instruction,Distance\n")
-    int len = snprintf(buffer, BLE_CMD_BUFFER_SIZE, "NAV:%s,%u\n",
-                       instruction ? instruction : "NULL",
-                       distance);
+    // Payload: seq | distance_m (u16 LE) | maneuver (u8) | arg (u8)
+    ble_put_u16(&payload[BLE_NAV_OFS_DISTANCE], distance);
+    payload[BLE_NAV_OFS_MANEUVER] = maneuver;
+    payload[BLE_NAV_OFS_ARG] = arg;
 
-    if (len > 0 && len < BLE_CMD_BUFFER_SIZE) {
-        log_info("BLE UART: Sending Nav Update: %s", buffer);
-        return send_packet((uint8_t*)buffer, len);
-    } else {
-        log_error("BLE UART: Failed to format nav update (buffer overflow?)");
-        return false;
-    }
+    log_debug("BLE UART: Sending Nav Update: maneuver %u, %u m", maneuver, distance);
+    return send_sequenced(BLE_MSG_NAV_UPDATE, payload, BLE_NAV_LEN, critical);
 }
 
 bool ble_uart_send_status_update(uint16_t battery_voltage_mv, uint8_t signal_status, uint8_t speed_kmh) {
-    char buffer[BLE_CMD_BUFFER_SIZE];
+    uint8_t payload[BLE_STATUS_LEN];
 
-    // Format the status update message (example format: "STATUS:Batt_mV,Signals,Speed_kmh\n")
-    int len = snprintf(buffer, BLE_CMD_BUFFER_SIZE, "STATUS:%u,%u,%u\n",
-                       battery_voltage_mv,
-                       signal_status,
-                       speed_kmh);
+    ble_put_u16(&payload[BLE_STATUS_OFS_BATTERY], battery_voltage_mv);
+    payload[BLE_STATUS_OFS_SIGNAL] = signal_status;
+    payload[BLE_STATUS_OFS_SPEED] = speed_kmh;
 
-     if (len > 0 && len < BLE_CMD_BUFFER_SIZE) {
-        log_info("BLE UART: Sending Status: %s", buffer);
-        return send_packet((uint8_t*)buffer, len);
-    } else {
-        log_error("BLE UART: Failed to format status update (buffer overflow?)");
-        return false;
+    log_debug("BLE UART: Sending Status: %u mV, Sig=%u, %u km/h", battery_voltage_mv, signal_status, speed_kmh);
+    return send_sequenced(BLE_MSG_STATUS_UPDATE, payload, sizeof(payload), false);
+}
+
+bool ble_uart_send_field_update(uint8_t field_mask, uint16_t battery_voltage_mv, uint8_t signal_status, uint8_t speed_kmh) {
+    uint8_t payload[BLE_FIELD_UPDATE_MAX_LEN];
+    uint8_t len = BLE_FIELD_OFS_DATA;
+
+    field_mask &= BLE_FIELD_ALL;
+    if (field_mask == 0) return false;
+
+    // Fields follow the mask byte in bit order.
+    payload[BLE_FIELD_OFS_MASK] = field_mask;
+    if (field_mask & BLE_FIELD_BATTERY) {
+        ble_put_u16(&payload[len], battery_voltage_mv);
+        len += 2;
     }
+    if (field_mask & BLE_FIELD_SIGNAL) {
+        payload[len++] = signal_status;
+    }
+    if (field_mask & BLE_FIELD_SPEED) {
+        payload[len++] = speed_kmh;
+    }
+
+    log_debug("BLE UART: Sending Field Update: mask=0x%02X", field_mask);
+    return send_sequenced(BLE_MSG_FIELD_UPDATE, payload, len, false);
+}
+
+bool ble_uart_send_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length) {
+    return send_frame((ble_msg_id_t)msg_id, payload, length);
+}
+
+bool ble_uart_send_heartbeat(void) {
+    uint8_t payload[BLE_HEARTBEAT_LEN];
+    return send_sequenced(BLE_MSG_HEARTBEAT, payload, sizeof(payload), false);
+}
+
+bool ble_uart_send_route_ack(uint16_t next_index, uint8_t status) {
+    uint8_t payload[BLE_ROUTE_ACK_LEN];
+
+    ble_put_u16(&payload[0], next_index);
+    payload[2] = status;
+    return send_frame(BLE_MSG_ROUTE_ACK, payload, sizeof(payload));
+}
+
+void ble_uart_set_frame_handler(ble_uart_frame_handler_t handler) {
+    frame_handler = handler;
 }
 
 void ble_uart_process_char(uint8_t received_char) {
@@ -89,6 +165,18 @@ void ble_uart_process_char(uint8_t received_char) {
     static char ble_rx_buffer[BLE_CMD_BUFFER_SIZE];
     static uint8_t ble_rx_idx = 0;
 
+    // Binary frames from the phone take priority over module text lines.
+    bool in_frame = rx_parser.state != BLE_PARSE_WAIT_START;
+    if (ble_parser_feed(&rx_parser, received_char)) {
+        if (frame_handler) {
+            frame_handler(rx_parser.msg_id, rx_parser.payload, rx_parser.length);
+        }
+        return;
+    }
+    if (in_frame || rx_parser.state != BLE_PARSE_WAIT_START) {
+        return; // Byte belongs to a frame (or started one)
+    }
+
     if (received_char == '\n') {
         ble_rx_buffer[ble_rx_idx] = '\0'; // Null-terminate
         if (ble_rx_idx > 0 && ble_rx_buffer[ble_rx_idx - 1] == '\r') {
@@ -96,16 +184,14 @@ void ble_uart_process_char(uint8_t received_char) {
         }
         log_debug("BLE RX: %s", ble_rx_buffer);
 
-        // Parse the received line (ble_rx_buffer) for known responses or data packets.
-        // Update internal state (e.g., ble_connected) based on parsed messages.
-        if (strstr(ble_rx_buffer, "CONNECT") != NULL) { // Simplified check
-            log_info("BLE UART: Connection detected");
-            ble_connected = true;
-        } else if (strstr(ble_rx_buffer, "DISCONNECT") != NULL) { // Simplified check
+        // Module status lines. DISCONNECT first: it contains CONNECT.
+        if (line_has_token(ble_rx_buffer, "DISCONNECT")) {
             log_info("BLE UART: Disconnection detected");
             ble_connected = false;
-        } else {
-            // Handle other received data/responses as needed.
+            link_quality_on_disconnect(); // ACKs from before no longer count
+        } else if (line_has_token(ble_rx_buffer, "CONNECT")) {
+            log_info("BLE UART: Connection detected");
+            ble_connected = true;
         }
 
         ble_rx_idx = 0; // Reset buffer for next message
@@ -117,6 +203,11 @@ void ble_uart_process_char(uint8_t received_char) {
     }
 }
 
+void ble_uart_get_parser_errors(uint16_t *crc_errors, uint16_t *framing_errors) {
+    if (crc_errors) *crc_errors = rx_parser.crc_errors;
+    if (framing_errors) *framing_errors = rx_parser.framing_errors;
+}
+
 bool ble_uart_is_connected(void) {
     // Return the last known connection status.
     return ble_connected;
@@ -0,0 +1,116 @@
+/**
+ * @file ext_flash.c
+ * @brief Driver for the AT24CM02 class serial memory on the I2C bus.
+ * The high address bits select one of four 64 KB blocks through the device
+ * address; the low 16 bits go out big-endian ahead of the data. The write
+ * cycle is timed rather than ACK polled, which would tie up the bus the IMU
+ * shares. Writes go out from the I2C queue; the cycle is timed from their
+ * completion. Reads (trace playback only) use the blocking wrapper.
+ */
+
+#include "modules/ext_flash.h" // Use the module header file name
+#include "hal/i2c.h"
+#include "hal/timer.h"
+#include "util/logger.h"
+#include "config.h"
+#include <string.h>
+#include <util/atomic.h> // For ATOMIC_BLOCK
+
+// --- Defines ---
+#define EXT_FLASH_BLOCK_BITS 16 // Address bits sent after the device address
+
+_Static_assert(EXT_FLASH_WRITE_MAX <= EXT_FLASH_PAGE_SIZE && (EXT_FLASH_PAGE_SIZE % EXT_FLASH_WRITE_MAX) == 0,
+               "EXT_FLASH_WRITE_MAX must divide the page size");
+
+// --- Internal State ---
+static bool present = false;
+static volatile bool write_pending = false; // A write cycle started at write_ms
+static volatile bool write_failed = false;  // Reported by the next ext_flash_is_busy()
+static uint32_t write_ms = 0;
+static uint32_t failed_address = 0;
+static i2c_request_t write_req;             // status is I2C_OK (0) until the first write
+static uint8_t write_buf[EXT_FLASH_WRITE_MAX];
+
+// --- Internal Helper Functions ---
+
+static uint8_t device_address(uint32_t address) {
+    return (uint8_t)(EXT_FLASH_I2C_ADDRESS | (address >> EXT_FLASH_BLOCK_BITS));
+}
+
+// TWI interrupt: the page is in the part's buffer, its write cycle starts now.
+static void on_write_done(i2c_status_t status, void *context) {
+    (void)context;
+    if (status == I2C_OK) {
+        write_ms = hal_timer_millis();
+        write_pending = true;
+    } else {
+        write_failed = true;
+    }
+}
+
+// --- Public API Implementation ---
+
+bool ext_flash_init(void) {
+    present = hal_i2c_probe(MAIN_I2C_ID, EXT_FLASH_I2C_ADDRESS);
+    write_pending = false;
+    if (present) {
+        log_info("Ext Flash: %lu bytes at 0x%02X", EXT_FLASH_SIZE_BYTES, EXT_FLASH_I2C_ADDRESS);
+    } else {
+        log_info("Ext Flash: Not fitted");
+    }
+    return present;
+}
+
+bool ext_flash_is_present(void) {
+    return present;
+}
+
+bool ext_flash_is_busy(void) {
+    bool busy;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (write_pending && hal_timer_millis() - write_ms > EXT_FLASH_WRITE_CYCLE_MS) {
+            write_pending = false; // Strictly greater: the tick may be up to 1 ms late
+        }
+        busy = write_pending || write_req.status == I2C_PENDING;
+    }
+    if (write_failed) {
+        write_failed = false;
+        log_warn("Ext Flash: Write failed at %lu", failed_address);
+    }
+    return busy;
+}
+
+bool ext_flash_write(uint32_t address, const uint8_t *data, uint8_t length) {
+    if (!present || ext_flash_is_busy() || length == 0 || length > EXT_FLASH_WRITE_MAX ||
+        address + length > EXT_FLASH_SIZE_BYTES ||
+        (address % EXT_FLASH_PAGE_SIZE) + length > EXT_FLASH_PAGE_SIZE) {
+        return false;
+    }
+
+    memcpy(write_buf, data, length);
+    write_req.address = device_address(address);
+    write_req.prefix_length = 2;
+    write_req.prefix[0] = (uint8_t)(address >> 8);
+    write_req.prefix[1] = (uint8_t)address;
+    write_req.tx_data = write_buf;
+    write_req.tx_length = length;
+    write_req.rx_data = NULL;
+    write_req.rx_length = 0;
+    write_req.callback = on_write_done;
+    failed_address = address;
+    return hal_i2c_submit(MAIN_I2C_ID, &write_req);
+}
+
+bool ext_flash_read(uint32_t address, uint8_t *data, size_t length) {
+    if (!present || ext_flash_is_busy() || length == 0 || address + length > EXT_FLASH_SIZE_BYTES ||
+        device_address(address) != device_address(address + length - 1)) {
+        return false;
+    }
+
+    uint8_t addr[2] = { (uint8_t)(address >> 8), (uint8_t)address };
+    if (hal_i2c_write_read(MAIN_I2C_ID, device_address(address), addr, sizeof(addr), data, length) != I2C_OK) {
+        log_warn("Ext Flash: Read failed at %lu", address);
+        return false;
+    }
+    return true;
+}
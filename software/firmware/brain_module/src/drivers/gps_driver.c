@@ -3,173 +3,744 @@
  * @brief Driver for handling GPS communication and NMEA sentence parsing.
  * Interacts with the UART HAL to receive data and provides structured GPS info.
  *
- * This implementation focuses on parsing $GPRMC and $GPGGA sentences.
+ * The parser is a single-pass state machine: every byte updates the running
+ * checksum and the value of the current field, so no sentence is buffered and
+ * the cost per byte is a small constant. Recognised sentences (RMC, GGA, VTG,
+ * GSA from any talker) decode into a scratch copy of the GPS data that is only
+ * published once the checksum has matched. All arithmetic is integer.
+ *
+ * With GPS_USE_UBX the receiver is switched to GPS_UBX_BAUD and binary
+ * NAV-PVT output at startup. UBX frames are decoded the same way, byte by
+ * byte into the scratch copy. If no UBX frame arrives in time the driver
+ * returns to GPS_UART_BAUD and keeps parsing NMEA.
+ *
+ * The last good 3D fix is cached in EEPROM (util/persist.h) and, in UBX mode,
+ * handed back to the receiver at the next start as an approximate position,
+ * which shortens the satellite search (warm start). The cache is rewritten
+ * only once the bike has moved GPS_FIX_HINT_MOVE_M from it.
+ *
+ * Published data sits behind a sequence lock (util/snapshot.h): the parser
+ * may run in the UART ISR or the main loop, and readers always get a
+ * consistent copy, of the whole structure or of just the fields they need.
  */
 
 #include "modules/gps.h" // Use the module header file name
 #include "hal/uart.h"
+#include "hal/timer.h"
 #include "util/logger.h"
-#include <string.h> // For strcmp, strlen, etc.
-#include <stdlib.h> // For atof, atoi
-#include <stdio.h>  // For sscanf (use with caution on embedded systems due to code size)
+#include "util/fixed.h"
+#include "util/perf.h"
+#include "util/persist.h"
+#include "util/snapshot.h"
+#include <stddef.h> // For NULL
+#include <string.h> // For memcpy, memset
 
 // --- Defines ---
-#define NMEA_MAX_SENTENCE_LEN 82   // Maximum NMEA sentence length
-#define NMEA_MAX_FIELDS 20         // Maximum number of comma-separated fields expected
+#define NMEA_MAX_SENTENCE_LEN 82 // Maximum NMEA sentence length, '$' to LF
+#define NMEA_MAX_FRAC_DIGITS 5   // Fraction digits kept per field (enough for minutes_e5)
+
+#define UBX_SYNC_CHAR_1 0xB5
+#define UBX_SYNC_CHAR_2 0x62
+#define UBX_MAX_PAYLOAD 512      // Longer frames are treated as corrupt
+#define UBX_CLASS_NAV 0x01
+#define UBX_CLASS_ACK 0x05
+#define UBX_CLASS_CFG 0x06
+#define UBX_NAV_PVT 0x07
+#define UBX_NAV_PVT_LEN 92
+#define UBX_ACK_NAK 0x00
+#define UBX_ACK_ACK 0x01
+#define UBX_CFG_PRT 0x00
+#define UBX_CFG_MSG 0x01
+#define UBX_CFG_RATE 0x08
+#define UBX_CLASS_MGA 0x13
+#define UBX_MGA_INI 0x40
+#define UBX_MGA_INI_POS_LLH 0x01 // MGA-INI type byte
+#define NMEA_STD_CLASS 0xF0      // UBX class of the standard NMEA messages
+
+#define GPS_FIX_VERSION 1 // Bump when gps_fix_hint_t changes layout
+#define GPS_FIX_SLOTS   4
+
+// --- Internal Data Structures ---
+
+// Cached position for the warm start.
+typedef struct {
+    int32_t latitude_e6;
+    int32_t longitude_e6;
+    int16_t altitude_m;
+} gps_fix_hint_t;
+
+typedef enum {
+    NMEA_STATE_IDLE,        // Waiting for '$'
+    NMEA_STATE_BODY,        // Between '$' and '*', decoding fields
+    NMEA_STATE_SKIP,        // Unrecognised sentence: ignore until the next '$'
+    NMEA_STATE_CHECKSUM_HI, // Expecting the first checksum hex digit
+    NMEA_STATE_CHECKSUM_LO  // Expecting the second checksum hex digit
+} nmea_state_t;
+
+// Value of one field, accumulated as its characters arrive.
+typedef struct {
+    uint32_t ipart;      // Digits before the decimal point
+    uint32_t frac;       // Up to NMEA_MAX_FRAC_DIGITS digits after it
+    uint8_t frac_digits; // Number of digits held in frac
+    uint8_t len;         // Characters in the field (0 = empty)
+    char letter;         // First non-numeric character (status, hemisphere, units)
+    bool in_frac;
+} nmea_field_t;
+
+// Called at the end of each field of a recognised sentence.
+typedef void (*nmea_field_handler_t)(uint8_t index, const nmea_field_t *field);
+// Called once the checksum has matched, before the scratch data is published.
+typedef void (*nmea_commit_handler_t)(void);
+
+typedef struct {
+    char type[3]; // Sentence type without the talker ID, e.g. "RMC"
+    nmea_field_handler_t on_field;
+    nmea_commit_handler_t on_commit;
+} nmea_sentence_t;
+
+typedef enum {
+    UBX_STATE_IDLE, // Waiting for the first sync character
+    UBX_STATE_SYNC2,
+    UBX_STATE_CLASS,
+    UBX_STATE_ID,
+    UBX_STATE_LEN_LO,
+    UBX_STATE_LEN_HI,
+    UBX_STATE_PAYLOAD,
+    UBX_STATE_CK_A,
+    UBX_STATE_CK_B
+} ubx_state_t;
+
+// Called with each payload byte of a recognised UBX message.
+typedef void (*ubx_byte_handler_t)(uint16_t offset, uint8_t byte);
+
+typedef struct {
+    uint8_t msg_class;
+    uint8_t msg_id;
+    uint16_t length;                 // Expected payload length
+    ubx_byte_handler_t on_byte;      // May be NULL
+    nmea_commit_handler_t on_commit; // Called once the checksum has matched
+} ubx_message_t;
+
+// Receiver protocol negotiation (GPS_USE_UBX)
+typedef enum {
+    GPS_LINK_NMEA,          // NMEA at GPS_UART_BAUD
+    GPS_LINK_UBX_SWITCHING, // CFG-PRT sent, waiting for it to leave at the old baud rate
+    GPS_LINK_UBX_PROBING,   // At GPS_UBX_BAUD, waiting for the first UBX frame
+    GPS_LINK_UBX            // NAV-PVT streaming
+} gps_link_t;
 
 // --- Internal State ---
-static gps_data_t current_gps_data; // Holds the latest parsed data
-static bool data_updated = false;   // Flag indicating new data is available
+static gps_data_t current_gps_data; // Holds the latest parsed data (published under gps_snapshot)
+static gps_data_t scratch_gps_data; // Decoded from the sentence in progress
+static bool data_updated = false;   // Set by a commit handler: the next publish announces new data
 static bool data_valid_fix = false; // Flag indicating the current data represents a valid fix
+static snapshot_t gps_snapshot;
+static uint8_t read_version = 0;    // Consumer side: version gps_get_data() last copied
+
+static struct {
+    nmea_state_t state;
+    const nmea_sentence_t *sentence; // NULL while the address field is being read
+    char type[3];                    // Last three characters of the address field
+    uint8_t field_index;
+    uint8_t length;
+    uint8_t checksum;                // Running XOR of the characters between '$' and '*'
+    uint8_t received_checksum;
+    uint8_t prev_field_len;          // Length of the previous field (hemisphere handling)
+    nmea_field_t field;
+    // Per-sentence values that are only applied on commit
+    char rmc_status;
+    uint8_t gga_quality;
+    uint16_t rmc_speed_knots_x100;
+    bool vtg_has_kmh;
+} nmea;
+
+static struct {
+    ubx_state_t state;
+    const ubx_message_t *message; // NULL for messages that are not decoded
+    uint8_t msg_class;
+    uint8_t msg_id;
+    uint16_t length;
+    uint16_t offset;
+    uint8_t ck_a;                 // 8-bit Fletcher checksum over class..payload
+    uint8_t ck_b;
+    uint32_t word;                // Last four payload bytes, little endian
+    uint8_t pvt_fix_type;
+    uint8_t pvt_flags;
+} ubx;
+
+static gps_link_t link_state = GPS_LINK_NMEA;
+#if GPS_USE_UBX
+static uint32_t link_deadline_ms = 0;
+#endif
+
+static uint16_t checksum_errors = 0;
+
+static gps_fix_hint_t fix_hint;
+static bool fix_hint_valid = false;   // fix_hint holds a position (loaded or cached this run)
+static bool fix_hint_pending = false; // fix_hint still has to be saved
+static uint32_t fix_hint_checked_ms = 0;
+static persist_record_t fix_record = {
+    .base = GPS_FIX_EEPROM_BASE,
+    .length = sizeof(gps_fix_hint_t),
+    .slots = GPS_FIX_SLOTS,
+    .version = GPS_FIX_VERSION,
+};
+
+_Static_assert(GPS_FIX_EEPROM_BASE + PERSIST_SIZE(sizeof(gps_fix_hint_t), GPS_FIX_SLOTS) <= ROUTE_STORE_EEPROM_BASE,
+               "Cached GPS fix overlaps the route store in EEPROM");
+
+// --- Field Conversion Helpers ---
+
+static const uint32_t pow10_table[NMEA_MAX_FRAC_DIGITS + 1] = { 1, 10, 100, 1000, 10000, 100000 };
+
+// Returns the field value with exactly 'digits' fraction digits (e.g. 2 for x100).
+static uint32_t field_scaled(const nmea_field_t *f, uint8_t digits) {
+    uint32_t frac = f->frac;
+    uint8_t have = f->frac_digits;
+    while (have > digits) { // Truncate surplus precision
+        frac /= 10;
+        have--;
+    }
+    return f->ipart * pow10_table[digits] + frac * pow10_table[digits - have];
+}
 
-// NMEA sentence buffer and parser state
-static char nmea_buffer[NMEA_MAX_SENTENCE_LEN + 1];
-static uint8_t nmea_buffer_index = 0;
-static bool sentence_in_progress = false;
+static uint16_t field_u16(const nmea_field_t *f, uint8_t digits) {
+    return fixed_sat_u16(field_scaled(f, digits));
+}
 
-// --- NMEA Parsing Helper Functions ---
+// Converts NMEA (D)DDMM.mmmmm to micro-degrees without floating point.
+static int32_t field_coordinate_e6(const nmea_field_t *f) {
+    uint16_t whole = (uint16_t)f->ipart; // At most 18000
+    uint16_t degrees = whole / 100;
+    uint32_t minutes_e5 = (uint32_t)(whole % 100) * 100000UL + (field_scaled(f, 5) - f->ipart * 100000UL);
+    // 1 minute = 1e6/60 micro-degrees, i.e. minutes_e5 / 6
+    return (int32_t)((uint32_t)degrees * 1000000UL + (minutes_e5 + 3) / 6);
+}
 
-// Calculate NMEA checksum
-static uint8_t nmea_calculate_checksum(const char *sentence) {
-    uint8_t checksum = 0;
-    // Checksum includes characters between '$' and '*'
-    if (*sentence == '$') sentence++;
-    while (*sentence && *sentence != '*') {
-        checksum ^= *sentence++;
+// hhmmss.sss
+static void field_time(const nmea_field_t *f, gps_data_t *d) {
+    if (f->len < 6) return;
+    uint32_t hms = f->ipart;
+    d->hour = (uint8_t)(hms / 10000);
+    d->minute = (uint8_t)((hms / 100) % 100);
+    d->second = (uint8_t)(hms % 100);
+    d->millisecond = (uint16_t)(field_scaled(f, 3) - hms * 1000UL);
+}
+
+// ddmmyy
+static void field_date(const nmea_field_t *f, gps_data_t *d) {
+    if (f->len < 6) return;
+    uint32_t dmy = f->ipart;
+    d->day = (uint8_t)(dmy / 10000);
+    d->month = (uint8_t)((dmy / 100) % 100);
+    d->year = (uint16_t)(2000 + dmy % 100);
+}
+
+// N/S or E/W following a coordinate field.
+static void field_hemisphere(const nmea_field_t *f, int32_t *coordinate) {
+    if (nmea.prev_field_len > 0 && (f->letter == 'S' || f->letter == 'W')) {
+        *coordinate = -*coordinate;
     }
-    return checksum;
 }
 
-// Validate NMEA checksum
-static bool nmea_validate_checksum(const char *sentence) {
-    const char *checksum_str = strchr(sentence, '*');
-    if (!checksum_str || strlen(checksum_str) < 3) {
-        return false; // No '*' or checksum too short
+// --- Sentence Handlers ---
+
+// $--RMC,time,status,lat,N/S,lon,E/W,speed_kn,course,date,magvar,E/W[,mode]
+static void rmc_field(uint8_t index, const nmea_field_t *f) {
+    gps_data_t *d = &scratch_gps_data;
+    switch (index) {
+        case 1: field_time(f, d); break;
+        case 2: nmea.rmc_status = f->letter; break;
+        case 3: if (f->len) d->latitude_e6 = field_coordinate_e6(f); break;
+        case 4: field_hemisphere(f, &d->latitude_e6); break;
+        case 5: if (f->len) d->longitude_e6 = field_coordinate_e6(f); break;
+        case 6: field_hemisphere(f, &d->longitude_e6); break;
+        case 7: nmea.rmc_speed_knots_x100 = field_u16(f, 2); break;
+        case 8: if (f->len) d->course_deg_x100 = field_u16(f, 2); break;
+        case 9: field_date(f, d); break;
+        case 12: if (f->letter == 'N') nmea.rmc_status = 'V'; break; // Mode indicator: no fix
+        default: break;
     }
-    uint8_t calculated_checksum = nmea_calculate_checksum(sentence);
-    uint8_t received_checksum = (uint8_t)strtol(checksum_str + 1, NULL, 16);
-    return calculated_checksum == received_checksum;
 }
 
-// Split NMEA sentence into fields
-// Returns the number of fields found
-static int nmea_split_fields(char *sentence, char *fields[], int max_fields) {
-    int count = 0;
-    fields[count++] = sentence; // First field starts after '$' (or at beginning if no '$')
+static void rmc_commit(void) {
+    gps_data_t *d = &scratch_gps_data;
+    // km/h = knots * 1.852; 759/4096 = 0.18530 converts knots_x100 to km/h_x10
+    d->speed_kmh_x10 = (uint16_t)(((uint32_t)nmea.rmc_speed_knots_x100 * 759UL + 2048UL) >> 12);
+    d->fix_valid = (nmea.rmc_status == 'A');
+    d->seen_rmc = true;
+    data_updated = true;
+}
 
-    char* p = sentence;
-    while (*p && *p != '*' && count < max_fields) {
-        if (*p == ',') {
-            *p = '\0'; // Null-terminate previous field
-            fields[count++] = p + 1; // Next field starts after comma
-        }
-        p++;
+// $--GGA,time,lat,N/S,lon,E/W,quality,sats,hdop,alt,M,geoid,M,age,station
+static void gga_field(uint8_t index, const nmea_field_t *f) {
+    gps_data_t *d = &scratch_gps_data;
+    switch (index) {
+        case 1: field_time(f, d); break;
+        case 2: if (f->len) d->latitude_e6 = field_coordinate_e6(f); break;
+        case 3: field_hemisphere(f, &d->latitude_e6); break;
+        case 4: if (f->len) d->longitude_e6 = field_coordinate_e6(f); break;
+        case 5: field_hemisphere(f, &d->longitude_e6); break;
+        case 6: nmea.gga_quality = (uint8_t)f->ipart; break;
+        case 7: d->satellites_tracked = (uint8_t)f->ipart; break;
+        case 8: if (f->len) d->hdop_x100 = field_u16(f, 2); break;
+        case 9:
+            if (f->len) {
+                int32_t alt_cm = (int32_t)field_scaled(f, 2);
+                d->altitude_cm = (f->letter == '-') ? -alt_cm : alt_cm;
+            }
+            break;
+        default: break;
     }
-    // Null-terminate the last field (before '*')
-    if (*p == '*') {
-        *p = '\0';
+}
+
+static void gga_commit(void) {
+    gps_data_t *d = &scratch_gps_data;
+    d->fix_quality = nmea.gga_quality;
+    // RMC status is authoritative; fall back to GGA quality if RMC is absent, and
+    // never keep a fix the receiver says it has lost.
+    if (!d->seen_rmc || d->fix_quality == 0) {
+        d->fix_valid = (d->fix_quality > 0);
     }
-    return count;
+    d->seen_gga = true;
+    data_updated = true;
 }
 
-// Parse $GPRMC sentence
-static void parse_gprmc(char *fields[], int field_count) {
-    if (field_count < 12) return; // Not enough fields for RMC
+// $--VTG,course_t,T,course_m,M,speed_kn,N,speed_kmh,K[,mode]
+static void vtg_field(uint8_t index, const nmea_field_t *f) {
+    gps_data_t *d = &scratch_gps_data;
+    switch (index) {
+        case 1: if (f->len) d->course_deg_x100 = field_u16(f, 2); break;
+        case 7:
+            if (f->len) {
+                d->speed_kmh_x10 = field_u16(f, 1);
+                nmea.vtg_has_kmh = true;
+            }
+            break;
+        default: break;
+    }
+}
+
+static void vtg_commit(void) {
+    if (nmea.vtg_has_kmh) {
+        scratch_gps_data.seen_vtg = true;
+        data_updated = true;
+    }
+}
 
-    // Field 1: Time (HHMMSS.sss) - Extract time components.
-    if (strlen(fields[1]) >= 6) {
-        // Actual parsing logic using sscanf or manual conversion would go here.
-        current_gps_data.hour = 12; // Dummy data
-        current_gps_data.minute = 34;
-        current_gps_data.second = 56;
+// $--GSA,mode,fix,sv1..sv12,pdop,hdop,vdop
+static void gsa_field(uint8_t index, const nmea_field_t *f) {
+    gps_data_t *d = &scratch_gps_data;
+    switch (index) {
+        case 2: if (f->len) d->fix_mode = (uint8_t)f->ipart; break;
+        case 15: if (f->len) d->pdop_x100 = field_u16(f, 2); break;
+        case 16: if (f->len) d->hdop_x100 = field_u16(f, 2); break;
+        case 17: if (f->len) d->vdop_x100 = field_u16(f, 2); break;
+        default: break;
     }
+}
 
-    // Field 2: Status (A=Active/Valid, V=Void/Invalid) - Update fix validity.
-    current_gps_data.fix_valid = (fields[2][0] == 'A');
+static void gsa_commit(void) {
+    scratch_gps_data.seen_gsa = true;
+}
 
-    // Field 3, 4: Latitude (DDMM.mmmm, N/S) - Extract and convert.
-    // Field 5, 6: Longitude (DDDMM.mmmm, E/W) - Extract and convert.
-    // Actual parsing and conversion logic (e.g., atof, helper functions) needed here.
-    current_gps_data.latitude = 40.7128f;  // Dummy data
-    current_gps_data.longitude = -74.0060f; // Dummy data
+static const nmea_sentence_t sentence_table[] = {
+    { { 'R', 'M', 'C' }, rmc_field, rmc_commit },
+    { { 'G', 'G', 'A' }, gga_field, gga_commit },
+    { { 'V', 'T', 'G' }, vtg_field, vtg_commit },
+    { { 'G', 'S', 'A' }, gsa_field, gsa_commit },
+};
+#define SENTENCE_COUNT (sizeof(sentence_table) / sizeof(sentence_table[0]))
 
-    // Field 7: Speed over ground (knots) - Convert to float.
-    current_gps_data.speed_knots = atof(fields[7]); // Keep atof for plausible value
-    current_gps_data.speed_kmh = current_gps_data.speed_knots * 1.852f;
+// --- Parser Helpers ---
 
-    // Field 8: Track angle (degrees true) - Convert to float.
-    current_gps_data.course_deg = atof(fields[8]); // Keep atof
+// Makes the decoded sentence or frame visible to readers.
+static void publish_scratch(void) {
+    snapshot_write_begin(&gps_snapshot);
+    memcpy(&current_gps_data, &scratch_gps_data, sizeof(gps_data_t));
+    data_valid_fix = current_gps_data.fix_valid; // Update overall validity
+    snapshot_write_end(&gps_snapshot, data_updated);
+    data_updated = false;
+}
+
+static inline void field_reset(void) {
+    memset(&nmea.field, 0, sizeof(nmea.field));
+}
 
-    // Field 9: Date (DDMMYY) - Extract date components.
-    if (strlen(fields[9]) == 6) {
-        // Actual parsing logic using sscanf or manual conversion would go here.
-        current_gps_data.day = 5; // Dummy data
-        current_gps_data.month = 5;
-        current_gps_data.year = 2025;
+static void sentence_start(void) {
+    nmea.state = NMEA_STATE_BODY;
+    nmea.sentence = NULL;
+    nmea.type[0] = nmea.type[1] = nmea.type[2] = 0;
+    nmea.field_index = 0;
+    nmea.length = 1;
+    nmea.checksum = 0;
+    nmea.prev_field_len = 0;
+    field_reset();
+}
+
+// Address field complete: pick a handler by sentence type, ignoring the talker ID.
+static void sentence_identify(void) {
+    for (uint8_t i = 0; i < SENTENCE_COUNT; ++i) {
+        if (memcmp(sentence_table[i].type, nmea.type, sizeof(nmea.type)) == 0) {
+            nmea.sentence = &sentence_table[i];
+            memcpy(&scratch_gps_data, &current_gps_data, sizeof(gps_data_t));
+            nmea.rmc_status = 'V';
+            nmea.gga_quality = 0;
+            nmea.rmc_speed_knots_x100 = 0;
+            nmea.vtg_has_kmh = false;
+            return;
+        }
     }
+    nmea.state = NMEA_STATE_SKIP;
+}
 
-    // Fields 10, 11: Magnetic variation (optional) - Ignored.
+static void field_end(void) {
+    if (nmea.field_index == 0) {
+        sentence_identify();
+    } else {
+        nmea.sentence->on_field(nmea.field_index, &nmea.field);
+    }
+    nmea.prev_field_len = nmea.field.len;
+    nmea.field_index++;
+    field_reset();
+}
 
-    current_gps_data.seen_rmc = true;
-    data_updated = true; // Mark data as updated
-    data_valid_fix = current_gps_data.fix_valid; // Update overall validity
-    log_debug("GPS: Parsed RMC, Valid: %d", current_gps_data.fix_valid);
+static void field_accumulate(uint8_t c) {
+    nmea_field_t *f = &nmea.field;
+    f->len++;
+    if (nmea.field_index == 0) {
+        nmea.type[0] = nmea.type[1];
+        nmea.type[1] = nmea.type[2];
+        nmea.type[2] = (char)c;
+        return;
+    }
+    if (c >= '0' && c <= '9') {
+        uint8_t digit = c - '0';
+        if (!f->in_frac) {
+            f->ipart = f->ipart * 10 + digit;
+        } else if (f->frac_digits < NMEA_MAX_FRAC_DIGITS) {
+            f->frac = f->frac * 10 + digit;
+            f->frac_digits++;
+        }
+    } else if (c == '.') {
+        f->in_frac = true;
+    } else if (f->letter == 0) {
+        f->letter = (char)c; // Includes a leading '-' sign
+    }
 }
 
-// Parse $GPGGA sentence
-static void parse_gpgga(char *fields[], int field_count) {
-     if (field_count < 10) return; // Not enough fields for GGA
+static inline int8_t hex_value(uint8_t c) {
+    if (c >= '0' && c <= '9') return (int8_t)(c - '0');
+    if (c >= 'A' && c <= 'F') return (int8_t)(c - 'A' + 10);
+    if (c >= 'a' && c <= 'f') return (int8_t)(c - 'a' + 10);
+    return -1;
+}
 
-    // Field 1: Time (HHMMSS.sss) - Can update time if needed, RMC usually preferred
-    // Field 2, 3: Latitude (DDMM.mmmm, N/S) - Can update if needed
-    // Field 4, 5: Longitude (DDDMM.mmmm, E/W) - Can update if needed
+static void sentence_finish(void) {
+    PERF_SCOPE(NMEA_SENTENCE);
+    if (nmea.received_checksum != nmea.checksum) {
+        checksum_errors++;
+        PERF_COUNT(NMEA_CHECKSUM);
+        log_warn("GPS: Invalid checksum (%u errors)", checksum_errors);
+        return;
+    }
+    nmea.sentence->on_commit();
+    publish_scratch();
+}
 
-    // Field 6: Fix Quality (0=Invalid, 1=GPS, 2=DGPS, ...)
-    current_gps_data.fix_quality = atoi(fields[6]);
-    // Update overall validity based on GGA quality if RMC wasn't seen or was void
-    if (!current_gps_data.seen_rmc || fields[2][0] == 'V') {
-         current_gps_data.fix_valid = (current_gps_data.fix_quality > 0);
+// --- UBX Message Handlers ---
+
+// NAV-PVT: position, velocity and time solution. Offsets are those of the
+// last byte of each little-endian field, so ubx.word holds the whole field.
+static void pvt_byte(uint16_t offset, uint8_t byte) {
+    gps_data_t *d = &scratch_gps_data;
+    switch (offset) {
+        case 5: d->year = (uint16_t)(ubx.word >> 16); break;
+        case 6: d->month = byte; break;
+        case 7: d->day = byte; break;
+        case 8: d->hour = byte; break;
+        case 9: d->minute = byte; break;
+        case 10: d->second = byte; break;
+        case 11: // valid: bit0 validDate, bit1 validTime
+            if (!(byte & 0x01)) {
+                d->year = current_gps_data.year;
+                d->month = current_gps_data.month;
+                d->day = current_gps_data.day;
+            }
+            if (!(byte & 0x02)) {
+                d->hour = current_gps_data.hour;
+                d->minute = current_gps_data.minute;
+                d->second = current_gps_data.second;
+            }
+            break;
+        case 19: { // nano (ns, signed)
+            int32_t nano = (int32_t)ubx.word;
+            d->millisecond = (nano > 0) ? (uint16_t)(nano / 1000000L) : 0;
+            break;
+        }
+        case 20: ubx.pvt_fix_type = byte; break;
+        case 21: ubx.pvt_flags = byte; break;
+        case 23: d->satellites_tracked = byte; break;
+        case 27: d->longitude_e6 = fixed_div_round((int32_t)ubx.word, 10); break; // 1e-7 deg
+        case 31: d->latitude_e6 = fixed_div_round((int32_t)ubx.word, 10); break;
+        case 39: d->altitude_cm = fixed_div_round((int32_t)ubx.word, 10); break;  // hMSL, mm
+        case 63: { // gSpeed, mm/s; 9437/2^18 = 0.036 converts to 0.1 km/h
+            int32_t mm_s = (int32_t)ubx.word;
+            uint32_t kmh_x10 = (mm_s > 0) ? (((uint32_t)mm_s * 9437UL + (1UL << 17)) >> 18) : 0;
+            d->speed_kmh_x10 = fixed_sat_u16(kmh_x10);
+            break;
+        }
+        case 67: { // headMot, 1e-5 deg
+            int32_t heading = fixed_div_round((int32_t)ubx.word, 1000);
+            d->course_deg_x100 = (heading < 0) ? (uint16_t)(heading + 36000) : (uint16_t)heading;
+            break;
+        }
+        case 77: d->pdop_x100 = (uint16_t)(ubx.word >> 16); break;
+        default: break;
     }
+}
+
+static void pvt_commit(void) {
+    gps_data_t *d = &scratch_gps_data;
+    // fixType: 0 none, 1 DR only, 2 2D, 3 3D, 4 GNSS+DR, 5 time only
+    bool fix_ok = (ubx.pvt_flags & 0x01) && ubx.pvt_fix_type >= 2 && ubx.pvt_fix_type <= 4;
+    d->fix_valid = fix_ok;
+    d->fix_quality = fix_ok ? 1 : 0;
+    d->fix_mode = (ubx.pvt_fix_type == 2) ? 2 : (ubx.pvt_fix_type >= 3 && ubx.pvt_fix_type <= 4) ? 3 : 1;
+    d->seen_pvt = true;
+    data_updated = true;
+}
 
-    // Field 7: Number of satellites tracked
-    current_gps_data.satellites_tracked = atoi(fields[7]);
+static void ack_nak_commit(void) {
+    log_warn("GPS: UBX message rejected");
+}
 
-    // Field 8: Horizontal Dilution of Precision (HDOP) - Ignored for now
+static const ubx_message_t ubx_message_table[] = {
+    { UBX_CLASS_NAV, UBX_NAV_PVT, UBX_NAV_PVT_LEN, pvt_byte, pvt_commit },
+    { UBX_CLASS_ACK, UBX_ACK_NAK, 2, NULL, ack_nak_commit },
+};
+#define UBX_MESSAGE_COUNT (sizeof(ubx_message_table) / sizeof(ubx_message_table[0]))
 
-    // Field 9, 10: Altitude (Meters, M) - Convert to float.
-    current_gps_data.altitude_msl = atof(fields[9]); // Keep atof
+// --- UBX Parser Helpers ---
 
-    // Other fields: Geoid separation, DGPS age, DGPS station ID - Ignored.
+static inline void ubx_checksum_add(uint8_t byte) {
+    ubx.ck_a += byte;
+    ubx.ck_b += ubx.ck_a;
+}
 
-    current_gps_data.seen_gga = true;
-    data_updated = true; // Mark data as updated
-    data_valid_fix = current_gps_data.fix_valid; // Update overall validity
-    log_debug("GPS: Parsed GGA, Quality: %d, Sats: %d", current_gps_data.fix_quality, current_gps_data.satellites_tracked);
+// Header complete: look up a decoder for this class/ID/length.
+static void ubx_identify(void) {
+    ubx.message = NULL;
+    for (uint8_t i = 0; i < UBX_MESSAGE_COUNT; ++i) {
+        const ubx_message_t *m = &ubx_message_table[i];
+        if (m->msg_class == ubx.msg_class && m->msg_id == ubx.msg_id && m->length == ubx.length) {
+            ubx.message = m;
+            memcpy(&scratch_gps_data, &current_gps_data, sizeof(gps_data_t));
+            ubx.pvt_fix_type = 0;
+            ubx.pvt_flags = 0;
+            return;
+        }
+    }
+}
+
+static void ubx_finish(void) {
+    if (link_state == GPS_LINK_UBX_PROBING) {
+        link_state = GPS_LINK_UBX; // Any valid frame proves the receiver speaks UBX
+        log_info("GPS: UBX mode active, NAV-PVT at %u Hz", GPS_UBX_RATE_HZ);
+    }
+    if (ubx.message) {
+        ubx.message->on_commit();
+        if (ubx.message->on_byte) {
+            publish_scratch();
+        }
+    }
 }
 
-// Process a complete, validated NMEA sentence
-static void process_nmea_sentence(char *sentence) {
-    log_debug("GPS: Processing: %s", sentence);
+static void ubx_process_char(uint8_t c) {
+    switch (ubx.state) {
+        case UBX_STATE_IDLE:
+            if (c == UBX_SYNC_CHAR_1) {
+                ubx.state = UBX_STATE_SYNC2;
+                nmea.state = NMEA_STATE_IDLE; // Frames never nest inside a sentence
+            }
+            break;
+        case UBX_STATE_SYNC2:
+            ubx.state = (c == UBX_SYNC_CHAR_2) ? UBX_STATE_CLASS : UBX_STATE_IDLE;
+            ubx.ck_a = ubx.ck_b = 0;
+            break;
+        case UBX_STATE_CLASS:
+            ubx.msg_class = c;
+            ubx_checksum_add(c);
+            ubx.state = UBX_STATE_ID;
+            break;
+        case UBX_STATE_ID:
+            ubx.msg_id = c;
+            ubx_checksum_add(c);
+            ubx.state = UBX_STATE_LEN_LO;
+            break;
+        case UBX_STATE_LEN_LO:
+            ubx.length = c;
+            ubx_checksum_add(c);
+            ubx.state = UBX_STATE_LEN_HI;
+            break;
+        case UBX_STATE_LEN_HI:
+            ubx.length |= (uint16_t)c << 8;
+            ubx_checksum_add(c);
+            if (ubx.length > UBX_MAX_PAYLOAD) {
+                ubx.state = UBX_STATE_IDLE;
+                break;
+            }
+            ubx_identify();
+            ubx.offset = 0;
+            ubx.state = (ubx.length > 0) ? UBX_STATE_PAYLOAD : UBX_STATE_CK_A;
+            break;
+        case UBX_STATE_PAYLOAD:
+            ubx_checksum_add(c);
+            ubx.word = (ubx.word >> 8) | ((uint32_t)c << 24);
+            if (ubx.message && ubx.message->on_byte) {
+                ubx.message->on_byte(ubx.offset, c);
+            }
+            if (++ubx.offset >= ubx.length) {
+                ubx.state = UBX_STATE_CK_A;
+            }
+            break;
+        case UBX_STATE_CK_A:
+            ubx.state = (c == ubx.ck_a) ? UBX_STATE_CK_B : UBX_STATE_IDLE;
+            if (c != ubx.ck_a) checksum_errors++;
+            break;
+        case UBX_STATE_CK_B:
+            ubx.state = UBX_STATE_IDLE;
+            if (c == ubx.ck_b) {
+                ubx_finish();
+            } else {
+                checksum_errors++;
+            }
+            break;
+        default:
+            ubx.state = UBX_STATE_IDLE;
+            break;
+    }
+}
 
-    char *fields[NMEA_MAX_FIELDS];
-    // Skip the '$'
-    int field_count = nmea_split_fields(sentence + 1, fields, NMEA_MAX_FIELDS);
+// --- UBX Configuration ---
 
-    if (field_count < 1) return;
+#if GPS_USE_UBX
+// Blocking, but only a handful of short frames are sent during negotiation.
+static void ubx_send(uint8_t msg_class, uint8_t msg_id, const uint8_t *payload, uint16_t length) {
+    uint8_t header[4] = { msg_class, msg_id, (uint8_t)length, (uint8_t)(length >> 8) };
+    uint8_t ck_a = 0, ck_b = 0;
 
-    // Identify sentence type and call appropriate parser
-    if (strncmp(fields[0], "GPRMC", 5) == 0 || strncmp(fields[0], "GNRMC", 5) == 0) {
-        parse_gprmc(fields, field_count);
-    } else if (strncmp(fields[0], "GPGGA", 5) == 0 || strncmp(fields[0], "GNGGA", 5) == 0) {
-        parse_gpgga(fields, field_count);
+    hal_uart_put_char(GPS_UART_ID, UBX_SYNC_CHAR_1);
+    hal_uart_put_char(GPS_UART_ID, UBX_SYNC_CHAR_2);
+    for (uint8_t i = 0; i < sizeof(header); ++i) {
+        ck_a += header[i];
+        ck_b += ck_a;
+        hal_uart_put_char(GPS_UART_ID, header[i]);
     }
-    // Add handlers for other sentences (GSA, GSV, VTG) if needed
-    // else if (strncmp(fields[0], "GPVTG", 5) == 0) { parse_gpvtg(fields, field_count); }
-    else {
-        log_debug("GPS: Ignoring sentence type: %s", fields[0]);
+    for (uint16_t i = 0; i < length; ++i) {
+        ck_a += payload[i];
+        ck_b += ck_a;
+        hal_uart_put_char(GPS_UART_ID, payload[i]);
     }
+    hal_uart_put_char(GPS_UART_ID, ck_a);
+    hal_uart_put_char(GPS_UART_ID, ck_b);
 }
 
+static void ubx_set_message_rate(uint8_t msg_class, uint8_t msg_id, uint8_t rate) {
+    uint8_t payload[3] = { msg_class, msg_id, rate }; // Rate on the port receiving the command
+    ubx_send(UBX_CLASS_CFG, UBX_CFG_MSG, payload, sizeof(payload));
+}
+
+// CFG-PRT for UART1: 8N1 at GPS_UBX_BAUD, UBX+NMEA in and out.
+static void ubx_request_baud(void) {
+    uint32_t baud = GPS_UBX_BAUD;
+    uint8_t payload[20] = {
+        1, 0, 0, 0,                 // portID = UART1, reserved, txReady off
+        0xD0, 0x08, 0x00, 0x00,     // mode: 8 data bits, no parity, 1 stop bit
+        (uint8_t)baud, (uint8_t)(baud >> 8), (uint8_t)(baud >> 16), (uint8_t)(baud >> 24),
+        0x03, 0x00,                 // inProtoMask: UBX | NMEA
+        0x03, 0x00,                 // outProtoMask: UBX | NMEA
+        0, 0, 0, 0                  // flags, reserved
+    };
+    ubx_send(UBX_CLASS_CFG, UBX_CFG_PRT, payload, sizeof(payload));
+}
+
+static void put_i32(uint8_t *p, int32_t value) {
+    uint32_t v = (uint32_t)value;
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+// MGA-INI-POS_LLH: the cached fix as initial position. No time is given (the
+// brain has no RTC); the receiver's own almanac and the position are enough
+// to pick the visible satellites.
+static void ubx_send_position_hint(void) {
+    uint8_t payload[20] = { UBX_MGA_INI_POS_LLH, 0, 0, 0 }; // type, version, reserved
+    put_i32(&payload[4], fix_hint.latitude_e6 * 10);            // 1e-7 deg
+    put_i32(&payload[8], fix_hint.longitude_e6 * 10);
+    put_i32(&payload[12], (int32_t)fix_hint.altitude_m * 100); // cm (MSL, close enough at this accuracy)
+    put_i32(&payload[16], (int32_t)(GPS_FIX_HINT_ACCURACY_M * 100UL));
+    ubx_send(UBX_CLASS_MGA, UBX_MGA_INI, payload, sizeof(payload));
+}
+
+// Sent at GPS_UBX_BAUD: NMEA sentences off, NAV-PVT on at GPS_UBX_RATE_HZ.
+static void ubx_configure_output(void) {
+    uint16_t meas_ms = 1000 / GPS_UBX_RATE_HZ;
+    uint8_t rate[6] = { (uint8_t)meas_ms, (uint8_t)(meas_ms >> 8), 1, 0, 1, 0 }; // navRate 1, timeRef GPS
+    ubx_send(UBX_CLASS_CFG, UBX_CFG_RATE, rate, sizeof(rate));
+
+    for (uint8_t id = 0x00; id <= 0x05; ++id) { // GGA, GLL, GSA, GSV, RMC, VTG
+        ubx_set_message_rate(NMEA_STD_CLASS, id, 0);
+    }
+    ubx_set_message_rate(UBX_CLASS_NAV, UBX_NAV_PVT, 1);
+
+    if (fix_hint_valid) {
+        ubx_send_position_hint();
+        log_info("GPS: Warm start from cached fix");
+    }
+}
+#endif // GPS_USE_UBX
+
+// --- Fix Cache ---
+
+// Caches a good 3D fix once the bike is GPS_FIX_HINT_MOVE_M from the cached
+// one, checked every GPS_FIX_HINT_INTERVAL_MS (at once while nothing is cached).
+static void fix_hint_update(uint32_t now) {
+    if (fix_hint_pending) {
+        fix_hint_pending = !persist_save(&fix_record, &fix_hint); // Another record is being written
+        return;
+    }
+    if (fix_hint_valid && now - fix_hint_checked_ms < GPS_FIX_HINT_INTERVAL_MS) {
+        return;
+    }
+    int32_t latitude_e6, longitude_e6, altitude_cm;
+    bool fix_3d;
+    uint8_t seq;
+    do {
+        seq = snapshot_read_begin(&gps_snapshot);
+        fix_3d = current_gps_data.fix_valid && current_gps_data.fix_mode == 3;
+        latitude_e6 = current_gps_data.latitude_e6;
+        longitude_e6 = current_gps_data.longitude_e6;
+        altitude_cm = current_gps_data.altitude_cm;
+    } while (snapshot_read_retry(&gps_snapshot, seq));
+    if (!fix_3d) {
+        return;
+    }
+    fix_hint_checked_ms = now;
+    if (fix_hint_valid && fixed_equirect_distance_m(fix_hint.latitude_e6, fix_hint.longitude_e6,
+                                                    latitude_e6, longitude_e6) < GPS_FIX_HINT_MOVE_M) {
+        return;
+    }
+    int32_t altitude_m = altitude_cm / 100;
+    fix_hint.latitude_e6 = latitude_e6;
+    fix_hint.longitude_e6 = longitude_e6;
+    fix_hint.altitude_m = (altitude_m > INT16_MAX) ? INT16_MAX : (altitude_m < INT16_MIN) ? INT16_MIN : (int16_t)altitude_m;
+    fix_hint_valid = true;
+    fix_hint_pending = !persist_save(&fix_record, &fix_hint);
+    log_info("GPS: Fix cached for the next start");
+}
 
 // --- Public API Implementation ---
 
@@ -182,97 +753,156 @@ void gps_init(void) {
     memset(&current_gps_data, 0, sizeof(current_gps_data));
     data_updated = false;
     data_valid_fix = false;
-    nmea_buffer_index = 0;
-    sentence_in_progress = false;
+    snapshot_init(&gps_snapshot);
+    read_version = 0;
+    nmea.state = NMEA_STATE_IDLE;
+    ubx.state = UBX_STATE_IDLE;
+    checksum_errors = 0;
+    link_state = GPS_LINK_NMEA;
+    fix_hint_valid = persist_load(&fix_record, &fix_hint);
+    fix_hint_pending = false;
+    fix_hint_checked_ms = 0;
+
+#if GPS_USE_UBX
+    // Ask a u-blox receiver to move to the faster baud rate; gps_poll() follows it.
+    ubx_request_baud();
+    link_state = GPS_LINK_UBX_SWITCHING;
+    link_deadline_ms = hal_timer_millis() + GPS_UBX_SWITCH_DELAY_MS;
+#endif
 
-    // Enable UART RX interrupt if desired, otherwise rely on polling gps_process_char
-    // hal_uart_enable_rx_interrupt(GPS_UART_ID, gps_uart_rx_handler); // Need handler function
     log_info("GPS: Initialized. Waiting for data on UART %d.", GPS_UART_ID);
 }
 
+void gps_poll(void) {
+    uint32_t now = hal_timer_millis();
+    fix_hint_update(now);
+
+#if GPS_USE_UBX
+    if ((int32_t)(now - link_deadline_ms) < 0) {
+        return;
+    }
+
+    if (link_state == GPS_LINK_UBX_SWITCHING) {
+        hal_uart_set_baud(GPS_UART_ID, GPS_UBX_BAUD);
+        hal_uart_flush_rx_buffer(GPS_UART_ID); // Bytes received mid-switch are garbage
+        ubx_configure_output();
+        link_state = GPS_LINK_UBX_PROBING;
+        link_deadline_ms = now + GPS_UBX_DETECT_TIMEOUT_MS;
+    } else if (link_state == GPS_LINK_UBX_PROBING) {
+        log_warn("GPS: No UBX response, using NMEA at %lu baud", GPS_UART_BAUD);
+        hal_uart_set_baud(GPS_UART_ID, GPS_UART_BAUD);
+        hal_uart_flush_rx_buffer(GPS_UART_ID);
+        link_state = GPS_LINK_NMEA;
+    }
+#endif
+}
+
+bool gps_is_ubx_active(void) {
+    return link_state == GPS_LINK_UBX;
+}
+
 void gps_process_char(uint8_t received_char) {
-    // Handle NMEA sentence framing and buffering
-    if (received_char == '$') {
-        // Start of a new sentence
-        nmea_buffer_index = 0;
-        nmea_buffer[nmea_buffer_index++] = received_char;
-        sentence_in_progress = true;
-    } else if (sentence_in_progress) {
-        // Continue buffering characters
-        if (nmea_buffer_index < NMEA_MAX_SENTENCE_LEN) {
-            nmea_buffer[nmea_buffer_index++] = received_char;
-        } else {
-            // Buffer overflow, discard sentence
-            sentence_in_progress = false;
-            log_warn("GPS: NMEA buffer overflow");
-        }
+    PERF_SCOPE(GPS_CHAR);
+    if (ubx.state != UBX_STATE_IDLE || received_char == UBX_SYNC_CHAR_1) {
+        ubx_process_char(received_char); // NMEA is 7-bit ASCII, so 0xB5 always starts a frame
+        return;
+    }
 
-        // Check for end of sentence (CR LF)
-        if (received_char == '\n') {
-            nmea_buffer[nmea_buffer_index] = '\0'; // Null-terminate
+    if (received_char == '$') {
+        sentence_start(); // Always resynchronise on '$', even mid-sentence
+        return;
+    }
 
-            // Check preceding character was CR
-            if (nmea_buffer_index > 1 && nmea_buffer[nmea_buffer_index - 2] == '\r') {
-                 nmea_buffer[nmea_buffer_index - 2] = '\0'; // Terminate before CR LF
+    switch (nmea.state) {
+        case NMEA_STATE_BODY:
+            if (++nmea.length > NMEA_MAX_SENTENCE_LEN) {
+                nmea.state = NMEA_STATE_IDLE; // Overlong: discard
+                PERF_COUNT(NMEA_OVERFLOW);
+            } else if (received_char == '\r' || received_char == '\n') {
+                nmea.state = NMEA_STATE_IDLE; // Missing checksum: discard
+            } else if (received_char == '*') {
+                if (nmea.field_index == 0) {
+                    nmea.state = NMEA_STATE_IDLE; // No address field
+                    break;
+                }
+                field_end();
+                if (nmea.state == NMEA_STATE_BODY) {
+                    nmea.state = NMEA_STATE_CHECKSUM_HI;
+                }
             } else {
-                 nmea_buffer[nmea_buffer_index - 1] = '\0'; // Terminate before LF only
+                nmea.checksum ^= received_char;
+                if (received_char == ',') {
+                    field_end();
+                } else {
+                    field_accumulate(received_char);
+                }
             }
-
-
-            // Validate checksum and process
-            if (nmea_validate_checksum(nmea_buffer)) {
-                process_nmea_sentence(nmea_buffer);
+            break;
+
+        case NMEA_STATE_CHECKSUM_HI:
+        case NMEA_STATE_CHECKSUM_LO: {
+            int8_t nibble = hex_value(received_char);
+            if (nibble < 0) {
+                nmea.state = NMEA_STATE_IDLE;
+                break;
+            }
+            if (nmea.state == NMEA_STATE_CHECKSUM_HI) {
+                nmea.received_checksum = (uint8_t)(nibble << 4);
+                nmea.state = NMEA_STATE_CHECKSUM_LO;
             } else {
-                log_warn("GPS: Invalid checksum: %s", nmea_buffer);
+                nmea.received_checksum |= (uint8_t)nibble;
+                nmea.state = NMEA_STATE_IDLE;
+                sentence_finish();
             }
-            sentence_in_progress = false; // Ready for next sentence
+            break;
         }
+
+        case NMEA_STATE_IDLE:
+        case NMEA_STATE_SKIP:
+        default:
+            break; // Ignore characters outside of a recognised sentence
     }
-    // Ignore characters received outside of a sentence ($...*xx\r\n)
 }
 
 bool gps_is_data_available(void) {
-    // Data is considered available if essential sentences have been updated
-    // and the fix is marked as valid.
-    bool available = data_updated;
-    // Reset flag after checking, so it only returns true once per update cycle
-    // data_updated = false; // Resetting here might be too soon if gps_get_data isn't called immediately
-    return available;
+    return snapshot_version(&gps_snapshot) != read_version;
 }
 
 bool gps_get_data(gps_data_t *data) {
     if (data == NULL) return false;
+    read_version = snapshot_read(&gps_snapshot, data, &current_gps_data, sizeof(gps_data_t));
+    return data->fix_valid;
+}
 
-    // Copy internal data structure
-    memcpy(data, &current_gps_data, sizeof(gps_data_t));
-
-    // Reset the update flag now that data has been retrieved
-    data_updated = false;
-
-    // Return the validity status of the copied data
-    return data_valid_fix;
+bool gps_has_fix(void) {
+    return data_valid_fix; // One byte: no lock needed
 }
 
-float gps_get_speed_kmh(void) {
-    if (data_valid_fix) {
-        return current_gps_data.speed_kmh;
-    } else {
-        return 0.0f; // Or indicate invalid speed differently, e.g., -1.0f
-    }
+uint16_t gps_get_speed_kmh_x10(void) {
+    uint16_t speed;
+    uint8_t seq;
+    do {
+        seq = snapshot_read_begin(&gps_snapshot);
+        speed = data_valid_fix ? current_gps_data.speed_kmh_x10 : 0;
+    } while (snapshot_read_retry(&gps_snapshot, seq));
+    return speed;
 }
 
-bool gps_get_location(float *latitude, float *longitude) {
-    if (data_valid_fix && latitude != NULL && longitude != NULL) {
-        *latitude = current_gps_data.latitude;
-        *longitude = current_gps_data.longitude;
-        return true;
-    } else {
-        // Optionally set output pointers to 0 or NaN
-        if (latitude) *latitude = 0.0f;
-        if (longitude) *longitude = 0.0f;
-        return false;
+bool gps_get_location(int32_t *latitude_e6, int32_t *longitude_e6) {
+    int32_t lat, lon;
+    bool valid;
+    uint8_t seq;
+    do {
+        seq = snapshot_read_begin(&gps_snapshot);
+        valid = data_valid_fix;
+        lat = current_gps_data.latitude_e6;
+        lon = current_gps_data.longitude_e6;
+    } while (snapshot_read_retry(&gps_snapshot, seq));
+    if (!valid) {
+        lat = 0;
+        lon = 0;
     }
+    if (latitude_e6) *latitude_e6 = lat;
+    if (longitude_e6) *longitude_e6 = lon;
+    return valid && latitude_e6 != NULL && longitude_e6 != NULL;
 }
-
-// UART RX Handler would typically call gps_process_char(data)
-// when a byte is received on the GPS UART.
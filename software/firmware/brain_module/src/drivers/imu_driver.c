@@ -0,0 +1,302 @@
+/**
+ * @file imu_driver.c
+ * @brief Driver for an MPU-6050 class IMU (also MPU-6500/9250 register maps).
+ * Accelerometer and gyro samples go into the sensor FIFO (12 bytes each). A
+ * poll costs two bus transactions whatever the batch size: the FIFO count,
+ * then one burst read of every whole sample. Both run from the TWI interrupt
+ * (the count's completion queues the burst), so a poll only processes the
+ * batch the previous poll fetched and queues the next count read.
+ *
+ * Axes (sensor mounted flat): X forward, Y left, Z up. Roll about X is the lean.
+ */
+
+#include "modules/imu.h" // Use the module header file name
+#include "hal/i2c.h"
+#include "hal/timer.h"
+#include "util/logger.h"
+#include "util/fixed.h"
+#include <util/delay.h>
+
+// --- Defines ---
+#ifndef IMU_RETRY_INTERVAL_MS
+#define IMU_RETRY_INTERVAL_MS 1000
+#endif
+
+// Registers
+#define REG_SMPLRT_DIV    0x19
+#define REG_CONFIG        0x1A
+#define REG_GYRO_CONFIG   0x1B
+#define REG_ACCEL_CONFIG  0x1C
+#define REG_FIFO_EN       0x23
+#define REG_INT_STATUS    0x3A
+#define REG_USER_CTRL     0x6A
+#define REG_PWR_MGMT_1    0x6B
+#define REG_FIFO_COUNTH   0x72
+#define REG_FIFO_R_W      0x74
+#define REG_WHO_AM_I      0x75
+
+#define PWR_RESET         0x80
+#define PWR_CLK_PLL_X     0x01 // Gyro X PLL, more stable than the internal oscillator
+#define DLPF_20HZ         0x04 // Gyro output rate stays 1 kHz with the DLPF on
+#define GYRO_FS_500DPS    0x08 // 65.5 LSB per deg/s
+#define ACCEL_FS_4G       0x08
+#define FIFO_EN_ACCEL_GYRO 0x78 // XG, YG, ZG and accel
+#define USER_FIFO_EN      0x40
+#define USER_FIFO_RESET   0x04
+
+#define IMU_SAMPLE_BYTES  12    // ax ay az gx gy gz, big-endian int16
+#define IMU_FIFO_SIZE     1024
+#define GYRO_CDPS_Q8      391   // 0.01 deg/s per LSB at 500 dps (100 / 65.5), Q8
+#define GYRO_STILL_LSB    200   // ~3 deg/s: quieter than this while stopped counts as bias
+#define KINEMATIC_MIN_KMH_X10 100 // Below 10 km/h the lean reference is the gravity vector
+// v [0.1 km/h] * rate [0.01 deg/s] / this = tan(lean): 36 * 18000 * 9.80665 / pi
+#define LEAN_TAN_DIVISOR  2022770L
+
+_Static_assert(1000 % IMU_SAMPLE_RATE_HZ == 0 && IMU_SAMPLE_RATE_HZ <= 250, "Unsupported IMU sample rate");
+
+// Read sequence, advanced by on_transfer_done() in the TWI interrupt
+typedef enum {
+    STAGE_IDLE,
+    STAGE_COUNT,        // FIFO count read in flight
+    STAGE_BURST,        // FIFO burst read in flight
+    STAGE_RESET_STATUS, // Overflow: INT_STATUS read, then the two USER_CTRL writes
+    STAGE_RESET_CLEAR,
+    STAGE_RESET_ENABLE,
+    STAGE_READY,        // fifo_buf holds burst_samples samples
+    STAGE_FAILED        // failed_stage did not complete
+} imu_stage_t;
+
+// --- Internal State ---
+static bool present = false;
+static uint8_t fifo_buf[IMU_FIFO_BURST_SAMPLES * IMU_SAMPLE_BYTES];
+static volatile uint8_t stage = STAGE_IDLE;
+static volatile uint8_t failed_stage;
+static volatile uint8_t burst_samples;
+static volatile uint16_t reset_count_bytes; // FIFO count that caused the last reset, 0 once logged
+static bool failing = false;   // Reads failing: logged once, retried every IMU_RETRY_INTERVAL_MS
+static uint32_t failed_ms = 0; // Failure logged or last retry submitted
+static i2c_request_t count_req;
+static i2c_request_t burst_req;
+static i2c_request_t status_req;
+static i2c_request_t clear_req;
+static i2c_request_t enable_req;
+static uint8_t count_be[2];
+static uint8_t int_status;
+static const uint8_t fifo_clear = USER_FIFO_RESET;
+static const uint8_t fifo_enable = USER_FIFO_EN;
+static int32_t gyro_bias_acc[3];   // Bias << IMU_BIAS_SHIFT, raw LSB
+static int32_t lean_cdeg = 0;
+static int16_t heading_rate_cdps = 0;
+
+// --- Internal Helper Functions ---
+
+static bool write_reg(uint8_t reg, uint8_t value) {
+    return hal_i2c_write_register(MAIN_I2C_ID, IMU_I2C_ADDRESS, reg, &value, 1) == I2C_OK;
+}
+
+static int16_t be16(const uint8_t *p) {
+    return (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+// Signed result of fixed_bearing_deg(): atan2(x, y) in 0.01 degrees, -18000..18000.
+static int32_t atan2_cdeg(int32_t x, int32_t y) {
+    int32_t deg = fixed_bearing_deg(x, y);
+    return ((deg > 180) ? deg - 360 : deg) * 100;
+}
+
+static void reset_fifo(void) {
+    write_reg(REG_USER_CTRL, USER_FIFO_RESET);
+    write_reg(REG_USER_CTRL, USER_FIFO_EN);
+}
+
+static void submit_stage(i2c_request_t *req, uint8_t next) {
+    stage = next;
+    if (!hal_i2c_submit(MAIN_I2C_ID, req)) {
+        failed_stage = next;
+        stage = STAGE_FAILED;
+    }
+}
+
+// TWI interrupt: moves the read sequence on.
+static void on_transfer_done(i2c_status_t status, void *context) {
+    (void)context;
+    if (status != I2C_OK) {
+        failed_stage = stage;
+        stage = STAGE_FAILED;
+        return;
+    }
+    switch (stage) {
+        case STAGE_COUNT: {
+            uint16_t count = (uint16_t)be16(count_be);
+            if (count >= IMU_FIFO_SIZE - IMU_SAMPLE_BYTES || count % IMU_SAMPLE_BYTES != 0) {
+                // Overflowed (e.g. after parked sleep) or out of step: the oldest bytes were lost.
+                reset_count_bytes = count;
+                submit_stage(&status_req, STAGE_RESET_STATUS); // Clears FIFO_OFLOW
+                break;
+            }
+            uint8_t samples = (uint8_t)((count > IMU_FIFO_BURST_SAMPLES * IMU_SAMPLE_BYTES)
+                                            ? IMU_FIFO_BURST_SAMPLES // The rest waits for the next poll
+                                            : count / IMU_SAMPLE_BYTES);
+            if (samples == 0) {
+                stage = STAGE_IDLE;
+                break;
+            }
+            burst_samples = samples;
+            burst_req.rx_length = (uint16_t)samples * IMU_SAMPLE_BYTES;
+            submit_stage(&burst_req, STAGE_BURST);
+            break;
+        }
+        case STAGE_BURST:        stage = STAGE_READY; break;
+        case STAGE_RESET_STATUS: submit_stage(&clear_req, STAGE_RESET_CLEAR); break;
+        case STAGE_RESET_CLEAR:  submit_stage(&enable_req, STAGE_RESET_ENABLE); break;
+        default:                 stage = STAGE_IDLE; break;
+    }
+}
+
+static void prepare_requests(void) {
+    hal_i2c_prepare_read_register(&count_req, IMU_I2C_ADDRESS, REG_FIFO_COUNTH, count_be, sizeof(count_be));
+    hal_i2c_prepare_read_register(&burst_req, IMU_I2C_ADDRESS, REG_FIFO_R_W, fifo_buf, 0);
+    hal_i2c_prepare_read_register(&status_req, IMU_I2C_ADDRESS, REG_INT_STATUS, &int_status, 1);
+    hal_i2c_prepare_write_register(&clear_req, IMU_I2C_ADDRESS, REG_USER_CTRL, &fifo_clear, 1);
+    hal_i2c_prepare_write_register(&enable_req, IMU_I2C_ADDRESS, REG_USER_CTRL, &fifo_enable, 1);
+    i2c_request_t *all[] = { &count_req, &burst_req, &status_req, &clear_req, &enable_req };
+    for (uint8_t i = 0; i < sizeof(all) / sizeof(all[0]); ++i) {
+        all[i]->callback = on_transfer_done;
+        all[i]->context = NULL;
+    }
+}
+
+static void process_sample(const uint8_t *p, uint16_t speed_kmh_x10, int32_t *heading_sum) {
+    int16_t ay = be16(p + 2);
+    int16_t az = be16(p + 4);
+    int32_t rate[3];
+
+    bool still = (speed_kmh_x10 == 0);
+    for (uint8_t i = 0; i < 3; ++i) {
+        int32_t raw = be16(p + 6 + 2 * i);
+        int32_t bias = gyro_bias_acc[i] >> IMU_BIAS_SHIFT;
+        if (raw - bias > GYRO_STILL_LSB || raw - bias < -GYRO_STILL_LSB) still = false;
+        rate[i] = raw - bias;
+    }
+    if (still) {
+        for (uint8_t i = 0; i < 3; ++i) {
+            int32_t raw = be16(p + 6 + 2 * i);
+            gyro_bias_acc[i] += raw - (gyro_bias_acc[i] >> IMU_BIAS_SHIFT);
+        }
+    }
+    for (uint8_t i = 0; i < 3; ++i) {
+        rate[i] = (rate[i] * GYRO_CDPS_Q8) >> 8; // 0.01 deg/s
+    }
+
+    // Yaw about the vertical: the body Z and Y rates weighted by cos/sin of the lean.
+    q15_t sin_lean, cos_lean;
+    fixed_sin_cos_q15((uint16_t)((lean_cdeg < 0) ? lean_cdeg + 36000 : lean_cdeg), &sin_lean, &cos_lean);
+    int32_t heading_rate = -(fixed_scale_q15(rate[1], sin_lean) + fixed_scale_q15(rate[2], cos_lean));
+    *heading_sum += heading_rate;
+
+    // Lean: integrate the roll rate, then pull toward the reference.
+    int32_t reference;
+    if (speed_kmh_x10 >= KINEMATIC_MIN_KMH_X10) {
+        uint16_t v = (speed_kmh_x10 > 4000) ? 4000 : speed_kmh_x10;
+        int32_t r = fixed_clamp_i32(heading_rate, -100000L, 100000L); // Keep v * r in 32 bits
+        reference = atan2_cdeg((int32_t)v * r, LEAN_TAN_DIVISOR);
+    } else {
+        reference = atan2_cdeg(ay, az);
+    }
+    lean_cdeg += rate[0] / IMU_SAMPLE_RATE_HZ;
+    lean_cdeg += (reference - lean_cdeg) >> IMU_LEAN_GAIN_SHIFT;
+    lean_cdeg = fixed_clamp_i32(lean_cdeg, -9000, 9000);
+}
+
+// --- Public API Implementation ---
+
+void imu_init(void) {
+#if ENABLE_IMU
+    uint8_t who = 0;
+    if (hal_i2c_read_register(MAIN_I2C_ID, IMU_I2C_ADDRESS, REG_WHO_AM_I, &who, 1) != I2C_OK ||
+        (who != 0x68 && who != 0x70 && who != 0x71)) {
+        log_warn("IMU: Not found (WHO_AM_I 0x%02X)", who);
+        return;
+    }
+
+    write_reg(REG_PWR_MGMT_1, PWR_RESET);
+    _delay_ms(100); // Register reset
+    bool ok = write_reg(REG_PWR_MGMT_1, PWR_CLK_PLL_X) &&
+              write_reg(REG_SMPLRT_DIV, (uint8_t)(1000 / IMU_SAMPLE_RATE_HZ - 1)) &&
+              write_reg(REG_CONFIG, DLPF_20HZ) &&
+              write_reg(REG_GYRO_CONFIG, GYRO_FS_500DPS) &&
+              write_reg(REG_ACCEL_CONFIG, ACCEL_FS_4G) &&
+              write_reg(REG_FIFO_EN, FIFO_EN_ACCEL_GYRO);
+    if (!ok) {
+        log_error("IMU: Configuration failed");
+        return;
+    }
+    reset_fifo();
+    for (uint8_t i = 0; i < 3; ++i) gyro_bias_acc[i] = 0;
+    lean_cdeg = 0;
+    heading_rate_cdps = 0;
+    prepare_requests();
+    stage = STAGE_IDLE;
+    failing = false;
+    present = true;
+    log_info("IMU: 0x%02X at %u Hz, FIFO enabled", who, IMU_SAMPLE_RATE_HZ);
+#endif
+}
+
+bool imu_is_present(void) {
+    return present;
+}
+
+void imu_poll(uint16_t speed_kmh_x10) {
+    if (!present) return;
+
+    if (failing && (stage == STAGE_READY || stage == STAGE_IDLE)) {
+        failing = false;
+        log_info("IMU: FIFO reads recovered");
+    }
+    switch (stage) {
+        case STAGE_READY: {
+            uint8_t samples = burst_samples;
+            int32_t heading_sum = 0;
+            for (uint8_t i = 0; i < samples; ++i) {
+                process_sample(&fifo_buf[i * IMU_SAMPLE_BYTES], speed_kmh_x10, &heading_sum);
+            }
+            heading_rate_cdps = (int16_t)fixed_clamp_i32(heading_sum / samples, INT16_MIN, INT16_MAX);
+            break;
+        }
+        case STAGE_FAILED: {
+            uint32_t now = hal_timer_millis();
+            if (!failing) {
+                log_warn("IMU: FIFO %s failed, retrying every %u ms",
+                         (failed_stage == STAGE_COUNT)   ? "count read"
+                         : (failed_stage == STAGE_BURST) ? "burst read"
+                                                         : "reset",
+                         IMU_RETRY_INTERVAL_MS);
+                failing = true;
+                failed_ms = now;
+                heading_rate_cdps = 0; // Stale; dead reckoning holds its course meanwhile
+            }
+            if (now - failed_ms < IMU_RETRY_INTERVAL_MS) return;
+            failed_ms = now; // Next retry, if this one fails too
+            break;
+        }
+        case STAGE_IDLE:
+            break;
+        default:
+            return; // Still on the bus (the I2C timeout ends it if the bus hangs)
+    }
+
+    if (reset_count_bytes) {
+        log_debug("IMU: FIFO reset (%u bytes)", reset_count_bytes);
+        reset_count_bytes = 0;
+    }
+    submit_stage(&count_req, STAGE_COUNT);
+}
+
+int16_t imu_get_heading_rate_cdps(void) {
+    return heading_rate_cdps;
+}
+
+int16_t imu_get_lean_cdeg(void) {
+    return (int16_t)lean_cdeg;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file speed_sensor.c
+ * @brief Driver for the Hall effect wheel speed sensor.
+ * SPEED_SENSOR_PIN (PD4) is not the Timer1 input capture pin, so the pulse
+ * is captured in the pin change ISR instead: it reads the 4 us Timer0
+ * timestamp, which is exact to a few microseconds of interrupt latency. The
+ * period-to-speed division runs only when the speed is read.
+ *
+ * Leaned over, the tyre rolls on its shoulder, whose radius is smaller than
+ * the upright rolling radius by SPEED_TYRE_CROWN_RADIUS_MM * (1 - cos(lean)),
+ * so the wheel turns faster for the same road speed. With the IMU lean
+ * (speed_sensor_set_lean_cdeg()) the speed is scaled back down; at 45 degrees
+ * that is about 6 % on a 17 inch rear wheel, which dead reckoning through a
+ * long bend would otherwise add to the distance travelled.
+ */
+
+#include "modules/speed.h" // Use the module header file name
+#include "modules/ride_trace.h"
+#include "modules/settings.h"
+#include "hal/gpio.h"
+#include "hal/timer.h"
+#include "util/logger.h"
+#include "util/fixed.h"
+#include <util/atomic.h>
+
+// --- Defines ---
+#ifndef SPEED_TYRE_CROWN_RADIUS_MM
+#define SPEED_TYRE_CROWN_RADIUS_MM 60
+#endif
+#define SPEED_TIMEOUT_US       ((uint32_t)SPEED_TIMEOUT_MS * 1000UL)
+#define INV_TWO_PI_Q15         5215 // Circumference to radius
+
+// --- Internal State ---
+// Written by the pin change ISR, read under ATOMIC_BLOCK.
+static uint32_t last_pulse_us = 0;
+static uint32_t period_us = 0;   // Between the last two pulses; 0 = stopped or not measured
+static uint16_t pulse_count = 0;
+static bool pulse_valid = false; // last_pulse_us is recent enough to measure a period from
+static bool present = false;
+static bool replay = false;      // Pulses come from speed_sensor_inject_pulse(), not the pin
+
+// 0.1 km/h times pulse period in us: mm per pulse * 3600 (mm/us -> km/h) * 10, from the wheel settings
+static uint32_t kmh_x10_times_us = 0;
+static uint8_t wheel_revision = 0;
+static q15_t lean_scale_q15 = FIXED_Q15_ONE; // Rolling radius at the current lean over the upright one
+
+// --- Internal Helper Functions ---
+
+// Takes one pulse at time now (us). Interrupts off.
+static void accept_pulse(uint32_t now) {
+    if (pulse_valid) {
+        uint32_t period = now - last_pulse_us;
+        if (period < SPEED_MIN_PERIOD_US) {
+            return; // Noise, keep measuring from the previous pulse
+        }
+        period_us = period;
+        present = true;
+    }
+    last_pulse_us = now;
+    pulse_valid = true;
+    pulse_count++;
+}
+
+// Refreshes the speed numerator after the wheel settings change.
+static uint32_t speed_numerator(void) {
+    uint8_t revision = settings_get_revision();
+    if (kmh_x10_times_us == 0 || revision != wheel_revision) {
+        const settings_t *s = settings_get();
+        kmh_x10_times_us = (uint32_t)s->wheel_circumference_mm * 36000UL / s->wheel_pulses_per_rev;
+        wheel_revision = revision;
+    }
+    return kmh_x10_times_us;
+}
+
+#if ENABLE_SPEED_SENSOR
+// Pin change ISR callback: both edges arrive here, the falling one (magnet arriving) counts.
+static void on_speed_edge(uint8_t pin) {
+    if (hal_gpio_read(pin)) {
+        return;
+    }
+    ride_trace_record_speed_pulse(); // Before the noise filter, so playback exercises it
+    if (!replay) {
+        accept_pulse(hal_timer_micros());
+    }
+}
+#endif
+
+// --- Public API Implementation ---
+
+void speed_sensor_init(void) {
+#if ENABLE_SPEED_SENSOR
+    hal_gpio_init(SPEED_SENSOR_PIN, GPIO_MODE_INPUT_PULLUP); // Open collector output
+    hal_gpio_configure_interrupt(SPEED_SENSOR_PIN, GPIO_INT_PIN_CHANGE, on_speed_edge);
+    hal_gpio_enable_interrupt(SPEED_SENSOR_PIN);
+    log_info("Speed Sensor: %u mm per pulse",
+             settings_get()->wheel_circumference_mm / settings_get()->wheel_pulses_per_rev);
+#endif
+}
+
+bool speed_sensor_is_present(void) {
+    bool seen;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        seen = present;
+    }
+    return seen;
+}
+
+uint16_t speed_sensor_get_speed_kmh_x10(void) {
+    uint32_t last, period;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        last = last_pulse_us;
+        period = period_us;
+    }
+    if (period == 0) {
+        return 0;
+    }
+
+    uint32_t elapsed = hal_timer_micros() - last;
+    if (elapsed >= SPEED_TIMEOUT_US) {
+        // Stopped. Also drops the old timestamp well before the 71 minute wrap of micros.
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            if (last_pulse_us == last) {
+                period_us = 0;
+                pulse_valid = false;
+            }
+        }
+        return 0;
+    }
+    if (elapsed > period) {
+        period = elapsed; // Next pulse overdue: the wheel is at most this fast
+    }
+    return fixed_sat_u16(fixed_scale_q15((int32_t)(speed_numerator() / period), lean_scale_q15));
+}
+
+void speed_sensor_set_lean_cdeg(int16_t lean_cdeg) {
+    uint32_t radius_mm = ((uint32_t)settings_get()->wheel_circumference_mm * INV_TWO_PI_Q15) >> 15;
+    if (SPEED_TYRE_CROWN_RADIUS_MM == 0 || radius_mm <= SPEED_TYRE_CROWN_RADIUS_MM) {
+        lean_scale_q15 = FIXED_Q15_ONE;
+        return;
+    }
+    q15_t sin_lean, cos_lean;
+    fixed_sin_cos_q15((uint16_t)((lean_cdeg < 0) ? -lean_cdeg : lean_cdeg), &sin_lean, &cos_lean);
+    uint32_t shrink = (uint32_t)SPEED_TYRE_CROWN_RADIUS_MM * (uint16_t)(FIXED_Q15_ONE - cos_lean) / radius_mm;
+    lean_scale_q15 = (q15_t)(FIXED_Q15_ONE - shrink); // shrink < 1 - cos(lean) < 1
+}
+
+uint16_t speed_sensor_get_pulse_count(void) {
+    uint16_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = pulse_count;
+    }
+    return count;
+}
+
+void speed_sensor_set_replay(bool enabled) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        replay = enabled;
+        period_us = 0; // Live and replayed pulse times do not mix
+        pulse_valid = false;
+    }
+}
+
+void speed_sensor_inject_pulse(uint32_t at_us) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (replay) {
+            accept_pulse(at_us);
+        }
+    }
+}
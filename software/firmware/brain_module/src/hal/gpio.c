@@ -2,12 +2,16 @@
  * @file gpio.c
  * @brief GPIO Hardware Abstraction Layer implementation for ATmega328P.
  * Provides functions to control GPIO pins, including configuration,
- * read/write operations, and interrupt handling.
+ * read/write operations, and interrupt handling. This module owns the
+ * INT0/INT1 and pin change vectors and dispatches them to the registered callbacks.
  */
 
 #include "hal/gpio.h"
 #include "util/logger.h" // For logging status/errors
 #include <stddef.h>      // For NULL
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 
 // --- Internal Data Structures ---
 
@@ -15,13 +19,47 @@
 typedef struct {
     gpio_interrupt_callback_t callback;
     uint8_t pin_number; // Store the pin number for the callback context
+    bool external;      // true: INT0/INT1, false: pin change
 } gpio_interrupt_config_t;
 
-// Allocate storage for callbacks (adjust size based on available interrupt pins)
-// ATmega328P has INT0, INT1, and 24 PCINT pins (grouped into 3 banks)
-#define MAX_GPIO_INTERRUPTS (2 + 24)
+// Turn signals (INT0/INT1) and the speed sensor, plus one spare
+#define MAX_GPIO_INTERRUPTS 4
 static gpio_interrupt_config_t interrupt_configs[MAX_GPIO_INTERRUPTS];
 static uint8_t interrupt_count = 0; // Track configured interrupts
+static uint8_t pcint_last_level[3]; // Port levels at the previous pin change, per PCINT bank
+
+_Static_assert(GPIO_INT_EDGE_LOW_LEVEL == 0 && GPIO_INT_EDGE_ANY_CHANGE == 1 &&
+               GPIO_INT_EDGE_FALLING == 2 && GPIO_INT_EDGE_RISING == 3, "Edge types must match ISCn1:ISCn0");
+
+// --- Helper Functions ---
+
+// PINx, DDRx and PORTx are consecutive I/O registers on the ATmega328P.
+static volatile uint8_t *pin_register(uint8_t pin) {
+    switch (GPIO_PIN_PORT(pin)) {
+        case GPIO_PORT_B: return &PINB;
+        case GPIO_PORT_C: return &PINC;
+        default:          return &PIND;
+    }
+}
+
+#define DDR_REG(pinreg)  (*((pinreg) + 1))
+#define PORT_REG(pinreg) (*((pinreg) + 2))
+
+// PCMSKn for a port: B = PCINT0..7, C = PCINT8..14, D = PCINT16..23.
+static volatile uint8_t *pcint_mask_register(uint8_t port) {
+    switch (port) {
+        case GPIO_PORT_B: return &PCMSK0;
+        case GPIO_PORT_C: return &PCMSK1;
+        default:          return &PCMSK2;
+    }
+}
+
+// INT0/INT1 index of a pin, or -1 if the pin has no external interrupt.
+static int8_t external_index(uint8_t pin) {
+    if (pin == GPIO_PIN(GPIO_PORT_D, PD2)) return 0;
+    if (pin == GPIO_PIN(GPIO_PORT_D, PD3)) return 1;
+    return -1;
+}
 
 // Helper function to find interrupt config by pin
 static gpio_interrupt_config_t* find_interrupt_config(uint8_t pin) {
@@ -36,61 +74,165 @@ static gpio_interrupt_config_t* find_interrupt_config(uint8_t pin) {
 // --- Public API Implementation ---
 
 void hal_gpio_init(uint8_t pin, gpio_mode_t mode) {
-    // Configure the specified pin with the given mode (Input/Output/Pullup/Analog).
-    log_debug("GPIO: Init Pin %d, Mode %d", pin, mode);
-    // Hardware-specific configuration would happen here.
+    volatile uint8_t *pinreg = pin_register(pin);
+    uint8_t mask = _BV(GPIO_PIN_BIT(pin));
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        switch (mode) {
+            case GPIO_MODE_OUTPUT_PP:
+                DDR_REG(pinreg) |= mask;
+                break;
+            case GPIO_MODE_INPUT_PULLUP:
+                DDR_REG(pinreg) &= (uint8_t)~mask;
+                PORT_REG(pinreg) |= mask;
+                break;
+            case GPIO_MODE_ANALOG:
+                if (GPIO_PIN_PORT(pin) == GPIO_PORT_C) {
+                    DIDR0 |= mask; // ADC pins share the bit numbers of port C
+                }
+                // Fall through: high-impedance input
+            case GPIO_MODE_INPUT:
+            default:
+                DDR_REG(pinreg) &= (uint8_t)~mask;
+                PORT_REG(pinreg) &= (uint8_t)~mask;
+                break;
+        }
+    }
+    log_debug("GPIO: Init Pin 0x%02x, Mode %d", pin, mode);
 }
 
 void hal_gpio_write(uint8_t pin, bool state) {
-    // Set the output state (High/Low) for a pin configured as output.
-    log_debug("GPIO: Write Pin %d, State %d", pin, state);
-    // Hardware-specific write operation would happen here.
+    volatile uint8_t *pinreg = pin_register(pin);
+    uint8_t mask = _BV(GPIO_PIN_BIT(pin));
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (state) {
+            PORT_REG(pinreg) |= mask;
+        } else {
+            PORT_REG(pinreg) &= (uint8_t)~mask;
+        }
+    }
 }
 
 bool hal_gpio_read(uint8_t pin) {
-    // Read the current input state of the specified pin.
-    log_debug("GPIO: Read Pin %d", pin);
-    // Hardware-specific read operation would happen here.
-    // Return a dummy value for demonstration.
-    static bool dummy_state = false;
-    dummy_state = !dummy_state;
-    return dummy_state;
+    return (*pin_register(pin) & _BV(GPIO_PIN_BIT(pin))) != 0;
 }
 
 void hal_gpio_toggle(uint8_t pin) {
-    // Toggle the output state of a pin configured as output.
-    log_debug("GPIO: Toggle Pin %d", pin);
-    // Hardware-specific toggle operation would happen here.
+    *pin_register(pin) = _BV(GPIO_PIN_BIT(pin)); // Writing 1 to PINx toggles PORTx
 }
 
 bool hal_gpio_configure_interrupt(uint8_t pin, gpio_interrupt_edge_t edge, gpio_interrupt_callback_t callback) {
-    if (interrupt_count >= MAX_GPIO_INTERRUPTS) {
-        log_error("GPIO: Max interrupts configured (%d)", MAX_GPIO_INTERRUPTS);
+    int8_t ext = external_index(pin);
+    if (edge != GPIO_INT_PIN_CHANGE && ext < 0) {
+        log_error("GPIO: Pin 0x%02x has no external interrupt", pin);
         return false;
     }
-    // Configure the specified pin to trigger an interrupt on a given edge/condition
-    // and associate the provided callback function.
-    log_info("GPIO: Cfg Int Pin %d, Edge %d, CB %p", pin, edge, callback);
+    gpio_interrupt_config_t *cfg = find_interrupt_config(pin);
+    if (!cfg) {
+        if (interrupt_count >= MAX_GPIO_INTERRUPTS) {
+            log_error("GPIO: Max interrupts configured (%d)", MAX_GPIO_INTERRUPTS);
+            return false;
+        }
+        cfg = &interrupt_configs[interrupt_count];
+    }
 
-    // Store callback association for simulation purposes.
-    interrupt_configs[interrupt_count].callback = callback;
-    interrupt_configs[interrupt_count].pin_number = pin;
-    interrupt_count++;
-    // Hardware-specific interrupt configuration would happen here.
-    return true; // Assume success
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        cfg->callback = callback;
+        cfg->pin_number = pin;
+        cfg->external = (edge != GPIO_INT_PIN_CHANGE);
+        if (cfg == &interrupt_configs[interrupt_count]) {
+            interrupt_count++;
+        }
+
+        if (cfg->external) {
+            // ISCn1:ISCn0 = 00 low level, 01 any change, 10 falling, 11 rising
+            uint8_t shift = (uint8_t)(ext * 2);
+            uint8_t sense = (uint8_t)edge;
+            EICRA = (uint8_t)((EICRA & ~(0x03 << shift)) | (sense << shift));
+            EIFR = _BV(ext); // Drop an edge latched under the old setting
+        }
+    }
+    log_info("GPIO: Cfg Int Pin 0x%02x, Edge %d", pin, edge);
+    return true;
 }
 
 void hal_gpio_enable_interrupt(uint8_t pin) {
-    // Enable the previously configured interrupt for the specified pin.
-    log_debug("GPIO: Enable Int Pin %d", pin);
-    // Hardware-specific interrupt enable operation would happen here.
+    gpio_interrupt_config_t *cfg = find_interrupt_config(pin);
+    if (!cfg) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (cfg->external) {
+            EIMSK |= _BV(external_index(pin));
+        } else {
+            uint8_t port = GPIO_PIN_PORT(pin);
+            pcint_last_level[port] = *pin_register(pin);
+            *pcint_mask_register(port) |= _BV(GPIO_PIN_BIT(pin));
+            PCIFR = _BV(port); // PCIFn/PCIEn bit n is the port's bank
+            PCICR |= _BV(port);
+        }
+    }
 }
 
 void hal_gpio_disable_interrupt(uint8_t pin) {
-    // Disable the interrupt for the specified pin.
-    log_debug("GPIO: Disable Int Pin %d", pin);
-    // Hardware-specific interrupt disable operation would happen here.
+    gpio_interrupt_config_t *cfg = find_interrupt_config(pin);
+    if (!cfg) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (cfg->external) {
+            EIMSK &= (uint8_t)~_BV(external_index(pin));
+        } else {
+            uint8_t port = GPIO_PIN_PORT(pin);
+            volatile uint8_t *mask = pcint_mask_register(port);
+            *mask &= (uint8_t)~_BV(GPIO_PIN_BIT(pin));
+            if (*mask == 0) {
+                PCICR &= (uint8_t)~_BV(port);
+            }
+        }
+    }
+}
+
+// --- Interrupt Service Routines ---
+
+static void dispatch_external(uint8_t pin) {
+    for (uint8_t i = 0; i < interrupt_count; ++i) {
+        if (interrupt_configs[i].external && interrupt_configs[i].pin_number == pin) {
+            interrupt_configs[i].callback(pin);
+            return;
+        }
+    }
+}
+
+// Calls back every enabled pin of the bank whose level changed since the last interrupt.
+static void dispatch_pin_change(uint8_t port, uint8_t level) {
+    uint8_t changed = (uint8_t)((level ^ pcint_last_level[port]) & *pcint_mask_register(port));
+    pcint_last_level[port] = level;
+    for (uint8_t i = 0; i < interrupt_count && changed; ++i) {
+        uint8_t pin = interrupt_configs[i].pin_number;
+        if (!interrupt_configs[i].external && GPIO_PIN_PORT(pin) == port &&
+            (changed & _BV(GPIO_PIN_BIT(pin)))) {
+            interrupt_configs[i].callback(pin);
+        }
+    }
+}
+
+// hal_power_deep_sleep() switches INT0/INT1 to low level for wake-up; a level
+// interrupt keeps firing while the pin is low, so it masks itself here.
+ISR(INT0_vect) {
+    if ((EICRA & (_BV(ISC01) | _BV(ISC00))) == 0) EIMSK &= (uint8_t)~_BV(INT0);
+    dispatch_external(GPIO_PIN(GPIO_PORT_D, PD2));
+}
+
+ISR(INT1_vect) {
+    if ((EICRA & (_BV(ISC11) | _BV(ISC10))) == 0) EIMSK &= (uint8_t)~_BV(INT1);
+    dispatch_external(GPIO_PIN(GPIO_PORT_D, PD3));
 }
 
-// Interrupt Service Routines would normally be defined here, calling the
-// associated callbacks stored in interrupt_configs.
+ISR(PCINT0_vect) {
+    dispatch_pin_change(GPIO_PORT_B, PINB);
+}
+
+ISR(PCINT1_vect) {
+    dispatch_pin_change(GPIO_PORT_C, PINC);
+}
+
+ISR(PCINT2_vect) {
+    dispatch_pin_change(GPIO_PORT_D, PIND);
+}
@@ -1,84 +1,216 @@
 /**
  * @file i2c.c
  * @brief I2C (TWI) HAL implementation for ATmega328P.
- * Provides blocking master mode functions for I2C communication.
+ * An interrupt-driven master: TWI_vect steps the current request through
+ * START, address, prefix, data, repeated START and read, then completes it
+ * and starts the next queued one with a combined STOP + START. The main loop
+ * only touches the queue, so a 96-byte IMU burst costs it nothing but the
+ * submit. Timeouts and bus recovery live in hal_i2c_service().
  */
 
 #include "hal/i2c.h"
+#include "hal/timer.h"
 #include "util/logger.h"
-#include <util/delay.h> // For timeouts
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h> // For ATOMIC_BLOCK
+#include <util/delay.h>
+#include <util/twi.h> // TW_* status codes
 
 // --- Defines ---
-#define I2C_TIMEOUT_MS 10 // Timeout for I2C operations
+#ifndef I2C_QUEUE_SIZE
+#define I2C_QUEUE_SIZE     4  // Requests waiting behind the one on the bus
+#endif
+#ifndef I2C_TIMEOUT_MS
+#define I2C_TIMEOUT_MS     20 // Per transaction; a 96-byte burst takes 2.4 ms at 400 kHz
+#endif
+#define I2C_RECOVERY_CLOCKS 9 // Enough for a slave to finish any byte it was sending
+#define I2C_SDA_BIT        PC4 // The TWI pins are fixed on the ATmega328P
+#define I2C_SCL_BIT        PC5
+
+// TWCR values: continue with the interrupt enabled; idle with the interrupt off.
+#define TWCR_GO   (_BV(TWINT) | _BV(TWEN) | _BV(TWIE))
+#define TWCR_IDLE _BV(TWEN)
+
+// --- Internal State ---
+static i2c_request_t *queue[I2C_QUEUE_SIZE];
+static uint8_t queue_head = 0;
+static uint8_t queue_count = 0;
+static i2c_request_t *volatile current = NULL; // On the bus
+static uint16_t tx_pos = 0;    // Prefix + data bytes sent
+static uint16_t rx_pos = 0;    // Bytes received
+static bool reading = false;   // Past the repeated START
+static bool completing = false; // In a callback: submits queue instead of starting
+static volatile uint32_t started_ms = 0;
+static uint32_t clock_hz = I2C_CLOCK_SPEED;
 
 // --- Internal Helper Functions ---
 
-// Waits for the current I2C operation to complete, with a timeout mechanism.
-static bool i2c_wait_for_complete(void) {
-    // Simulate waiting for hardware completion.
-    _delay_us(50); // Simulate hardware delay
-    // In a real implementation, check hardware status flags and handle timeouts.
-    return true; // Assume success for placeholder
+// All queue and engine state below is touched with interrupts disabled.
+
+static void begin(i2c_request_t *req, uint8_t twcr) {
+    current = req;
+    tx_pos = 0;
+    rx_pos = 0;
+    reading = (req->prefix_length == 0 && req->tx_length == 0 && req->rx_length > 0);
+    started_ms = hal_timer_millis();
+    TWCR = twcr | _BV(TWSTA);
 }
 
-// Initiates an I2C START condition on the bus.
-static i2c_status_t i2c_start(void) {
-    // Send START condition command to hardware.
-    if (!i2c_wait_for_complete()) return I2C_ERROR_TIMEOUT;
-    // Check hardware status to confirm START was sent successfully.
-    log_debug("I2C: START sent");
-    return I2C_OK; // Assume success
+static i2c_request_t *dequeue(void) {
+    if (queue_count == 0) return NULL;
+    i2c_request_t *req = queue[queue_head];
+    queue_head = (uint8_t)((queue_head + 1) % I2C_QUEUE_SIZE);
+    queue_count--;
+    return req;
 }
 
-// Initiates an I2C STOP condition on the bus.
-static void i2c_stop(void) {
-    // Send STOP condition command to hardware.
-    // No status check typically needed, but ensure command is sent.
-    log_debug("I2C: STOP sent");
+// Completes the current request and moves on. release: the TWI still holds
+// the bus and must send a STOP (not after arbitration loss or a reset).
+static void complete(i2c_status_t status, bool release) {
+    i2c_request_t *req = current;
+    current = NULL;
+    if (req) {
+        req->status = status;
+        if (req->callback) {
+            completing = true;
+            req->callback(status, req->context);
+            completing = false;
+        }
+    }
+    i2c_request_t *next = dequeue();
+    if (next) {
+        begin(next, release ? (TWCR_GO | _BV(TWSTO)) : TWCR_GO); // STOP then START
+    } else {
+        TWCR = release ? (_BV(TWINT) | _BV(TWSTO) | TWCR_IDLE) : TWCR_IDLE;
+    }
+}
+
+static uint8_t tx_byte(const i2c_request_t *req, uint16_t pos) {
+    return (pos < req->prefix_length) ? req->prefix[pos] : req->tx_data[pos - req->prefix_length];
+}
+
+// One step of the master state machine, on TWINT.
+static void twi_step(void) {
+    i2c_request_t *req = current;
+    if (!req) {
+        TWCR = TWCR_IDLE; // Stray interrupt, e.g. after a reset
+        return;
+    }
+
+    switch (TW_STATUS) {
+        case TW_START:
+        case TW_REP_START:
+            TWDR = (uint8_t)((req->address << 1) | (reading ? 1 : 0));
+            TWCR = TWCR_GO;
+            break;
+
+        case TW_MT_SLA_ACK:
+        case TW_MT_DATA_ACK:
+            if (tx_pos < (uint16_t)req->prefix_length + req->tx_length) {
+                TWDR = tx_byte(req, tx_pos++);
+                TWCR = TWCR_GO;
+            } else if (req->rx_length > 0) {
+                reading = true;
+                TWCR = TWCR_GO | _BV(TWSTA); // Repeated START
+            } else {
+                complete(I2C_OK, true);
+            }
+            break;
+
+        case TW_MR_SLA_ACK:
+            TWCR = (req->rx_length > 1) ? (TWCR_GO | _BV(TWEA)) : TWCR_GO; // NACK the last byte
+            break;
+
+        case TW_MR_DATA_ACK:
+            req->rx_data[rx_pos++] = TWDR;
+            TWCR = (rx_pos + 1 < req->rx_length) ? (TWCR_GO | _BV(TWEA)) : TWCR_GO;
+            break;
+
+        case TW_MR_DATA_NACK:
+            req->rx_data[rx_pos++] = TWDR;
+            complete(I2C_OK, true);
+            break;
+
+        case TW_MT_SLA_NACK:  complete(I2C_ERROR_SLA_W_NACK, true); break;
+        case TW_MR_SLA_NACK:  complete(I2C_ERROR_SLA_R_NACK, true); break;
+        case TW_MT_DATA_NACK: complete(I2C_ERROR_DATA_TX_NACK, true); break;
+        case TW_MT_ARB_LOST:  complete(I2C_ERROR_ARB_LOST, false); break; // Also TW_MR_ARB_LOST
+        default:              complete(I2C_ERROR_UNKNOWN, true); break;   // TW_BUS_ERROR: STOP resets the TWI
+    }
 }
 
-// Sends the slave address byte (with R/W bit) onto the bus.
-static i2c_status_t i2c_send_address(uint8_t address_rw) {
-    // Load address into hardware data register and initiate transmission.
-    if (!i2c_wait_for_complete()) return I2C_ERROR_TIMEOUT;
-    // Check hardware status for ACK/NACK from the slave.
-    log_debug("I2C: Address 0x%02X sent", address_rw);
-    // Return appropriate status (I2C_OK, I2C_ERROR_SLA_W_NACK, I2C_ERROR_SLA_R_NACK).
-    return I2C_OK; // Assume ACK received
+static void set_clock(uint32_t clock_speed) {
+    // SCL = F_CPU / (16 + 2 * TWBR) with prescaler 1: TWBR 12 for 400 kHz at 16 MHz
+    uint32_t twbr = (F_CPU / clock_speed - 16) / 2;
+    TWSR = 0;
+    TWBR = (twbr > 255) ? 255 : (uint8_t)twbr;
+    TWCR = TWCR_IDLE;
 }
 
-// Sends a single data byte onto the bus.
-static i2c_status_t i2c_send_data(uint8_t data) {
-    // Load data into hardware data register and initiate transmission.
-    if (!i2c_wait_for_complete()) return I2C_ERROR_TIMEOUT;
-    // Check hardware status for ACK/NACK from the slave.
-    log_debug("I2C: Data 0x%02X sent", data);
-    // Return appropriate status (I2C_OK, I2C_ERROR_DATA_TX_NACK).
-    return I2C_OK; // Assume ACK received
+// Frees a bus held by a slave that lost sync mid-byte: with the TWI off, clock
+// SCL until SDA is released, then make a STOP. Open drain by hand: a pin is
+// driven low with DDR set and PORT clear, and released to the pull-up otherwise.
+static void recover_bus(void) {
+    TWCR = 0;
+    PORTC &= (uint8_t)~(_BV(I2C_SDA_BIT) | _BV(I2C_SCL_BIT));
+    DDRC &= (uint8_t)~(_BV(I2C_SDA_BIT) | _BV(I2C_SCL_BIT));
+    for (uint8_t i = 0; i < I2C_RECOVERY_CLOCKS && !(PINC & _BV(I2C_SDA_BIT)); ++i) {
+        DDRC |= _BV(I2C_SCL_BIT);
+        _delay_us(5);
+        DDRC &= (uint8_t)~_BV(I2C_SCL_BIT);
+        _delay_us(5);
+    }
+    DDRC |= _BV(I2C_SDA_BIT); // STOP: SDA rises while SCL is high
+    _delay_us(5);
+    DDRC &= (uint8_t)~_BV(I2C_SDA_BIT);
+    _delay_us(5);
+    set_clock(clock_hz);
 }
 
-// Receives a data byte from the bus and sends an ACK.
-static i2c_status_t i2c_receive_data_ack(uint8_t *data) {
-    // Configure hardware to receive data and send ACK afterwards.
-    if (!i2c_wait_for_complete()) return I2C_ERROR_TIMEOUT;
-    // Check hardware status to confirm data received successfully.
-    // Read data from hardware data register.
-    *data = 0xAB; // Provide dummy data
-    log_debug("I2C: Data 0x%02X received (ACK)", *data);
-    return I2C_OK; // Assume success
+// Aborts the transaction on the bus (if any) after recovering the bus.
+static void abort_current(void) {
+    i2c_request_t *req;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        req = current;
+        current = NULL; // Requests submitted now queue up behind the recovery
+        completing = true;
+        TWCR = 0;
+    }
+    recover_bus(); // ~100 us with interrupts on
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        completing = false;
+        current = req;
+        complete(I2C_ERROR_TIMEOUT, false);
+    }
 }
 
-// Receives a data byte from the bus and sends a NACK (used for the last byte).
-static i2c_status_t i2c_receive_data_nack(uint8_t *data) {
-    // Configure hardware to receive data and send NACK afterwards.
-    if (!i2c_wait_for_complete()) return I2C_ERROR_TIMEOUT;
-    // Check hardware status to confirm data received successfully.
-    // Read data from hardware data register.
-    *data = 0xCD; // Provide dummy data
-    log_debug("I2C: Data 0x%02X received (NACK)", *data);
-    return I2C_OK; // Assume success
+static bool valid(const i2c_request_t *req) {
+    return req->prefix_length <= sizeof(req->prefix) && (req->tx_length == 0 || req->tx_data) &&
+           (req->rx_length == 0 || req->rx_data);
 }
 
+// Blocking wrappers: submit and wait. Steps the state machine by hand if
+// interrupts are off, so the wrappers also work before sei() (the timeout
+// needs the millisecond tick, though).
+static void pump(void) {
+    if (!(SREG & _BV(SREG_I)) && (TWCR & _BV(TWINT))) {
+        twi_step();
+    }
+    hal_i2c_service(I2C_ID_0);
+}
+
+static i2c_status_t run(i2c_request_t *req) {
+    if (!valid(req)) return I2C_ERROR_UNKNOWN;
+    req->callback = NULL;
+    while (!hal_i2c_submit(I2C_ID_0, req)) {
+        pump(); // Queue full: wait for room
+    }
+    while (req->status == I2C_PENDING) {
+        pump();
+    }
+    return req->status;
+}
 
 // --- Public API Implementation ---
 
@@ -87,189 +219,111 @@ void hal_i2c_init(i2c_id_t i2c_id, uint32_t clock_speed) {
         log_error("I2C: Invalid ID %d for init", i2c_id);
         return;
     }
-    // Configure the I2C hardware peripheral (e.g., TWI on ATmega).
-    log_info("I2C: Init ID %d, Speed %lu Hz", i2c_id, clock_speed);
-    // Set clock speed (e.g., configure TWBR register).
-    // Enable the I2C peripheral.
-}
-
-i2c_status_t hal_i2c_write(i2c_id_t i2c_id, uint8_t device_address, const uint8_t *data, size_t length, bool stop) {
-    if (i2c_id != I2C_ID_0) return I2C_ERROR_UNKNOWN;
-
-    i2c_status_t status;
-
-    // Initiate START condition.
-    status = i2c_start();
-    if (status != I2C_OK) {
-        i2c_stop(); // Attempt to clean up bus on error.
-        return status;
+    clock_hz = clock_speed;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        current = NULL;
+        queue_head = 0;
+        queue_count = 0;
+        set_clock(clock_speed);
     }
+    log_info("I2C: Init ID %d, Speed %lu Hz (TWBR %u)", i2c_id, clock_speed, TWBR);
+}
 
-    // Send slave address with Write bit.
-    status = i2c_send_address((device_address << 1) | 0);
-    if (status != I2C_OK) {
-        i2c_stop();
-        return status;
+bool hal_i2c_submit(i2c_id_t i2c_id, i2c_request_t *req) {
+    if (i2c_id != I2C_ID_0 || !req || !valid(req)) {
+        return false;
     }
-
-    // Send data bytes sequentially.
-    for (size_t i = 0; i < length; ++i) {
-        status = i2c_send_data(data[i]);
-        if (status != I2C_OK) {
-            i2c_stop();
-            return status;
+    bool accepted = true;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!current && !completing && queue_count == 0) {
+            req->status = I2C_PENDING;
+            // A STOP from the last transaction may still be on the bus (a few us)
+            for (uint8_t n = 0; n < 200 && (TWCR & _BV(TWSTO)); ++n) {
+            }
+            begin(req, TWCR_GO);
+        } else if (queue_count < I2C_QUEUE_SIZE) {
+            req->status = I2C_PENDING;
+            queue[(queue_head + queue_count) % I2C_QUEUE_SIZE] = req;
+            queue_count++;
+        } else {
+            accepted = false;
         }
     }
+    return accepted;
+}
 
-    // Send STOP condition if requested.
-    if (stop) {
-        i2c_stop();
+bool hal_i2c_is_busy(i2c_id_t i2c_id) {
+    (void)i2c_id;
+    bool busy;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        busy = (current != NULL || queue_count != 0);
     }
-
-    return I2C_OK;
+    return busy;
 }
 
-i2c_status_t hal_i2c_read(i2c_id_t i2c_id, uint8_t device_address, uint8_t *data, size_t length, bool stop) {
-     if (i2c_id != I2C_ID_0 || length == 0) return I2C_ERROR_UNKNOWN;
-
-    i2c_status_t status;
-
-    // Initiate START condition.
-    status = i2c_start();
-    if (status != I2C_OK) {
-        i2c_stop();
-        return status;
+void hal_i2c_service(i2c_id_t i2c_id) {
+    if (i2c_id != I2C_ID_0) return;
+    bool expired;
+    uint8_t address = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        expired = (current != NULL && hal_timer_millis() - started_ms > I2C_TIMEOUT_MS);
+        if (expired) address = current->address;
     }
-
-    // Send slave address with Read bit.
-    status = i2c_send_address((device_address << 1) | 1);
-    if (status != I2C_OK) {
-        i2c_stop();
-        return status;
+    if (expired) {
+        log_warn("I2C: Transaction to 0x%02X timed out, recovering bus", address);
+        abort_current();
     }
+}
 
-    // Receive data bytes sequentially.
-    for (size_t i = 0; i < length; ++i) {
-        bool is_last_byte = (i == length - 1);
-        if (is_last_byte) {
-            // Receive last byte and send NACK.
-            status = i2c_receive_data_nack(&data[i]);
-        } else {
-            // Receive byte and send ACK.
-            status = i2c_receive_data_ack(&data[i]);
-        }
-        if (status != I2C_OK) {
-            i2c_stop();
-            return status;
-        }
-    }
+i2c_status_t hal_i2c_write(i2c_id_t i2c_id, uint8_t device_address, const uint8_t *data, size_t length) {
+    return hal_i2c_write_read(i2c_id, device_address, data, length, NULL, 0);
+}
 
-    // Send STOP condition if requested.
-    if (stop) {
-        i2c_stop();
-    }
+i2c_status_t hal_i2c_read(i2c_id_t i2c_id, uint8_t device_address, uint8_t *data, size_t length) {
+    if (length == 0) return I2C_ERROR_UNKNOWN;
+    return hal_i2c_write_read(i2c_id, device_address, NULL, 0, data, length);
+}
 
-    return I2C_OK;
+i2c_status_t hal_i2c_write_read(i2c_id_t i2c_id, uint8_t device_address, const uint8_t *tx_data, size_t tx_length,
+                                uint8_t *rx_data, size_t rx_length) {
+    if (i2c_id != I2C_ID_0) return I2C_ERROR_UNKNOWN;
+    i2c_request_t req = {
+        .address = device_address,
+        .tx_data = tx_data,
+        .tx_length = (uint16_t)tx_length,
+        .rx_data = rx_data,
+        .rx_length = (uint16_t)rx_length,
+    };
+    return run(&req);
 }
 
 i2c_status_t hal_i2c_write_register(i2c_id_t i2c_id, uint8_t device_address, uint8_t reg_address, const uint8_t *data, size_t length) {
     if (i2c_id != I2C_ID_0) return I2C_ERROR_UNKNOWN;
-
-    i2c_status_t status;
-
-    // Initiate START condition.
-    status = i2c_start();
-    if (status != I2C_OK) { i2c_stop(); return status; }
-
-    // Send slave address with Write bit.
-    status = i2c_send_address((device_address << 1) | 0);
-    if (status != I2C_OK) { i2c_stop(); return status; }
-
-    // Send the register address to write to.
-    status = i2c_send_data(reg_address);
-    if (status != I2C_OK) { i2c_stop(); return status; }
-
-    // Send the data bytes for the register.
-    for (size_t i = 0; i < length; ++i) {
-        status = i2c_send_data(data[i]);
-        if (status != I2C_OK) { i2c_stop(); return status; }
-    }
-
-    // Send STOP condition.
-    i2c_stop();
-
-    return I2C_OK;
+    i2c_request_t req;
+    hal_i2c_prepare_write_register(&req, device_address, reg_address, data, (uint16_t)length);
+    return run(&req);
 }
 
 i2c_status_t hal_i2c_read_register(i2c_id_t i2c_id, uint8_t device_address, uint8_t reg_address, uint8_t *data, size_t length) {
     if (i2c_id != I2C_ID_0 || length == 0) return I2C_ERROR_UNKNOWN;
-
-    i2c_status_t status;
-
-    // --- Write Phase: Send register address ---
-    status = i2c_start();
-    if (status != I2C_OK) { i2c_stop(); return status; }
-
-    status = i2c_send_address((device_address << 1) | 0);
-    if (status != I2C_OK) { i2c_stop(); return status; }
-
-    status = i2c_send_data(reg_address);
-    if (status != I2C_OK) { i2c_stop(); return status; }
-
-    // --- Read Phase ---
-    // Send Repeated START condition.
-    status = i2c_start();
-    if (status != I2C_OK) { i2c_stop(); return status; }
-
-    // Send slave address with Read bit.
-    status = i2c_send_address((device_address << 1) | 1);
-    if (status != I2C_OK) { i2c_stop(); return status; }
-
-    // Receive data bytes.
-    for (size_t i = 0; i < length; ++i) {
-        bool is_last_byte = (i == length - 1);
-        if (is_last_byte) {
-            status = i2c_receive_data_nack(&data[i]); // NACK last byte
-        } else {
-            status = i2c_receive_data_ack(&data[i]); // ACK intermediate bytes
-        }
-        if (status != I2C_OK) { i2c_stop(); return status; }
-    }
-
-    // Send STOP condition.
-    i2c_stop();
-
-    return I2C_OK;
+    i2c_request_t req;
+    hal_i2c_prepare_read_register(&req, device_address, reg_address, data, (uint16_t)length);
+    return run(&req);
 }
 
 bool hal_i2c_probe(i2c_id_t i2c_id, uint8_t device_address) {
-    if (i2c_id != I2C_ID_0) return false;
-
-    i2c_status_t status;
-    bool ack_received = false;
-
-    // Send START.
-    status = i2c_start();
-    if (status == I2C_OK) {
-        // Send address + Write bit and check for ACK/NACK.
-        status = i2c_send_address((device_address << 1) | 0);
-        if (status == I2C_OK) {
-            ack_received = true; // Device acknowledged.
-        }
-    }
-    // Always send STOP after probing.
-    i2c_stop();
-
+    // An empty write: START, SLA+W, STOP
+    bool ack_received = (hal_i2c_write(i2c_id, device_address, NULL, 0) == I2C_OK);
     log_debug("I2C: Probe Addr 0x%02X -> %s", device_address, ack_received ? "ACK" : "NACK/Error");
     return ack_received;
 }
 
 void hal_i2c_reset(i2c_id_t i2c_id) {
     if (i2c_id != I2C_ID_0) return;
-    // Attempt to recover the I2C bus if it gets stuck.
     log_warn("I2C: Resetting TWI peripheral");
-    // This might involve disabling/re-enabling the peripheral,
-    // or manually toggling clock/data lines in some cases.
-    // Re-initialize after reset attempt.
-    hal_i2c_init(i2c_id, I2C_CLOCK_SPEED); // Re-run init
+    abort_current();
+}
+
+ISR(TWI_vect) {
+    twi_step();
 }
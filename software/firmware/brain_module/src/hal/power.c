@@ -0,0 +1,154 @@
+/**
+ * @file power.c
+ * @brief Power HAL implementation for ATmega328P.
+ * Provides IDLE sleep between scheduler tasks, power-down sleep for parked
+ * mode, and bookkeeping of how much time the CPU actually spends awake.
+ */
+
+#include "hal/power.h"
+#include "hal/timer.h"
+#include "util/logger.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/power.h>
+
+// --- Configuration ---
+#define POWER_WDT_PERIOD_MS 8000UL // Watchdog wake interval while parked (WDP3|WDP0)
+
+// --- Internal State ---
+static uint32_t stats_start_ms = 0;
+static uint32_t idle_ms = 0;
+static uint16_t idle_us_remainder = 0; // Sub-millisecond idle time carried between sleeps
+static uint32_t deep_ms = 0;
+static uint32_t idle_wakeups = 0;
+static volatile bool wdt_wake = false; // Set by WDT_vect; any other wake is a pin (ISRs in hal/gpio.c)
+
+// --- Helper Functions ---
+
+// Watchdog in interrupt-only mode (no reset), used as the deep-sleep wake timer.
+static void wdt_start_interrupt(void) {
+    __asm__ __volatile__("wdr");
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = _BV(WDIE) | _BV(WDP3) | _BV(WDP0); // ~8 s
+}
+
+static void wdt_stop(void) {
+    __asm__ __volatile__("wdr");
+    MCUSR &= (uint8_t)~_BV(WDRF);
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = 0;
+}
+
+// --- Public API Implementation ---
+
+void hal_power_init(void) {
+    // The Brain Module uses USART0, TWI, ADC and Timer0 only.
+    power_spi_disable();
+    power_timer1_disable();
+    power_timer2_disable();
+    hal_power_reset_stats();
+    log_info("Power: Unused peripherals off (SPI, Timer1, Timer2)");
+}
+
+void hal_power_idle(void) {
+    uint32_t start_us = hal_timer_micros();
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sei();       // The instruction after SEI always executes, so no wake-up is lost
+    sleep_cpu();
+    sleep_disable();
+
+    // Typically under 1 ms (the tick always wakes us), so avoid a 32-bit division.
+    uint32_t slept_us = hal_timer_micros() - start_us + idle_us_remainder;
+    while (slept_us >= 1000) {
+        slept_us -= 1000;
+        idle_ms++;
+    }
+    idle_us_remainder = (uint16_t)slept_us;
+    idle_wakeups++;
+}
+
+power_wake_t hal_power_deep_sleep(void) {
+    cli();
+    uint8_t saved_eicra = EICRA;
+    uint8_t saved_eimsk = EIMSK;
+    uint8_t saved_pcmsk2 = PCMSK2;
+    uint8_t saved_pcicr = PCICR;
+    wdt_wake = false;
+    uint8_t saved_adcsra = ADCSRA;
+    ADCSRA &= (uint8_t)~_BV(ADEN); // Background sampling stops with Timer0 anyway; the enabled ADC still draws current
+
+    // INT0/INT1 can only wake power-down on a low level; the signals are active low.
+    EICRA &= (uint8_t)~(_BV(ISC11) | _BV(ISC10) | _BV(ISC01) | _BV(ISC00));
+    EIFR = _BV(INTF1) | _BV(INTF0);
+    EIMSK |= _BV(INT1) | _BV(INT0);
+    // Speed sensor on PCINT20: any change.
+    PCMSK2 |= _BV(PCINT20);
+    PCIFR = _BV(PCIF2);
+    PCICR |= _BV(PCIE2);
+    wdt_start_interrupt();
+
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+#if defined(BODS)
+    sleep_bod_disable(); // Brown-out detector off while asleep
+#endif
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    cli();
+    wdt_stop();
+    ADCSRA = saved_adcsra;
+    EIMSK = saved_eimsk;
+    EICRA = saved_eicra;
+    PCMSK2 = saved_pcmsk2;
+    PCICR = saved_pcicr;
+    bool woke_by_pin = !wdt_wake;
+    if (!woke_by_pin) {
+        // Timer0 was stopped; account for the full watchdog period.
+        hal_timer_advance_ms(POWER_WDT_PERIOD_MS);
+        deep_ms += POWER_WDT_PERIOD_MS;
+    }
+    sei();
+
+    return woke_by_pin ? POWER_WAKE_PIN : POWER_WAKE_WATCHDOG;
+}
+
+void hal_power_get_stats(power_stats_t *stats) {
+    if (!stats) return;
+    stats->total_ms = hal_timer_millis() - stats_start_ms;
+    stats->idle_ms = idle_ms;
+    stats->deep_ms = deep_ms;
+    stats->wakeups = idle_wakeups;
+
+    uint32_t asleep_ms = idle_ms + deep_ms;
+    if (stats->total_ms == 0) {
+        stats->duty_pct = 100;
+    } else if (asleep_ms >= stats->total_ms) {
+        stats->duty_pct = 0;
+    } else {
+        uint32_t awake_ms = stats->total_ms - asleep_ms;
+        uint32_t one_pct = stats->total_ms / 100; // Avoids a 64-bit multiply on long uptimes
+        uint32_t pct = one_pct ? awake_ms / one_pct : (awake_ms * 100) / stats->total_ms;
+        stats->duty_pct = (pct > 100) ? 100 : (uint8_t)pct;
+    }
+}
+
+void hal_power_reset_stats(void) {
+    stats_start_ms = hal_timer_millis();
+    idle_ms = 0;
+    idle_us_remainder = 0;
+    deep_ms = 0;
+    idle_wakeups = 0;
+}
+
+// --- Interrupt Service Routine ---
+
+// INT0/INT1 and PCINT2 are dispatched by hal/gpio.c; the watchdog is the only
+// power-down wake source handled here.
+ISR(WDT_vect) {
+    wdt_wake = true;
+}
@@ -2,13 +2,19 @@
  * @file uart.c
  * @brief UART HAL implementation for ATmega328P.
  * Handles communication for Hardware USART0 and potentially Software UART instances.
- * Uses ring buffers for transmit/receive buffering, especially with interrupts.
+ * USART0 is fully interrupt driven: the RX-complete ISR fills hw_uart0_rx_rb and
+ * the UDRE ISR drains hw_uart0_tx_rb, so reads and writes never block the main loop.
+ * The rings are SPSC (one ISR, one main-loop side), so no interrupt locking is needed.
  */
 
 #include "hal/uart.h"
-#include "util/ring_buffer.h" // Assumes a ring buffer utility exists
+#include "util/ring_buffer.h"
 #include "util/logger.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h> // For ATOMIC_BLOCK
 #include <stddef.h> // For NULL
+#include <string.h> // For memset
 
 // --- Configuration ---
 // Define buffer sizes (can be overridden by config.h if needed)
@@ -25,6 +31,10 @@
 #define SW_UART1_TX_BUFFER_SIZE 32
 #endif
 
+_Static_assert(RING_BUFFER_SIZE_VALID(HW_UART0_RX_BUFFER_SIZE) && RING_BUFFER_SIZE_VALID(HW_UART0_TX_BUFFER_SIZE) &&
+               RING_BUFFER_SIZE_VALID(SW_UART1_RX_BUFFER_SIZE) && RING_BUFFER_SIZE_VALID(SW_UART1_TX_BUFFER_SIZE),
+               "UART buffer sizes must be powers of two (2..256)");
+
 // --- Internal Data Structures ---
 
 // Buffers and state for Hardware UART0
@@ -32,16 +42,22 @@ static uint8_t hw_uart0_rx_buf_data[HW_UART0_RX_BUFFER_SIZE];
 static ring_buffer_t hw_uart0_rx_rb;
 static uint8_t hw_uart0_tx_buf_data[HW_UART0_TX_BUFFER_SIZE];
 static ring_buffer_t hw_uart0_tx_rb;
-static uart_rx_callback_t hw_uart0_rx_callback = NULL;
+static volatile uart_rx_callback_t hw_uart0_rx_callback = NULL;
+static volatile uart_tx_empty_callback_t hw_uart0_tx_empty_callback = NULL;
+static volatile bool hw_uart0_tx_active = false; // Set while bytes are queued or shifting out
+static volatile uart_stats_t hw_uart0_stats;
 
 // Buffers and state for Software UART1 (Example)
 // A real Software UART implementation (like Arduino's SoftwareSerial) would be needed here.
-// These are just placeholders for the HAL structure.
+// These are just placeholders for the HAL structure; bytes queued for
+// transmission stay in sw_uart1_tx_rb until a bit engine drains them.
 static uint8_t sw_uart1_rx_buf_data[SW_UART1_RX_BUFFER_SIZE];
 static ring_buffer_t sw_uart1_rx_rb;
 static uint8_t sw_uart1_tx_buf_data[SW_UART1_TX_BUFFER_SIZE];
 static ring_buffer_t sw_uart1_tx_rb;
 static uart_rx_callback_t sw_uart1_rx_callback = NULL;
+static uart_tx_empty_callback_t sw_uart1_tx_empty_callback = NULL;
+static volatile uart_stats_t sw_uart1_stats;
 
 
 // --- Helper Functions ---
@@ -59,50 +75,144 @@ static ring_buffer_t* get_tx_rb(uart_id_t uart_id) {
     return NULL;
 }
 
+static volatile uart_stats_t* get_stats(uart_id_t uart_id) {
+    if (uart_id == UART_ID_0) return &hw_uart0_stats;
+    if (uart_id == UART_ID_1) return &sw_uart1_stats;
+    return NULL;
+}
+
+// Program USART0 for the requested baud rate and frame format (double-speed mode).
+static void hw_uart0_set_ubrr(uint32_t baud_rate) {
+    uint16_t ubrr = (uint16_t)((F_CPU + 4UL * baud_rate) / (8UL * baud_rate) - 1); // Rounded, U2X0 = 1
+    UBRR0H = (uint8_t)(ubrr >> 8);
+    UBRR0L = (uint8_t)ubrr;
+}
+
+static void hw_uart0_configure(uint32_t baud_rate, uint8_t data_bits, uint8_t stop_bits, uint8_t parity) {
+    hw_uart0_set_ubrr(baud_rate);
+    UCSR0A = _BV(U2X0);
+
+    uint8_t ucsrc = 0;
+    switch (data_bits) {
+        case 5:  break;
+        case 6:  ucsrc |= _BV(UCSZ00); break;
+        case 7:  ucsrc |= _BV(UCSZ01); break;
+        default: ucsrc |= _BV(UCSZ01) | _BV(UCSZ00); break; // 8 data bits
+    }
+    if (stop_bits == 2) ucsrc |= _BV(USBS0);
+    if (parity == 1) ucsrc |= _BV(UPM01);                     // Even
+    else if (parity == 2) ucsrc |= _BV(UPM01) | _BV(UPM00);   // Odd
+    UCSR0C = ucsrc;
+
+    // RX and TX-complete interrupts always on (TXC fires once per burst, not per byte);
+    // UDRE is enabled on demand when data is queued.
+    UCSR0B = _BV(RXEN0) | _BV(TXEN0) | _BV(RXCIE0) | _BV(TXCIE0);
+}
+
+// Start the UDRE interrupt so queued bytes begin draining.
+static inline void hw_uart0_kick_tx(void) {
+    hw_uart0_tx_active = true;
+    UCSR0B |= _BV(UDRIE0);
+}
+
 // --- Public API Implementation ---
 
 void hal_uart_init(uart_id_t uart_id, uint32_t baud_rate, uint8_t data_bits, uint8_t stop_bits, uint8_t parity) {
-    log_info("UART: Init ID %d, Baud %lu", uart_id, baud_rate);
-
     if (uart_id == UART_ID_0) {
-        // Initialize ring buffers
-        ring_buffer_init(&hw_uart0_rx_rb, hw_uart0_rx_buf_data, HW_UART0_RX_BUFFER_SIZE);
-        ring_buffer_init(&hw_uart0_tx_rb, hw_uart0_tx_buf_data, HW_UART0_TX_BUFFER_SIZE);
-        hw_uart0_rx_callback = NULL;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            // Initialize ring buffers
+            ring_buffer_init(&hw_uart0_rx_rb, hw_uart0_rx_buf_data, HW_UART0_RX_BUFFER_SIZE);
+            ring_buffer_init(&hw_uart0_tx_rb, hw_uart0_tx_buf_data, HW_UART0_TX_BUFFER_SIZE);
+            hw_uart0_rx_callback = NULL;
+            hw_uart0_tx_empty_callback = NULL;
+            hw_uart0_tx_active = false;
+            memset((void *)&hw_uart0_stats, 0, sizeof(hw_uart0_stats));
 
-        // Configure hardware UART0 registers for baud rate, frame format,
-        // and enable transmitter/receiver.
+            // Configure hardware UART0 registers for baud rate, frame format,
+            // and enable transmitter/receiver.
+            hw_uart0_configure(baud_rate, data_bits, stop_bits, parity);
+        }
 
     } else if (uart_id == UART_ID_1) {
         // Initialize ring buffers for software UART
         ring_buffer_init(&sw_uart1_rx_rb, sw_uart1_rx_buf_data, SW_UART1_RX_BUFFER_SIZE);
         ring_buffer_init(&sw_uart1_tx_rb, sw_uart1_tx_buf_data, SW_UART1_TX_BUFFER_SIZE);
         sw_uart1_rx_callback = NULL;
+        sw_uart1_tx_empty_callback = NULL;
+        memset((void *)&sw_uart1_stats, 0, sizeof(sw_uart1_stats));
 
         // Configure GPIO pins and timers required for software UART operation.
-        log_info("UART: Software UART ID %d init (simulated)", uart_id);
 
     } else {
         log_error("UART: Invalid ID %d for init", uart_id);
+        return;
     }
+    log_info("UART: Init ID %d, Baud %lu", uart_id, baud_rate);
+}
+
+void hal_uart_set_baud(uart_id_t uart_id, uint32_t baud_rate) {
+    if (uart_id != UART_ID_0) {
+        return; // Software UART timing is fixed at init
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        hw_uart0_set_ubrr(baud_rate);
+    }
+    log_info("UART: ID %d now at %lu baud", uart_id, baud_rate);
 }
 
 void hal_uart_put_char(uart_id_t uart_id, uint8_t data) {
-    // Send a single byte over the specified UART interface (blocking).
+    ring_buffer_t *rb = get_tx_rb(uart_id);
+    if (!rb) return;
+
+    if (uart_id == UART_ID_0 && !(SREG & _BV(SREG_I))) {
+        // Interrupts are off (early boot or ISR context): the UDRE ISR cannot
+        // drain the ring, so write straight to the hardware.
+        loop_until_bit_is_set(UCSR0A, UDRE0);
+        UDR0 = data;
+        return;
+    }
+
+    // Wait for room in the transmit ring, then queue the byte.
+    while (!ring_buffer_write(rb, data)) {
+        if (uart_id == UART_ID_0) hw_uart0_kick_tx(); // Make sure the ring is draining
+    }
     if (uart_id == UART_ID_0) {
-        // Hardware UART: Wait for transmit buffer empty, then write data.
-    } else if (uart_id == UART_ID_1) {
-        // Software UART: Perform timed bit-banging to transmit the byte.
+        hw_uart0_kick_tx();
+    }
+    // Software UART: the byte waits in sw_uart1_tx_rb for the bit engine.
+}
+
+size_t hal_uart_write(uart_id_t uart_id, const uint8_t *buffer, size_t length) {
+    ring_buffer_t *rb = get_tx_rb(uart_id);
+    if (!rb || !buffer || length == 0) return 0;
+
+    rb_size_t queued = ring_buffer_write_multi(rb, buffer, (rb_size_t)length);
+    if (queued > 0 && uart_id == UART_ID_0) {
+        hw_uart0_kick_tx();
+    }
+    return queued; // Truncation is reported to the caller, not counted
+}
+
+size_t hal_uart_tx_space(uart_id_t uart_id) {
+    ring_buffer_t *rb = get_tx_rb(uart_id);
+    return rb ? ring_buffer_space_remaining(rb) : 0;
+}
+
+bool hal_uart_tx_idle(uart_id_t uart_id) {
+    ring_buffer_t *rb = get_tx_rb(uart_id);
+    if (!rb) return true;
+
+    if (uart_id == UART_ID_0) {
+        return !hw_uart0_tx_active;
     }
-    // If using transmit interrupts/buffers, this would add to the buffer
-    // and potentially enable the transmit interrupt.
-    log_debug("UART: Put Char ID %d: 0x%02X", uart_id, data);
+    return ring_buffer_is_empty(rb);
 }
 
-void hal_uart_write(uart_id_t uart_id, const uint8_t *buffer, size_t length) {
-    // Send multiple bytes by calling put_char repeatedly.
-    for (size_t i = 0; i < length; ++i) {
-        hal_uart_put_char(uart_id, buffer[i]); // Send byte by byte (blocking)
+void hal_uart_set_tx_empty_callback(uart_id_t uart_id, uart_tx_empty_callback_t callback) {
+    if (uart_id == UART_ID_0) {
+        hw_uart0_tx_empty_callback = callback;
+    } else if (uart_id == UART_ID_1) {
+        sw_uart1_tx_empty_callback = callback;
     }
 }
 
@@ -114,58 +224,58 @@ int16_t hal_uart_get_char(uart_id_t uart_id) {
         // --- Buffered Read ---
         if (ring_buffer_read(rb, &data)) {
             return data; // Return data read from buffer
-        } else {
-            // If buffer is empty, optionally perform a blocking read.
-            // This is less common if using interrupts or polling data_available.
-            // if (uart_id == UART_ID_0) { /* Wait for hardware RX flag and read */ }
-            // else if (uart_id == UART_ID_1) { /* Wait for software UART reception */ }
-            return -1; // Indicate no data currently available
         }
+        return -1; // Indicate no data currently available
     }
     return -1; // Invalid UART ID
 }
 
 bool hal_uart_data_available(uart_id_t uart_id) {
-    ring_buffer_t* rb = get_rx_rb(uart_id);
     // Check if the receive ring buffer for the specified UART has data.
     ring_buffer_t* rb = get_rx_rb(uart_id);
     if (rb) {
         return !ring_buffer_is_empty(rb);
     }
-    // Alternatively, could check hardware status flags directly if not using buffers.
     return false;
 }
 
 size_t hal_uart_read(uart_id_t uart_id, uint8_t *buffer, size_t length) {
     ring_buffer_t* rb = get_rx_rb(uart_id);
-    size_t bytes_read = 0;
-    if (rb) {
-        while (bytes_read < length && ring_buffer_read(rb, &buffer[bytes_read])) {
-            bytes_read++;
-        }
+    rb_size_t bytes_read = 0;
+    if (rb && buffer) {
+        bytes_read = ring_buffer_read_multi(rb, buffer, (rb_size_t)length);
     }
     return bytes_read;
 }
 
+size_t hal_uart_rx_span(uart_id_t uart_id, const uint8_t **data) {
+    ring_buffer_t* rb = get_rx_rb(uart_id);
+    if (!rb || !data) return 0;
+    return ring_buffer_read_span(rb, data);
+}
+
+void hal_uart_rx_consume(uart_id_t uart_id, size_t length) {
+    ring_buffer_t* rb = get_rx_rb(uart_id);
+    if (rb) {
+        ring_buffer_read_commit(rb, (rb_size_t)length);
+    }
+}
+
 void hal_uart_enable_rx_interrupt(uart_id_t uart_id, uart_rx_callback_t callback) {
-    // Enable the receive interrupt for the specified UART and register the callback.
+    // Register the per-byte callback; the RX interrupt itself stays enabled.
     log_debug("UART: Enable RX Int ID %d", uart_id);
     if (uart_id == UART_ID_0) {
         hw_uart0_rx_callback = callback;
-        // Configure hardware registers to enable RX interrupt.
     } else if (uart_id == UART_ID_1) {
         sw_uart1_rx_callback = callback;
         // Configure pin change interrupts or timers for software UART RX.
     }
-    // Ensure global interrupts are enabled elsewhere (e.g., sei()).
 }
 
 void hal_uart_disable_rx_interrupt(uart_id_t uart_id) {
-    // Disable the receive interrupt for the specified UART.
     log_debug("UART: Disable RX Int ID %d", uart_id);
     if (uart_id == UART_ID_0) {
         hw_uart0_rx_callback = NULL;
-        // Configure hardware registers to disable RX interrupt.
     } else if (uart_id == UART_ID_1) {
         sw_uart1_rx_callback = NULL;
         // Disable pin change interrupts or timers for software UART RX.
@@ -178,12 +288,73 @@ void hal_uart_flush_rx_buffer(uart_id_t uart_id) {
     if (rb) {
         ring_buffer_clear(rb);
     }
-    // May also need to clear hardware flags or read dummy data from the
-    // hardware data register to ensure the interrupt flag is cleared.
 }
 
-// Interrupt Service Routines (ISRs) for UART RX/TX would typically reside here.
-// They would read/write data from/to the hardware and interact with the
-// ring buffers and callbacks. Example:
-// ISR(USART_RX_vect) { /* Read UDR0 -> write to hw_uart0_rx_rb -> call hw_uart0_rx_callback */ }
-// ISR(USART_UDRE_vect) { /* Read from hw_uart0_tx_rb -> write to UDR0 -> disable UDRIE if buffer empty */ }
+void hal_uart_get_stats(uart_id_t uart_id, uart_stats_t *stats) {
+    volatile uart_stats_t *src = get_stats(uart_id);
+    if (!src || !stats) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stats->overrun_errors = src->overrun_errors;
+        stats->framing_errors = src->framing_errors;
+        stats->parity_errors = src->parity_errors;
+        stats->rx_dropped = src->rx_dropped;
+    }
+}
+
+void hal_uart_clear_stats(uart_id_t uart_id) {
+    volatile uart_stats_t *src = get_stats(uart_id);
+    if (!src) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        src->overrun_errors = 0;
+        src->framing_errors = 0;
+        src->parity_errors = 0;
+        src->rx_dropped = 0;
+    }
+}
+
+// --- Interrupt Service Routines (USART0) ---
+
+// RX complete: read status before data (reading UDR0 clears the error flags).
+ISR(USART_RX_vect) {
+    uint8_t status = UCSR0A;
+    uint8_t data = UDR0;
+
+    if (status & _BV(DOR0)) hw_uart0_stats.overrun_errors++;
+    if (status & _BV(FE0)) {
+        hw_uart0_stats.framing_errors++;
+        return; // Corrupt byte, do not deliver
+    }
+    if (status & _BV(UPE0)) {
+        hw_uart0_stats.parity_errors++;
+        return;
+    }
+
+    if (!ring_buffer_write(&hw_uart0_rx_rb, data)) {
+        hw_uart0_stats.rx_dropped++;
+    }
+    uart_rx_callback_t cb = hw_uart0_rx_callback;
+    if (cb) {
+        cb(UART_ID_0, data);
+    }
+}
+
+// Data register empty: feed the next queued byte, or stop when the ring is drained.
+ISR(USART_UDRE_vect) {
+    uint8_t data;
+    if (ring_buffer_read(&hw_uart0_tx_rb, &data)) {
+        UDR0 = data;
+    } else {
+        UCSR0B &= (uint8_t)~_BV(UDRIE0);
+    }
+}
+
+// TX complete: the shift register ran dry, which only happens at the end of a burst.
+ISR(USART_TX_vect) {
+    if (ring_buffer_is_empty(&hw_uart0_tx_rb)) {
+        hw_uart0_tx_active = false;
+        uart_tx_empty_callback_t cb = hw_uart0_tx_empty_callback;
+        if (cb) {
+            cb(UART_ID_0);
+        }
+    }
+}
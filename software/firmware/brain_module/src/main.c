@@ -8,12 +8,14 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <util/delay.h> // For basic delays if needed
+#include <avr/interrupt.h> // For sei()
 
 // Include HAL headers
 #include "hal/gpio.h"
 #include "hal/uart.h"
 #include "hal/i2c.h"
-// #include "hal/timer.h" // Include if a timer HAL is used
+#include "hal/timer.h"
+#include "hal/power.h"
 
 // Include Module headers
 #include "modules/gps.h"
@@ -21,23 +23,54 @@
 #include "modules/battery.h"
 #include "modules/nav_logic.h"
 #include "modules/signal.h"
+#include "modules/speed.h"
+#include "modules/imu.h"
+#include "modules/status_publisher.h"
+#include "modules/link_quality.h"
+#include "modules/route_store.h"
+#include "modules/ride_trace.h"
+#include "modules/ota_relay.h"
+#include "modules/settings.h"
+#include "ble_protocol.h" // For BLE_MSG_STATS_REQUEST, BLE_MSG_TRACE_CONTROL, BLE_MSG_LINK_ACK
 
 // Include Utilities
 #include "util/logger.h"
 #include "util/ring_buffer.h" // May be used internally by HAL/modules
+#include "util/scheduler.h"
+#include "util/fixed.h"
+#include "util/perf.h"
+#include "util/persist.h"
 #include "config.h"          // System configuration constants
 
 // --- Private Function Prototypes ---
 static void hardware_init(void);
 static void modules_init(void);
+static void tasks_init(void);
 static void main_loop(void);
 static void process_communication(void);
-static void process_sensors(void);
 static void run_logic_updates(void);
+static void sample_battery(void);
+static void process_imu(void);
+static void publish_status(void);
+static void check_parked(void);
+static void enter_parked_mode(void);
+static void log_power_stats(void);
+static void gps_rx_notify(uart_id_t uart_id, uint8_t data);
+static void signal_edge_notify(void);
+static void handle_phone_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length);
+static void start_stats_report(bool reset_after);
+static void handle_trace_control(const uint8_t *payload, uint8_t length);
+static uint16_t current_speed_kmh_x10(void);
+static void follow_settings(void);
 
 // --- Global Variables / State (Use Sparingly) ---
-// Example: System tick or flags for periodic tasks
-volatile uint32_t system_ticks_ms = 0; // Assume updated by a timer ISR
+static task_id_t comm_task = SCHEDULER_INVALID_TASK; // Signaled from the GPS RX interrupt
+static task_id_t nav_task = SCHEDULER_INVALID_TASK;  // Signaled on every new GPS fix
+static task_id_t status_task = SCHEDULER_INVALID_TASK; // Signaled on every turn signal edge
+static task_id_t battery_task = SCHEDULER_INVALID_TASK; // Period follows the status_battery_ms setting
+static uint8_t settings_revision = 0; // Settings revision the task periods were taken from
+static uint32_t last_activity_ms = 0; // Last time the bike moved, a signal was on or an update ran
+static bool parked = false;           // Set by check_parked(), handled by main_loop()
 
 /**
  * @brief Main function - entry point of the application.
@@ -64,26 +97,28 @@ int main(void) {
  * @brief Initializes core hardware peripherals using the HAL.
  */
 static void hardware_init(void) {
-    // Initialize GPIO pins for signals, sensors, etc.
-    // Pins are defined in config.h
-    hal_gpio_init(LEFT_SIGNAL_PIN, GPIO_MODE_INPUT_PULLUP);
-    hal_gpio_init(RIGHT_SIGNAL_PIN, GPIO_MODE_INPUT_PULLUP);
-    hal_gpio_init(SPEED_SENSOR_PIN, GPIO_MODE_INPUT_PULLUP); // Assuming pullup needed
-    // Battery sense pin init is handled by battery_monitor_init -> hal_gpio_init
+    // Signal and speed sensor pins and their edge interrupts are set up by
+    // signal_detector_init() and speed_sensor_init().
+    // Battery sense pin and ADC sampling are set up by battery_monitor_init()
 
     // Initialize UART interfaces (GPS, BLE/Log)
     // Note: UART init for GPS/BLE is handled within their respective module inits.
     // Logger init handles its own UART.
 
-    // Initialize I2C interface (if used by any sensors directly)
+    // Initialize I2C interface (IMU)
     hal_i2c_init(MAIN_I2C_ID, I2C_CLOCK_SPEED);
 
-    // Initialize Timers (if used for periodic tasks, debouncing, etc.)
-    // hal_timer_init(...);
-    // hal_timer_start(...);
+    // Start the 1 ms system tick used by the scheduler and all timeouts
+    hal_timer_init();
 
-    // Enable global interrupts if required by HAL components (e.g., UART RX, Timers)
-    // sei(); // Needs <avr/interrupt.h>
+    // Gate clocks to unused peripherals and start duty-cycle accounting
+    hal_power_init();
+
+    // Free-running Timer1 for section timing (bench builds only, see util/perf.h)
+    perf_init();
+
+    // Enable global interrupts: the UART HAL is interrupt driven
+    sei();
 
     log_debug("Hardware initialization complete.");
 }
@@ -94,57 +129,169 @@ static void hardware_init(void) {
 static void modules_init(void) {
     // Logger needs to be initialized first if other modules log during init.
     logger_init();
+    settings_init(); // Before the modules that read calibration from it
 
     // Initialize remaining modules
     battery_monitor_init();
     gps_init();
     ble_uart_init();
     signal_detector_init();
+    speed_sensor_init();
+    imu_init(); // Probes the I2C bus; stays inactive without an IMU
+    ride_trace_init(); // Probes for the external memory (ENABLE_RIDE_TRACE)
+    route_store_init();
+    ble_uart_set_frame_handler(handle_phone_frame); // Route loads, settings, STATS and TRACE requests, display ACKs and resyncs
     nav_logic_init();
+    link_quality_init();
+    status_publisher_init();
+    status_publisher_set_battery(battery_monitor_get_voltage_mv()); // Seed the first keyframe
+
+    tasks_init();
 
     log_debug("Application modules initialization complete.");
 }
 
+/**
+ * @brief Registers the periodic and event-driven work with the scheduler.
+ * Priorities decide the order when several tasks are due in the same pass.
+ */
+static void tasks_init(void) {
+    scheduler_init();
+    comm_task = scheduler_add_task("comm", process_communication, COMM_POLL_INTERVAL_MS, TASK_PRIORITY_HIGH);
+    status_task = scheduler_add_task("status", publish_status, STATUS_PUBLISH_INTERVAL_MS, TASK_PRIORITY_NORMAL);
+    nav_task = scheduler_add_task("nav", run_logic_updates, NAV_UPDATE_INTERVAL_MS, TASK_PRIORITY_LOW);
+    if (imu_is_present()) {
+        scheduler_add_task("imu", process_imu, IMU_POLL_INTERVAL_MS, TASK_PRIORITY_NORMAL);
+    }
+    battery_task = scheduler_add_task("battery", sample_battery, settings_get()->status_battery_ms, TASK_PRIORITY_IDLE);
+    settings_revision = settings_get_revision();
+    scheduler_add_task("power", check_parked, POWER_CHECK_INTERVAL_MS, TASK_PRIORITY_IDLE);
+    scheduler_add_task("pstats", log_power_stats, POWER_STATS_INTERVAL_MS, TASK_PRIORITY_IDLE);
+    last_activity_ms = hal_timer_millis();
+
+    // Drain GPS bytes as soon as they arrive rather than waiting for the next poll.
+    hal_uart_enable_rx_interrupt(GPS_UART_ID, gps_rx_notify);
+    // Send turn signal changes straight away; no task polls the signal pins.
+    signal_detector_set_edge_handler(signal_edge_notify);
+}
+
 /**
  * @brief Main application super-loop.
- * Continuously processes inputs, runs logic, and generates outputs.
+ * All work runs as scheduler tasks; the loop dispatches whatever is due and
+ * sleeps whenever nothing is.
  */
 static void main_loop(void) {
-    uint32_t last_status_update_ms = 0;
-    uint32_t last_nav_update_ms = 0;
-
     while (1) {
-        // Update system time (crude simulation if no timer ISR)
-        // system_ticks_ms++;
-        // _delay_ms(1); // Very basic delay if no timer
-
-        // 1. Process Communication Interfaces (UARTs, I2C)
-        process_communication();
-
-        // 2. Process Sensor Inputs (GPIOs, ADC)
-        process_sensors();
-
-        // 3. Run Core Logic Updates (Navigation, State Machines)
-        // Run periodically based on system time or flags set by ISRs/polling.
-        uint32_t now = system_ticks_ms; // Use actual timer value if available
-        if (now - last_nav_update_ms >= NAV_UPDATE_INTERVAL_MS) {
-             run_logic_updates();
-             last_nav_update_ms = now;
+        PERF_COUNT(MAIN_LOOP);
+        if (scheduler_run_once()) {
+            continue; // Keep draining due tasks before considering sleep
+        }
+        if (logger_service() || perf_report_service()) {
+            continue; // Queued log records and STATS replies go out only when no task is due
         }
 
-        // 4. Send Periodic Status Updates via BLE
-        if (now - last_status_update_ms >= BLE_STATUS_UPDATE_INTERVAL_MS) {
-            if (ble_uart_is_connected()) {
-                 uint16_t batt_mv = battery_monitor_get_voltage_mv();
-                 signal_state_t sig_state = signal_detector_get_state();
-                 float speed = gps_get_speed_kmh(); // Use latest speed from GPS/NavLogic
-                 ble_uart_send_status_update(batt_mv, sig_state, (uint8_t)speed);
-            }
-             last_status_update_ms = now;
+        if (parked) {
+            enter_parked_mode();
+            continue;
         }
 
-        // 5. Optional: Enter low-power sleep mode if idle.
-        // sleep_cpu();
+        // Nothing due: IDLE until the next interrupt (1 ms tick, UART RX, pin change).
+        // Re-check with interrupts off so an ISR signaling a task cannot slip in before sleeping.
+        cli();
+        if (scheduler_ms_until_next() > 0) {
+            hal_power_idle(); // Returns with interrupts enabled
+        } else {
+            sei();
+        }
+    }
+}
+
+// GPS RX interrupt hook: wake the communication task.
+static void gps_rx_notify(uart_id_t uart_id, uint8_t data) {
+    (void)uart_id;
+    (void)data;
+    scheduler_signal(comm_task);
+}
+
+// Turn signal edge hook (ISR context): publish the new state now.
+static void signal_edge_notify(void) {
+    scheduler_signal(status_task);
+}
+
+// Frames from the link: updates are relayed, settings, display ACKs, STATS and TRACE requests handled here, the rest load routes.
+static void handle_phone_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length) {
+    if (ota_relay_handle_frame(msg_id, payload, length, hal_timer_millis())) {
+        return; // Display firmware update, phone <-> bootloader
+    }
+    if (settings_handle_frame(msg_id, payload, length, hal_timer_millis())) {
+        return; // Settings, or a display setting relayed either way
+    }
+    if (msg_id == BLE_MSG_LINK_ACK) {
+        link_quality_on_ack(payload, length, hal_timer_millis());
+        return;
+    }
+    if (msg_id == BLE_MSG_KEYFRAME_REQUEST) {
+        status_publisher_request_keyframe(); // Display resyncing: answer now, not at the next keyframe
+        scheduler_signal(status_task);
+        return;
+    }
+    if (msg_id == BLE_MSG_STATS_REQUEST) {
+        start_stats_report(length > 0 && (payload[0] & BLE_STATS_FLAG_RESET));
+        return;
+    }
+    if (msg_id == BLE_MSG_TRACE_CONTROL) {
+        handle_trace_control(payload, length);
+        return;
+    }
+    route_store_handle_frame(msg_id, payload, length);
+}
+
+/**
+ * @brief Snapshots the error counts kept by the drivers and queues a STATS report.
+ */
+static void start_stats_report(bool reset_after) {
+#if ENABLE_PERF_COUNTERS
+    uart_stats_t uart;
+    hal_uart_get_stats(GPS_UART_ID, &uart);
+    perf_counter_set(PERF_COUNTER_GPS_OVERRUN, (uint32_t)uart.overrun_errors + uart.rx_dropped);
+    hal_uart_get_stats(BLE_UART_ID, &uart);
+    perf_counter_set(PERF_COUNTER_BLE_OVERRUN, (uint32_t)uart.overrun_errors + uart.rx_dropped);
+
+    uint16_t crc_errors, framing_errors;
+    ble_uart_get_parser_errors(&crc_errors, &framing_errors);
+    perf_counter_set(PERF_COUNTER_BLE_CRC, crc_errors);
+    perf_counter_set(PERF_COUNTER_BLE_FRAMING, framing_errors);
+    perf_counter_set(PERF_COUNTER_TRACE_DROP, ride_trace_get_dropped());
+
+    link_quality_stats_t link;
+    link_quality_get_stats(&link);
+    perf_counter_set(PERF_COUNTER_LINK_SENT, link.frames_sent);
+    perf_counter_set(PERF_COUNTER_LINK_LOST, link.frames_lost);
+    perf_counter_set(PERF_COUNTER_LINK_RETX, link.retransmits);
+    perf_counter_set(PERF_COUNTER_LINK_RTT, link.rtt_ms);
+#endif
+    perf_report_start(reset_after);
+}
+
+/**
+ * @brief Starts or stops a ride trace capture or playback (see ride_trace.h).
+ */
+static void handle_trace_control(const uint8_t *payload, uint8_t length) {
+    if (length < 1) {
+        return;
+    }
+    switch (payload[0]) {
+        case BLE_TRACE_STOP:
+            ride_trace_stop();
+            break;
+        case BLE_TRACE_CAPTURE:
+            ride_trace_start_capture();
+            break;
+        case BLE_TRACE_PLAY:
+            ride_trace_start_playback((length >= BLE_TRACE_CONTROL_LEN) ? payload[1] : 1);
+            break;
+        default:
+            break;
     }
 }
 
@@ -152,39 +299,46 @@ static void main_loop(void) {
  * @brief Handles processing of incoming data from communication interfaces.
  */
 static void process_communication(void) {
-    // Poll GPS UART for incoming NMEA characters
-    while (hal_uart_data_available(GPS_UART_ID)) {
-        int16_t data = hal_uart_get_char(GPS_UART_ID);
-        if (data != -1) {
-            gps_process_char((uint8_t)data);
+    const uint8_t *data;
+    size_t len;
+
+    // Feed GPS NMEA/UBX bytes straight out of the RX ring (no copy).
+    // During a ride trace playback the receiver is ignored and the trace feeds the parser.
+    bool live_gps = ride_trace_get_mode() != RIDE_TRACE_PLAYBACK;
+    while ((len = hal_uart_rx_span(GPS_UART_ID, &data)) > 0) {
+        ride_trace_record_gps(data, len);
+        for (size_t i = 0; live_gps && i < len; ++i) {
+            gps_process_char(data[i]);
         }
+        hal_uart_rx_consume(GPS_UART_ID, len);
+    }
+    ride_trace_poll(); // Writes out the capture, or plays the records that are due
+    gps_poll(); // Finishes UBX negotiation / NMEA fallback
+    if (gps_is_data_available()) {
+        scheduler_signal(nav_task); // Guidance follows the GPS fix rate
     }
 
     // Poll BLE UART for incoming commands or responses
-    while (hal_uart_data_available(BLE_UART_ID)) {
-         int16_t data = hal_uart_get_char(BLE_UART_ID);
-        if (data != -1) {
-            ble_uart_process_char((uint8_t)data);
+    while ((len = hal_uart_rx_span(BLE_UART_ID, &data)) > 0) {
+        for (size_t i = 0; i < len; ++i) {
+            ble_uart_process_char(data[i]);
             // Also pass to logger if echoing input is desired
-            // log_char((char)data);
+            // log_char((char)data[i]);
         }
+        hal_uart_rx_consume(BLE_UART_ID, len);
     }
-
-    // Handle I2C communication if needed (e.g., polling sensors)
+    route_store_poll(); // Writes received route points to EEPROM
+    settings_poll(hal_timer_millis()); // Queues changed settings for saving
+    follow_settings();
+    persist_poll(); // Writes settings and the cached GPS fix to EEPROM
+    hal_i2c_service(MAIN_I2C_ID); // IMU and trace transfers run from the TWI interrupt; times out stuck ones
 }
 
 /**
- * @brief Handles reading and processing of sensor inputs.
+ * @brief Returns the wheel speed if the sensor is fitted and working, else the GPS speed.
  */
-static void process_sensors(void) {
-    // Update turn signal detection logic (reads GPIOs, debounces)
-    signal_detector_update();
-
-    // Read battery voltage (reads ADC) - reading might happen within get_voltage_mv
-    // battery_monitor_get_voltage_mv(); // Called periodically in main loop for status update
-
-    // Read speed sensor (if separate from GPS, e.g., Hall effect)
-    // speed_sensor_update(); // Would read GPIO/timer/interrupts
+static uint16_t current_speed_kmh_x10(void) {
+    return speed_sensor_is_present() ? speed_sensor_get_speed_kmh_x10() : gps_get_speed_kmh_x10();
 }
 
 /**
@@ -200,10 +354,99 @@ static void run_logic_updates(void) {
             nav_logic_set_gps_data(NULL); // Indicate invalid fix
         }
     }
-    // Pass other relevant sensor data to nav logic if needed
-    // nav_logic_set_speed(...); // Speed might be set directly from GPS data
+    // Speed drives the dead reckoning between fixes
+    nav_logic_set_speed(current_speed_kmh_x10());
     nav_logic_set_signal_state(signal_detector_get_state());
 
     // Trigger navigation logic calculation/update
-    nav_logic_update(); // This function now also sends the BLE nav update
+    nav_logic_update(); // Publishes the nav state through the status publisher
+}
+
+/**
+ * @brief Drains the IMU FIFO and hands the heading rate to the dead reckoning
+ * and the lean to the wheel speed correction.
+ */
+static void process_imu(void) {
+    imu_poll(current_speed_kmh_x10());
+    nav_logic_set_heading_rate(imu_get_heading_rate_cdps());
+    speed_sensor_set_lean_cdeg(imu_get_lean_cdeg());
+}
+
+/**
+ * @brief Reschedules the tasks whose period is a setting, once it has changed.
+ */
+static void follow_settings(void) {
+    uint8_t revision = settings_get_revision();
+    if (revision == settings_revision) return;
+    settings_revision = revision;
+    scheduler_set_period(battery_task, settings_get()->status_battery_ms);
+}
+
+/**
+ * @brief Passes the latest filtered battery voltage to the status publisher.
+ */
+static void sample_battery(void) {
+    status_publisher_set_battery(battery_monitor_get_voltage_mv());
+}
+
+/**
+ * @brief Tracks rider activity and flags parked mode after PARKED_TIMEOUT_MS of inactivity.
+ */
+static void check_parked(void) {
+    uint32_t now = hal_timer_millis();
+    if (current_speed_kmh_x10() >= PARKED_SPEED_KMH * 10 || signal_detector_get_state() != SIGNAL_STATE_OFF ||
+        ota_relay_is_active(now)) {
+        last_activity_ms = now;
+    }
+#if ENABLE_PARKED_SLEEP
+    if (now - last_activity_ms >= PARKED_TIMEOUT_MS) {
+        parked = true;
+    }
+#endif
+}
+
+/**
+ * @brief Powers down until a turn signal or the speed sensor shows activity.
+ * Watchdog wakes only keep the tick roughly in step; the MCU goes straight back down.
+ */
+static void enter_parked_mode(void) {
+    log_info("Power: Parked, entering power-down");
+    logger_flush();
+    uint32_t start = hal_timer_millis();
+    while ((!hal_uart_tx_idle(BLE_UART_ID) || hal_i2c_is_busy(MAIN_I2C_ID)) && hal_timer_millis() - start < 20) {
+        // Give the last log line a moment to leave the UART, and I2C transfers to finish
+    }
+
+    while (hal_power_deep_sleep() == POWER_WAKE_WATCHDOG) {
+        // Still parked
+    }
+
+    parked = false;
+    last_activity_ms = hal_timer_millis();
+    hal_uart_flush_rx_buffer(GPS_UART_ID);   // Drop any sentence cut short by the sleep
+    status_publisher_request_keyframe();     // Resync the display after the gap
+    log_info("Power: Activity detected, resuming");
+}
+
+/**
+ * @brief Logs the awake share of CPU time since the last report.
+ */
+static void log_power_stats(void) {
+    power_stats_t stats;
+    hal_power_get_stats(&stats);
+    log_info("Power: awake %u%%, idle %lu ms, parked %lu ms, %lu wakeups in %lu ms",
+             stats.duty_pct, stats.idle_ms, stats.deep_ms, stats.wakeups, stats.total_ms);
+    hal_power_reset_stats();
+}
+
+/**
+ * @brief Publishes status via BLE; only changed fields are sent, each at its own rate.
+ */
+static void publish_status(void) {
+    if (ota_relay_is_active(hal_timer_millis())) {
+        return; // The display is in its bootloader; the link belongs to the update
+    }
+    status_publisher_set_signal(signal_detector_get_state());
+    status_publisher_set_speed(fixed_sat_u8(current_speed_kmh_x10() / 10)); // Wheel speed between GPS fixes
+    status_publisher_update(hal_timer_millis());
 }
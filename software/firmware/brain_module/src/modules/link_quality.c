@@ -0,0 +1,202 @@
+/**
+ * @file link_quality.c
+ * @brief Sequence numbers, ACK bookkeeping and link statistics for the
+ * BLE link to the Display Module (see link_quality.h).
+ */
+
+#include "modules/link_quality.h"
+#include "ble_protocol.h" // For BLE_SEQ_*, BLE_LINK_ACK_LEN
+#include "util/fixed.h"
+#include "util/logger.h"
+#include "config.h"
+#include <string.h> // For memset
+
+// --- Defines ---
+#ifndef LINK_ACK_TIMEOUT_MS
+#define LINK_ACK_TIMEOUT_MS 2000
+#endif
+#ifndef LINK_RETRANSMIT_MIN_MS
+#define LINK_RETRANSMIT_MIN_MS 150
+#endif
+#ifndef LINK_DEGRADED_LOSS_PERMILLE
+#define LINK_DEGRADED_LOSS_PERMILLE 50
+#endif
+#ifndef LINK_POOR_LOSS_PERMILLE
+#define LINK_POOR_LOSS_PERMILLE 200
+#endif
+#ifndef LINK_DEGRADED_RTT_MS
+#define LINK_DEGRADED_RTT_MS 300
+#endif
+#ifndef LINK_ALIVE_TIMEOUT_MS
+#define LINK_ALIVE_TIMEOUT_MS 5000
+#endif
+#define ACK_WINDOW     8 // Frames covered by recv_mask
+#define RTT_EMA_SHIFT  2 // 1/4 per sample
+#define LOSS_EMA_SHIFT 3 // 1/8 per ACK interval
+
+// --- Internal State ---
+static link_quality_stats_t stats;
+static uint8_t next_seq = 0;
+
+// Last ACK
+static bool ack_seen = false;
+static uint8_t ack_seq = 0;
+static uint8_t ack_rx_count = 0;
+static bool acks_live = false; // An ACK since the last disconnect, at last_ack_ms
+static uint32_t last_ack_ms = 0;
+
+// Frames sent that no ACK has covered yet
+static bool unacked = false;
+static uint32_t unacked_since_ms = 0;
+
+// Last critical frame
+static bool critical_pending = false;
+static bool critical_lost = false;
+static uint8_t critical_seq = 0;
+static uint32_t critical_sent_ms = 0;
+
+static fixed_ema_t rtt_ema;
+static fixed_ema_t loss_ema;
+
+// --- Internal Helper Functions ---
+
+// Settles the pending critical frame against an ACK.
+static void check_critical(uint8_t last_seq, uint8_t recv_mask, uint32_t now_ms) {
+    if (!critical_pending) return;
+    uint8_t back = (uint8_t)(last_seq - critical_seq) & BLE_SEQ_MASK;
+    if (back > BLE_SEQ_MASK / 2) {
+        return; // ACK predates the critical frame
+    }
+    critical_pending = false;
+    if (back < ACK_WINDOW && (recv_mask & (1U << back))) {
+        if (back == 0) { // Acknowledged at once: a clean round trip
+            stats.rtt_ms = fixed_ema_update(&rtt_ema, (uint16_t)(now_ms - critical_sent_ms));
+        }
+    } else {
+        critical_lost = true; // Missing from the mask, or already out of it
+    }
+}
+
+static uint32_t retransmit_timeout_ms(void) {
+    uint32_t timeout = 2UL * stats.rtt_ms;
+    return (timeout > LINK_RETRANSMIT_MIN_MS) ? timeout : LINK_RETRANSMIT_MIN_MS;
+}
+
+// --- Public API Implementation ---
+
+void link_quality_init(void) {
+    memset(&stats, 0, sizeof(stats));
+    next_seq = 0;
+    ack_seen = false;
+    acks_live = false;
+    unacked = false;
+    critical_pending = false;
+    critical_lost = false;
+    fixed_ema_init(&rtt_ema, RTT_EMA_SHIFT);
+    fixed_ema_init(&loss_ema, LOSS_EMA_SHIFT);
+}
+
+uint8_t link_quality_next_seq(bool critical) {
+    return next_seq | (critical ? BLE_SEQ_ACK_REQUEST : 0);
+}
+
+void link_quality_on_sent(bool critical, uint32_t now_ms) {
+    if (critical) {
+        critical_pending = true;
+        critical_lost = false;
+        critical_seq = next_seq;
+        critical_sent_ms = now_ms;
+    }
+    if (!unacked) {
+        unacked = true;
+        unacked_since_ms = now_ms;
+    }
+    next_seq = (uint8_t)(next_seq + 1) & BLE_SEQ_MASK;
+    stats.frames_sent++;
+}
+
+void link_quality_on_ack(const uint8_t *payload, uint8_t length, uint32_t now_ms) {
+    if (length < BLE_LINK_ACK_LEN) {
+        log_warn("Link: Short ACK (%u bytes)", length);
+        return;
+    }
+    uint8_t last_seq = payload[0] & BLE_SEQ_MASK;
+    uint8_t recv_mask = payload[1];
+    uint8_t rx_count = payload[2];
+
+    if (ack_seen) {
+        // Frames sent up to last_seq against frames received since the previous ACK
+        uint8_t sent = (uint8_t)(last_seq - ack_seq) & BLE_SEQ_MASK;
+        uint8_t received = (uint8_t)(rx_count - ack_rx_count);
+        if (sent > 0) {
+            uint8_t lost = (sent > received) ? sent - received : 0;
+            stats.frames_lost += lost;
+            stats.loss_permille = fixed_ema_update(&loss_ema, (uint16_t)(((uint32_t)lost * 1000U) / sent));
+        }
+        stats.frames_received += received;
+    } else {
+        ack_seen = true;
+        stats.frames_received += rx_count;
+        log_info("Link: Display acknowledges frames");
+    }
+    ack_seq = last_seq;
+    ack_rx_count = rx_count;
+    acks_live = true;
+    last_ack_ms = now_ms;
+
+    // Frames sent after last_seq are still in flight: restart their clock
+    unacked = last_seq != ((uint8_t)(next_seq - 1) & BLE_SEQ_MASK);
+    unacked_since_ms = now_ms;
+
+    check_critical(last_seq, recv_mask, now_ms);
+}
+
+bool link_quality_critical_lost(uint32_t now_ms) {
+    if (!critical_lost && critical_pending && ack_seen &&
+        now_ms - critical_sent_ms >= retransmit_timeout_ms()) {
+        critical_pending = false;
+        critical_lost = true; // No ACK in time: the frame or its ACK was lost
+    }
+    if (!critical_lost) return false;
+    critical_lost = false;
+    return true;
+}
+
+void link_quality_on_retransmit(void) {
+    if (stats.retransmits < UINT16_MAX) stats.retransmits++;
+}
+
+void link_quality_on_disconnect(void) {
+    acks_live = false;
+}
+
+bool link_quality_is_connected(bool transport_up, uint32_t now_ms) {
+    if (acks_live && now_ms - last_ack_ms < LINK_ALIVE_TIMEOUT_MS) {
+        return true;
+    }
+    return transport_up && !ack_seen; // A display that has never acknowledged: trust the module
+}
+
+link_quality_level_t link_quality_get_level(uint32_t now_ms) {
+    link_quality_level_t level = LINK_QUALITY_GOOD;
+    if (!ack_seen) {
+        level = LINK_QUALITY_UNKNOWN;
+    } else if ((unacked && now_ms - unacked_since_ms >= LINK_ACK_TIMEOUT_MS) ||
+               stats.loss_permille >= LINK_POOR_LOSS_PERMILLE) {
+        level = LINK_QUALITY_POOR;
+    } else if (stats.loss_permille >= LINK_DEGRADED_LOSS_PERMILLE || stats.rtt_ms >= LINK_DEGRADED_RTT_MS) {
+        level = LINK_QUALITY_DEGRADED;
+    }
+
+    if (level != stats.level) {
+        log_info("Link: Quality %u -> %u (loss %u/1000, RTT %u ms)", stats.level, level, stats.loss_permille,
+                 stats.rtt_ms);
+        stats.level = (uint8_t)level;
+    }
+    return level;
+}
+
+void link_quality_get_stats(link_quality_stats_t *out) {
+    if (!out) return;
+    *out = stats;
+}
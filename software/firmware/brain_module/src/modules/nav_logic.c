@@ -1,70 +1,327 @@
 /**
  * @file nav_logic.c
  * @brief Navigation Logic Module.
- * Processes GPS data and potentially other inputs (speed, signals)
- * to generate navigation instructions or guidance information.
- * (Placeholder implementation)
+ * Matches GPS fixes against the stored route and produces the next maneuver,
+ * the distance along the route to it and the bearing to the next route point.
+ *
+ * Geometry uses a local equirectangular projection in integer meters around
+ * the start of the current segment (util/fixed.h). The cursor only ever moves
+ * forward one segment at a time, so an update touches a constant number of
+ * points; the full route is scanned once, when a route is first matched.
+ *
+ * Between fixes the position is dead-reckoned from the smoothed speed and the
+ * last GPS course, turned by the IMU heading rate when there is one; each fix pulls the estimate toward it by a fixed gain
+ * (a complementary filter, NAV_DR_GAIN_SHIFT). Guidance is recomputed from the
+ * estimate every NAV_UPDATE_INTERVAL_MS, so the distance counts down smoothly
+ * at 20 Hz instead of in one step per fix.
  */
 
 #include "modules/nav_logic.h" // Use the module header file name
 #include "modules/gps.h"
-#include "modules/ble_uart.h" // To send updates
+#include "modules/route_store.h"
+#include "modules/settings.h"
+#include "modules/status_publisher.h" // To publish updates to the display
+#include "hal/timer.h"
 #include "util/logger.h"
-#include <string.h> // For memcpy
-#include <math.h>   // For fabs, etc.
+#include "util/fixed.h"
+#include "util/perf.h"
+#include <string.h> // For memcpy, memset
+
+// --- Defines ---
+#define UDEG_PER_MM_Q16     589      // 1 / 111.195 mm per micro-degree of latitude
+#define DR_MAX_OFFSET_MM    1000000L // Travel since the last fix is clamped to +/-1 km per axis
+#define DR_MIN_COS_LAT_Q15  1024     // Keeps the longitude scale finite near the poles
 
 // --- Internal State ---
 static gps_data_t current_gps_state;
 static bool gps_fix_is_valid = false;
-static float current_speed_kmh = 0.0f;
-// Add state for route, waypoints, turn instructions etc. if implementing actual navigation
-static char current_instruction[64] = "Proceed straight";
-static uint16_t distance_to_next_m = 1000;
+static fixed_ema_t speed_filter;      // Smoothed speed, 0.1 km/h
+
+// Dead reckoning estimate: base position plus the travel propagated since the last fix
+static bool est_valid = false;
+static int32_t est_base_lat_e6 = 0;
+static int32_t est_base_lon_e6 = 0;
+static uint16_t est_cos_lat_q15 = FIXED_Q15_ONE;
+static int32_t est_east_mm = 0;
+static int32_t est_north_mm = 0;
+static uint32_t est_ms = 0;          // Time the estimate was propagated to
+static uint32_t last_fix_ms = 0;
+static int32_t course_cdeg = 0;      // Last GPS course taken at speed, turned by the heading rate
+static q15_t course_sin_q15 = 0;
+static q15_t course_cos_q15 = FIXED_Q15_ONE;
+static int16_t heading_rate_cdps = 0; // From the IMU, positive clockwise
+
+// Route cursor: the rider is on the segment seg_start -> seg_end (points cursor, cursor + 1)
+static uint8_t route_revision = 0;
+static uint16_t route_count = 0;
+static bool route_matched = false;   // False until the first fix after a route change
+static uint16_t cursor = 0;
+static route_point_t seg_start;
+static route_point_t seg_end;
+static uint16_t seg_cos_q15 = 0;     // cos(latitude) at seg_start
+static int32_t seg_east_m = 0;       // seg_end relative to seg_start
+static int32_t seg_north_m = 0;
+static int32_t seg_len2 = 0;         // Squared segment length (m^2)
+static uint16_t seg_len_m = 0;
+static uint16_t maneuver_index = 0;  // Next point with an instruction
+static route_point_t maneuver_point;
+static uint32_t after_seg_m = 0;     // Route distance from seg_end to the maneuver point
+static bool off_route = false;
+
+// Published guidance
+static uint8_t current_maneuver = NAV_MANEUVER_NO_ROUTE;
+static uint8_t maneuver_arg = 0;     // Roundabout exit number
+static uint16_t distance_to_next_m = 0;
+static uint16_t bearing_deg = 0;
+
+// --- Geometry Helpers ---
+
+static void local_offset(const route_point_t *origin, uint16_t cos_q15, int32_t lat_e6, int32_t lon_e6,
+                         int32_t *east_m, int32_t *north_m) {
+    fixed_equirect_offset_m(origin->lat_e6, origin->lon_e6, cos_q15, lat_e6, lon_e6, east_m, north_m);
+}
+
+// --- Route Cursor Helpers ---
+
+// Loads the segment (index, index + 1); seg_start is reused when advancing.
+static void load_segment(uint16_t index, bool reuse_start) {
+    if (reuse_start) {
+        seg_start = seg_end;
+    } else {
+        route_store_get_point(index, &seg_start);
+    }
+    route_store_get_point(index + 1, &seg_end);
+    cursor = index;
+    seg_cos_q15 = fixed_cos_lat_q15(seg_start.lat_e6);
+    local_offset(&seg_start, seg_cos_q15, seg_end.lat_e6, seg_end.lon_e6, &seg_east_m, &seg_north_m);
+    seg_len2 = seg_east_m * seg_east_m + seg_north_m * seg_north_m;
+    seg_len_m = fixed_hypot_m(seg_east_m, seg_north_m);
+}
+
+// Finds the next instruction point after seg_end and the route distance to it.
+// Runs once per maneuver; the distance is then reduced segment by segment.
+static void find_next_maneuver(void) {
+    route_point_t a = seg_end;
+    route_point_t b;
+    uint16_t i = cursor + 1;
+    after_seg_m = 0;
+
+    while (a.maneuver == NAV_MANEUVER_NONE && i + 1 < route_count) {
+        route_store_get_point(i + 1, &b);
+        int32_t e, n;
+        local_offset(&a, fixed_cos_lat_q15(a.lat_e6), b.lat_e6, b.lon_e6, &e, &n);
+        after_seg_m += fixed_hypot_m(e, n);
+        a = b;
+        i++;
+    }
+    maneuver_index = i;
+    maneuver_point = a;
+    if (i + 1 >= route_count) {
+        maneuver_point.maneuver = NAV_MANEUVER_ARRIVE; // The last point always ends the route
+    }
+}
+
+static void advance_segment(void) {
+    bool passed_maneuver = (cursor + 1 == maneuver_index);
+    load_segment(cursor + 1, true);
+    if (passed_maneuver) {
+        find_next_maneuver();
+    } else {
+        after_seg_m = (after_seg_m > seg_len_m) ? after_seg_m - seg_len_m : 0;
+    }
+}
+
+// Distance from a point (relative to seg_start) to the current segment.
+static uint16_t segment_distance_m(int32_t east_m, int32_t north_m) {
+    int32_t along = east_m * seg_east_m + north_m * seg_north_m;
+    if (along <= 0 || seg_len_m == 0) {
+        return fixed_hypot_m(east_m, north_m);
+    }
+    if (along >= seg_len2) {
+        return fixed_hypot_m(seg_east_m - east_m, seg_north_m - north_m);
+    }
+    int32_t cross = east_m * seg_north_m - north_m * seg_east_m;
+    if (cross < 0) cross = -cross;
+    return (uint16_t)(cross / seg_len_m);
+}
+
+// One-off search for the nearest segment after a route change (e.g. after a reboot mid-route).
+static void match_route(int32_t lat_e6, int32_t lon_e6) {
+    uint16_t best = 0;
+    uint16_t best_dist = UINT16_MAX;
+    for (uint16_t i = 0; i + 1 < route_count; ++i) {
+        load_segment(i, i > 0);
+        int32_t e, n;
+        local_offset(&seg_start, seg_cos_q15, lat_e6, lon_e6, &e, &n);
+        uint16_t d = segment_distance_m(e, n);
+        if (d < best_dist) {
+            best_dist = d;
+            best = i;
+        }
+    }
+    load_segment(best, false);
+    find_next_maneuver();
+    route_matched = true;
+    log_info("NavLogic: Matched segment %u of %u (%u m away)", best, route_count - 1, best_dist);
+}
+
+static void check_route_changed(void) {
+    uint8_t rev = route_store_get_revision();
+    if (rev == route_revision) return;
+    route_revision = rev;
+    route_count = route_store_get_count();
+    route_matched = false;
+    off_route = false;
+    log_info("NavLogic: Route changed (%u points)", route_count);
+}
+
+// --- Dead Reckoning Helpers ---
+
+// Current estimate in micro-degrees.
+static void estimate_position(int32_t *lat_e6, int32_t *lon_e6) {
+    // |offset| <= 1 km, so mm * 589 and the longitude scaling below fit in 32 bits
+    int32_t north_udeg = (est_north_mm * UDEG_PER_MM_Q16) >> 16;
+    int32_t east_udeg = (est_east_mm * UDEG_PER_MM_Q16) >> 16;
+    *lat_e6 = est_base_lat_e6 + north_udeg;
+    *lon_e6 = est_base_lon_e6 + (east_udeg * 32768L) / est_cos_lat_q15;
+}
+
+// Moves the estimate along the last course at the smoothed speed, up to now.
+static void predict_to(uint32_t now) {
+    uint32_t dt = now - est_ms;
+    est_ms = now;
+#if ENABLE_DEAD_RECKONING
+    uint16_t speed = fixed_ema_value(&speed_filter);
+    if (!est_valid || speed < NAV_DR_MIN_SPEED_KMH_X10) return;
+    if (dt > NAV_DR_MAX_COAST_MS) dt = NAV_DR_MAX_COAST_MS;
+
+    if (heading_rate_cdps != 0) {
+        course_cdeg += ((int32_t)heading_rate_cdps * (int32_t)dt) / 1000;
+        course_cdeg %= 36000;
+        if (course_cdeg < 0) course_cdeg += 36000;
+        fixed_sin_cos_q15((uint16_t)course_cdeg, &course_sin_q15, &course_cos_q15);
+    }
+    int32_t travel_mm = (int32_t)(((uint32_t)speed * dt) / 36); // 0.1 km/h = 1/36 mm per ms
+    est_east_mm = fixed_clamp_i32(est_east_mm + fixed_scale_q15(travel_mm, course_sin_q15),
+                                  -DR_MAX_OFFSET_MM, DR_MAX_OFFSET_MM);
+    est_north_mm = fixed_clamp_i32(est_north_mm + fixed_scale_q15(travel_mm, course_cos_q15),
+                                   -DR_MAX_OFFSET_MM, DR_MAX_OFFSET_MM);
+#else
+    (void)dt;
+#endif
+}
+
+static void reset_estimate(int32_t lat_e6, int32_t lon_e6) {
+    est_base_lat_e6 = lat_e6;
+    est_base_lon_e6 = lon_e6;
+    est_east_mm = 0;
+    est_north_mm = 0;
+}
+
+// Complementary filter step: the prediction carries the short-term motion,
+// the fix removes its drift.
+static void correct_with_fix(const gps_data_t *fix, uint32_t now) {
+    predict_to(now);
+#if ENABLE_DEAD_RECKONING
+    int32_t lat, lon;
+    estimate_position(&lat, &lon);
+    int32_t err_lat = fix->latitude_e6 - lat;
+    int32_t err_lon = fix->longitude_e6 - lon;
+    // The raw longitude check also catches a prediction across the antimeridian.
+    if (!est_valid || err_lon > 1000000L || err_lon < -1000000L ||
+        fixed_equirect_distance_m(lat, lon, fix->latitude_e6, fix->longitude_e6) > NAV_DR_SNAP_M) {
+        reset_estimate(fix->latitude_e6, fix->longitude_e6);
+    } else {
+        reset_estimate(lat + fixed_div_round(err_lat, 1L << NAV_DR_GAIN_SHIFT),
+                       lon + fixed_div_round(err_lon, 1L << NAV_DR_GAIN_SHIFT));
+    }
+#else
+    reset_estimate(fix->latitude_e6, fix->longitude_e6);
+#endif
+    uint16_t cos_lat = fixed_cos_lat_q15(est_base_lat_e6);
+    est_cos_lat_q15 = (cos_lat < DR_MIN_COS_LAT_Q15) ? DR_MIN_COS_LAT_Q15 : cos_lat;
+    if (fix->speed_kmh_x10 >= NAV_DR_MIN_SPEED_KMH_X10) {
+        course_cdeg = fix->course_deg_x100;
+        fixed_sin_cos_q15(fix->course_deg_x100, &course_sin_q15, &course_cos_q15);
+    }
+    est_valid = true;
+    last_fix_ms = now;
+}
 
 // --- Internal Helper Functions ---
 
+static void set_guidance(uint8_t maneuver, uint8_t arg, uint16_t distance) {
+    current_maneuver = maneuver;
+    maneuver_arg = arg;
+    distance_to_next_m = distance;
+}
+
 // Updates the current navigation guidance based on the latest GPS data and route.
 static void update_navigation_guidance(void) {
-    if (!gps_fix_is_valid) {
-        // Handle case where there is no valid GPS signal.
-        strcpy(current_instruction, "Waiting for GPS fix...");
-        distance_to_next_m = 0;
-        log_warn("NavLogic: No valid GPS fix for guidance update.");
-        // Send update via BLE to inform display
-        ble_uart_send_nav_update(current_instruction, distance_to_next_m);
-        return;
+    uint32_t now = hal_timer_millis();
+    check_route_changed();
+
+    // Without a fix, keep guiding on the estimate for a short while (tunnels, bridges).
+    // The coast runs from the last valid fix, so a receiver that goes silent
+    // expires the estimate just like one reporting an invalid fix.
+    if (est_valid && (now - last_fix_ms >= NAV_DR_MAX_COAST_MS || (!ENABLE_DEAD_RECKONING && !gps_fix_is_valid))) {
+        est_valid = false;
     }
 
-    // Perform route matching, calculate distance/bearing to next maneuver,
-    // determine turn instructions, etc.
-    // This is where the core navigation algorithm resides.
+    if (route_count < 2) {
+        set_guidance(NAV_MANEUVER_NO_ROUTE, 0, 0);
+    } else if (!est_valid) {
+        // Handle case where there is no valid GPS signal.
+        if (current_maneuver != NAV_MANEUVER_NO_FIX) {
+            log_warn("NavLogic: No valid GPS fix for guidance update.");
+        }
+        set_guidance(NAV_MANEUVER_NO_FIX, 0, 0);
+    } else {
+        int32_t lat, lon;
+        int32_t e, n;
+        predict_to(now);
+        estimate_position(&lat, &lon);
 
-    // Simulate guidance update for demonstration:
-    // Simulate distance decreasing based on current speed.
-    float speed_mps = current_speed_kmh / 3.6f;
-    float time_interval_s = (float)NAV_UPDATE_INTERVAL_MS / 1000.0f;
-    float distance_covered_m = speed_mps * time_interval_s;
+        if (!route_matched) {
+            match_route(lat, lon);
+        }
 
-    if (distance_to_next_m > distance_covered_m) {
-        distance_to_next_m -= (uint16_t)distance_covered_m;
-    } else {
-        distance_to_next_m = 0;
-    }
+        // Move the cursor forward while the rider is past the end of the segment.
+        for (uint8_t k = 0; ; ++k) {
+            local_offset(&seg_start, seg_cos_q15, lat, lon, &e, &n);
+            int32_t along = e * seg_east_m + n * seg_north_m;
+            if (along < seg_len2 || cursor + 2 >= route_count || k >= ROUTE_MAX_ADVANCE_PER_FIX) break;
+            advance_segment();
+        }
+
+        // Off-route with hysteresis, so a noisy fix near the limit does not flap.
+        uint16_t offset_m = segment_distance_m(e, n);
+        if (offset_m > ROUTE_OFF_ROUTE_M) {
+            off_route = true;
+        } else if (offset_m < ROUTE_OFF_ROUTE_M / 2) {
+            off_route = false;
+        }
+
+        int32_t to_end_e = seg_east_m - e;
+        int32_t to_end_n = seg_north_m - n;
+        uint32_t remaining = (uint32_t)fixed_hypot_m(to_end_e, to_end_n) + after_seg_m;
+        uint16_t distance = (remaining > UINT16_MAX) ? UINT16_MAX : (uint16_t)remaining;
+        bearing_deg = fixed_bearing_deg(to_end_e, to_end_n);
 
-    // Simulate changing instruction when close
-    if (distance_to_next_m < 50 && distance_to_next_m > 0) {
-         strcpy(current_instruction, "Turn right soon");
-    } else if (distance_to_next_m == 0) {
-         strcpy(current_instruction, "Arrived (Simulated)");
-         // Load next instruction/waypoint here...
-         distance_to_next_m = 2000; // Simulate next leg
-         strcpy(current_instruction, "Proceed straight (New Leg)");
+        if (off_route) {
+            set_guidance(NAV_MANEUVER_OFF_ROUTE, 0, offset_m);
+        } else if (maneuver_point.maneuver == NAV_MANEUVER_ARRIVE && distance < ROUTE_ARRIVE_RADIUS_M) {
+            set_guidance(NAV_MANEUVER_ARRIVE, 0, 0);
+        } else {
+            set_guidance(maneuver_point.maneuver, maneuver_point.arg, distance);
+        }
     }
 
-    log_debug("NavLogic: Update: Instr='%s', Dist=%um", current_instruction, distance_to_next_m);
+    log_debug("NavLogic: Update: Maneuver=%u/%u, Dist=%um, Brg=%u", current_maneuver, maneuver_arg, distance_to_next_m, bearing_deg);
 
-    // Send update via BLE
-    ble_uart_send_nav_update(current_instruction, distance_to_next_m);
+    // Publish; the status publisher only transmits when something changed.
+    // The display turns the code into an icon and text.
+    status_publisher_set_nav(current_maneuver, maneuver_arg, distance_to_next_m);
 }
 
 
@@ -74,9 +331,11 @@ void nav_logic_init(void) {
     log_info("Navigation Logic: Initializing...");
     memset(&current_gps_state, 0, sizeof(current_gps_state));
     gps_fix_is_valid = false;
-    current_speed_kmh = 0.0f;
-    distance_to_next_m = 1000; // Initial dummy distance
-    strcpy(current_instruction, "Initializing Navigation...");
+    est_valid = false;
+    fixed_ema_init(&speed_filter, settings_get()->speed_smoothing_shift);
+    route_revision = route_store_get_revision() - 1; // Force a route check on the first update
+    bearing_deg = 0;
+    set_guidance(NAV_MANEUVER_NO_FIX, 0, 0);
     log_info("Navigation Logic: Initialized.");
 }
 
@@ -84,26 +343,28 @@ void nav_logic_set_gps_data(const gps_data_t *data) {
     if (data != NULL && data->fix_valid) {
         memcpy(&current_gps_state, data, sizeof(gps_data_t));
         gps_fix_is_valid = true;
-        // Use GPS speed directly if available and valid
-        if (data->speed_kmh >= 0.0f) { // Check for valid speed indication
-             nav_logic_set_speed(data->speed_kmh);
-        }
+        correct_with_fix(data, hal_timer_millis());
         log_debug("NavLogic: Received valid GPS data.");
     } else {
-        gps_fix_is_valid = false;
-        // Keep last known speed? Or reset? Resetting might be safer.
-        nav_logic_set_speed(0.0f);
+        gps_fix_is_valid = false; // The estimate coasts until NAV_DR_MAX_COAST_MS after the last fix
         log_warn("NavLogic: Received invalid or NULL GPS data.");
     }
 }
 
-void nav_logic_set_speed(float speed_kmh) {
-    // Apply smoothing (e.g., exponential moving average)
-    current_speed_kmh = (SPEED_SMOOTHING_FACTOR * speed_kmh) + ((1.0f - SPEED_SMOOTHING_FACTOR) * current_speed_kmh);
-    if (fabsf(current_speed_kmh) < 0.1f) { // Clamp small values to zero
-        current_speed_kmh = 0.0f;
+void nav_logic_set_speed(uint16_t speed_kmh_x10) {
+    // Exponential moving average, alpha = 1 / 2^speed_smoothing_shift
+    uint8_t shift = settings_get()->speed_smoothing_shift;
+    if (shift != speed_filter.shift) {
+        uint16_t value = fixed_ema_value(&speed_filter); // Keep the smoothed value across the change
+        speed_filter.shift = shift;
+        speed_filter.acc = (uint32_t)value << shift;
     }
-    log_debug("NavLogic: Speed updated to %.1f km/h", current_speed_kmh);
+    uint16_t smoothed = fixed_ema_update(&speed_filter, speed_kmh_x10);
+    log_debug("NavLogic: Speed updated to %u.%u km/h", smoothed / 10, smoothed % 10);
+}
+
+void nav_logic_set_heading_rate(int16_t rate_cdps) {
+    heading_rate_cdps = rate_cdps;
 }
 
 void nav_logic_set_signal_state(signal_state_t signals) {
@@ -114,18 +375,26 @@ void nav_logic_set_signal_state(signal_state_t signals) {
 }
 
 void nav_logic_update(void) {
-    // This function is called periodically (e.g., every NAV_UPDATE_INTERVAL_MS)
-    // to recalculate guidance and send updates.
-    log_debug("NavLogic: Periodic update triggered.");
+    PERF_SCOPE(NAV_UPDATE);
+    // Called on every new GPS fix and every NAV_UPDATE_INTERVAL_MS
+    // to recalculate guidance and publish updates.
     update_navigation_guidance();
 }
 
 // --- Functions to get current navigation state (if needed by other modules) ---
 
-const char* nav_logic_get_current_instruction(void) {
-    return current_instruction;
+uint8_t nav_logic_get_maneuver(void) {
+    return current_maneuver;
+}
+
+uint8_t nav_logic_get_maneuver_arg(void) {
+    return maneuver_arg;
 }
 
 uint16_t nav_logic_get_distance_to_next(void) {
     return distance_to_next_m;
 }
+
+uint16_t nav_logic_get_bearing_deg(void) {
+    return bearing_deg;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file ota_relay.c
+ * @brief Phone <-> display bootloader relay for firmware updates (see ota_relay.h).
+ */
+
+#include "modules/ota_relay.h"
+#include "modules/ble_uart.h"
+#include "util/logger.h"
+#include "ble_protocol.h" // For BLE_MSG_OTA_*, BLE_MSG_BOOT_*, BLE_OTA_RELAY_BIT
+#include "config.h"
+
+// --- Defines ---
+#ifndef OTA_RELAY_IDLE_MS
+#define OTA_RELAY_IDLE_MS 5000
+#endif
+
+// --- Internal State ---
+static bool active = false;
+static uint32_t last_frame_ms = 0;
+static uint16_t forwarded = 0; // Frames relayed in this update
+static uint16_t dropped = 0;   // Frames the link could not take
+
+// --- Public API Implementation ---
+
+bool ota_relay_handle_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length, uint32_t now_ms) {
+    bool to_display = msg_id >= BLE_MSG_OTA_BEGIN && msg_id <= BLE_MSG_OTA_END;
+    if (!to_display && msg_id != BLE_MSG_BOOT_ACK) {
+        return false;
+    }
+
+    if (!active) {
+        active = true;
+        forwarded = 0;
+        dropped = 0;
+        log_info("OTA: Relaying a display update");
+    }
+    last_frame_ms = now_ms;
+
+    uint8_t relayed_id = to_display ? (uint8_t)(msg_id | BLE_OTA_RELAY_BIT) : BLE_MSG_OTA_ACK;
+    if (ble_uart_send_frame(relayed_id, payload, length)) {
+        forwarded++;
+    } else {
+        dropped++;
+    }
+
+    if (!to_display && length >= BLE_OTA_ACK_LEN && payload[2] == BLE_OTA_DONE) {
+        log_info("OTA: Display updated, %u frames relayed, %u dropped", forwarded, dropped);
+        active = false;
+    }
+    return true;
+}
+
+bool ota_relay_is_active(uint32_t now_ms) {
+    if (active && now_ms - last_frame_ms >= OTA_RELAY_IDLE_MS) {
+        log_warn("OTA: No update traffic for %u ms, resuming (%u frames relayed, %u dropped)",
+                 (uint16_t)OTA_RELAY_IDLE_MS, forwarded, dropped);
+        active = false;
+    }
+    return active;
+}
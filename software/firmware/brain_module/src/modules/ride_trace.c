@@ -0,0 +1,390 @@
+/**
+ * @file ride_trace.c
+ * @brief Ride trace capture to and playback from the external memory (ENABLE_RIDE_TRACE).
+ * Both directions go through one RAM ring. Capture encodes records into it
+ * from the GPS drain and the edge ISRs, and ride_trace_poll() writes it out
+ * one chunk per memory write cycle. Playback reads the memory ahead into it
+ * and feeds each record once the playback clock reaches its timestamp.
+ * The record format is described in ride_trace.h.
+ */
+
+#include "modules/ride_trace.h" // Use the module header file name
+
+#if ENABLE_RIDE_TRACE
+
+#include "modules/ext_flash.h"
+#include "modules/gps.h"
+#include "modules/speed.h"
+#include "hal/timer.h"
+#include "util/ring_buffer.h"
+#include "util/logger.h"
+#include "ble_protocol.h" // For the little-endian field helpers
+#include <string.h>
+#include <util/atomic.h>
+
+// --- Defines ---
+#define TRACE_MAGIC          "HVT1"
+#define TRACE_MAGIC_LEN      4
+#define TRACE_HEADER_LEN     8
+#define TRACE_LENGTH_OPEN    0xFFFFFFFFUL // Header length of a capture that was never closed
+
+#define TAG_TYPE_SHIFT       6
+#define TAG_ARG_MASK         0x3F
+#define TAG_GPS              0
+#define TAG_SIGNAL           1
+#define TAG_SPEED            2
+#define TAG_END              3
+#define SIGNAL_ARG_LIT       0x02
+
+#define GPS_RECORD_MAX       32 // UART bytes per GPS record (also bounds the time with interrupts off)
+#define VARINT_MAX_LEN       5
+#define RECORD_MAX_LEN       (1 + VARINT_MAX_LEN + GPS_RECORD_MAX)
+#define TRACE_CHUNK          EXT_FLASH_WRITE_MAX // Bytes per memory write or read
+#define MAX_CLOCK_STEP_US    1000000UL // Keeps step * speed within 32 bits after a stall
+
+_Static_assert(RING_BUFFER_SIZE_VALID(RIDE_TRACE_BUFFER_SIZE), "RIDE_TRACE_BUFFER_SIZE must be a power of two (2..256)");
+_Static_assert(RIDE_TRACE_BUFFER_SIZE > RECORD_MAX_LEN + TRACE_CHUNK, "RIDE_TRACE_BUFFER_SIZE too small for a record and a chunk");
+_Static_assert(GPS_RECORD_MAX - 1 <= TAG_ARG_MASK, "GPS record length must fit the tag argument");
+
+// --- Internal State ---
+typedef enum {
+    STATE_IDLE,
+    STATE_CAPTURE,
+    STATE_CLOSING, // Capture stopped, records and the header still being written
+    STATE_PLAYBACK
+} trace_state_t;
+
+// Next record to play: tag and delta already consumed, payload still in the ring.
+typedef struct {
+    bool valid;
+    uint8_t type;
+    uint8_t arg;
+    uint32_t time; // Trace time in RIDE_TRACE_TICK_US
+} pending_record_t;
+
+static uint8_t ring_data[RIDE_TRACE_BUFFER_SIZE];
+static ring_buffer_t ring;
+static volatile trace_state_t state = STATE_IDLE; // Checked by the recording ISRs
+static uint32_t address = 0;     // Next memory address to write (capture) or read (playback)
+static uint32_t records = 0;     // Records played
+static volatile uint16_t dropped = 0;
+
+// Capture
+static uint32_t last_record_us = 0; // Time base of the next delta (written with interrupts off)
+static bool header_written = false;
+
+// Playback
+static uint32_t end_address = 0;
+static pending_record_t next;
+static uint32_t next_time = 0;   // Trace time of the last decoded record
+static uint8_t play_speed = 1;
+static uint32_t play_ticks = 0;  // Trace time the playback clock has reached
+static uint32_t play_last_us = 0;
+static uint32_t play_rem_us = 0; // Scaled time not yet a whole tick
+
+// --- Internal Helper Functions ---
+
+static uint8_t put_varint(uint8_t *out, uint32_t value) {
+    uint8_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+// Stamps and queues one record. Any context; dropped whole if the ring is full.
+static void put_record(uint8_t tag, const uint8_t *payload, uint8_t length) {
+    uint8_t record[RECORD_MAX_LEN];
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (state == STATE_CAPTURE) {
+            uint32_t ticks = (hal_timer_micros() - last_record_us) / RIDE_TRACE_TICK_US;
+            uint8_t n = 0;
+            record[n++] = tag;
+            n += put_varint(&record[n], ticks);
+            if (length > 0) {
+                memcpy(&record[n], payload, length);
+                n += length;
+            }
+            if (ring_buffer_space_remaining(&ring) >= n) {
+                ring_buffer_write_multi(&ring, record, n);
+                last_record_us += ticks * RIDE_TRACE_TICK_US; // The remainder carries into the next delta
+            } else if (dropped != UINT16_MAX) {
+                dropped++;
+            }
+        }
+    }
+}
+
+static bool write_header(uint32_t length) {
+    uint8_t header[TRACE_HEADER_LEN];
+    memcpy(header, TRACE_MAGIC, TRACE_MAGIC_LEN);
+    ble_put_u32(&header[TRACE_MAGIC_LEN], length);
+    return ext_flash_write(0, header, sizeof(header));
+}
+
+// Writes at most one chunk: the memory takes one write per write cycle.
+static void capture_poll(void) {
+    if (ext_flash_is_busy()) {
+        return;
+    }
+    if (!header_written) {
+        header_written = write_header(TRACE_LENGTH_OPEN);
+        return;
+    }
+
+    rb_size_t available = ring_buffer_bytes_available(&ring);
+    uint32_t room = EXT_FLASH_SIZE_BYTES - address;
+    if (state == STATE_CLOSING && (available == 0 || room == 0)) {
+        if (write_header(address - TRACE_HEADER_LEN)) {
+            state = STATE_IDLE;
+            log_info("Ride Trace: Captured %lu bytes, %u records dropped", address - TRACE_HEADER_LEN, dropped);
+        }
+        return;
+    }
+    if (room == 0) {
+        log_warn("Ride Trace: Memory full");
+        state = STATE_CLOSING;
+        return;
+    }
+    if (available < TRACE_CHUNK && state != STATE_CLOSING) {
+        return; // Wait for a full chunk
+    }
+
+    const uint8_t *data;
+    uint32_t n = ring_buffer_read_span(&ring, &data);
+    uint32_t chunk_left = TRACE_CHUNK - (address % TRACE_CHUNK); // Chunks never cross a page
+    if (n > chunk_left) n = chunk_left;
+    if (n > room) n = room;
+    if (ext_flash_write(address, data, (uint8_t)n)) {
+        ring_buffer_read_commit(&ring, (rb_size_t)n);
+        address += n;
+    }
+}
+
+static void finish_playback(void) {
+    signal_detector_set_replay(false);
+    speed_sensor_set_replay(false);
+    state = STATE_IDLE;
+    log_info("Ride Trace: Playback finished, %lu records", records);
+}
+
+// Tops up the ring from the memory; reads stay inside one chunk (and so one 64 KB block).
+static bool playback_refill(void) {
+    while (address < end_address && ring_buffer_space_remaining(&ring) >= TRACE_CHUNK) {
+        uint8_t chunk[TRACE_CHUNK];
+        uint32_t n = TRACE_CHUNK - (address % TRACE_CHUNK);
+        if (n > end_address - address) n = end_address - address;
+        if (!ext_flash_read(address, chunk, n)) {
+            return false;
+        }
+        ring_buffer_write_multi(&ring, chunk, (rb_size_t)n);
+        address += n;
+    }
+    return true;
+}
+
+// Decodes the tag and delta of the next record once the whole record is in the ring.
+static bool peek_record(void) {
+    if (next.valid) {
+        return true;
+    }
+    uint8_t tag, b;
+    if (!ring_buffer_peek(&ring, &tag, 0)) {
+        return false;
+    }
+    uint32_t delta = 0;
+    uint8_t n = 1;
+    do {
+        if (n > VARINT_MAX_LEN) {
+            tag = TAG_END << TAG_TYPE_SHIFT; // Corrupt delta: nothing after it can be trusted
+            break;
+        }
+        if (!ring_buffer_peek(&ring, &b, n)) {
+            return false;
+        }
+        delta |= (uint32_t)(b & 0x7F) << (7 * (n - 1));
+        n++;
+    } while (b & 0x80);
+
+    next.type = tag >> TAG_TYPE_SHIFT;
+    next.arg = tag & TAG_ARG_MASK;
+    rb_size_t payload = (next.type == TAG_GPS) ? next.arg + 1 : 0;
+    if (ring_buffer_bytes_available(&ring) < n + payload) {
+        return false;
+    }
+    uint8_t skip[1 + VARINT_MAX_LEN];
+    ring_buffer_read_multi(&ring, skip, n);
+    next_time += delta;
+    next.time = next_time;
+    next.valid = true;
+    return true;
+}
+
+// Feeds the pending record; lag_us is how long ago it fell due on the live clock.
+static void play_record(uint32_t lag_us) {
+    switch (next.type) {
+        case TAG_GPS:
+            for (uint8_t i = 0; i <= next.arg; ++i) {
+                uint8_t c;
+                ring_buffer_read(&ring, &c);
+                gps_process_char(c);
+            }
+            break;
+        case TAG_SIGNAL:
+            signal_detector_inject_edge((next.arg & 0x01) ? SIGNAL_SIDE_RIGHT : SIGNAL_SIDE_LEFT,
+                                        (next.arg & SIGNAL_ARG_LIT) != 0, hal_timer_millis() - lag_us / 1000);
+            break;
+        case TAG_SPEED:
+            speed_sensor_inject_pulse(hal_timer_micros() - lag_us);
+            break;
+        default:
+            break;
+    }
+    next.valid = false;
+    records++;
+}
+
+// Plays what has fallen due; at most a ring's worth per call so the main loop keeps running.
+static void playback_poll(void) {
+    uint32_t now = hal_timer_micros();
+    uint32_t step = now - play_last_us;
+    play_last_us = now;
+    if (step > MAX_CLOCK_STEP_US) step = MAX_CLOCK_STEP_US;
+    play_rem_us += step * play_speed;
+    play_ticks += play_rem_us / RIDE_TRACE_TICK_US;
+    play_rem_us %= RIDE_TRACE_TICK_US;
+
+    if (!playback_refill()) {
+        log_warn("Ride Trace: Read failed at %lu", address);
+        finish_playback();
+        return;
+    }
+    while (peek_record()) {
+        if (next.type == TAG_END) {
+            finish_playback();
+            return;
+        }
+        if (play_speed == RIDE_TRACE_SPEED_MAX) {
+            play_ticks = next.time; // The clock follows the records
+        } else if ((int32_t)(next.time - play_ticks) > 0) {
+            return; // Not due yet
+        }
+        play_record((play_ticks - next.time) * RIDE_TRACE_TICK_US / (play_speed ? play_speed : 1));
+    }
+    if (address >= end_address) {
+        finish_playback(); // Out of records (a capture cut short has no END)
+    }
+}
+
+// --- Public API Implementation ---
+
+void ride_trace_init(void) {
+    state = STATE_IDLE;
+    ext_flash_init();
+}
+
+bool ride_trace_start_capture(void) {
+    if (state != STATE_IDLE) {
+        return false;
+    }
+    if (!ext_flash_is_present()) {
+        log_warn("Ride Trace: No external memory");
+        return false;
+    }
+    ring_buffer_init(&ring, ring_data, RIDE_TRACE_BUFFER_SIZE);
+    address = TRACE_HEADER_LEN;
+    header_written = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        dropped = 0;
+        last_record_us = hal_timer_micros();
+        state = STATE_CAPTURE;
+    }
+    log_info("Ride Trace: Capturing, %lu bytes free", EXT_FLASH_SIZE_BYTES - TRACE_HEADER_LEN);
+    return true;
+}
+
+bool ride_trace_start_playback(uint8_t speed) {
+    if (state != STATE_IDLE || !ext_flash_is_present() || ext_flash_is_busy()) {
+        return false;
+    }
+    uint8_t header[TRACE_HEADER_LEN];
+    if (!ext_flash_read(0, header, sizeof(header)) || memcmp(header, TRACE_MAGIC, TRACE_MAGIC_LEN) != 0) {
+        log_warn("Ride Trace: No trace stored");
+        return false;
+    }
+    uint32_t length = ble_get_u32(&header[TRACE_MAGIC_LEN]);
+    if (length > EXT_FLASH_SIZE_BYTES - TRACE_HEADER_LEN) {
+        length = EXT_FLASH_SIZE_BYTES - TRACE_HEADER_LEN; // Open capture: play until END or erased memory
+    }
+
+    ring_buffer_init(&ring, ring_data, RIDE_TRACE_BUFFER_SIZE);
+    address = TRACE_HEADER_LEN;
+    end_address = TRACE_HEADER_LEN + length;
+    records = 0;
+    next.valid = false;
+    next_time = 0;
+    play_speed = speed;
+    play_ticks = 0;
+    play_rem_us = 0;
+    play_last_us = hal_timer_micros();
+    signal_detector_set_replay(true);
+    speed_sensor_set_replay(true);
+    state = STATE_PLAYBACK;
+    log_info("Ride Trace: Playing %lu bytes at %ux", length, speed);
+    return true;
+}
+
+void ride_trace_stop(void) {
+    if (state == STATE_CAPTURE) {
+        put_record(TAG_END << TAG_TYPE_SHIFT, NULL, 0);
+        state = STATE_CLOSING;
+    } else if (state == STATE_PLAYBACK) {
+        finish_playback();
+    }
+}
+
+ride_trace_mode_t ride_trace_get_mode(void) {
+    switch (state) {
+        case STATE_CAPTURE:
+        case STATE_CLOSING:  return RIDE_TRACE_CAPTURE;
+        case STATE_PLAYBACK: return RIDE_TRACE_PLAYBACK;
+        default:             return RIDE_TRACE_IDLE;
+    }
+}
+
+uint16_t ride_trace_get_dropped(void) {
+    uint16_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = dropped;
+    }
+    return count;
+}
+
+void ride_trace_record_gps(const uint8_t *data, size_t length) {
+    while (length > 0 && state == STATE_CAPTURE) {
+        uint8_t n = (length > GPS_RECORD_MAX) ? GPS_RECORD_MAX : (uint8_t)length;
+        put_record((TAG_GPS << TAG_TYPE_SHIFT) | (n - 1), data, n);
+        data += n;
+        length -= n;
+    }
+}
+
+void ride_trace_record_signal(signal_side_t side, bool lit) {
+    put_record((TAG_SIGNAL << TAG_TYPE_SHIFT) | (lit ? SIGNAL_ARG_LIT : 0) | (uint8_t)side, NULL, 0);
+}
+
+void ride_trace_record_speed_pulse(void) {
+    put_record(TAG_SPEED << TAG_TYPE_SHIFT, NULL, 0);
+}
+
+void ride_trace_poll(void) {
+    if (state == STATE_CAPTURE || state == STATE_CLOSING) {
+        capture_poll();
+    } else if (state == STATE_PLAYBACK) {
+        playback_poll();
+    }
+}
+
+#endif // ENABLE_RIDE_TRACE
@@ -0,0 +1,231 @@
+/**
+ * @file route_store.c
+ * @brief EEPROM-backed route store loaded over BLE.
+ *
+ * EEPROM layout from ROUTE_STORE_EEPROM_BASE:
+ *   magic (u16) | version (u8) | reserved (u8) | point_count (u16) | route_id (u16)
+ *   followed by point_count records of BLE_ROUTE_PT_LEN bytes (ble_protocol.h order).
+ *
+ * Each received frame is staged in RAM and written one byte per poll, since an
+ * EEPROM byte write takes ~3.4 ms. The ACK for a frame is only sent once it is
+ * fully written, which throttles the phone to the EEPROM's speed. The header
+ * is invalidated first and rewritten last, so a load that is interrupted
+ * leaves no route rather than a corrupt one.
+ */
+
+#include "modules/route_store.h"
+#include "modules/ble_uart.h"
+#include "hal/eeprom.h"
+#include "util/logger.h"
+#include "ble_protocol.h"
+#include "config.h"
+#include <string.h> // For memcpy
+
+// --- Defines ---
+#define ROUTE_MAGIC         0x5254 // "RT"
+#define ROUTE_VERSION       1
+#define ROUTE_HEADER_LEN    8
+#define ROUTE_POINTS_BASE   (ROUTE_STORE_EEPROM_BASE + ROUTE_HEADER_LEN)
+#define ROUTE_MAX_POINTS    ((HAL_EEPROM_SIZE - ROUTE_POINTS_BASE) / BLE_ROUTE_PT_LEN)
+
+_Static_assert(ROUTE_STORE_EEPROM_BASE + ROUTE_HEADER_LEN + BLE_ROUTE_PT_LEN <= HAL_EEPROM_SIZE,
+               "Route store does not fit in EEPROM");
+
+// What to do once the staged bytes are in EEPROM.
+typedef enum {
+    STAGE_IDLE,
+    STAGE_BEGIN,    // Header invalidated: acknowledge ROUTE_BEGIN
+    STAGE_POINTS,   // Points written: acknowledge and advance next_index
+    STAGE_ACTIVATE  // Header written: the new route is active
+} stage_action_t;
+
+// --- Internal State ---
+static uint16_t active_count = 0; // 0 = no usable route
+static uint8_t revision = 0;
+
+// Load in progress
+static bool loading = false;
+static uint16_t load_count = 0;
+static uint16_t load_route_id = 0;
+static uint16_t next_index = 0;
+
+// Bytes waiting to be written
+static uint8_t stage_data[BLE_PROTO_MAX_PAYLOAD];
+static uint16_t stage_address = 0;
+static uint8_t stage_length = 0;
+static uint8_t stage_pos = 0;
+static uint8_t stage_points = 0;
+static stage_action_t stage_action = STAGE_IDLE;
+
+// --- Internal Helper Functions ---
+
+static void send_ack(uint8_t status) {
+    ble_uart_send_route_ack(next_index, status);
+}
+
+static void stage(uint16_t address, const uint8_t *data, uint8_t length, stage_action_t action) {
+    memcpy(stage_data, data, length);
+    stage_address = address;
+    stage_length = length;
+    stage_pos = 0;
+    stage_action = action;
+}
+
+static void set_active(uint16_t count) {
+    active_count = count;
+    revision++;
+}
+
+static void handle_begin(const uint8_t *payload, uint8_t length) {
+    if (length < BLE_ROUTE_BEGIN_LEN) {
+        send_ack(BLE_ROUTE_INVALID);
+        return;
+    }
+    uint16_t count = ble_get_u16(&payload[0]);
+    next_index = 0;
+    if (count < 2 || count > ROUTE_MAX_POINTS) {
+        log_warn("Route: %u points rejected (max %u)", count, (unsigned)ROUTE_MAX_POINTS);
+        send_ack(BLE_ROUTE_TOO_LONG);
+        return;
+    }
+
+    loading = true;
+    load_count = count;
+    load_route_id = ble_get_u16(&payload[2]);
+    if (active_count) {
+        set_active(0); // The old route is about to be overwritten
+    }
+
+    uint8_t invalid_magic[2] = { 0, 0 };
+    stage(ROUTE_STORE_EEPROM_BASE, invalid_magic, sizeof(invalid_magic), STAGE_BEGIN);
+    log_info("Route: Loading %u points (id %u)", count, load_route_id);
+}
+
+static void handle_points(const uint8_t *payload, uint8_t length) {
+    if (!loading || length < BLE_ROUTE_PTS_OFS_DATA + BLE_ROUTE_PT_LEN) {
+        send_ack(BLE_ROUTE_INVALID);
+        return;
+    }
+    uint16_t first = ble_get_u16(&payload[BLE_ROUTE_PTS_OFS_FIRST]);
+    uint8_t points = (length - BLE_ROUTE_PTS_OFS_DATA) / BLE_ROUTE_PT_LEN;
+    if (first != next_index) {
+        send_ack(BLE_ROUTE_SEQUENCE);
+        return;
+    }
+    if ((uint32_t)first + points > load_count) {
+        send_ack(BLE_ROUTE_INVALID);
+        return;
+    }
+
+    stage(ROUTE_POINTS_BASE + first * BLE_ROUTE_PT_LEN, &payload[BLE_ROUTE_PTS_OFS_DATA],
+          points * BLE_ROUTE_PT_LEN, STAGE_POINTS);
+    stage_points = points;
+}
+
+static void handle_end(const uint8_t *payload, uint8_t length) {
+    if (!loading || length < BLE_ROUTE_END_LEN ||
+        ble_get_u16(&payload[0]) != load_count || next_index != load_count) {
+        send_ack(BLE_ROUTE_INVALID);
+        return;
+    }
+
+    uint8_t header[ROUTE_HEADER_LEN];
+    ble_put_u16(&header[0], ROUTE_MAGIC);
+    header[2] = ROUTE_VERSION;
+    header[3] = 0;
+    ble_put_u16(&header[4], load_count);
+    ble_put_u16(&header[6], load_route_id);
+    stage(ROUTE_STORE_EEPROM_BASE, header, sizeof(header), STAGE_ACTIVATE);
+}
+
+// All staged bytes are written: complete the action that queued them.
+static void stage_complete(void) {
+    stage_action_t action = stage_action;
+    stage_action = STAGE_IDLE;
+
+    switch (action) {
+        case STAGE_BEGIN:
+            send_ack(BLE_ROUTE_OK);
+            break;
+        case STAGE_POINTS:
+            next_index += stage_points;
+            send_ack(BLE_ROUTE_OK);
+            break;
+        case STAGE_ACTIVATE:
+            loading = false;
+            set_active(load_count);
+            send_ack(BLE_ROUTE_OK);
+            log_info("Route: %u points active", active_count);
+            break;
+        default:
+            break;
+    }
+}
+
+// --- Public API Implementation ---
+
+void route_store_init(void) {
+    uint8_t header[ROUTE_HEADER_LEN];
+    hal_eeprom_read(ROUTE_STORE_EEPROM_BASE, header, sizeof(header));
+
+    uint16_t count = ble_get_u16(&header[4]);
+    loading = false;
+    stage_action = STAGE_IDLE;
+    next_index = 0;
+    if (ble_get_u16(&header[0]) == ROUTE_MAGIC && header[2] == ROUTE_VERSION &&
+        count >= 2 && count <= ROUTE_MAX_POINTS) {
+        set_active(count);
+        log_info("Route: Stored route with %u points (id %u)", count, ble_get_u16(&header[6]));
+    } else {
+        set_active(0);
+        log_info("Route: No stored route (capacity %u points)", (unsigned)ROUTE_MAX_POINTS);
+    }
+}
+
+void route_store_handle_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length) {
+    if (msg_id != BLE_MSG_ROUTE_BEGIN && msg_id != BLE_MSG_ROUTE_POINTS && msg_id != BLE_MSG_ROUTE_END) {
+        return;
+    }
+    if (stage_action != STAGE_IDLE) {
+        send_ack(BLE_ROUTE_BUSY);
+        return;
+    }
+
+    switch (msg_id) {
+        case BLE_MSG_ROUTE_BEGIN:  handle_begin(payload, length); break;
+        case BLE_MSG_ROUTE_POINTS: handle_points(payload, length); break;
+        default:                   handle_end(payload, length); break;
+    }
+}
+
+void route_store_poll(void) {
+    if (stage_action == STAGE_IDLE) return;
+
+    // At most one byte per call is started; the next call finds the EEPROM busy.
+    while (stage_pos < stage_length && hal_eeprom_write_byte(stage_address + stage_pos, stage_data[stage_pos])) {
+        stage_pos++;
+    }
+    if (stage_pos >= stage_length && hal_eeprom_is_ready()) {
+        stage_complete();
+    }
+}
+
+uint16_t route_store_get_count(void) {
+    return active_count;
+}
+
+uint8_t route_store_get_revision(void) {
+    return revision;
+}
+
+bool route_store_get_point(uint16_t index, route_point_t *point) {
+    if (!point || index >= active_count) return false;
+
+    uint8_t record[BLE_ROUTE_PT_LEN];
+    hal_eeprom_read(ROUTE_POINTS_BASE + index * BLE_ROUTE_PT_LEN, record, sizeof(record));
+    point->lat_e6 = (int32_t)ble_get_u32(&record[BLE_ROUTE_PT_OFS_LAT]);
+    point->lon_e6 = (int32_t)ble_get_u32(&record[BLE_ROUTE_PT_OFS_LON]);
+    point->maneuver = record[BLE_ROUTE_PT_OFS_MANEUVER];
+    point->arg = record[BLE_ROUTE_PT_OFS_ARG];
+    return true;
+}
@@ -1,122 +1,189 @@
 /**
  * @file signal_detector.c
  * @brief Module for detecting motorcycle turn signal activation.
- * Reads GPIO pins connected to turn signal indicators and applies debouncing.
+ * The indicator lines (active low) interrupt on every edge. The ISR accepts a
+ * change of level unless it falls within the debounce time (a setting) of the last
+ * accepted one, and timestamps each flash. Blinking, hazard and steady-on are
+ * told apart from those timestamps when the state is read, so no task polls the pins.
  */
 
 #include "modules/signal.h" // Use the module header file name
+#include "modules/ride_trace.h"
+#include "modules/settings.h"
 #include "hal/gpio.h"
+#include "hal/timer.h"
 #include "util/logger.h"
-// #include "hal/timer.h" // Assuming a timer HAL for periodic checks
+#include "util/fixed.h"
+#include <stddef.h>
+#include <util/atomic.h>
 
 // --- Internal State ---
-static signal_state_t current_signal_state = SIGNAL_STATE_OFF;
-
-// Debouncing state for left signal
-static bool left_signal_raw_state = false; // Assumes active low signals (pull-up enabled)
-static bool left_signal_debounced_state = false;
-static uint32_t left_signal_last_change_time_ms = 0; // Requires a system timer/tick
-
-// Debouncing state for right signal
-static bool right_signal_raw_state = false;
-static bool right_signal_debounced_state = false;
-static uint32_t right_signal_last_change_time_ms = 0;
-
-// Function to get current time (replace with actual timer HAL call)
-static uint32_t get_current_time_ms(void) {
-    // Placeholder implementation - requires a real timer source.
-    static uint32_t time_ms = 0;
-    time_ms += 10; // Simulate time passing with each call
-    return time_ms;
-}
-// --- End Assumed Timer HAL ---
 
+// One indicator line. Written by the edge ISR; read and reconciled under ATOMIC_BLOCK.
+typedef struct {
+    uint8_t pin;
+    bool lit;           // Accepted level (true = lamp on, pin low)
+    uint32_t change_ms; // Time of the last accepted change
+    uint32_t lit_ms;    // Time of the last accepted off -> on change (flash start)
+    uint16_t period_ms; // Between the last two flash starts, 0 until measured
+} signal_channel_t;
+
+static signal_channel_t channels[2];
+static signal_edge_handler_t edge_handler = NULL;
+static bool replay = false;    // Levels come from signal_detector_inject_edge(), not the pins
+static bool replay_lit[2];
+static signal_state_t last_state = SIGNAL_STATE_OFF; // For change logging only
 
 // --- Internal Helper Functions ---
 
-// Applies debouncing logic to a single signal input pin.
-static bool debounce_signal(uint8_t pin, bool *raw_state, bool *debounced_state, uint32_t *last_change_time) {
-    bool current_pin_state = hal_gpio_read(pin);
-    uint32_t now = get_current_time_ms(); // Use the timer function
-    bool state_changed = false;
-
-    if (current_pin_state != *raw_state) {
-        // State has changed, update raw state and reset debounce timer.
-        *raw_state = current_pin_state;
-        *last_change_time = now;
-        log_debug("Signal Pin %d: Raw state changed to %d", pin, *raw_state);
-    } else {
-        // State is stable, check if debounce time has elapsed.
-        if ((now - *last_change_time >= SIGNAL_DEBOUNCE_TIME_MS) && (*debounced_state != *raw_state)) {
-            // Debounce time elapsed and state differs, update debounced state.
-            *debounced_state = *raw_state;
-            state_changed = true;
-            log_info("Signal Pin %d: Debounced state changed to %d", pin, *debounced_state);
-        }
+static void accept_change(signal_channel_t *ch, bool lit, uint32_t now) {
+    ch->lit = lit;
+    ch->change_ms = now;
+    if (lit) {
+        ch->period_ms = fixed_sat_u16(now - ch->lit_ms);
+        ch->lit_ms = now;
     }
-    return state_changed; // Return true if the debounced state changed
 }
 
-// --- Public API Implementation ---
-
-void signal_detector_init(void) {
-    log_info("Signal Detector: Initializing...");
+static bool read_lit(signal_side_t side) {
+    return replay ? replay_lit[side] : !hal_gpio_read(channels[side].pin);
+}
 
-    // Initialize GPIO pins for signal inputs with pull-ups (assuming active low signals)
-    hal_gpio_init(LEFT_SIGNAL_PIN, GPIO_MODE_INPUT_PULLUP);
-    hal_gpio_init(RIGHT_SIGNAL_PIN, GPIO_MODE_INPUT_PULLUP);
+// The first edge of a bounce burst is taken at once; the rest of the burst
+// falls inside the lock-out window. Interrupts off.
+static void handle_edge(signal_side_t side, bool lit, uint32_t now) {
+    signal_channel_t *ch = &channels[side];
+    if (lit == ch->lit || now - ch->change_ms < settings_get()->signal_debounce_ms) {
+        return; // Bounce
+    }
+    accept_change(ch, lit, now);
+    if (edge_handler) {
+        edge_handler();
+    }
+}
 
-    // Initialize debouncing states based on initial pin readings
-    left_signal_raw_state = hal_gpio_read(LEFT_SIGNAL_PIN);
-    left_signal_debounced_state = left_signal_raw_state;
-    right_signal_raw_state = hal_gpio_read(RIGHT_SIGNAL_PIN);
-    right_signal_debounced_state = right_signal_raw_state;
+// Edge ISR callback (INT0/INT1, any change).
+static void on_signal_edge(uint8_t pin) {
+    signal_side_t side = (pin == RIGHT_SIGNAL_PIN) ? SIGNAL_SIDE_RIGHT : SIGNAL_SIDE_LEFT;
+    bool lit = !hal_gpio_read(pin);
+    ride_trace_record_signal(side, lit); // Raw edge, so playback exercises the debounce
+    if (!replay) {
+        handle_edge(side, lit, hal_timer_millis());
+    }
+}
 
-    uint32_t now = get_current_time_ms(); // Use the timer function
-    left_signal_last_change_time_ms = now;
-    right_signal_last_change_time_ms = now;
+// Copies one channel. A burst that settled on the other level inside the
+// lock-out window left no edge to accept, so the live level is checked here.
+static void snapshot_channel(signal_side_t side, uint32_t now, signal_channel_t *out) {
+    signal_channel_t *ch = &channels[side];
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        bool lit = read_lit(side);
+        if (lit != ch->lit && now - ch->change_ms >= settings_get()->signal_debounce_ms) {
+            accept_change(ch, lit, now);
+        }
+        *out = *ch;
+    }
+}
 
-    current_signal_state = SIGNAL_STATE_OFF; // Start with signals off
+static signal_mode_t classify(const signal_channel_t *ch, uint32_t now) {
+    uint32_t since_flash = now - ch->lit_ms;
+    if (since_flash >= SIGNAL_BLINK_MAX_PERIOD_MS) {
+        // While lit, lit_ms is the time of the last change: on that long is steady
+        return ch->lit ? SIGNAL_MODE_STEADY : SIGNAL_MODE_OFF;
+    }
+    if (ch->period_ms != 0 && ch->period_ms < SIGNAL_BLINK_MIN_PERIOD_MS) {
+        return SIGNAL_MODE_STEADY; // Flicker, not a flasher
+    }
+    return SIGNAL_MODE_BLINKING;
+}
 
-    log_info("Signal Detector: Initialized. Left=%d, Right=%d (Raw)", left_signal_raw_state, right_signal_raw_state);
+static void init_channel(signal_side_t side, uint8_t pin, uint32_t now) {
+    signal_channel_t *ch = &channels[side];
+    hal_gpio_init(pin, GPIO_MODE_INPUT_PULLUP);
+    ch->pin = pin;
+    ch->lit = !hal_gpio_read(pin);
+    ch->lit_ms = now - SIGNAL_BLINK_MAX_PERIOD_MS; // No flash seen: a lamp lit at power-on reads as steady
+    ch->change_ms = ch->lit_ms;
+    ch->period_ms = 0;
+    hal_gpio_configure_interrupt(pin, GPIO_INT_EDGE_ANY_CHANGE, on_signal_edge);
+    hal_gpio_enable_interrupt(pin);
 }
 
-void signal_detector_update(void) {
-    // This function should be called periodically (e.g., every 10-20ms)
-    // to update the debouncing logic.
+// --- Public API Implementation ---
 
-    bool left_changed = debounce_signal(LEFT_SIGNAL_PIN,
-                                        &left_signal_raw_state,
-                                        &left_signal_debounced_state,
-                                        &left_signal_last_change_time_ms);
+void signal_detector_init(void) {
+    log_info("Signal Detector: Initializing...");
 
-    bool right_changed = debounce_signal(RIGHT_SIGNAL_PIN,
-                                         &right_signal_raw_state,
-                                         &right_signal_debounced_state,
-                                         &right_signal_last_change_time_ms);
+    uint32_t now = hal_timer_millis();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        init_channel(SIGNAL_SIDE_LEFT, LEFT_SIGNAL_PIN, now);
+        init_channel(SIGNAL_SIDE_RIGHT, RIGHT_SIGNAL_PIN, now);
+    }
+    last_state = SIGNAL_STATE_OFF; // Start with signals off
 
-    // Determine the final signal state based on the debounced inputs.
-    // Assumes the hardware uses active-low signals (signal ON = pin LOW).
-    bool left_on = !left_signal_debounced_state;  // Signal is ON if debounced state is LOW (false)
-    bool right_on = !right_signal_debounced_state; // Signal is ON if debounced state is LOW (false)
+    log_info("Signal Detector: Initialized. Left=%d, Right=%d (Lit)", channels[0].lit, channels[1].lit);
+}
 
-    signal_state_t new_state = SIGNAL_STATE_OFF;
+void signal_detector_set_edge_handler(signal_edge_handler_t handler) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        edge_handler = handler;
+    }
+}
+
+signal_state_t signal_detector_get_state(void) {
+    uint32_t now = hal_timer_millis();
+    signal_channel_t left, right;
+    snapshot_channel(SIGNAL_SIDE_LEFT, now, &left);
+    snapshot_channel(SIGNAL_SIDE_RIGHT, now, &right);
+    bool left_on = classify(&left, now) == SIGNAL_MODE_BLINKING;
+    bool right_on = classify(&right, now) == SIGNAL_MODE_BLINKING;
+
+    signal_state_t state = SIGNAL_STATE_OFF;
     if (left_on && right_on) {
-        new_state = SIGNAL_STATE_HAZARD; // Both signals active -> Hazard lights
+        // One flasher drives both sides for hazard. Out of phase means the rider
+        // just switched sides and the old side has not timed out yet.
+        int32_t skew = (int32_t)(left.lit_ms - right.lit_ms);
+        uint32_t newest_ms = (skew > 0) ? left.lit_ms : right.lit_ms;
+        if (skew <= SIGNAL_HAZARD_SYNC_MS && skew >= -SIGNAL_HAZARD_SYNC_MS) {
+            state = SIGNAL_STATE_HAZARD;
+        } else if (last_state == SIGNAL_STATE_HAZARD && now - newest_ms < SIGNAL_HAZARD_SYNC_MS) {
+            state = SIGNAL_STATE_HAZARD; // The other side's flash is still due
+        } else {
+            state = (skew > 0) ? SIGNAL_STATE_LEFT : SIGNAL_STATE_RIGHT;
+        }
     } else if (left_on) {
-        new_state = SIGNAL_STATE_LEFT;
+        state = SIGNAL_STATE_LEFT;
     } else if (right_on) {
-        new_state = SIGNAL_STATE_RIGHT;
+        state = SIGNAL_STATE_RIGHT;
     }
 
-    if (new_state != current_signal_state) {
-        log_info("Signal Detector: State changed from %d to %d", current_signal_state, new_state);
-        current_signal_state = new_state;
-        // Optionally notify other modules immediately on change
-        // nav_logic_set_signal_state(current_signal_state);
+    if (state != last_state) {
+        log_info("Signal Detector: State changed from %d to %d", last_state, state);
+        last_state = state;
     }
+    return state;
 }
 
-signal_state_t signal_detector_get_state(void) {
-    return current_signal_state;
+signal_mode_t signal_detector_get_mode(signal_side_t side) {
+    uint32_t now = hal_timer_millis();
+    signal_channel_t ch;
+    snapshot_channel(side, now, &ch);
+    return classify(&ch, now);
+}
+
+void signal_detector_set_replay(bool enabled) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        replay = enabled;
+        replay_lit[SIGNAL_SIDE_LEFT] = false;
+        replay_lit[SIGNAL_SIDE_RIGHT] = false;
+    }
+}
+
+void signal_detector_inject_edge(signal_side_t side, bool lit, uint32_t at_ms) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (replay) {
+            replay_lit[side] = lit;
+            handle_edge(side, lit, at_ms);
+        }
+    }
 }
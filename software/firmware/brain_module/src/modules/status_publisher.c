@@ -0,0 +1,236 @@
+/**
+ * @file status_publisher.c
+ * @brief Change-driven status/nav publisher for the BLE link.
+ * Keeps the last value sent for each field and only transmits deltas,
+ * with per-field deadlines and a low-rate keyframe. Maneuver changes are sent
+ * as critical frames and resent if the display's ACKs show them lost; on a
+ * degraded or poor link (link_quality.h) the keyframe and rate-limit intervals
+ * stretch 2x or 4x, so more changes coalesce into each frame. When nothing has
+ * gone out for the heartbeat interval a heartbeat does, so the display
+ * can tell a quiet link from a dead one. Updates only go out while the
+ * display counts as connected (link_quality_is_connected()); when its ACKs
+ * stop, only heartbeat probes do.
+ */
+
+#include "modules/status_publisher.h"
+#include "modules/ble_uart.h"
+#include "modules/link_quality.h"
+#include "modules/settings.h"
+#include "util/logger.h"
+#include "ble_protocol.h" // For BLE_FIELD_*
+#include "nav_maneuver.h"
+#include "config.h"
+
+// --- Defines ---
+#ifndef LINK_RETRANSMIT_MAX
+#define LINK_RETRANSMIT_MAX 3
+#endif
+
+// Keyframe halves still to go out (keyframe_pending)
+#define KEYFRAME_STATUS 0x01
+#define KEYFRAME_NAV    0x02
+#define KEYFRAME_ALL    (KEYFRAME_STATUS | KEYFRAME_NAV)
+
+// --- Internal State ---
+
+// Latest values pushed by the producers
+static uint16_t current_battery_mv = 0;
+static uint8_t current_signal = 0;
+static uint8_t current_speed_kmh = 0;
+static uint8_t current_maneuver = NAV_MANEUVER_NO_FIX;
+static uint8_t current_arg = 0;
+static uint16_t current_distance_m = 0;
+
+// Values as last transmitted to the display
+static uint16_t sent_battery_mv = 0;
+static uint8_t sent_signal = 0;
+static uint8_t sent_speed_kmh = 0;
+static uint8_t sent_maneuver = NAV_MANEUVER_NO_FIX;
+static uint8_t sent_arg = 0;
+static uint16_t sent_distance_m = 0;
+
+// Per-field transmit timestamps (for rate limiting)
+static uint32_t last_battery_tx_ms = 0;
+static uint32_t last_speed_tx_ms = 0;
+static uint32_t last_nav_tx_ms = 0;
+static uint32_t last_keyframe_ms = 0;
+static uint32_t last_tx_ms = 0; // Any frame, for the heartbeat
+
+static uint8_t keyframe_pending = KEYFRAME_ALL;
+static bool was_connected = false;
+static uint8_t nav_retries = 0; // Resends of the current maneuver
+static bool resend_due = false; // The current maneuver was lost and waits to be resent
+
+// --- Internal Helper Functions ---
+
+// Sends the halves of the keyframe still pending; a half the UART did not
+// accept stays pending for the next update, like a delta frame would.
+static void send_keyframe(uint32_t now_ms) {
+    if ((keyframe_pending & KEYFRAME_STATUS) &&
+        ble_uart_send_status_update(current_battery_mv, current_signal, current_speed_kmh)) {
+        sent_battery_mv = current_battery_mv;
+        sent_signal = current_signal;
+        sent_speed_kmh = current_speed_kmh;
+        last_battery_tx_ms = now_ms;
+        last_speed_tx_ms = now_ms;
+        last_tx_ms = now_ms;
+        keyframe_pending &= (uint8_t)~KEYFRAME_STATUS;
+    }
+    if ((keyframe_pending & KEYFRAME_NAV) &&
+        ble_uart_send_nav_update(current_maneuver, current_arg, current_distance_m, false)) {
+        sent_maneuver = current_maneuver;
+        sent_arg = current_arg;
+        sent_distance_m = current_distance_m;
+        last_nav_tx_ms = now_ms;
+        last_tx_ms = now_ms;
+        keyframe_pending &= (uint8_t)~KEYFRAME_NAV;
+    }
+    if (!keyframe_pending) {
+        last_keyframe_ms = now_ms;
+        log_debug("StatusPub: Keyframe sent");
+    }
+}
+
+// Interval multiplier (as a shift) for the current link quality.
+static uint8_t interval_shift(uint32_t now_ms) {
+    switch (link_quality_get_level(now_ms)) {
+        case LINK_QUALITY_DEGRADED:
+            return 1;
+        case LINK_QUALITY_POOR:
+            return 2;
+        default:
+            return 0; // Good, or a display that does not acknowledge
+    }
+}
+
+// --- Public API Implementation ---
+
+void status_publisher_init(void) {
+    current_battery_mv = sent_battery_mv = 0;
+    current_signal = sent_signal = 0;
+    current_speed_kmh = sent_speed_kmh = 0;
+    current_distance_m = sent_distance_m = 0;
+    current_maneuver = sent_maneuver = NAV_MANEUVER_NO_FIX; // Until nav_logic publishes
+    current_arg = sent_arg = 0;
+    last_battery_tx_ms = last_speed_tx_ms = last_nav_tx_ms = last_keyframe_ms = last_tx_ms = 0;
+    keyframe_pending = KEYFRAME_ALL;
+    was_connected = false;
+    nav_retries = 0;
+    resend_due = false;
+    log_info("StatusPub: Initialized.");
+}
+
+void status_publisher_set_signal(uint8_t signal_status) {
+    current_signal = signal_status;
+}
+
+void status_publisher_set_speed(uint8_t speed_kmh) {
+    current_speed_kmh = speed_kmh;
+}
+
+void status_publisher_set_battery(uint16_t battery_mv) {
+    current_battery_mv = battery_mv;
+}
+
+void status_publisher_set_nav(uint8_t maneuver, uint8_t arg, uint16_t distance_m) {
+    current_maneuver = maneuver;
+    current_arg = arg;
+    current_distance_m = distance_m;
+}
+
+void status_publisher_request_keyframe(void) {
+    keyframe_pending = KEYFRAME_ALL;
+}
+
+void status_publisher_update(uint32_t now_ms) {
+    const settings_t *cfg = settings_get();
+    bool transport_up = ble_uart_is_connected();
+    bool connected = link_quality_is_connected(transport_up, now_ms);
+    if (connected && !was_connected) {
+        keyframe_pending = KEYFRAME_ALL; // Fresh link: give the display the full picture
+    }
+    was_connected = connected;
+    if (!connected) {
+        // ACKs stopped with the radio still up: keep probing with heartbeats,
+        // which the display acknowledges; its first ACK brings the link back.
+        if (transport_up && now_ms - last_tx_ms >= cfg->status_heartbeat_ms && ble_uart_send_heartbeat()) {
+            last_tx_ms = now_ms;
+        }
+        return;
+    }
+
+    uint8_t shift = interval_shift(now_ms);
+    if (!keyframe_pending && now_ms - last_keyframe_ms >= ((uint32_t)cfg->status_keyframe_ms << shift)) {
+        keyframe_pending = KEYFRAME_ALL; // Periodic refresh
+    }
+    if (keyframe_pending) {
+        send_keyframe(now_ms);
+        return;
+    }
+
+    // Status fields: collect every changed field whose deadline has passed into one frame.
+    uint8_t mask = 0;
+    if (current_signal != sent_signal) {
+        mask |= BLE_FIELD_SIGNAL; // Edges go out immediately
+    }
+    if (current_speed_kmh != sent_speed_kmh && now_ms - last_speed_tx_ms >= ((uint32_t)cfg->status_speed_ms << shift)) {
+        mask |= BLE_FIELD_SPEED;
+    }
+    if (current_battery_mv != sent_battery_mv && now_ms - last_battery_tx_ms >= cfg->status_battery_ms) {
+        mask |= BLE_FIELD_BATTERY;
+    }
+    if (mask) {
+        if (ble_uart_send_field_update(mask, current_battery_mv, current_signal, current_speed_kmh)) {
+            if (mask & BLE_FIELD_SIGNAL) {
+                sent_signal = current_signal;
+            }
+            if (mask & BLE_FIELD_SPEED) {
+                sent_speed_kmh = current_speed_kmh;
+                last_speed_tx_ms = now_ms;
+            }
+            if (mask & BLE_FIELD_BATTERY) {
+                sent_battery_mv = current_battery_mv;
+                last_battery_tx_ms = now_ms;
+            }
+            last_tx_ms = now_ms;
+        }
+    }
+
+    // Navigation: new maneuvers are sent at once as critical frames, and resent
+    // (with the latest distance) if lost; distance countdowns are rate limited.
+    bool maneuver_changed = current_maneuver != sent_maneuver || current_arg != sent_arg;
+    bool distance_due = current_distance_m != sent_distance_m &&
+                        now_ms - last_nav_tx_ms >= ((uint32_t)cfg->status_nav_ms << shift);
+    if (link_quality_critical_lost(now_ms)) {
+        if (nav_retries < LINK_RETRANSMIT_MAX) {
+            resend_due = true; // Until the UART takes it
+        } else {
+            log_warn("StatusPub: Maneuver not acknowledged after %u resends", nav_retries);
+        }
+    }
+    if (maneuver_changed) {
+        nav_retries = 0;
+        resend_due = false; // The new maneuver goes out critical anyway
+    }
+    if (maneuver_changed || distance_due || resend_due) {
+        bool critical = maneuver_changed || resend_due;
+        if (ble_uart_send_nav_update(current_maneuver, current_arg, current_distance_m, critical)) {
+            sent_maneuver = current_maneuver;
+            sent_arg = current_arg;
+            sent_distance_m = current_distance_m;
+            last_nav_tx_ms = now_ms;
+            last_tx_ms = now_ms;
+            if (resend_due) {
+                resend_due = false;
+                nav_retries++;
+                link_quality_on_retransmit();
+                log_debug("StatusPub: Maneuver lost, resend %u", nav_retries);
+            }
+        }
+    }
+
+    // Not scaled with the link level: the display's deadlines are fixed.
+    if (now_ms - last_tx_ms >= cfg->status_heartbeat_ms && ble_uart_send_heartbeat()) {
+        last_tx_ms = now_ms;
+    }
+}
@@ -1,12 +1,17 @@
 /**
  * @file logger.c
  * @brief Simple logging utility for embedded systems.
- * Sends log messages over a designated UART interface.
+ * Sends log messages on the log channel of the link (link_mux.h).
+ * Text output (LOG_TOKENIZED 0); tokenized records are queued by common/src/util/log_queue.c.
  */
 
 #include "util/logger.h"
 #include "hal/uart.h"
+#include "link_mux.h"
 #include "config.h" // Include config for LOG_LEVEL, LOG_UART_ID etc.
+#if LOG_TO_DEBUG_PIN
+#include "hal/debug_uart.h"
+#endif
 #include <stdio.h>  // For vsnprintf
 #include <stdarg.h> // For va_list, va_start, va_end
 #include <string.h> // For strlen
@@ -18,32 +23,52 @@
 
 // --- Internal State ---
 static bool logger_initialized = false;
+static uint16_t lines_dropped = 0; // Lines refused by the link since the last summary
 
 // --- Helper Function ---
-// Sends the provided string over the designated log UART.
+// Opens the log output: the debug pin software UART or LOG_UART_ID.
+static void log_output_init(void) {
+#if LOG_TO_DEBUG_PIN
+    hal_debug_uart_init(LOG_DEBUG_BAUD);
+#else
+    hal_uart_init(LOG_UART_ID, LOG_UART_BAUD, 8, 1, 0);
+#endif
+}
+
+// Sends the provided string on the log channel. Lines the link refuses (data
+// frames have priority, and logs have a byte budget) are counted, and a
+// summary goes out ahead of the next line that fits.
 static void log_send_string(const char *str) {
     // Ensure logger is initialized before attempting to write.
-    // A robust implementation might queue messages if called too early.
     if (!logger_initialized) {
-       return; // Or handle error appropriately
+       return;
+    }
+    if (lines_dropped != 0) {
+        char note[40];
+        int n = snprintf(note, sizeof(note), "[WRN] %u log lines dropped\r\n", lines_dropped);
+        if (!link_mux_send(LINK_CHANNEL_LOG, (const uint8_t*)note, (size_t)n)) {
+            if (lines_dropped != UINT16_MAX) lines_dropped++;
+            return;
+        }
+        lines_dropped = 0;
+    }
+    if (!link_mux_send(LINK_CHANNEL_LOG, (const uint8_t*)str, strlen(str)) && lines_dropped != UINT16_MAX) {
+        lines_dropped++;
     }
-    hal_uart_write(LOG_UART_ID, (const uint8_t*)str, strlen(str));
 }
 
 // --- Public API Implementation ---
 
 void logger_init(void) {
-    // Initialize the UART peripheral designated for logging
-    hal_uart_init(LOG_UART_ID, LOG_UART_BAUD, 8, 1, 0);
+    // Initialize the peripheral designated for logging
+    log_output_init();
     logger_initialized = true;
+    log_queue_init(); // Tokenized records queue up from here on
     log_send_string("\r\n--- Logger Initialized ---\r\n");
 }
 
 void log_message(log_level_t level, const char *file, int line, const char *format, ...) {
-    // Check if the message level is high enough to be logged
-    if (level < LOG_LEVEL) {
-        return;
-    }
+    // Levels below LOG_LEVEL are compiled out by the log_* macros and never get here
 
     char buffer[LOG_BUFFER_SIZE];
     char *buf_ptr = buffer;
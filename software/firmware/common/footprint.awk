@@ -0,0 +1,53 @@
+# Flash and RAM per source file, from the .sym listing both Makefiles write
+# with 'avr-nm -n -S -l' (make footprint). Each sized symbol is charged to
+# the file its debug info names: code and PROGMEM (t/T/w/W) to flash,
+# initialized data (d/D) to flash and RAM, zeroed data (b/B) to RAM.
+# Symbols without a file (libgcc, avr-libc, startup) are grouped together.
+# EEPROM contents (0x810000 and up) and the unallocated .logfmt are skipped.
+#
+# Prints "<file> <flash> <ram>" per file, unsorted; with -v total=1 only
+# the totals.
+
+BEGIN { FS = "\t" }
+
+{
+    n = split($1, f, " ")
+    if (n < 4) next                     # No size: linker-defined labels
+    addr = f[1]; type = f[3]
+    if (addr >= "00810000") next        # .eeprom image (and .fuse, .lock)
+    size = 0
+    for (i = 1; i <= length(f[2]); ++i) {
+        size = size * 16 + index("0123456789abcdef", tolower(substr(f[2], i, 1))) - 1
+    }
+
+    file = $2
+    sub(/:[0-9]+$/, "", file)
+    if (file == "") {
+        file = "(libc/startup)"
+    } else if (match(file, /\/common\/(src|include)\//)) {
+        file = "common/" substr(file, RSTART + RLENGTH)
+    } else if (match(file, /\/(src|include)\//)) {
+        file = substr(file, RSTART + RLENGTH)
+    }
+
+    if (type ~ /^[tTwW]$/) {
+        flash[file] += size
+    } else if (type ~ /^[dDvV]$/) {
+        flash[file] += size
+        ram[file] += size
+    } else if (type ~ /^[bB]$/) {
+        ram[file] += size
+    } else {
+        next
+    }
+    seen[file] = 1
+}
+
+END {
+    for (file in seen) {
+        total_flash += flash[file]
+        total_ram += ram[file]
+        if (!total) printf "%-32s %7d %6d\n", file, flash[file], ram[file]
+    }
+    if (total) printf "%-32s %7d %6d\n", "Total (symbols)", total_flash, total_ram
+}
@@ -0,0 +1,332 @@
+#ifndef BLE_PROTOCOL_H
+#define BLE_PROTOCOL_H
+
+/**
+ * @file ble_protocol.h
+ * @brief Binary frame protocol shared by the Brain Module and Display Module.
+ *
+ * Every message on the BLE UART link is sent as one frame:
+ *
+ *   START | MSG_ID | LEN | PAYLOAD[LEN] | CRC8 | END
+ *
+ * - START/END are BLE_PACKET_START_BYTE / BLE_PACKET_END_BYTE from config.h.
+ * - LEN is the payload length in bytes (0..BLE_PROTO_MAX_PAYLOAD).
+ * - CRC8 is CRC-8/CCITT (poly 0x07, init 0x00) over MSG_ID, LEN and PAYLOAD.
+ * - All multi-byte payload fields are fixed-width and little-endian.
+ *
+ * There is no byte stuffing: the receiver relies on LEN to find the end of
+ * the payload and resynchronises on the next START byte after any CRC or
+ * framing error.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h> // For size_t
+#include "config.h" // For BLE_PACKET_START_BYTE / BLE_PACKET_END_BYTE
+
+#if !defined(BLE_PACKET_START_BYTE) || !defined(BLE_PACKET_END_BYTE)
+#error "config.h must define BLE_PACKET_START_BYTE and BLE_PACKET_END_BYTE"
+#endif
+
+// --- Frame Geometry ---
+#define BLE_PROTO_MAX_PAYLOAD   48 // Largest payload either side will send or accept
+#define BLE_PROTO_OVERHEAD      5  // START + ID + LEN + CRC + END
+#define BLE_PROTO_MAX_FRAME     (BLE_PROTO_MAX_PAYLOAD + BLE_PROTO_OVERHEAD)
+
+// --- Message Identifiers ---
+typedef enum {
+    BLE_MSG_NAV_UPDATE    = 0x01, // Brain -> Display: maneuver code and distance
+    BLE_MSG_STATUS_UPDATE = 0x02, // Brain -> Display: battery, turn signals and speed (keyframe)
+    BLE_MSG_FIELD_UPDATE  = 0x03, // Brain -> Display: only the status fields that changed
+    BLE_MSG_LINK_ACK      = 0x04, // Display -> Brain: which sequenced frames arrived
+    BLE_MSG_HEARTBEAT     = 0x05, // Brain -> Display: nothing else sent for STATUS_HEARTBEAT_INTERVAL_MS
+    BLE_MSG_KEYFRAME_REQUEST = 0x06, // Display -> Brain: send the full status and nav now (no payload)
+    BLE_MSG_ROUTE_BEGIN   = 0x10, // Phone -> Brain: start loading a route (replaces the stored one)
+    BLE_MSG_ROUTE_POINTS  = 0x11, // Phone -> Brain: consecutive route points
+    BLE_MSG_ROUTE_END     = 0x12, // Phone -> Brain: all points sent, activate the route
+    BLE_MSG_ROUTE_ACK     = 0x13, // Brain -> Phone: flow control for the route load
+    BLE_MSG_OTA_BEGIN     = 0x20, // Phone -> Brain: start a Display Module firmware update
+    BLE_MSG_OTA_DATA      = 0x21, // Phone -> Brain: image bytes
+    BLE_MSG_OTA_END       = 0x22, // Phone -> Brain: image complete, verify and run it
+    BLE_MSG_OTA_ACK       = 0x23, // Brain -> Phone: bootloader progress (relayed BLE_MSG_BOOT_ACK)
+    BLE_MSG_BOOT_BEGIN    = 0x28, // Brain -> Display: relayed BLE_MSG_OTA_BEGIN
+    BLE_MSG_BOOT_DATA     = 0x29, // Brain -> Display: relayed BLE_MSG_OTA_DATA
+    BLE_MSG_BOOT_END      = 0x2A, // Brain -> Display: relayed BLE_MSG_OTA_END
+    BLE_MSG_BOOT_ACK      = 0x2B, // Display bootloader -> Brain: flow control for the update
+    BLE_MSG_CONFIG_SET    = 0x30, // Phone -> Brain: change one persistent setting
+    BLE_MSG_CONFIG_GET    = 0x31, // Phone -> Brain: read one setting
+    BLE_MSG_CONFIG_VALUE  = 0x32, // Brain -> Phone: a setting's value, answering SET and GET
+    BLE_MSG_DISPLAY_CONFIG_SET   = 0x38, // Brain -> Display: relayed BLE_MSG_CONFIG_SET
+    BLE_MSG_DISPLAY_CONFIG_GET   = 0x39, // Brain -> Display: relayed BLE_MSG_CONFIG_GET
+    BLE_MSG_DISPLAY_CONFIG_VALUE = 0x3A, // Display -> Brain: relayed back as BLE_MSG_CONFIG_VALUE
+    BLE_MSG_TRACE_CONTROL = 0x7C, // Host -> Brain: start or stop a ride trace capture or playback
+    BLE_MSG_STATS_REQUEST = 0x7D, // Host -> either module: send the profiling results (util/perf.h)
+    BLE_MSG_STATS         = 0x7E, // Either module -> host: one item of a profiling report
+    BLE_MSG_LOG           = 0x7F, // Either module -> host: one tokenized log record (util/logger.h)
+} ble_msg_id_t;
+
+// --- Payload Layouts ---
+
+// Sequenced frames (NAV, STATUS, FIELD, HEARTBEAT) start with seq (u8): bits 6..0
+// count the Brain's sequenced frames mod 128, bit 7 asks for an immediate
+// BLE_MSG_LINK_ACK (set on frames the Brain retransmits if lost).
+#define BLE_SEQ_OFS             0
+#define BLE_SEQ_MASK            0x7F
+#define BLE_SEQ_ACK_REQUEST     0x80
+
+// BLE_MSG_NAV_UPDATE: seq | distance_m (u16) | maneuver (u8, nav_maneuver_t) | arg (u8)
+// The display owns the icon and text for each maneuver, so no strings are sent.
+#define BLE_NAV_OFS_DISTANCE    1
+#define BLE_NAV_OFS_MANEUVER    3
+#define BLE_NAV_OFS_ARG         4
+#define BLE_NAV_LEN             5
+
+// BLE_MSG_STATUS_UPDATE: seq | battery_mv (u16) | signal_status (u8) | speed_kmh (u8)
+#define BLE_STATUS_OFS_BATTERY  1
+#define BLE_STATUS_OFS_SIGNAL   3
+#define BLE_STATUS_OFS_SPEED    4
+#define BLE_STATUS_LEN          5
+
+// BLE_MSG_FIELD_UPDATE: seq | field_mask (u8) followed by each flagged field, in
+// bit order, using the same widths as BLE_MSG_STATUS_UPDATE.
+#define BLE_FIELD_OFS_MASK      1
+#define BLE_FIELD_OFS_DATA      2
+#define BLE_FIELD_BATTERY       (1 << 0) // battery_mv (u16)
+#define BLE_FIELD_SIGNAL        (1 << 1) // signal_status (u8)
+#define BLE_FIELD_SPEED         (1 << 2) // speed_kmh (u8)
+#define BLE_FIELD_ALL           (BLE_FIELD_BATTERY | BLE_FIELD_SIGNAL | BLE_FIELD_SPEED)
+#define BLE_FIELD_UPDATE_MAX_LEN (BLE_FIELD_OFS_DATA + BLE_STATUS_LEN - 1)
+
+// BLE_MSG_HEARTBEAT: seq only. Keeps the display's liveness deadline while nothing changes.
+#define BLE_HEARTBEAT_LEN       1
+
+// BLE_MSG_LINK_ACK: last_seq (u8, newest seq received) | recv_mask (u8, bit n set
+// if last_seq - n arrived) | rx_count (u8, sequenced frames received, mod 256).
+// Sent at once for BLE_SEQ_ACK_REQUEST, otherwise every LINK_ACK_INTERVAL_MS
+// while frames arrive. 8 bytes on the wire.
+#define BLE_LINK_ACK_LEN        3
+
+// Route point as sent in BLE_MSG_ROUTE_POINTS and kept in the route store:
+// lat_e6 (i32) | lon_e6 (i32) | maneuver (u8, nav_maneuver_t) | arg (u8)
+#define BLE_ROUTE_PT_OFS_LAT    0
+#define BLE_ROUTE_PT_OFS_LON    4
+#define BLE_ROUTE_PT_OFS_MANEUVER 8
+#define BLE_ROUTE_PT_OFS_ARG    9
+#define BLE_ROUTE_PT_LEN        10
+
+// BLE_MSG_ROUTE_BEGIN: point_count (u16) | route_id (u16)
+#define BLE_ROUTE_BEGIN_LEN     4
+// BLE_MSG_ROUTE_POINTS: first_index (u16) | 1..BLE_ROUTE_PTS_PER_FRAME points
+#define BLE_ROUTE_PTS_OFS_FIRST 0
+#define BLE_ROUTE_PTS_OFS_DATA  2
+#define BLE_ROUTE_PTS_PER_FRAME ((BLE_PROTO_MAX_PAYLOAD - BLE_ROUTE_PTS_OFS_DATA) / BLE_ROUTE_PT_LEN)
+// BLE_MSG_ROUTE_END: point_count (u16), must match BLE_MSG_ROUTE_BEGIN
+#define BLE_ROUTE_END_LEN       2
+// BLE_MSG_ROUTE_ACK: next_index (u16) | status (u8, ble_route_status_t)
+#define BLE_ROUTE_ACK_LEN       3
+
+// The phone sends the next POINTS frame only after an ACK, because EEPROM
+// writes take ~3.4 ms per byte. On anything but OK it resends from next_index.
+typedef enum {
+    BLE_ROUTE_OK       = 0, // Points up to next_index are stored
+    BLE_ROUTE_BUSY     = 1, // Previous frame still being written, resend later
+    BLE_ROUTE_SEQUENCE = 2, // first_index was not next_index
+    BLE_ROUTE_TOO_LONG = 3, // point_count exceeds the store capacity
+    BLE_ROUTE_INVALID  = 4  // Malformed frame, or END without a matching BEGIN
+} ble_route_status_t;
+
+// Display Module firmware update. The phone (or host_tools/flash_firmware.py)
+// sends BLE_MSG_OTA_* to the Brain, which relays each frame to the display as
+// the matching BLE_MSG_BOOT_* (ID | BLE_OTA_RELAY_BIT) and relays the
+// bootloader's BLE_MSG_BOOT_ACK back as BLE_MSG_OTA_ACK. Payloads are the same
+// on both hops.
+//
+// The first BOOT_BEGIN restarts the display into its bootloader, which
+// answers BLE_OTA_READY; the sender repeats BEGIN until it gets BLE_OTA_OK.
+// The image then goes out in BLE_OTA_CHUNK byte DATA frames, in order. The
+// bootloader programs flash a page (BLE_OTA_PAGE_SIZE) at a time while it
+// receives the next one, so the sender keeps up to BLE_OTA_WINDOW_PAGES pages
+// beyond the last acknowledged offset in flight. END carries the CRC of the
+// whole image; the bootloader checks it against flash before running it.
+#define BLE_OTA_RELAY_BIT       0x08
+#define BLE_OTA_PAGE_SIZE       128 // ATmega328P flash page (SPM_PAGESIZE)
+#define BLE_OTA_CHUNK           32  // Image bytes per DATA frame
+#define BLE_OTA_WINDOW_PAGES    2   // Pages in flight: one programming, one arriving
+// BLE_MSG_OTA_BEGIN: image_len (u16, bytes)
+#define BLE_OTA_BEGIN_LEN       2
+// BLE_MSG_OTA_DATA: offset (u16) | BLE_OTA_CHUNK image bytes (fewer in the last frame)
+#define BLE_OTA_DATA_OFS_BYTES  2
+#define BLE_OTA_DATA_MAX_LEN    (BLE_OTA_DATA_OFS_BYTES + BLE_OTA_CHUNK)
+// BLE_MSG_OTA_END: image_len (u16) | image_crc (u16, CRC-16/XMODEM over image_len bytes)
+#define BLE_OTA_END_LEN         4
+// BLE_MSG_OTA_ACK: offset (u16) | status (u8, ble_ota_status_t). With BLE_OTA_OK,
+// the image bytes programmed and verified so far; otherwise where to resume.
+#define BLE_OTA_ACK_LEN         3
+
+typedef enum {
+    BLE_OTA_READY    = 0, // Bootloader running, send BEGIN
+    BLE_OTA_OK       = 1, // Pages up to offset are programmed and verified
+    BLE_OTA_SEQUENCE = 2, // DATA offset was not the next one, resend from offset
+    BLE_OTA_VERIFY   = 3, // A page read back wrong, resend from offset
+    BLE_OTA_TOO_LONG = 4, // image_len exceeds the application section
+    BLE_OTA_CRC      = 5, // Image CRC mismatch, start again with BEGIN
+    BLE_OTA_DONE     = 6  // Image verified, the display restarts into it
+} ble_ota_status_t;
+
+// Persistent settings (modules/settings.h in each tree). Every setting is a
+// u16 under a one-byte key; keys with BLE_CONFIG_KEY_DISPLAY set belong to the
+// Display Module, and the Brain relays their SET and GET as
+// BLE_MSG_DISPLAY_CONFIG_* (ID | BLE_OTA_RELAY_BIT, as for the update) and the
+// display's answer back as BLE_MSG_CONFIG_VALUE. A SET takes effect at once
+// unless noted, and is saved to EEPROM shortly after the last change.
+#define BLE_CONFIG_KEY_DISPLAY  0x80
+// BLE_MSG_CONFIG_SET: key (u8) | value (u16)
+#define BLE_CONFIG_SET_LEN      3
+// BLE_MSG_CONFIG_GET: key (u8)
+#define BLE_CONFIG_GET_LEN      1
+// BLE_MSG_CONFIG_VALUE: key (u8) | value (u16, the current one) | status (u8, ble_config_status_t)
+#define BLE_CONFIG_VALUE_LEN    4
+
+typedef enum {
+    // Brain Module (defaults in its config.h)
+    BLE_CONFIG_BATTERY_R1_OHMS      = 0x00, // BATTERY_R1_OHMS
+    BLE_CONFIG_BATTERY_R2_OHMS      = 0x01, // BATTERY_R2_OHMS
+    BLE_CONFIG_BATTERY_VREF_MV      = 0x02, // BATTERY_ADC_VREF_MV
+    BLE_CONFIG_WHEEL_CIRCUMFERENCE_MM = 0x03, // SPEED_WHEEL_CIRCUMFERENCE_MM
+    BLE_CONFIG_WHEEL_PULSES_PER_REV = 0x04, // SPEED_PULSES_PER_REV
+    BLE_CONFIG_SPEED_SMOOTHING_SHIFT = 0x05, // SPEED_SMOOTHING_SHIFT
+    BLE_CONFIG_SIGNAL_DEBOUNCE_MS   = 0x06, // SIGNAL_DEBOUNCE_TIME_MS
+    BLE_CONFIG_STATUS_SPEED_MS      = 0x07, // STATUS_SPEED_MIN_INTERVAL_MS
+    BLE_CONFIG_STATUS_NAV_MS        = 0x08, // STATUS_NAV_MIN_INTERVAL_MS
+    BLE_CONFIG_STATUS_KEYFRAME_MS   = 0x09, // STATUS_KEYFRAME_INTERVAL_MS
+    BLE_CONFIG_STATUS_BATTERY_MS    = 0x0A, // STATUS_BATTERY_INTERVAL_MS (sampling period, applies at once)
+    BLE_CONFIG_STATUS_HEARTBEAT_MS  = 0x0B, // STATUS_HEARTBEAT_INTERVAL_MS
+    BLE_CONFIG_DEFAULTS             = 0x7F, // SET only: every Brain setting back to its default
+    // Display Module (defaults in its config.h)
+    BLE_CONFIG_DISPLAY_BATTERY_R1_OHMS = 0x80, // BATTERY_SENSE_R1_OHMS
+    BLE_CONFIG_DISPLAY_BATTERY_R2_OHMS = 0x81, // BATTERY_SENSE_R2_OHMS
+    BLE_CONFIG_DISPLAY_BATTERY_VREF_MV = 0x82, // BATTERY_ADC_VREF_MV
+    BLE_CONFIG_DISPLAY_LAYOUT          = 0x83, // SCREEN_DEFAULT_LAYOUT (ui_layout_id_t: day, night, minimal)
+    BLE_CONFIG_DISPLAY_SCREEN_MS       = 0x84, // SCREEN_UPDATE_INTERVAL_MS (applies at once)
+    BLE_CONFIG_DISPLAY_BATTERY_MS      = 0x85, // BATTERY_UPDATE_INTERVAL_MS (applies at once)
+    BLE_CONFIG_DISPLAY_DEFAULTS        = 0xFF  // SET only: every display setting back to its default
+} ble_config_key_t;
+
+typedef enum {
+    BLE_CONFIG_OK      = 0, // Value is the setting's current value
+    BLE_CONFIG_UNKNOWN = 1, // No such key
+    BLE_CONFIG_RANGE   = 2, // Value outside the setting's range; the old one is kept
+    BLE_CONFIG_INVALID = 3  // Malformed frame
+} ble_config_status_t;
+
+// BLE_MSG_TRACE_CONTROL: command (u8, ble_trace_command_t) | speed (u8, PLAY only:
+// 1 = real time, N = N times faster, 0 = as fast as the trace reads)
+#define BLE_TRACE_CONTROL_LEN   2
+
+typedef enum {
+    BLE_TRACE_STOP    = 0,
+    BLE_TRACE_CAPTURE = 1,
+    BLE_TRACE_PLAY    = 2
+} ble_trace_command_t;
+
+// BLE_MSG_STATS_REQUEST: flags (u8, optional)
+#define BLE_STATS_FLAG_RESET    (1 << 0) // Clear the results once the report has been sent
+
+// BLE_MSG_STATS: kind (u8, ble_stats_kind_t) | fields below. A report is one
+// HEADER, then every SECTION, then every COUNTER. Names are ASCII, not terminated.
+// HEADER:  window_ms (u32) | section_count (u8) | counter_count (u8) | cpu_hz (u32)
+// SECTION: index (u8) | count (u32) | min (u32) | max (u32) | avg (u32) | name, in CPU cycles
+// COUNTER: index (u8) | value (u32) | name
+#define BLE_STATS_HEADER_LEN    11
+#define BLE_STATS_SECTION_LEN   18 // Without the name
+#define BLE_STATS_COUNTER_LEN   6  // Without the name
+
+typedef enum {
+    BLE_STATS_KIND_HEADER  = 0,
+    BLE_STATS_KIND_SECTION = 1,
+    BLE_STATS_KIND_COUNTER = 2
+} ble_stats_kind_t;
+
+// --- Little-Endian Field Helpers ---
+
+static inline void ble_put_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline uint16_t ble_get_u16(const uint8_t *p) {
+    return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+static inline void ble_put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t ble_get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// --- Frame Parser ---
+
+// Receiver states, advanced one byte at a time by ble_parser_feed()
+typedef enum {
+    BLE_PARSE_WAIT_START,
+    BLE_PARSE_MSG_ID,
+    BLE_PARSE_LENGTH,
+    BLE_PARSE_PAYLOAD,
+    BLE_PARSE_CRC,
+    BLE_PARSE_END
+} ble_parse_state_t;
+
+// Parser context. After ble_parser_feed() returns true, msg_id, length and
+// payload hold the completed frame until the next byte is fed.
+typedef struct {
+    ble_parse_state_t state;
+    uint8_t msg_id;
+    uint8_t length;
+    uint8_t index;
+    uint8_t crc;
+    uint8_t payload[BLE_PROTO_MAX_PAYLOAD];
+    uint16_t crc_errors;     // Frames dropped because the CRC did not match
+    uint16_t framing_errors; // Frames dropped for a bad length or missing END byte
+} ble_parser_t;
+
+/**
+ * @brief Advances a CRC-8/CCITT (poly 0x07) with one byte.
+ * @param crc The running CRC value (start with 0).
+ * @param data The next byte to include.
+ * @return The updated CRC value.
+ */
+uint8_t ble_crc8_update(uint8_t crc, uint8_t data);
+
+/**
+ * @brief Encodes a message into a complete frame.
+ * @param out Buffer receiving the frame.
+ * @param out_size Size of the output buffer (BLE_PROTO_MAX_FRAME is always enough).
+ * @param msg_id Message identifier (ble_msg_id_t).
+ * @param payload Pointer to the payload bytes (may be NULL if length is 0).
+ * @param length Number of payload bytes.
+ * @return Number of bytes written to out, or 0 if the frame does not fit.
+ */
+size_t ble_frame_encode(uint8_t *out, size_t out_size, uint8_t msg_id, const uint8_t *payload, uint8_t length);
+
+/**
+ * @brief Resets a parser to wait for the next START byte.
+ * Error counters are cleared as well.
+ * @param parser The parser context.
+ */
+void ble_parser_init(ble_parser_t *parser);
+
+/**
+ * @brief Feeds one received byte into the frame parser.
+ * @param parser The parser context.
+ * @param byte The byte received from the UART.
+ * @return true if this byte completed a valid frame, false otherwise.
+ */
+bool ble_parser_feed(ble_parser_t *parser, uint8_t byte);
+
+#endif // BLE_PROTOCOL_H
@@ -0,0 +1,35 @@
+#ifndef HAL_ADC_H
+#define HAL_ADC_H
+
+/**
+ * @file adc.h
+ * @brief Hardware Abstraction Layer for background ADC sampling, shared by both modules.
+ * One channel is converted in the background, triggered by the Timer0 1 ms
+ * compare match, so sampling adds no wake-ups of its own. The conversion
+ * complete ISR sums 16 samples into one 12-bit value (oversampling and
+ * decimation) and feeds it through a moving-average filter; readers only
+ * copy the latest filtered value.
+ */
+
+#include <stdint.h>
+#include "config.h" // For ADC_FILTER_SHIFT
+
+#define HAL_ADC_OVERSAMPLE   16   // 10-bit samples per decimated value (4^2 for 2 extra bits)
+#define HAL_ADC_FILTERED_MAX 4092 // Full scale of the 12-bit result (16 * 1023 / 4)
+
+/**
+ * @brief Starts background sampling of one ADC channel.
+ * Uses AVCC (the 3.3 V rail) as the reference and a 125 kHz ADC clock.
+ * Takes one decimated reading synchronously (~2 ms), so the filtered value
+ * is valid as soon as this returns. Requires hal_timer_init() for the trigger.
+ * @param channel ADC input channel (0..7).
+ */
+void hal_adc_start(uint8_t channel);
+
+/**
+ * @brief Returns the latest filtered reading. Never blocks.
+ * @return 12-bit value (0..HAL_ADC_FILTERED_MAX).
+ */
+uint16_t hal_adc_get_filtered(void);
+
+#endif // HAL_ADC_H
@@ -0,0 +1,39 @@
+#ifndef HAL_DEBUG_UART_H
+#define HAL_DEBUG_UART_H
+
+/**
+ * @file debug_uart.h
+ * @brief Transmit-only software UART on the debug pin (LOG_TO_DEBUG_PIN builds).
+ * Timer2 in CTC mode interrupts once per bit and shifts the next bit out of
+ * DEBUG_TX_PORT/DEBUG_TX_BIT, 8N1, so logs can leave the BLE UART entirely.
+ * At 38400 baud the ISR costs roughly 12% of the CPU while bytes are going out.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "config.h" // For DEBUG_TX_PORT, DEBUG_TX_DDR, DEBUG_TX_BIT
+
+/**
+ * @brief Drives the debug pin idle high and starts Timer2 (clock gated back on).
+ * @param baud_rate Bit rate; 2 MHz / baud_rate should be close to an integer (19200, 38400).
+ */
+void hal_debug_uart_init(uint32_t baud_rate);
+
+/**
+ * @brief Queues bytes for transmission. Never blocks.
+ * @return Number of bytes queued (fewer than length if the buffer is full).
+ */
+size_t hal_debug_uart_write(const uint8_t *data, size_t length);
+
+/**
+ * @brief Free space in the transmit buffer, in bytes.
+ */
+size_t hal_debug_uart_tx_space(void);
+
+/**
+ * @brief Checks whether every queued byte, stop bit included, has been sent.
+ */
+bool hal_debug_uart_tx_idle(void);
+
+#endif // HAL_DEBUG_UART_H
@@ -0,0 +1,40 @@
+#ifndef HAL_EEPROM_H
+#define HAL_EEPROM_H
+
+/**
+ * @file hal_eeprom.h
+ * @brief Hardware Abstraction Layer for the on-chip EEPROM.
+ * Reads are immediate. Writes take ~3.4 ms per byte, so they are started one
+ * byte at a time and never waited for; callers poll hal_eeprom_is_ready().
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HAL_EEPROM_SIZE 1024 // ATmega328P
+
+/**
+ * @brief Reads a block of bytes.
+ * Waits for a write still in progress before reading.
+ * @param address Byte address of the first byte.
+ * @param data Destination buffer.
+ * @param length Number of bytes to read.
+ */
+void hal_eeprom_read(uint16_t address, void *data, uint16_t length);
+
+/**
+ * @brief Checks whether the EEPROM can accept another write.
+ * @return true if no write is in progress.
+ */
+bool hal_eeprom_is_ready(void);
+
+/**
+ * @brief Starts writing one byte without waiting for completion.
+ * The byte is skipped (saving a write cycle) if it already holds the value.
+ * @param address Byte address.
+ * @param value The value to store.
+ * @return true if the byte is stored or being stored, false if the EEPROM is busy.
+ */
+bool hal_eeprom_write_byte(uint16_t address, uint8_t value);
+
+#endif // HAL_EEPROM_H
@@ -0,0 +1,42 @@
+#ifndef HAL_TIMER_H
+#define HAL_TIMER_H
+
+/**
+ * @file hal_timer.h
+ * @brief Hardware Abstraction Layer for the system millisecond tick.
+ * Timer0 runs in CTC mode with a 1 ms compare match; the rest of the firmware
+ * reads time only through these functions.
+ */
+
+#include <stdint.h>
+#include "config.h" // For F_CPU
+
+/**
+ * @brief Starts the 1 ms system tick on Timer0 (CTC, prescaler 64).
+ * Requires global interrupts to be enabled for the tick to advance.
+ */
+void hal_timer_init(void);
+
+/**
+ * @brief Returns milliseconds since hal_timer_init().
+ * The 32-bit counter is read atomically; it wraps after ~49.7 days, so
+ * compare timestamps by subtraction.
+ * @return Current system time in milliseconds.
+ */
+uint32_t hal_timer_millis(void);
+
+/**
+ * @brief Returns microseconds since hal_timer_init(), with 4 us resolution.
+ * Intended for measuring short intervals (wraps after ~71 minutes).
+ * @return Current system time in microseconds.
+ */
+uint32_t hal_timer_micros(void);
+
+/**
+ * @brief Moves the millisecond counter forward.
+ * Used after power-down sleep, when Timer0 was stopped.
+ * @param ms Milliseconds to add.
+ */
+void hal_timer_advance_ms(uint32_t ms);
+
+#endif // HAL_TIMER_H
@@ -0,0 +1,72 @@
+#ifndef LINK_MUX_H
+#define LINK_MUX_H
+
+/**
+ * @file link_mux.h
+ * @brief Shares the BLE UART between protocol frames and log output.
+ *
+ * Writes are tagged with a logical channel:
+ * - LINK_CHANNEL_DATA: protocol frames. Queued whenever the whole frame fits.
+ * - LINK_CHANNEL_LOG: diagnostics. Queued only if LINK_DATA_RESERVE_BYTES of
+ *   the transmit buffer stay free for data afterwards, and only within the log
+ *   budget (LOG_BUDGET_BYTES_PER_S, a token bucket of LOG_BUDGET_BURST_BYTES).
+ *
+ * Log output goes to LOG_UART_ID, or to the software UART on the debug pin
+ * when LOG_TO_DEBUG_PIN is set (hal/debug_uart.h). Off the shared link the
+ * budget still applies but no space is reserved.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "config.h" // For LOG_UART_ID, BLE_UART_ID and the LOG_BUDGET_* settings
+
+#ifndef LOG_TO_DEBUG_PIN
+#define LOG_TO_DEBUG_PIN 0
+#endif
+#ifndef LOG_BUDGET_BYTES_PER_S
+#define LOG_BUDGET_BYTES_PER_S 0 // 0: no budget
+#endif
+#ifndef LOG_BUDGET_BURST_BYTES
+#define LOG_BUDGET_BURST_BYTES 128
+#endif
+
+typedef enum {
+    LINK_CHANNEL_DATA = 0,
+    LINK_CHANNEL_LOG = 1
+} link_channel_t;
+
+typedef struct {
+    uint32_t data_bytes;    // Bytes of data frames queued
+    uint32_t log_bytes;     // Bytes of log output queued
+    uint16_t data_dropped;  // Data frames that did not fit in the transmit buffer
+    uint16_t log_refused;   // Log writes held back (no spare space or over budget)
+} link_stats_t;
+
+/**
+ * @brief Queues bytes on a channel. Nothing is written unless all of it is accepted.
+ * @param channel Logical channel.
+ * @param bytes Data to send (a whole frame or log line).
+ * @param length Number of bytes.
+ * @return true if queued, false if the channel cannot take it now.
+ */
+bool link_mux_send(link_channel_t channel, const uint8_t *bytes, size_t length);
+
+/**
+ * @brief Checks whether a log write of this length would be accepted now.
+ */
+bool link_mux_log_can_send(size_t length);
+
+/**
+ * @brief Checks whether a log write of this length can never be accepted.
+ * True if it exceeds the budget burst, or the spare space of an empty buffer.
+ * Such output should be dropped rather than retried.
+ */
+bool link_mux_log_too_big(size_t length);
+
+/**
+ * @brief Copies the channel counters.
+ */
+void link_mux_get_stats(link_stats_t *stats);
+
+#endif // LINK_MUX_H
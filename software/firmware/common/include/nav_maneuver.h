@@ -0,0 +1,37 @@
+#ifndef NAV_MANEUVER_H
+#define NAV_MANEUVER_H
+
+/**
+ * @file nav_maneuver.h
+ * @brief Maneuver codes shared by the phone app, the Brain Module and the Display Module.
+ * A route is a list of points, each tagged with the maneuver to perform when
+ * it is reached. The code travels as one byte on the BLE link and in the
+ * on-device route store. Values are part of the wire format: append only.
+ */
+
+#include <stdint.h>
+
+typedef enum {
+    NAV_MANEUVER_NONE          = 0,  // Shape point: no instruction at this point
+    NAV_MANEUVER_DEPART        = 1,
+    NAV_MANEUVER_STRAIGHT      = 2,
+    NAV_MANEUVER_SLIGHT_LEFT   = 3,
+    NAV_MANEUVER_LEFT          = 4,
+    NAV_MANEUVER_SHARP_LEFT    = 5,
+    NAV_MANEUVER_SLIGHT_RIGHT  = 6,
+    NAV_MANEUVER_RIGHT         = 7,
+    NAV_MANEUVER_SHARP_RIGHT   = 8,
+    NAV_MANEUVER_KEEP_LEFT     = 9,
+    NAV_MANEUVER_KEEP_RIGHT    = 10,
+    NAV_MANEUVER_UTURN         = 11,
+    NAV_MANEUVER_ROUNDABOUT    = 12, // Exit number is carried in the point's argument byte
+    NAV_MANEUVER_MERGE         = 13,
+    NAV_MANEUVER_ARRIVE        = 14,
+    // Generated on the device, never stored in a route
+    NAV_MANEUVER_NO_LINK       = 0xFC, // Display only: nothing received from the Brain yet
+    NAV_MANEUVER_NO_ROUTE      = 0xFD,
+    NAV_MANEUVER_OFF_ROUTE     = 0xFE,
+    NAV_MANEUVER_NO_FIX        = 0xFF
+} nav_maneuver_t;
+
+#endif // NAV_MANEUVER_H
@@ -0,0 +1,181 @@
+#ifndef UTIL_FIXED_H
+#define UTIL_FIXED_H
+
+/**
+ * @file fixed.h
+ * @brief Integer fixed-point helpers shared by both firmware trees.
+ *
+ * The AVR has an 8x8 hardware multiplier and no FPU, so soft-float costs
+ * hundreds of cycles per operation. Everything here is integer-only:
+ * - Q-format types: q15_t (1.15, for ratios and trig) and Q8/Q16 scale factors
+ *   written as compile-time constants with FIXED_Q8()/FIXED_Q16().
+ * - Saturating arithmetic for the narrow types sent on the wire.
+ * - Integer EMA filters (alpha = 1 / 2^shift: a shift and two adds per sample).
+ * - Geometry on micro-degree coordinates: cos(latitude), the local
+ *   equirectangular projection in meters, integer sqrt and bearings.
+ *
+ * Small helpers are static inline; the table-driven ones live in fixed.c.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// --- Q-Format Types and Constants ---
+
+typedef int16_t q15_t; // Range [-1, 1), 1 LSB = 2^-15
+
+#define FIXED_Q15_ONE 32767
+
+// Compile-time conversion of a constant ratio to Q8/Q16 (folded by the compiler,
+// never evaluated at run time). Use only with constant arguments.
+#define FIXED_Q8(x)  ((uint32_t)((x) * 256.0 + 0.5))
+#define FIXED_Q16(x) ((uint32_t)((x) * 65536.0 + 0.5))
+
+static inline q15_t fixed_q15_mul(q15_t a, q15_t b) {
+    return (q15_t)(((int32_t)a * b + (1L << 14)) >> 15);
+}
+
+// value * scale, where scale is a Q8 factor; rounds to nearest.
+static inline uint32_t fixed_mul_q8(uint32_t value, uint16_t scale_q8) {
+    return (value * scale_q8 + 128U) >> 8;
+}
+
+// value * scale, where scale is a Q16 factor below 1.0; rounds to nearest.
+static inline uint16_t fixed_mul_q16(uint16_t value, uint16_t scale_q16) {
+    return (uint16_t)(((uint32_t)value * scale_q16 + 32768UL) >> 16);
+}
+
+// value * q15 for any int32 value, split so no partial product overflows.
+static inline int32_t fixed_scale_q15(int32_t value, q15_t q15) {
+    int32_t hi = value >> 15;
+    int32_t lo = (int32_t)((uint32_t)value & 0x7FFF);
+    return hi * q15 + ((lo * q15) >> 15);
+}
+
+// Signed division rounding half away from zero.
+static inline int32_t fixed_div_round(int32_t value, int32_t divisor) {
+    return (value >= 0) ? (value + divisor / 2) / divisor : (value - divisor / 2) / divisor;
+}
+
+// --- Saturating Arithmetic ---
+
+static inline uint16_t fixed_sat_u16(uint32_t value) {
+    return (value > UINT16_MAX) ? UINT16_MAX : (uint16_t)value;
+}
+
+static inline uint8_t fixed_sat_u8(uint16_t value) {
+    return (value > UINT8_MAX) ? UINT8_MAX : (uint8_t)value;
+}
+
+static inline uint16_t fixed_sat_add_u16(uint16_t a, uint16_t b) {
+    uint16_t sum = a + b;
+    return (sum < a) ? UINT16_MAX : sum;
+}
+
+static inline uint16_t fixed_sat_sub_u16(uint16_t a, uint16_t b) {
+    return (a > b) ? (uint16_t)(a - b) : 0;
+}
+
+static inline int32_t fixed_clamp_i32(int32_t value, int32_t lo, int32_t hi) {
+    return (value < lo) ? lo : (value > hi) ? hi : value;
+}
+
+// --- EMA Filter ---
+
+// Exponential moving average with alpha = 1 / 2^shift. The accumulator holds
+// value << shift, so no precision is lost between samples.
+typedef struct {
+    uint32_t acc;
+    uint8_t shift;
+    bool primed; // The first sample initializes the filter
+} fixed_ema_t;
+
+static inline void fixed_ema_init(fixed_ema_t *ema, uint8_t shift) {
+    ema->acc = 0;
+    ema->shift = shift;
+    ema->primed = false;
+}
+
+static inline uint16_t fixed_ema_value(const fixed_ema_t *ema) {
+    return (uint16_t)((ema->acc + ((1UL << ema->shift) >> 1)) >> ema->shift);
+}
+
+static inline uint16_t fixed_ema_update(fixed_ema_t *ema, uint16_t sample) {
+    if (!ema->primed) {
+        ema->acc = (uint32_t)sample << ema->shift;
+        ema->primed = true;
+    } else {
+        ema->acc = ema->acc - (ema->acc >> ema->shift) + sample;
+    }
+    return fixed_ema_value(ema);
+}
+
+// --- Geometry (coordinates in micro-degrees) ---
+
+#define FIXED_EQUIRECT_LIMIT_M 22000 // Local offsets saturate here so x*x + y*y fits in 32 bits
+
+/**
+ * @brief Integer square root.
+ * @param value Input value.
+ * @return floor(sqrt(value)).
+ */
+uint16_t fixed_isqrt32(uint32_t value);
+
+/**
+ * @brief Cosine of a latitude, interpolated from a 5 degree table.
+ * @param lat_e6 Latitude in micro-degrees.
+ * @return cos(lat) in Q15 (0..32767), within 0.1%.
+ */
+uint16_t fixed_cos_lat_q15(int32_t lat_e6);
+
+/**
+ * @brief Sine and cosine of a heading, from the same table as fixed_cos_lat_q15().
+ * @param deg_x100 Angle in 0.01 degrees (any value; reduced modulo 360).
+ * @param sin_q15 Receives sin(angle), Q15.
+ * @param cos_q15 Receives cos(angle), Q15.
+ */
+void fixed_sin_cos_q15(uint16_t deg_x100, q15_t *sin_q15, q15_t *cos_q15);
+
+/**
+ * @brief Converts a north-south angle in micro-degrees to meters.
+ * @param delta_e6 Angle in micro-degrees (any value in the int32 range).
+ * @return Meters (0.111195 m per micro-degree).
+ */
+int32_t fixed_udeg_to_m(int32_t delta_e6);
+
+/**
+ * @brief Projects a point onto the local plane around an origin.
+ * Equirectangular: exact enough (better than 0.1%) for offsets of a few km.
+ * Each component saturates at +/-FIXED_EQUIRECT_LIMIT_M.
+ * @param origin_lat_e6 Origin latitude.
+ * @param origin_lon_e6 Origin longitude.
+ * @param cos_lat_q15 fixed_cos_lat_q15(origin_lat_e6), cached by the caller.
+ * @param lat_e6 Point latitude.
+ * @param lon_e6 Point longitude.
+ * @param east_m Receives the east offset in meters.
+ * @param north_m Receives the north offset in meters.
+ */
+void fixed_equirect_offset_m(int32_t origin_lat_e6, int32_t origin_lon_e6, uint16_t cos_lat_q15,
+                             int32_t lat_e6, int32_t lon_e6, int32_t *east_m, int32_t *north_m);
+
+/**
+ * @brief Length of a local vector in meters.
+ * @return sqrt(east^2 + north^2), saturating at 65535.
+ */
+uint16_t fixed_hypot_m(int32_t east_m, int32_t north_m);
+
+/**
+ * @brief Equirectangular distance between two points, without the local limit.
+ * Vectors too long to square in 32 bits are scaled down first, so precision
+ * drops to a few meters beyond ~40 km.
+ * @return Distance in meters.
+ */
+uint32_t fixed_equirect_distance_m(int32_t lat1_e6, int32_t lon1_e6, int32_t lat2_e6, int32_t lon2_e6);
+
+/**
+ * @brief Bearing of a local vector.
+ * @return Degrees clockwise from north (0..359), within 0.3 degrees.
+ */
+uint16_t fixed_bearing_deg(int32_t east_m, int32_t north_m);
+
+#endif // UTIL_FIXED_H
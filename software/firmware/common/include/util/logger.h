@@ -0,0 +1,170 @@
+#ifndef UTIL_LOGGER_H
+#define UTIL_LOGGER_H
+
+/**
+ * @file logger.h
+ * @brief Logging macros shared by both firmware trees.
+ *
+ * Levels below LOG_LEVEL are removed at compile time: the call and its
+ * arguments are never evaluated, only type-checked against the format.
+ *
+ * Output format (LOG_TOKENIZED in config.h):
+ * - 0: text. log_message() formats the line with vsnprintf and queues it on
+ *   LOG_UART_ID at once.
+ * - 1: tokenized. Each call site's level, file, line and format string are
+ *   stored in the .logfmt ELF section, which common/logfmt.ld marks as not
+ *   loaded, so no format string takes flash. The call queues only a 16-bit
+ *   token (the string's offset in .logfmt) and the raw argument bytes; the
+ *   main loop sends the queued records as BLE_MSG_LOG frames when nothing
+ *   else is due (logger_service()). host_tools/diagnostics.py turns them back
+ *   into text using the ELF.
+ *
+ * Record payload: token (u16) | arguments in order. Integers are sent at
+ * their promoted size (2 bytes for int and smaller, 4 for long), little-endian;
+ * strings as a length byte and at most LOG_MAX_STRING_LEN characters.
+ * Format strings must be literals and take at most LOG_MAX_ARGS arguments.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h" // For ENABLE_LOGGING, LOG_LEVEL, LOG_TOKENIZED
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE  4
+
+typedef uint8_t log_level_t;
+
+#ifndef LOG_TOKENIZED
+#define LOG_TOKENIZED 0
+#endif
+
+#define LOG_MAX_ARGS        6
+#define LOG_MAX_STRING_LEN  16 // Longer %s arguments are truncated in tokenized records
+#define LOG_TOKEN_DROPPED   0xFFFF // Record token: u16 count of records lost to a full queue
+
+// Tokenized argument kinds, 2 bits per argument in bits 0..11 of log_tokenized()'s
+// arg_info; bits 12..15 hold the argument count.
+#define LOG_ARG_INT16  0
+#define LOG_ARG_INT32  1
+#define LOG_ARG_STRING 2
+#define LOG_ARG_INT64  3
+#define LOG_ARG_COUNT_SHIFT 12
+
+/**
+ * @brief Initializes the log UART. Call before anything else logs.
+ */
+void logger_init(void);
+
+/**
+ * @brief Opens the tokenized record queue. Called by logger_init().
+ * Records queued before this (opened on first use) are kept.
+ */
+void log_queue_init(void);
+
+/**
+ * @brief Formats and sends one text log line. Use the log_* macros instead.
+ */
+void log_message(log_level_t level, const char *file, int line, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+/**
+ * @brief Queues one tokenized record. Use the log_* macros instead.
+ * Safe to call from interrupt context. Drops the record if the queue is full.
+ * @param token Offset of the call site's descriptor in .logfmt.
+ * @param arg_info Argument count and LOG_ARG_* kinds, first argument in the low bits.
+ */
+void log_tokenized(uint16_t token, uint16_t arg_info, ...);
+
+/**
+ * @brief Sends queued records that fit in the UART transmit buffer.
+ * Call from the main loop when no task is due.
+ * @return true if anything was sent (call again before sleeping).
+ */
+bool logger_service(void);
+
+/**
+ * @brief Sends every queued record, waiting for UART space. Use before deep sleep.
+ */
+void logger_flush(void);
+
+/**
+ * @brief Sends one raw character (text mode only).
+ */
+void log_char(char c);
+
+// Never called: lets the compiler check the format of compiled-out and tokenized calls.
+static inline __attribute__((format(printf, 1, 2))) void log_format_check(const char *format, ...) {
+    (void)format;
+}
+
+// --- Call Site Machinery ---
+
+#define LOG_STR2_(x) #x
+#define LOG_STR_(x) LOG_STR2_(x)
+#define LOG_CAT2_(a, b) a##b
+#define LOG_CAT_(a, b) LOG_CAT2_(a, b)
+#define LOG_FIRST_(f, ...) f
+#define LOG_REST_(f, ...) , ##__VA_ARGS__
+
+// Number of arguments after the format string.
+#define LOG_NARGS_(...) LOG_NARGS_N_(__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0, _)
+#define LOG_NARGS_N_(f, _1, _2, _3, _4, _5, _6, n, ...) n
+
+#define LOG_KIND_(x) _Generic((x), \
+    char *: LOG_ARG_STRING, const char *: LOG_ARG_STRING, \
+    default: (sizeof((x) + 0) > 4 ? LOG_ARG_INT64 : sizeof((x) + 0) > 2 ? LOG_ARG_INT32 : LOG_ARG_INT16))
+
+#define LOG_KINDS_0(f) 0
+#define LOG_KINDS_1(f, a) LOG_KIND_(a)
+#define LOG_KINDS_2(f, a, ...) (LOG_KIND_(a) | (LOG_KINDS_1(f, __VA_ARGS__) << 2))
+#define LOG_KINDS_3(f, a, ...) (LOG_KIND_(a) | (LOG_KINDS_2(f, __VA_ARGS__) << 2))
+#define LOG_KINDS_4(f, a, ...) (LOG_KIND_(a) | (LOG_KINDS_3(f, __VA_ARGS__) << 2))
+#define LOG_KINDS_5(f, a, ...) (LOG_KIND_(a) | (LOG_KINDS_4(f, __VA_ARGS__) << 2))
+#define LOG_KINDS_6(f, a, ...) (LOG_KIND_(a) | (LOG_KINDS_5(f, __VA_ARGS__) << 2))
+#define LOG_ARG_INFO_(...) ((uint16_t)(LOG_CAT_(LOG_KINDS_, LOG_NARGS_(__VA_ARGS__))(__VA_ARGS__) | \
+                                   (LOG_NARGS_(__VA_ARGS__) << LOG_ARG_COUNT_SHIFT)))
+
+#define LOG_DISCARD_(...) do { if (0) log_format_check(__VA_ARGS__); } while (0)
+
+#if LOG_TOKENIZED
+// Descriptor "<tag>|<file>:<line>|<format>", read back by host_tools/diagnostics.py.
+#define LOG_EMIT_(level, tag, ...) do { \
+        static const char log_desc_[] __attribute__((section(".logfmt"), used)) = \
+            tag "|" __FILE__ ":" LOG_STR_(__LINE__) "|" LOG_FIRST_(__VA_ARGS__); \
+        LOG_DISCARD_(__VA_ARGS__); \
+        log_tokenized((uint16_t)(uintptr_t)log_desc_, LOG_ARG_INFO_(__VA_ARGS__) LOG_REST_(__VA_ARGS__)); \
+    } while (0)
+#else
+#define LOG_EMIT_(level, tag, ...) log_message(level, __FILE__, __LINE__, __VA_ARGS__)
+#endif
+
+// --- Logging Macros ---
+
+#if ENABLE_LOGGING && LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define log_debug(...) LOG_EMIT_(LOG_LEVEL_DEBUG, "D", __VA_ARGS__)
+#else
+#define log_debug(...) LOG_DISCARD_(__VA_ARGS__)
+#endif
+
+#if ENABLE_LOGGING && LOG_LEVEL <= LOG_LEVEL_INFO
+#define log_info(...) LOG_EMIT_(LOG_LEVEL_INFO, "I", __VA_ARGS__)
+#else
+#define log_info(...) LOG_DISCARD_(__VA_ARGS__)
+#endif
+
+#if ENABLE_LOGGING && LOG_LEVEL <= LOG_LEVEL_WARN
+#define log_warn(...) LOG_EMIT_(LOG_LEVEL_WARN, "W", __VA_ARGS__)
+#else
+#define log_warn(...) LOG_DISCARD_(__VA_ARGS__)
+#endif
+
+#if ENABLE_LOGGING && LOG_LEVEL <= LOG_LEVEL_ERROR
+#define log_error(...) LOG_EMIT_(LOG_LEVEL_ERROR, "E", __VA_ARGS__)
+#else
+#define log_error(...) LOG_DISCARD_(__VA_ARGS__)
+#endif
+
+#endif // UTIL_LOGGER_H
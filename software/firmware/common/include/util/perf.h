@@ -0,0 +1,152 @@
+#ifndef UTIL_PERF_H
+#define UTIL_PERF_H
+
+/**
+ * @file perf.h
+ * @brief Cycle timing of named code sections and event counters (ENABLE_PERF_COUNTERS).
+ *
+ * Timer1 runs free at clk/1 and its overflow interrupt extends it to 32 bits,
+ * so a section is timed to the CPU cycle (62.5 ns at 16 MHz). The cost of the
+ * measurement itself is calibrated at init and subtracted. Times are inclusive:
+ * a section that calls another instrumented one includes its time.
+ *
+ * Each tree lists its sections and counters in perf_sections.h:
+ *
+ *   #define PERF_SECTIONS(X) X(GPS_CHAR, "gps_char") ...
+ *   #define PERF_COUNTERS(X) X(MAIN_LOOP, "main_loop") ...
+ *
+ * which become PERF_SECTION_GPS_CHAR / PERF_COUNTER_MAIN_LOOP. Instrument with
+ * PERF_SCOPE(GPS_CHAR) at the top of a function (timed until the scope exits,
+ * early returns included) and PERF_COUNT(MAIN_LOOP). Both compile to nothing
+ * when ENABLE_PERF_COUNTERS is 0.
+ *
+ * On a BLE_MSG_STATS_REQUEST the tree sets its snapshot counters and calls
+ * perf_report_start(); perf_report_service() then sends the results as
+ * BLE_MSG_STATS frames on the log channel (link_mux.h) from the idle loop,
+ * one frame per pass. host_tools/diagnostics.py --stats prints them.
+ *
+ * Timer1 keeps running in IDLE, so its overflow wakes the CPU every 4.1 ms;
+ * leave ENABLE_PERF_COUNTERS off outside bench builds.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"        // For ENABLE_PERF_COUNTERS
+#include "perf_sections.h" // The tree's PERF_SECTIONS / PERF_COUNTERS lists
+
+#ifndef ENABLE_PERF_COUNTERS
+#define ENABLE_PERF_COUNTERS 0
+#endif
+
+#define PERF_NAME_MAX_LEN 16 // Longer section/counter names are cut in reports
+
+#define PERF_ENUM_SECTION_(id, name) PERF_SECTION_##id,
+#define PERF_ENUM_COUNTER_(id, name) PERF_COUNTER_##id,
+
+typedef enum {
+    PERF_SECTIONS(PERF_ENUM_SECTION_)
+    PERF_SECTION_COUNT
+} perf_section_t;
+
+typedef enum {
+    PERF_COUNTERS(PERF_ENUM_COUNTER_)
+    PERF_COUNTER_COUNT
+} perf_counter_t;
+
+typedef uint32_t perf_cycles_t;
+
+// Timing results for one section, in CPU cycles.
+typedef struct {
+    uint32_t count;      // Runs measured (halved with total when total would overflow)
+    perf_cycles_t min;
+    perf_cycles_t max;
+    uint32_t total;      // Sum over count runs, for the average
+} perf_section_stats_t;
+
+// Start time of a running PERF_SCOPE.
+typedef struct {
+    perf_cycles_t start;
+    uint8_t section;
+} perf_scope_t;
+
+#if ENABLE_PERF_COUNTERS
+
+/**
+ * @brief Starts Timer1 and calibrates the measurement overhead.
+ * Call after hal_power_init(), which gates Timer1 off.
+ */
+void perf_init(void);
+
+/**
+ * @brief Returns the free-running cycle count. Wraps after about 268 s.
+ */
+perf_cycles_t perf_cycles(void);
+
+/**
+ * @brief Adds one run of a section that started at the given cycle count.
+ * Main loop context only.
+ */
+void perf_record(perf_section_t section, perf_cycles_t start);
+
+/**
+ * @brief Cleanup handler behind PERF_SCOPE().
+ */
+void perf_scope_end(perf_scope_t *scope);
+
+/**
+ * @brief Increments an event counter (saturates). Main loop context only.
+ */
+void perf_count(perf_counter_t counter);
+
+/**
+ * @brief Sets a counter, for values kept elsewhere (e.g. UART error counts).
+ */
+void perf_counter_set(perf_counter_t counter, uint32_t value);
+
+/**
+ * @brief Copies the results of one section.
+ * @return false if the section id is out of range.
+ */
+bool perf_get_section(perf_section_t section, perf_section_stats_t *stats);
+
+/**
+ * @brief Returns the value of one counter (0 if out of range).
+ */
+uint32_t perf_get_counter(perf_counter_t counter);
+
+/**
+ * @brief Clears all sections and counters and restarts the report window.
+ */
+void perf_reset(void);
+
+/**
+ * @brief Queues a full report (see BLE_MSG_STATS in ble_protocol.h).
+ * A request while a report is going out restarts it.
+ * @param reset_after Clear the results once the last frame has been sent.
+ */
+void perf_report_start(bool reset_after);
+
+/**
+ * @brief Sends the next report frame if the log channel takes it now.
+ * Call from the main loop when no task is due.
+ * @return true if a frame was sent (call again before sleeping).
+ */
+bool perf_report_service(void);
+
+#define PERF_SCOPE(id) perf_scope_t perf_scope_ __attribute__((cleanup(perf_scope_end))) = \
+    { perf_cycles(), PERF_SECTION_##id }
+#define PERF_COUNT(id) perf_count(PERF_COUNTER_##id)
+
+#else // Profiling compiled out
+
+static inline void perf_init(void) {}
+static inline void perf_counter_set(perf_counter_t counter, uint32_t value) { (void)counter; (void)value; }
+static inline void perf_report_start(bool reset_after) { (void)reset_after; }
+static inline bool perf_report_service(void) { return false; }
+
+#define PERF_SCOPE(id) do { } while (0)
+#define PERF_COUNT(id) do { } while (0)
+
+#endif // ENABLE_PERF_COUNTERS
+
+#endif // UTIL_PERF_H
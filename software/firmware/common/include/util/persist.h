@@ -0,0 +1,69 @@
+#ifndef UTIL_PERSIST_H
+#define UTIL_PERSIST_H
+
+/**
+ * @file persist.h
+ * @brief Versioned, CRC-protected records in the on-chip EEPROM.
+ *
+ * A record is kept in a ring of slots at a fixed EEPROM address. Each save
+ * goes to the slot after the newest copy, so the writes spread over the ring
+ * (wear levelling) and the previous copy stays intact until the new one is
+ * complete. A slot holds:
+ *
+ *   seq (u8) | version (u8) | record[length] | CRC-16/XMODEM (u16) over the rest
+ *
+ * On load the valid copy with the highest sequence number wins; copies with a
+ * bad CRC (erased, or cut short by a reset) or another version are ignored.
+ *
+ * Writes take ~3.4 ms per byte, so persist_save() only copies the record and
+ * persist_poll() starts one byte at a time, like the route store. One record
+ * is written at a time.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PERSIST_OVERHEAD    4  // seq, version and CRC per slot
+#define PERSIST_MAX_LENGTH  28 // Largest record (the staging buffer is 32 bytes)
+
+// EEPROM bytes taken by a ring, for laying out and checking the EEPROM map.
+#define PERSIST_SIZE(length, slots) ((uint16_t)((length) + PERSIST_OVERHEAD) * (slots))
+
+typedef struct {
+    uint16_t base;   // EEPROM address of slot 0
+    uint8_t length;  // Record bytes, at most PERSIST_MAX_LENGTH
+    uint8_t slots;   // Slots in the ring (1 keeps no previous copy)
+    uint8_t version; // Record layout version
+    uint8_t seq;     // Sequence number of the newest copy (set by persist_load/save)
+    uint8_t slot;    // Slot holding it, or slots if none
+} persist_record_t;
+
+/**
+ * @brief Reads the newest valid copy of a record.
+ * @param record Ring description; seq and slot are updated.
+ * @param data Receives record->length bytes. Left untouched if there is no valid copy.
+ * @return true if a valid copy was found.
+ */
+bool persist_load(persist_record_t *record, void *data);
+
+/**
+ * @brief Queues a new copy of a record for the next slot of its ring.
+ * The data is copied, so the caller may change it at once.
+ * @param record Ring description; seq and slot advance to the new copy.
+ * @param data record->length bytes.
+ * @return false if another save is still being written; call again later.
+ */
+bool persist_save(persist_record_t *record, const void *data);
+
+/**
+ * @brief Advances the write in progress. Non-blocking; call every few milliseconds.
+ * @return true while a write is in progress.
+ */
+bool persist_poll(void);
+
+/**
+ * @brief Checks whether a save is still being written.
+ */
+bool persist_is_busy(void);
+
+#endif // UTIL_PERSIST_H
@@ -0,0 +1,125 @@
+#ifndef UTIL_RING_BUFFER_H
+#define UTIL_RING_BUFFER_H
+
+/**
+ * @file ring_buffer.h
+ * @brief Lock-free single-producer/single-consumer byte ring buffer.
+ *
+ * Designed for one ISR and the main loop sharing a buffer without disabling
+ * interrupts:
+ * - The size must be a power of two (2..256) so indices wrap with a mask
+ *   instead of a software division.
+ * - head is written only by the producer and tail only by the consumer; both
+ *   are single bytes, so each side's reads of the other index are atomic on AVR.
+ *   There is no shared count. One slot is kept free to tell full from empty,
+ *   so the capacity is size - 1.
+ * - Producer-side calls: write, write_multi, write_span/write_commit, space_remaining, is_full.
+ *   Consumer-side calls: read, read_multi, peek, read_span/read_commit,
+ *   bytes_available, is_empty, clear.
+ *
+ * Calling a producer-side function from two contexts (or consumer-side
+ * functions from two contexts) still needs external locking.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint16_t rb_size_t; // Lengths and counts (a 256-byte buffer holds 255 bytes)
+typedef uint8_t rb_index_t; // Masked head/tail positions, atomic on AVR
+
+// Evaluates true if n is a valid ring buffer size; use with _Static_assert on buffer sizes.
+#define RING_BUFFER_SIZE_VALID(n) ((n) >= 2 && (n) <= 256 && (((n) & ((n) - 1)) == 0))
+
+typedef struct {
+    uint8_t *buffer;
+    rb_index_t mask;           // size - 1
+    volatile rb_index_t head;  // Next slot to write (producer owned)
+    volatile rb_index_t tail;  // Next slot to read (consumer owned)
+} ring_buffer_t;
+
+/**
+ * @brief Initializes a ring buffer over caller-provided storage.
+ * Not ISR safe: call before the producer and consumer are running.
+ * @param rb Pointer to the ring buffer structure.
+ * @param buffer Storage for the data.
+ * @param size Size of the storage in bytes (power of two, 2..256). Invalid sizes leave rb untouched.
+ */
+void ring_buffer_init(ring_buffer_t *rb, uint8_t *buffer, rb_size_t size);
+
+/**
+ * @brief Writes one byte (producer).
+ * @return true if the byte was stored, false if the buffer is full.
+ */
+bool ring_buffer_write(ring_buffer_t *rb, uint8_t data);
+
+/**
+ * @brief Reads one byte (consumer).
+ * @return true if a byte was read into *data, false if the buffer is empty.
+ */
+bool ring_buffer_read(ring_buffer_t *rb, uint8_t *data);
+
+/**
+ * @brief Reads a byte without removing it (consumer).
+ * @param offset Position relative to the oldest unread byte.
+ * @return true if offset is within the unread data.
+ */
+bool ring_buffer_peek(const ring_buffer_t *rb, uint8_t *data, rb_size_t offset);
+
+/**
+ * @brief Number of unread bytes.
+ */
+rb_size_t ring_buffer_bytes_available(const ring_buffer_t *rb);
+
+/**
+ * @brief Number of bytes that can still be written.
+ */
+rb_size_t ring_buffer_space_remaining(const ring_buffer_t *rb);
+
+bool ring_buffer_is_empty(const ring_buffer_t *rb);
+bool ring_buffer_is_full(const ring_buffer_t *rb);
+
+/**
+ * @brief Discards all unread data (consumer).
+ */
+void ring_buffer_clear(ring_buffer_t *rb);
+
+/**
+ * @brief Writes as many bytes as fit, using at most two memcpy calls (producer).
+ * @return Number of bytes written.
+ */
+rb_size_t ring_buffer_write_multi(ring_buffer_t *rb, const uint8_t *data, rb_size_t length);
+
+/**
+ * @brief Reads up to length bytes, using at most two memcpy calls (consumer).
+ * @return Number of bytes read.
+ */
+rb_size_t ring_buffer_read_multi(ring_buffer_t *rb, uint8_t *buffer, rb_size_t length);
+
+/**
+ * @brief Returns the longest contiguous run of unread bytes, for zero-copy parsing (consumer).
+ * The data stays valid until ring_buffer_read_commit() releases it.
+ * @param data Receives a pointer to the oldest unread byte.
+ * @return Length of the run (0 if empty). Wrapped data needs a second call after committing.
+ */
+rb_size_t ring_buffer_read_span(const ring_buffer_t *rb, const uint8_t **data);
+
+/**
+ * @brief Releases bytes obtained with ring_buffer_read_span() (consumer).
+ * @param length Number of bytes consumed; must not exceed the span returned.
+ */
+void ring_buffer_read_commit(ring_buffer_t *rb, rb_size_t length);
+
+/**
+ * @brief Returns the longest contiguous run of free space, to fill in place (producer).
+ * @param data Receives a pointer to the first free byte.
+ * @return Length of the run (0 if full).
+ */
+rb_size_t ring_buffer_write_span(ring_buffer_t *rb, uint8_t **data);
+
+/**
+ * @brief Publishes bytes written into a ring_buffer_write_span() region (producer).
+ * @param length Number of bytes written; must not exceed the span returned.
+ */
+void ring_buffer_write_commit(ring_buffer_t *rb, rb_size_t length);
+
+#endif // UTIL_RING_BUFFER_H
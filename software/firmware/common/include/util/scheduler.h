@@ -0,0 +1,116 @@
+#ifndef UTIL_SCHEDULER_H
+#define UTIL_SCHEDULER_H
+
+/**
+ * @file scheduler.h
+ * @brief Cooperative run-to-completion task scheduler.
+ *
+ * Tasks are registered once at startup into a static table. A task becomes
+ * due when its period elapses (periodic tasks) or when scheduler_signal() is
+ * called for it (event tasks, typically from an ISR). Each call to
+ * scheduler_run_once() runs the highest-priority due task and records how
+ * long it took, so the worst-case run time of every task can be reported.
+ *
+ * Time comes from hal/timer.h, which each firmware tree provides.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h" // For SCHEDULER_MAX_TASKS
+
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 8
+#endif
+
+typedef void (*task_fn_t)(void);
+typedef uint8_t task_id_t;
+
+#define SCHEDULER_INVALID_TASK 0xFF // Returned when the task table is full
+
+// Lower value runs first when several tasks are due at once.
+typedef enum {
+    TASK_PRIORITY_HIGH = 0,
+    TASK_PRIORITY_NORMAL = 1,
+    TASK_PRIORITY_LOW = 2,
+    TASK_PRIORITY_IDLE = 3
+} task_priority_t;
+
+// Run-time statistics for one task.
+typedef struct {
+    const char *name;
+    uint16_t period_ms;   // 0 for pure event tasks
+    uint16_t worst_us;    // Longest single run (saturates at 65535)
+    uint16_t last_us;     // Duration of the most recent run
+    uint16_t overruns;    // Times the task started a full period or more late
+    uint32_t run_count;
+} task_stats_t;
+
+/**
+ * @brief Clears the task table. Call before registering tasks.
+ */
+void scheduler_init(void);
+
+/**
+ * @brief Registers a task.
+ * @param name Short name used in statistics output (not copied).
+ * @param fn Function to run; must return quickly (run-to-completion).
+ * @param period_ms Period in milliseconds, or 0 for a task that only runs when signaled.
+ * @param priority Scheduling priority (task_priority_t, lower runs first).
+ * @return The task handle, or SCHEDULER_INVALID_TASK if the table is full.
+ */
+task_id_t scheduler_add_task(const char *name, task_fn_t fn, uint16_t period_ms, uint8_t priority);
+
+/**
+ * @brief Marks a task as due so it runs at the next opportunity.
+ * Safe to call from interrupt context. Works for periodic tasks too.
+ * @param id Task handle from scheduler_add_task().
+ */
+void scheduler_signal(task_id_t id);
+
+/**
+ * @brief Enables or disables a task. A disabled task never becomes due.
+ * @param id Task handle from scheduler_add_task().
+ * @param enabled true to enable.
+ */
+void scheduler_set_enabled(task_id_t id, bool enabled);
+
+/**
+ * @brief Changes a task's period, e.g. after the setting it comes from changed.
+ * The next run is one new period from now; an unchanged period is left alone.
+ * @param id Task handle from scheduler_add_task().
+ * @param period_ms New period in milliseconds (0: only runs when signaled).
+ */
+void scheduler_set_period(task_id_t id, uint16_t period_ms);
+
+/**
+ * @brief Runs the highest-priority due task, if any.
+ * @return true if a task was run, false if nothing was due.
+ */
+bool scheduler_run_once(void);
+
+/**
+ * @brief Returns how long until the next periodic task is due.
+ * @return Milliseconds until the next deadline (0 if something is due now,
+ *         UINT32_MAX if no periodic task is enabled and nothing is signaled).
+ */
+uint32_t scheduler_ms_until_next(void);
+
+/**
+ * @brief Copies the statistics for one task.
+ * @param id Task handle from scheduler_add_task().
+ * @param stats Destination structure.
+ * @return false if the handle is invalid.
+ */
+bool scheduler_get_stats(task_id_t id, task_stats_t *stats);
+
+/**
+ * @brief Resets the worst-case, overrun and run counters of all tasks.
+ */
+void scheduler_reset_stats(void);
+
+/**
+ * @brief Logs one line of statistics per task at INFO level.
+ */
+void scheduler_log_stats(void);
+
+#endif // UTIL_SCHEDULER_H
@@ -0,0 +1,106 @@
+#ifndef UTIL_SNAPSHOT_H
+#define UTIL_SNAPSHOT_H
+
+/**
+ * @file snapshot.h
+ * @brief Sequence lock for a block of state written by one producer (an ISR
+ * or the main loop) and read in the main loop without disabling interrupts.
+ *
+ * The producer brackets every change with snapshot_write_begin()/_end(), which
+ * make the sequence number odd and then even again. A reader notes the number,
+ * copies what it needs, and copies again if the number moved meanwhile, so
+ * an interrupt that published in the middle of the copy costs a retry instead
+ * of a torn value:
+ *
+ *   uint8_t seq;
+ *   do {
+ *       seq = snapshot_read_begin(&snap);
+ *       speed = state.speed;            // Any fields, any size
+ *   } while (snapshot_read_retry(&snap, seq));
+ *
+ * Publishes that carry news also bump a version, which replaces an "updated"
+ * flag cleared by the reader: the reader keeps the version it last copied and
+ * compares, so nothing the producer owns is ever written by the consumer.
+ *
+ * Rules: one producer per snapshot, and readers must not interrupt the
+ * producer (an ISR reading state the main loop writes would spin).
+ * The counters are single bytes, so every access to them is atomic on AVR.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h> // For memcpy
+
+// Keeps the compiler from moving state accesses across the sequence number.
+#define SNAPSHOT_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+typedef struct {
+    volatile uint8_t seq;     // Odd while the producer is writing
+    volatile uint8_t version; // Bumped by publishes that announce new data
+} snapshot_t;
+
+static inline void snapshot_init(snapshot_t *s) {
+    s->seq = 0;
+    s->version = 0;
+}
+
+// --- Producer Side ---
+
+static inline void snapshot_write_begin(snapshot_t *s) {
+    s->seq++;
+    SNAPSHOT_BARRIER();
+}
+
+/**
+ * @brief Ends a change started with snapshot_write_begin().
+ * @param announce true to bump the version, so readers see new data.
+ */
+static inline void snapshot_write_end(snapshot_t *s, bool announce) {
+    SNAPSHOT_BARRIER();
+    if (announce) {
+        s->version++;
+    }
+    s->seq++;
+}
+
+// --- Consumer Side ---
+
+static inline uint8_t snapshot_read_begin(const snapshot_t *s) {
+    uint8_t seq;
+    while ((seq = s->seq) & 1) {
+        // Only reachable if the reader interrupted the producer (see the rules above)
+    }
+    SNAPSHOT_BARRIER();
+    return seq;
+}
+
+/**
+ * @brief Checks whether the state changed since snapshot_read_begin().
+ * @return true if the values read meanwhile may be torn; read them again.
+ */
+static inline bool snapshot_read_retry(const snapshot_t *s, uint8_t seq) {
+    SNAPSHOT_BARRIER();
+    return s->seq != seq;
+}
+
+/**
+ * @brief Copies a consistent image of len bytes of the state at src.
+ * @return The version of the copied data, to compare with snapshot_version().
+ */
+static inline uint8_t snapshot_read(const snapshot_t *s, void *dst, const void *src, size_t len) {
+    uint8_t seq;
+    uint8_t version;
+    do {
+        seq = snapshot_read_begin(s);
+        version = s->version;
+        memcpy(dst, src, len);
+    } while (snapshot_read_retry(s, seq));
+    return version;
+}
+
+static inline uint8_t snapshot_version(const snapshot_t *s) {
+    return s->version;
+}
+
+#endif // UTIL_SNAPSHOT_H
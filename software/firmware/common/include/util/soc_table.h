@@ -0,0 +1,54 @@
+#ifndef UTIL_SOC_TABLE_H
+#define UTIL_SOC_TABLE_H
+
+/**
+ * @file soc_table.h
+ * @brief Battery voltage to state-of-charge lookup from a table in flash.
+ * A table lists the voltage at evenly spaced charge levels from 0% to 100%
+ * (e.g. 11 entries for 10% steps), ascending; values in between are
+ * interpolated linearly. Each tree keeps the table for its own chemistry.
+ */
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+/**
+ * @brief Looks up the state of charge for a voltage.
+ * @param table_P Voltages in millivolts, in PROGMEM, ascending.
+ * @param points Number of entries (at least 2).
+ * @param mv Measured voltage in millivolts.
+ * @return Charge level in percent (0..100), saturating outside the table.
+ */
+static inline uint8_t soc_table_percent(const uint16_t *table_P, uint8_t points, uint16_t mv) {
+    uint16_t lo = pgm_read_word(&table_P[0]);
+    if (mv <= lo) return 0;
+    for (uint8_t i = 1; i < points; ++i) {
+        uint16_t hi = pgm_read_word(&table_P[i]);
+        if (mv < hi) {
+            // (i - 1 + (mv - lo) / (hi - lo)) steps of 100 / (points - 1) percent
+            uint32_t num = ((uint32_t)(i - 1) * (hi - lo) + (mv - lo)) * 100U;
+            return (uint8_t)(num / ((uint32_t)(points - 1) * (hi - lo)));
+        }
+        lo = hi;
+    }
+    return 100;
+}
+
+/**
+ * @brief Millivolts per ADC count of a divider Vbat --- R1 --- (ADC) --- R2 --- GND, Q8.
+ * VREF * (R1 + R2) / R2 / ADC_MAX, in 32-bit arithmetic; for calibration values
+ * set at run time (the result is cached by the callers).
+ * @param r1_ohms Upper resistor.
+ * @param r2_ohms Lower resistor (non-zero).
+ * @param vref_mv ADC reference voltage.
+ * @param adc_max Full-scale reading.
+ */
+static inline uint16_t soc_divider_mv_per_count_q8(uint16_t r1_ohms, uint16_t r2_ohms, uint16_t vref_mv,
+                                                   uint16_t adc_max) {
+    // Divider ratio in Q8 first (at most ~2^18 for R1/R2 <= 656), then the reference
+    uint32_t ratio_q8 = (((uint32_t)r1_ohms + r2_ohms) * 256U + r2_ohms / 2) / r2_ohms;
+    uint32_t scale = (ratio_q8 * vref_mv + adc_max / 2) / adc_max;
+    return (scale > UINT16_MAX) ? UINT16_MAX : (uint16_t)scale;
+}
+
+#endif // UTIL_SOC_TABLE_H
@@ -0,0 +1,110 @@
+/**
+ * @file ble_protocol.c
+ * @brief Frame encoder and byte-wise frame parser for the BLE link protocol.
+ * Compiled into both the Brain Module and Display Module firmware.
+ */
+
+#include "ble_protocol.h"
+#include <string.h> // For memcpy
+
+// --- Public API Implementation ---
+
+uint8_t ble_crc8_update(uint8_t crc, uint8_t data) {
+    // Bitwise CRC-8/CCITT; avoids a 256-byte table in flash.
+    crc ^= data;
+    for (uint8_t i = 0; i < 8; ++i) {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+size_t ble_frame_encode(uint8_t *out, size_t out_size, uint8_t msg_id, const uint8_t *payload, uint8_t length) {
+    if (!out || length > BLE_PROTO_MAX_PAYLOAD || out_size < (size_t)length + BLE_PROTO_OVERHEAD) {
+        return 0;
+    }
+    if (length > 0 && !payload) {
+        return 0;
+    }
+
+    uint8_t crc = 0;
+    size_t pos = 0;
+
+    out[pos++] = BLE_PACKET_START_BYTE;
+    out[pos++] = msg_id;
+    crc = ble_crc8_update(crc, msg_id);
+    out[pos++] = length;
+    crc = ble_crc8_update(crc, length);
+
+    for (uint8_t i = 0; i < length; ++i) {
+        out[pos++] = payload[i];
+        crc = ble_crc8_update(crc, payload[i]);
+    }
+
+    out[pos++] = crc;
+    out[pos++] = BLE_PACKET_END_BYTE;
+    return pos;
+}
+
+void ble_parser_init(ble_parser_t *parser) {
+    if (!parser) return;
+    memset(parser, 0, sizeof(*parser));
+    parser->state = BLE_PARSE_WAIT_START;
+}
+
+bool ble_parser_feed(ble_parser_t *parser, uint8_t byte) {
+    switch (parser->state) {
+        case BLE_PARSE_WAIT_START:
+            if (byte == BLE_PACKET_START_BYTE) {
+                parser->state = BLE_PARSE_MSG_ID;
+            }
+            break;
+
+        case BLE_PARSE_MSG_ID:
+            parser->msg_id = byte;
+            parser->crc = ble_crc8_update(0, byte);
+            parser->state = BLE_PARSE_LENGTH;
+            break;
+
+        case BLE_PARSE_LENGTH:
+            if (byte > BLE_PROTO_MAX_PAYLOAD) {
+                parser->framing_errors++;
+                parser->state = BLE_PARSE_WAIT_START;
+                break;
+            }
+            parser->length = byte;
+            parser->index = 0;
+            parser->crc = ble_crc8_update(parser->crc, byte);
+            parser->state = (byte > 0) ? BLE_PARSE_PAYLOAD : BLE_PARSE_CRC;
+            break;
+
+        case BLE_PARSE_PAYLOAD:
+            parser->payload[parser->index++] = byte;
+            parser->crc = ble_crc8_update(parser->crc, byte);
+            if (parser->index >= parser->length) {
+                parser->state = BLE_PARSE_CRC;
+            }
+            break;
+
+        case BLE_PARSE_CRC:
+            if (byte != parser->crc) {
+                parser->crc_errors++;
+                parser->state = BLE_PARSE_WAIT_START;
+                break;
+            }
+            parser->state = BLE_PARSE_END;
+            break;
+
+        case BLE_PARSE_END:
+            parser->state = BLE_PARSE_WAIT_START;
+            if (byte == BLE_PACKET_END_BYTE) {
+                return true; // Complete, CRC-checked frame
+            }
+            parser->framing_errors++;
+            break;
+
+        default:
+            parser->state = BLE_PARSE_WAIT_START;
+            break;
+    }
+    return false;
+}
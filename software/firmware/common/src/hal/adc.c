@@ -0,0 +1,72 @@
+/**
+ * @file adc.c
+ * @brief ADC HAL implementation for ATmega328P.
+ * Auto-triggered by Timer0 compare match A (1 kHz), so a decimated 12-bit
+ * value is produced every 16 ms and filtered with a 1 / 2^ADC_FILTER_SHIFT EMA.
+ */
+
+#include "hal/adc.h"
+#include "util/fixed.h"
+#include "util/logger.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h> // For ATOMIC_BLOCK
+
+// --- Configuration ---
+#define ADC_PRESCALER_BITS (_BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0)) // clk/128: 125 kHz at 16 MHz
+#define ADC_TRIGGER_TIMER0_COMPA (_BV(ADTS1) | _BV(ADTS0))
+
+// --- Internal State ---
+static fixed_ema_t filter;                // Touched only by the ISR once sampling runs
+static volatile uint16_t filtered_value = 0;
+static uint16_t oversample_sum = 0;       // ISR only
+static uint8_t oversample_count = 0;      // ISR only
+
+// --- Public API Implementation ---
+
+void hal_adc_start(uint8_t channel) {
+    ADCSRA = 0; // Stop any running conversion before reconfiguring
+    ADMUX = _BV(REFS0) | (channel & 0x07); // AVCC reference, right adjusted
+    if (channel < 6) {
+        DIDR0 |= _BV(channel); // Digital input buffer off: it only leaks current on an analog pin
+    }
+    ADCSRA = _BV(ADEN) | ADC_PRESCALER_BITS;
+
+    // Prime the filter with one blocking decimated reading.
+    uint16_t sum = 0;
+    for (uint8_t i = 0; i < HAL_ADC_OVERSAMPLE; ++i) {
+        ADCSRA |= _BV(ADSC);
+        while (ADCSRA & _BV(ADSC));
+        sum += ADC;
+    }
+    fixed_ema_init(&filter, ADC_FILTER_SHIFT);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        filtered_value = fixed_ema_update(&filter, sum >> 2);
+        oversample_sum = 0;
+        oversample_count = 0;
+    }
+
+    // From here on every Timer0 compare match starts a conversion.
+    ADCSRB = ADC_TRIGGER_TIMER0_COMPA;
+    ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADIF) | ADC_PRESCALER_BITS;
+    log_info("ADC: Sampling channel %u in the background", channel);
+}
+
+uint16_t hal_adc_get_filtered(void) {
+    uint16_t value;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        value = filtered_value;
+    }
+    return value;
+}
+
+// --- Interrupt Service Routine ---
+
+ISR(ADC_vect) {
+    oversample_sum += ADC;
+    if (++oversample_count == HAL_ADC_OVERSAMPLE) {
+        filtered_value = fixed_ema_update(&filter, oversample_sum >> 2); // 16 x 10 bit -> 12 bit
+        oversample_sum = 0;
+        oversample_count = 0;
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * @file debug_uart.c
+ * @brief Transmit-only software UART on the debug pin, driven by Timer2.
+ * The compare match ISR writes the bit computed on its previous run first,
+ * so edges stay on the timer grid whatever else delays the ISR.
+ */
+
+#include "hal/debug_uart.h"
+#include "util/ring_buffer.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/power.h>
+#include <util/atomic.h>
+
+#if LOG_TO_DEBUG_PIN
+
+// --- Defines ---
+#ifndef DEBUG_UART_TX_BUFFER_SIZE
+#define DEBUG_UART_TX_BUFFER_SIZE 64
+#endif
+#define DEBUG_UART_TIMER_HZ (F_CPU / 8) // Timer2 prescaler 8
+
+_Static_assert(RING_BUFFER_SIZE_VALID(DEBUG_UART_TX_BUFFER_SIZE), "DEBUG_UART_TX_BUFFER_SIZE must be a power of two");
+
+// --- Internal State ---
+static uint8_t tx_buf_data[DEBUG_UART_TX_BUFFER_SIZE];
+static ring_buffer_t tx_rb;
+static volatile uint16_t tx_shift = 1; // Bits still to send, LSB next; 1 = idle level
+static volatile uint8_t tx_bits = 0;   // Bits left in tx_shift
+static volatile bool tx_active = false;
+
+// --- Public API Implementation ---
+
+void hal_debug_uart_init(uint32_t baud_rate) {
+    ring_buffer_init(&tx_rb, tx_buf_data, DEBUG_UART_TX_BUFFER_SIZE);
+    DEBUG_TX_PORT |= _BV(DEBUG_TX_BIT); // Idle high before the pin becomes an output
+    DEBUG_TX_DDR |= _BV(DEBUG_TX_BIT);
+
+    power_timer2_enable(); // hal_power_init() gated it off
+    TCCR2A = _BV(WGM21);   // CTC, TOP = OCR2A
+    TCCR2B = _BV(CS21);    // clk/8
+    OCR2A = (uint8_t)((DEBUG_UART_TIMER_HZ + baud_rate / 2) / baud_rate - 1);
+    TIMSK2 = 0;            // Enabled only while there is something to send
+}
+
+size_t hal_debug_uart_write(const uint8_t *data, size_t length) {
+    if (!data || length == 0) return 0;
+
+    rb_size_t queued = ring_buffer_write_multi(&tx_rb, data, (rb_size_t)length);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (queued > 0 && !tx_active) {
+            // Start with one idle bit period, then the ISR loads the first byte.
+            tx_shift = 1;
+            tx_bits = 1;
+            tx_active = true;
+            TCNT2 = 0;
+            TIFR2 = _BV(OCF2A);
+            TIMSK2 = _BV(OCIE2A);
+        }
+    }
+    return queued;
+}
+
+size_t hal_debug_uart_tx_space(void) {
+    return ring_buffer_space_remaining(&tx_rb);
+}
+
+bool hal_debug_uart_tx_idle(void) {
+    return !tx_active;
+}
+
+// --- Interrupt Service Routine ---
+
+ISR(TIMER2_COMPA_vect) {
+    if (tx_shift & 1) {
+        DEBUG_TX_PORT |= _BV(DEBUG_TX_BIT);
+    } else {
+        DEBUG_TX_PORT &= (uint8_t)~_BV(DEBUG_TX_BIT);
+    }
+    tx_shift >>= 1;
+    if (--tx_bits != 0) return;
+
+    uint8_t byte;
+    if (ring_buffer_read(&tx_rb, &byte)) {
+        tx_shift = (uint16_t)(((uint16_t)byte << 1) | 0x200); // Start bit, 8 data bits LSB first, stop bit
+        tx_bits = 10;
+    } else {
+        TIMSK2 = 0; // The stop bit just written holds the line idle
+        tx_active = false;
+    }
+}
+
+#endif // LOG_TO_DEBUG_PIN
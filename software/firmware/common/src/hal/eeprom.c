@@ -0,0 +1,44 @@
+/**
+ * @file eeprom.c
+ * @brief EEPROM HAL implementation for ATmega328P.
+ * Uses the EEPROM control registers directly so writes can be started
+ * without the busy-wait in avr-libc's eeprom_write_byte().
+ */
+
+#include "hal/eeprom.h"
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <util/atomic.h> // For ATOMIC_BLOCK
+
+// --- Public API Implementation ---
+
+void hal_eeprom_read(uint16_t address, void *data, uint16_t length) {
+    if (!data || address >= HAL_EEPROM_SIZE) return;
+    if (length > HAL_EEPROM_SIZE - address) {
+        length = HAL_EEPROM_SIZE - address;
+    }
+    eeprom_read_block(data, (const void *)(uintptr_t)address, length);
+}
+
+bool hal_eeprom_is_ready(void) {
+    return !(EECR & _BV(EEPE));
+}
+
+bool hal_eeprom_write_byte(uint16_t address, uint8_t value) {
+    if (address >= HAL_EEPROM_SIZE) return true; // Nothing to do
+    if (!hal_eeprom_is_ready()) return false;
+
+    EEAR = address;
+    EECR |= _BV(EERE);
+    if (EEDR == value) {
+        return true; // Unchanged: no write cycle, no wear
+    }
+
+    EEDR = value;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // EEPE must be set within four cycles of EEMPE
+        EECR = _BV(EEMPE);
+        EECR |= _BV(EEPE);
+    }
+    return true;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file timer.c
+ * @brief Timer HAL implementation for ATmega328P.
+ * Timer0 compare match A fires every 1 ms and advances the tick counter.
+ */
+
+#include "hal/timer.h"
+#include "util/logger.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h> // For ATOMIC_BLOCK
+
+// --- Configuration ---
+#define TIMER0_PRESCALER    64UL
+#define TIMER0_TICKS_PER_MS (F_CPU / TIMER0_PRESCALER / 1000UL) // 250 at 16 MHz
+#define TIMER0_US_PER_TICK  (1000UL / TIMER0_TICKS_PER_MS)      // 4 us
+
+_Static_assert(TIMER0_TICKS_PER_MS >= 2 && TIMER0_TICKS_PER_MS <= 256, "F_CPU does not fit a 1 ms Timer0 CTC tick");
+
+// --- Internal State ---
+static volatile uint32_t tick_ms = 0;
+
+// --- Public API Implementation ---
+
+void hal_timer_init(void) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        tick_ms = 0;
+        TCCR0A = _BV(WGM01);               // CTC mode, TOP = OCR0A
+        TCCR0B = _BV(CS01) | _BV(CS00);    // clk/64
+        OCR0A = (uint8_t)(TIMER0_TICKS_PER_MS - 1);
+        TCNT0 = 0;
+        TIFR0 = _BV(OCF0A);                // Discard any stale match
+        TIMSK0 = _BV(OCIE0A);
+    }
+    log_info("Timer: 1 ms tick started");
+}
+
+uint32_t hal_timer_millis(void) {
+    uint32_t ms;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = tick_ms;
+    }
+    return ms;
+}
+
+uint32_t hal_timer_micros(void) {
+    uint32_t ms;
+    uint8_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms = tick_ms;
+        count = TCNT0;
+        // A match that has not been serviced yet means the counter already wrapped.
+        if ((TIFR0 & _BV(OCF0A)) && count < (TIMER0_TICKS_PER_MS - 1)) {
+            ms++;
+        }
+    }
+    return ms * 1000UL + (uint32_t)count * TIMER0_US_PER_TICK;
+}
+
+void hal_timer_advance_ms(uint32_t ms) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        tick_ms += ms;
+    }
+}
+
+// --- Interrupt Service Routine ---
+
+ISR(TIMER0_COMPA_vect) {
+    tick_ms++;
+}
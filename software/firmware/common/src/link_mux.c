@@ -0,0 +1,111 @@
+/**
+ * @file link_mux.c
+ * @brief Channel priorities and the log byte budget on the BLE UART.
+ * Shared by both firmware trees; uses the tree's hal/uart (and hal/debug_uart
+ * when logs go to the debug pin).
+ */
+
+#include "link_mux.h"
+#include "ble_protocol.h" // For BLE_PROTO_MAX_FRAME
+#include "hal/uart.h"
+#include "hal/timer.h"
+#if LOG_TO_DEBUG_PIN
+#include "hal/debug_uart.h"
+#endif
+
+// --- Defines ---
+#ifndef LINK_DATA_RESERVE_BYTES
+#define LINK_DATA_RESERVE_BYTES BLE_PROTO_MAX_FRAME // Room always left for one more data frame
+#endif
+#define BUDGET_SCALE 1000UL // Credit is kept in byte-milliseconds so slow rates still accrue
+
+// --- Internal State ---
+static uint32_t log_credit = (uint32_t)LOG_BUDGET_BURST_BYTES * BUDGET_SCALE;
+static uint32_t refill_ms = 0;
+static link_stats_t stats;
+
+// --- Helper Functions ---
+
+static size_t log_tx_space(void) {
+#if LOG_TO_DEBUG_PIN
+    return hal_debug_uart_tx_space();
+#else
+    size_t space = hal_uart_tx_space(LOG_UART_ID);
+    if (LOG_UART_ID == BLE_UART_ID) {
+        space = (space > LINK_DATA_RESERVE_BYTES) ? space - LINK_DATA_RESERVE_BYTES : 0;
+    }
+    return space;
+#endif
+}
+
+static bool log_tx_idle(void) {
+#if LOG_TO_DEBUG_PIN
+    return hal_debug_uart_tx_idle();
+#else
+    return hal_uart_tx_idle(LOG_UART_ID);
+#endif
+}
+
+static bool budget_allows(size_t length) {
+#if LOG_BUDGET_BYTES_PER_S
+    uint32_t now = hal_timer_millis();
+    uint32_t elapsed = now - refill_ms;
+    refill_ms = now;
+    if (elapsed > 60000UL) elapsed = 60000UL; // Long sleeps refill the bucket anyway
+    log_credit += elapsed * LOG_BUDGET_BYTES_PER_S;
+    if (log_credit > (uint32_t)LOG_BUDGET_BURST_BYTES * BUDGET_SCALE) {
+        log_credit = (uint32_t)LOG_BUDGET_BURST_BYTES * BUDGET_SCALE;
+    }
+    return log_credit >= length * BUDGET_SCALE;
+#else
+    (void)length;
+    return true;
+#endif
+}
+
+// --- Public API Implementation ---
+
+bool link_mux_send(link_channel_t channel, const uint8_t *bytes, size_t length) {
+    if (length == 0) return false;
+
+    if (channel == LINK_CHANNEL_DATA) {
+        if (hal_uart_tx_space(BLE_UART_ID) < length) {
+            stats.data_dropped++;
+            return false; // A partial frame would desync the receiver's parser
+        }
+        hal_uart_write(BLE_UART_ID, bytes, length);
+        stats.data_bytes += length;
+        return true;
+    }
+
+    if (!link_mux_log_can_send(length)) {
+        stats.log_refused++;
+        return false;
+    }
+#if LOG_BUDGET_BYTES_PER_S
+    log_credit -= length * BUDGET_SCALE;
+#endif
+#if LOG_TO_DEBUG_PIN
+    hal_debug_uart_write(bytes, length);
+#else
+    hal_uart_write(LOG_UART_ID, bytes, length);
+#endif
+    stats.log_bytes += length;
+    return true;
+}
+
+bool link_mux_log_can_send(size_t length) {
+    return log_tx_space() >= length && budget_allows(length);
+}
+
+bool link_mux_log_too_big(size_t length) {
+    if (LOG_BUDGET_BYTES_PER_S != 0 && length > LOG_BUDGET_BURST_BYTES) {
+        return true;
+    }
+    return log_tx_idle() && log_tx_space() < length;
+}
+
+void link_mux_get_stats(link_stats_t *out) {
+    if (!out) return;
+    *out = stats;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file fixed.c
+ * @brief Integer geometry helpers (see fixed.h).
+ * Shared by both firmware trees; no floating point anywhere.
+ */
+
+#include "util/fixed.h"
+#include <avr/pgmspace.h>
+
+// --- Defines ---
+#define M_PER_UDEG_Q16   7287UL      // 0.111195 m per micro-degree of latitude
+#define UDEG_HALF_TURN   180000000L
+#define UDEG_PER_STEP    5000000UL   // cos table step: 5 degrees
+
+// cos(0..90 degrees in 5 degree steps), Q15, in flash
+static const uint16_t cos_q15_table[19] PROGMEM = {
+    32767, 32643, 32270, 31651, 30792, 29698, 28378, 26842, 25102, 23170,
+    21063, 18795, 16384, 13848, 11207, 8481, 5690, 2856, 0
+};
+
+// --- Internal Helpers ---
+
+// Longitude difference wrapped to +/-180 degrees.
+static int32_t wrap_delta_lon(int32_t delta_e6) {
+    if (delta_e6 > UDEG_HALF_TURN) return delta_e6 - 2 * UDEG_HALF_TURN;
+    if (delta_e6 < -UDEG_HALF_TURN) return delta_e6 + 2 * UDEG_HALF_TURN;
+    return delta_e6;
+}
+
+// --- Public API Implementation ---
+
+uint16_t fixed_isqrt32(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > value) bit >>= 2;
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint16_t)root;
+}
+
+uint16_t fixed_cos_lat_q15(int32_t lat_e6) {
+    uint32_t a = (lat_e6 < 0) ? (uint32_t)-lat_e6 : (uint32_t)lat_e6;
+    if (a >= 90000000UL) return 0;
+    uint8_t idx = (uint8_t)(a / UDEG_PER_STEP);
+    uint16_t frac = (uint16_t)((a % UDEG_PER_STEP) / 5000UL); // 0..999
+    int32_t c0 = pgm_read_word(&cos_q15_table[idx]);
+    int32_t c1 = pgm_read_word(&cos_q15_table[idx + 1]);
+    return (uint16_t)(c0 - ((c0 - c1) * frac) / 1000);
+}
+
+void fixed_sin_cos_q15(uint16_t deg_x100, q15_t *sin_q15, q15_t *cos_q15) {
+    uint16_t a = deg_x100 % 36000;
+    uint8_t quadrant = (uint8_t)(a / 9000);
+    uint16_t r = a % 9000;
+    q15_t c = (q15_t)fixed_cos_lat_q15((int32_t)r * 10000L);          // cos(r)
+    q15_t s = (q15_t)fixed_cos_lat_q15((int32_t)(9000 - r) * 10000L); // sin(r)
+    switch (quadrant) {
+        case 0:  *sin_q15 = s;  *cos_q15 = c;  break;
+        case 1:  *sin_q15 = c;  *cos_q15 = -s; break;
+        case 2:  *sin_q15 = -s; *cos_q15 = -c; break;
+        default: *sin_q15 = -c; *cos_q15 = s;  break;
+    }
+}
+
+int32_t fixed_udeg_to_m(int32_t delta_e6) {
+    // Split so both partial products fit in 32 bits for any input.
+    int32_t hi = delta_e6 >> 16;
+    int32_t lo = delta_e6 & 0xFFFF;
+    return hi * (int32_t)M_PER_UDEG_Q16 + (int32_t)(((uint32_t)lo * M_PER_UDEG_Q16) >> 16);
+}
+
+void fixed_equirect_offset_m(int32_t origin_lat_e6, int32_t origin_lon_e6, uint16_t cos_lat_q15,
+                             int32_t lat_e6, int32_t lon_e6, int32_t *east_m, int32_t *north_m) {
+    int32_t north = fixed_udeg_to_m(lat_e6 - origin_lat_e6);
+    int32_t east = fixed_udeg_to_m(wrap_delta_lon(lon_e6 - origin_lon_e6));
+    east = fixed_clamp_i32(east, -FIXED_EQUIRECT_LIMIT_M, FIXED_EQUIRECT_LIMIT_M);
+    *north_m = fixed_clamp_i32(north, -FIXED_EQUIRECT_LIMIT_M, FIXED_EQUIRECT_LIMIT_M);
+    *east_m = (east * (int32_t)cos_lat_q15) >> 15; // |east| <= 22000, so this fits
+}
+
+uint16_t fixed_hypot_m(int32_t east_m, int32_t north_m) {
+    uint32_t ax = (east_m < 0) ? (uint32_t)-east_m : (uint32_t)east_m;
+    uint32_t ay = (north_m < 0) ? (uint32_t)-north_m : (uint32_t)north_m;
+    if (ax > UINT16_MAX || ay > UINT16_MAX) return UINT16_MAX;
+    uint32_t sum = ax * ax;
+    uint32_t y2 = ay * ay;
+    if (sum > UINT32_MAX - y2) return UINT16_MAX;
+    return fixed_isqrt32(sum + y2);
+}
+
+uint32_t fixed_equirect_distance_m(int32_t lat1_e6, int32_t lon1_e6, int32_t lat2_e6, int32_t lon2_e6) {
+    int32_t mid_lat = lat1_e6 / 2 + lat2_e6 / 2;
+    int32_t north = fixed_udeg_to_m(lat2_e6 - lat1_e6);
+    int32_t east = fixed_scale_q15(fixed_udeg_to_m(wrap_delta_lon(lon2_e6 - lon1_e6)), (q15_t)fixed_cos_lat_q15(mid_lat));
+
+    uint32_t ax = (east < 0) ? (uint32_t)-east : (uint32_t)east;
+    uint32_t ay = (north < 0) ? (uint32_t)-north : (uint32_t)north;
+    uint8_t shift = 0;
+    while ((ax | ay) > 32767UL) { // Keep x^2 + y^2 below 2^31
+        ax >>= 1;
+        ay >>= 1;
+        shift++;
+    }
+    return (uint32_t)fixed_isqrt32(ax * ax + ay * ay) << shift;
+}
+
+// atan(z) in degrees for z = 0..256 (Q8, 0..1): 45z + 15.64z(1-z).
+static uint16_t atan_deg_q8(uint16_t z) {
+    uint32_t num = (uint32_t)z * (45UL * 256 + ((4004UL * (256 - z)) >> 8));
+    return (uint16_t)((num + 32768UL) >> 16);
+}
+
+uint16_t fixed_bearing_deg(int32_t east_m, int32_t north_m) {
+    uint32_t ax = (east_m < 0) ? (uint32_t)-east_m : (uint32_t)east_m;
+    uint32_t ay = (north_m < 0) ? (uint32_t)-north_m : (uint32_t)north_m;
+    if (ax == 0 && ay == 0) return 0;
+    while ((ax | ay) > 0xFFFFFFUL) { // Keep the << 8 below from overflowing
+        ax >>= 1;
+        ay >>= 1;
+    }
+
+    uint16_t a = (ax <= ay) ? atan_deg_q8((uint16_t)((ax << 8) / ay))
+                            : 90 - atan_deg_q8((uint16_t)((ay << 8) / ax));
+    if (north_m >= 0) {
+        return (east_m >= 0) ? a : (uint16_t)((360 - a) % 360);
+    }
+    return (east_m >= 0) ? (uint16_t)(180 - a) : (uint16_t)(180 + a);
+}
@@ -0,0 +1,191 @@
+/**
+ * @file log_queue.c
+ * @brief Record queue for tokenized logging (LOG_TOKENIZED).
+ * Shared by both firmware trees. log_tokenized() packs a record into a RAM
+ * ring from any context; logger_service() frames queued records as
+ * BLE_MSG_LOG and hands them to the log channel (link_mux.h) when the main
+ * loop is idle. Records wait in the ring while the channel refuses them, so
+ * the log budget turns bursts into drop reports rather than lost data frames.
+ */
+
+#include "util/logger.h"
+#include "util/ring_buffer.h"
+#include "hal/timer.h"
+#include "ble_protocol.h"
+#include "link_mux.h"
+#include <stdarg.h>
+#include <string.h>
+#include <util/atomic.h>
+
+#if ENABLE_LOGGING && LOG_TOKENIZED
+
+// --- Defines ---
+#ifndef LOG_QUEUE_SIZE
+#define LOG_QUEUE_SIZE 128
+#endif
+#define LOG_FLUSH_TIMEOUT_MS 50 // logger_flush() gives up if the output stops draining
+
+_Static_assert(RING_BUFFER_SIZE_VALID(LOG_QUEUE_SIZE), "LOG_QUEUE_SIZE must be a power of two (2..256)");
+
+// --- Internal State ---
+// Each queued record is its payload length followed by the payload.
+static uint8_t queue_data[LOG_QUEUE_SIZE];
+static ring_buffer_t queue;
+static bool queue_open = false; // Set once ring_buffer_init() has run
+static volatile uint16_t dropped = 0; // Records lost since the last drop report
+
+// --- Helper Functions ---
+
+// Call with interrupts disabled.
+static void open_queue(void) {
+    if (!queue_open) {
+        ring_buffer_init(&queue, queue_data, LOG_QUEUE_SIZE);
+        queue_open = true;
+    }
+}
+
+// Frames and sends one payload if the log channel takes the whole frame now.
+static bool send_record(const uint8_t *payload, uint8_t length) {
+    uint8_t frame[BLE_PROTO_MAX_FRAME];
+    size_t frame_len = ble_frame_encode(frame, sizeof(frame), BLE_MSG_LOG, payload, length);
+    return link_mux_send(LINK_CHANNEL_LOG, frame, frame_len);
+}
+
+static void count_drop(void) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (dropped != UINT16_MAX) dropped++;
+    }
+}
+
+// Appends n bytes to a record payload if they fit.
+static bool append(uint8_t *payload, uint8_t *length, const void *src, uint8_t n) {
+    if (n > BLE_PROTO_MAX_PAYLOAD - *length) {
+        return false;
+    }
+    memcpy(&payload[*length], src, n);
+    *length += n;
+    return true;
+}
+
+static bool send_drop_report(void) {
+    uint16_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        count = dropped;
+    }
+    if (count == 0) {
+        return false;
+    }
+    uint8_t payload[4];
+    ble_put_u16(&payload[0], LOG_TOKEN_DROPPED);
+    ble_put_u16(&payload[2], count);
+    if (!send_record(payload, sizeof(payload))) {
+        return false;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        dropped -= count; // Keep drops counted while the report was going out
+    }
+    return true;
+}
+
+// --- Public API Implementation ---
+
+void log_queue_init(void) {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        open_queue(); // Keeps anything logged before logger_init()
+    }
+}
+
+void log_tokenized(uint16_t token, uint16_t arg_info, ...) {
+    uint8_t record[1 + BLE_PROTO_MAX_PAYLOAD];
+    uint8_t *payload = &record[1];
+    uint8_t length = 2;
+    ble_put_u16(payload, token);
+
+    // Both targets are little-endian, so values are copied as stored.
+    va_list args;
+    va_start(args, arg_info);
+    uint8_t count = (uint8_t)(arg_info >> LOG_ARG_COUNT_SHIFT);
+    bool fits = true;
+    for (uint8_t i = 0; i < count && fits; ++i, arg_info >>= 2) {
+        switch (arg_info & 0x03) {
+            case LOG_ARG_INT16: {
+                uint16_t v = (uint16_t)va_arg(args, unsigned int);
+                fits = append(payload, &length, &v, sizeof(v));
+                break;
+            }
+            case LOG_ARG_INT32: {
+                uint32_t v = va_arg(args, uint32_t);
+                fits = append(payload, &length, &v, sizeof(v));
+                break;
+            }
+            case LOG_ARG_STRING: {
+                const char *s = va_arg(args, const char *);
+                uint8_t n = s ? (uint8_t)strnlen(s, LOG_MAX_STRING_LEN) : 0;
+                fits = append(payload, &length, &n, 1) && append(payload, &length, s, n);
+                break;
+            }
+            default: {
+                uint64_t v = va_arg(args, uint64_t);
+                fits = append(payload, &length, &v, sizeof(v));
+                break;
+            }
+        }
+    } // A truncated record shows its missing arguments as '?' in the decoder
+    va_end(args);
+
+    record[0] = length;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        open_queue(); // Fallback if something logs before logger_init()
+        if (ring_buffer_space_remaining(&queue) > length) {
+            ring_buffer_write_multi(&queue, record, (rb_size_t)length + 1);
+        } else {
+            count_drop();
+        }
+    }
+}
+
+bool logger_service(void) {
+    uint8_t payload[BLE_PROTO_MAX_PAYLOAD];
+    uint8_t length;
+    bool sent = false;
+
+    while (ring_buffer_peek(&queue, &length, 0)) {
+        size_t frame_len = (size_t)length + BLE_PROTO_OVERHEAD;
+        bool never_fits = link_mux_log_too_big(frame_len);
+        if (!never_fits && !link_mux_log_can_send(frame_len)) {
+            return sent; // Link busy or budget spent; try again next pass
+        }
+        ring_buffer_read(&queue, &length);
+        ring_buffer_read_multi(&queue, payload, length);
+        if (never_fits) {
+            count_drop();
+            continue;
+        }
+        send_record(payload, length);
+        sent = true;
+    }
+    if (send_drop_report()) { // Only once the queue has drained
+        sent = true;
+    }
+    return sent;
+}
+
+void logger_flush(void) {
+    uint32_t start = hal_timer_millis();
+    while ((!ring_buffer_is_empty(&queue) || dropped != 0) &&
+           hal_timer_millis() - start < LOG_FLUSH_TIMEOUT_MS) {
+        logger_service();
+    }
+}
+
+#else // Text logging or logging disabled: nothing is ever queued
+
+void log_queue_init(void) {}
+
+bool logger_service(void) {
+    return false;
+}
+
+void logger_flush(void) {}
+
+#endif // ENABLE_LOGGING && LOG_TOKENIZED
@@ -0,0 +1,198 @@
+/**
+ * @file perf.c
+ * @brief Section timing on Timer1 and the STATS report (ENABLE_PERF_COUNTERS).
+ * Shared by both firmware trees; the section and counter lists come from the
+ * tree's perf_sections.h.
+ */
+
+#include "util/perf.h"
+
+#if ENABLE_PERF_COUNTERS
+
+#include "ble_protocol.h"
+#include "link_mux.h"
+#include "hal/timer.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/power.h>
+#include <avr/pgmspace.h>
+#include <string.h>
+#include <util/atomic.h>
+
+// --- Defines ---
+#define PERF_NAME_STR_(id, name) static const char perf_name_##id[] PROGMEM = name;
+#define PERF_NAME_REF_(id, name) perf_name_##id,
+
+PERF_SECTIONS(PERF_NAME_STR_)
+PERF_COUNTERS(PERF_NAME_STR_)
+
+static PGM_P const section_names[] PROGMEM = { PERF_SECTIONS(PERF_NAME_REF_) };
+static PGM_P const counter_names[] PROGMEM = { PERF_COUNTERS(PERF_NAME_REF_) };
+
+_Static_assert(PERF_SECTION_COUNT + PERF_COUNTER_COUNT < 255, "Too many perf items for one report");
+_Static_assert(BLE_STATS_SECTION_LEN + PERF_NAME_MAX_LEN <= BLE_PROTO_MAX_PAYLOAD, "Stats section frame too long");
+
+// --- Internal State ---
+static volatile uint16_t overflows = 0; // Timer1 high word
+static perf_cycles_t overhead = 0;      // Cycles a back-to-back begin/end reads as
+static perf_section_stats_t sections[PERF_SECTION_COUNT];
+static uint32_t counters[PERF_COUNTER_COUNT];
+static uint32_t window_start_ms = 0;
+
+// Report progress: 0 is the header, then sections, then counters.
+static uint8_t report_next = 0;
+static bool report_active = false;
+static bool report_reset = false;
+
+// --- Interrupt Service Routine ---
+
+ISR(TIMER1_OVF_vect) {
+    overflows++;
+}
+
+// --- Helper Functions ---
+
+// Copies a PROGMEM name after the fixed fields; returns the bytes used.
+static uint8_t put_name(uint8_t *out, PGM_P name) {
+    size_t n = strnlen_P(name, PERF_NAME_MAX_LEN);
+    memcpy_P(out, name, n);
+    return (uint8_t)n;
+}
+
+// Builds report item `index`; returns the payload length.
+static uint8_t build_item(uint8_t index, uint8_t *payload) {
+    if (index == 0) {
+        payload[0] = BLE_STATS_KIND_HEADER;
+        ble_put_u32(&payload[1], hal_timer_millis() - window_start_ms);
+        payload[5] = PERF_SECTION_COUNT;
+        payload[6] = PERF_COUNTER_COUNT;
+        ble_put_u32(&payload[7], F_CPU);
+        return BLE_STATS_HEADER_LEN;
+    }
+
+    index--;
+    if (index < PERF_SECTION_COUNT) {
+        const perf_section_stats_t *s = &sections[index];
+        payload[0] = BLE_STATS_KIND_SECTION;
+        payload[1] = index;
+        ble_put_u32(&payload[2], s->count);
+        ble_put_u32(&payload[6], s->count ? s->min : 0);
+        ble_put_u32(&payload[10], s->max);
+        ble_put_u32(&payload[14], s->count ? s->total / s->count : 0);
+        return BLE_STATS_SECTION_LEN +
+               put_name(&payload[BLE_STATS_SECTION_LEN], (PGM_P)pgm_read_ptr(&section_names[index]));
+    }
+
+    index -= PERF_SECTION_COUNT;
+    payload[0] = BLE_STATS_KIND_COUNTER;
+    payload[1] = index;
+    ble_put_u32(&payload[2], counters[index]);
+    return BLE_STATS_COUNTER_LEN +
+           put_name(&payload[BLE_STATS_COUNTER_LEN], (PGM_P)pgm_read_ptr(&counter_names[index]));
+}
+
+// --- Public API Implementation ---
+
+void perf_init(void) {
+    power_timer1_enable(); // hal_power_init() gated it off
+    TCCR1A = 0;            // Normal mode, free running to 0xFFFF
+    TCCR1B = _BV(CS10);    // clk/1
+    TCNT1 = 0;
+    TIFR1 = _BV(TOV1);
+    TIMSK1 = _BV(TOIE1);
+
+    // An empty section measures only the two reads; keep the fastest of a few tries.
+    overhead = UINT32_MAX;
+    for (uint8_t i = 0; i < 8; ++i) {
+        perf_cycles_t start = perf_cycles();
+        perf_cycles_t elapsed = perf_cycles() - start;
+        if (elapsed < overhead) overhead = elapsed;
+    }
+    perf_reset();
+}
+
+perf_cycles_t perf_cycles(void) {
+    uint16_t low, high;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        low = TCNT1;
+        high = overflows;
+        if ((TIFR1 & _BV(TOV1)) && low < 0x8000) {
+            high++; // Wrapped after interrupts went off; the ISR has not counted it yet
+        }
+    }
+    return ((perf_cycles_t)high << 16) | low;
+}
+
+void perf_record(perf_section_t section, perf_cycles_t start) {
+    if (section >= PERF_SECTION_COUNT) return;
+    perf_cycles_t elapsed = perf_cycles() - start;
+    elapsed = (elapsed > overhead) ? elapsed - overhead : 0;
+
+    perf_section_stats_t *s = &sections[section];
+    if (s->total > UINT32_MAX - elapsed || s->count == UINT32_MAX) {
+        s->total /= 2; // Keeps the average, weighting recent runs a little more
+        s->count /= 2;
+    }
+    if (s->count == 0 || elapsed < s->min) s->min = elapsed;
+    if (elapsed > s->max) s->max = elapsed;
+    s->total += elapsed;
+    s->count++;
+}
+
+void perf_scope_end(perf_scope_t *scope) {
+    perf_record((perf_section_t)scope->section, scope->start);
+}
+
+void perf_count(perf_counter_t counter) {
+    if (counter < PERF_COUNTER_COUNT && counters[counter] != UINT32_MAX) {
+        counters[counter]++;
+    }
+}
+
+void perf_counter_set(perf_counter_t counter, uint32_t value) {
+    if (counter < PERF_COUNTER_COUNT) {
+        counters[counter] = value;
+    }
+}
+
+bool perf_get_section(perf_section_t section, perf_section_stats_t *stats) {
+    if (section >= PERF_SECTION_COUNT || !stats) return false;
+    *stats = sections[section];
+    return true;
+}
+
+uint32_t perf_get_counter(perf_counter_t counter) {
+    return (counter < PERF_COUNTER_COUNT) ? counters[counter] : 0;
+}
+
+void perf_reset(void) {
+    memset(sections, 0, sizeof(sections));
+    memset(counters, 0, sizeof(counters));
+    window_start_ms = hal_timer_millis();
+}
+
+void perf_report_start(bool reset_after) {
+    report_next = 0;
+    report_active = true;
+    report_reset = reset_after;
+}
+
+bool perf_report_service(void) {
+    if (!report_active) return false;
+
+    uint8_t payload[BLE_PROTO_MAX_PAYLOAD];
+    uint8_t frame[BLE_PROTO_MAX_FRAME];
+    uint8_t length = build_item(report_next, payload);
+    size_t frame_len = ble_frame_encode(frame, sizeof(frame), BLE_MSG_STATS, payload, length);
+    if (!link_mux_send(LINK_CHANNEL_LOG, frame, frame_len)) {
+        return false; // Link busy or log budget spent; retry on a later pass
+    }
+
+    if (++report_next > PERF_SECTION_COUNT + PERF_COUNTER_COUNT) {
+        report_active = false;
+        if (report_reset) perf_reset();
+    }
+    return true;
+}
+
+#endif // ENABLE_PERF_COUNTERS
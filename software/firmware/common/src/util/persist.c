@@ -0,0 +1,94 @@
+/**
+ * @file persist.c
+ * @brief Wear-levelled EEPROM records (see persist.h).
+ */
+
+#include "util/persist.h"
+#include "hal/eeprom.h"
+#include <util/crc16.h>
+#include <string.h> // For memcpy
+
+// --- Defines ---
+#define SLOT_OFS_SEQ     0
+#define SLOT_OFS_VERSION 1
+#define SLOT_OFS_DATA    2
+
+// --- Internal State ---
+static uint8_t stage[PERSIST_MAX_LENGTH + PERSIST_OVERHEAD]; // Slot being written
+static uint16_t stage_address = 0;
+static uint8_t stage_length = 0;
+static uint8_t stage_pos = 0;
+
+// --- Internal Helper Functions ---
+
+static uint16_t slot_crc(const uint8_t *slot, uint8_t length) {
+    uint16_t crc = 0;
+    for (uint8_t i = 0; i < SLOT_OFS_DATA + length; ++i) {
+        crc = _crc_xmodem_update(crc, slot[i]);
+    }
+    return crc;
+}
+
+static uint16_t slot_address(const persist_record_t *record, uint8_t slot) {
+    return record->base + (uint16_t)slot * (record->length + PERSIST_OVERHEAD);
+}
+
+// --- Public API Implementation ---
+
+bool persist_load(persist_record_t *record, void *data) {
+    uint8_t slot[PERSIST_MAX_LENGTH + PERSIST_OVERHEAD];
+    uint8_t length = record->length;
+    record->slot = record->slots;
+    record->seq = 0;
+    if (length > PERSIST_MAX_LENGTH) return false;
+
+    for (uint8_t i = 0; i < record->slots; ++i) {
+        hal_eeprom_read(slot_address(record, i), slot, length + PERSIST_OVERHEAD);
+        uint16_t stored_crc = (uint16_t)slot[SLOT_OFS_DATA + length] | ((uint16_t)slot[SLOT_OFS_DATA + length + 1] << 8);
+        if (slot[SLOT_OFS_VERSION] != record->version || stored_crc != slot_crc(slot, length)) {
+            continue;
+        }
+        // Newer in serial number order: the ring is short, so seq never laps it
+        if (record->slot == record->slots || (int8_t)(slot[SLOT_OFS_SEQ] - record->seq) > 0) {
+            record->slot = i;
+            record->seq = slot[SLOT_OFS_SEQ];
+            memcpy(data, &slot[SLOT_OFS_DATA], length);
+        }
+    }
+    return record->slot < record->slots;
+}
+
+bool persist_save(persist_record_t *record, const void *data) {
+    uint8_t length = record->length;
+    if (stage_pos < stage_length || length > PERSIST_MAX_LENGTH || record->slots == 0) {
+        return false;
+    }
+
+    uint8_t next = (record->slot + 1 < record->slots) ? record->slot + 1 : 0;
+    record->seq++;
+    record->slot = next;
+
+    stage[SLOT_OFS_SEQ] = record->seq;
+    stage[SLOT_OFS_VERSION] = record->version;
+    memcpy(&stage[SLOT_OFS_DATA], data, length);
+    uint16_t crc = slot_crc(stage, length);
+    stage[SLOT_OFS_DATA + length] = (uint8_t)crc;
+    stage[SLOT_OFS_DATA + length + 1] = (uint8_t)(crc >> 8);
+
+    stage_address = slot_address(record, next);
+    stage_length = length + PERSIST_OVERHEAD;
+    stage_pos = 0;
+    return true;
+}
+
+bool persist_poll(void) {
+    // At most one byte per call is started; the next call finds the EEPROM busy.
+    while (stage_pos < stage_length && hal_eeprom_write_byte(stage_address + stage_pos, stage[stage_pos])) {
+        stage_pos++;
+    }
+    return stage_pos < stage_length;
+}
+
+bool persist_is_busy(void) {
+    return stage_pos < stage_length;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file ring_buffer.c
+ * @brief Lock-free SPSC ring buffer implementation.
+ * Shared by both firmware trees. Safe between one ISR and the main loop
+ * without disabling interrupts (see ring_buffer.h for the ownership rules).
+ */
+
+#include "util/ring_buffer.h"
+#include <stddef.h> // For NULL
+#include <string.h> // For memcpy
+
+// Compiler barrier: keeps buffer accesses on the right side of the index
+// update. The AVR core does not reorder memory accesses, so this is enough.
+#define RB_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+// --- Internal Helpers ---
+
+static inline rb_size_t rb_capacity(const ring_buffer_t *rb) {
+    return (rb_size_t)rb->mask + 1;
+}
+
+static inline rb_size_t rb_used(const ring_buffer_t *rb, rb_index_t head, rb_index_t tail) {
+    return (rb_index_t)(head - tail) & rb->mask;
+}
+
+// --- Public API Implementation ---
+
+void ring_buffer_init(ring_buffer_t *rb, uint8_t *buffer, rb_size_t size) {
+    if (!rb || !buffer || !RING_BUFFER_SIZE_VALID(size)) {
+        return; // Invalid arguments
+    }
+    rb->buffer = buffer;
+    rb->mask = (rb_index_t)(size - 1);
+    rb->head = 0;
+    rb->tail = 0;
+}
+
+bool ring_buffer_write(ring_buffer_t *rb, uint8_t data) {
+    rb_index_t head = rb->head;
+    rb_index_t next = (rb_index_t)(head + 1) & rb->mask;
+    if (next == rb->tail) {
+        return false; // Buffer full
+    }
+    rb->buffer[head] = data;
+    RB_BARRIER();
+    rb->head = next; // Publish after the data is in place
+    return true;
+}
+
+bool ring_buffer_read(ring_buffer_t *rb, uint8_t *data) {
+    rb_index_t tail = rb->tail;
+    if (tail == rb->head) {
+        return false; // Buffer empty
+    }
+    RB_BARRIER();
+    *data = rb->buffer[tail];
+    RB_BARRIER();
+    rb->tail = (rb_index_t)(tail + 1) & rb->mask; // Release the slot after reading it
+    return true;
+}
+
+bool ring_buffer_peek(const ring_buffer_t *rb, uint8_t *data, rb_size_t offset) {
+    rb_index_t tail = rb->tail;
+    if (!data || offset >= rb_used(rb, rb->head, tail)) {
+        return false; // Offset out of bounds
+    }
+    RB_BARRIER();
+    *data = rb->buffer[(rb_index_t)(tail + offset) & rb->mask];
+    return true;
+}
+
+rb_size_t ring_buffer_bytes_available(const ring_buffer_t *rb) {
+    return rb_used(rb, rb->head, rb->tail);
+}
+
+rb_size_t ring_buffer_space_remaining(const ring_buffer_t *rb) {
+    return rb->mask - rb_used(rb, rb->head, rb->tail);
+}
+
+bool ring_buffer_is_empty(const ring_buffer_t *rb) {
+    return rb->head == rb->tail;
+}
+
+bool ring_buffer_is_full(const ring_buffer_t *rb) {
+    return (((rb_index_t)(rb->head + 1)) & rb->mask) == rb->tail;
+}
+
+void ring_buffer_clear(ring_buffer_t *rb) {
+    rb->tail = rb->head; // Consumer-side: drop everything written so far
+}
+
+rb_size_t ring_buffer_write_multi(ring_buffer_t *rb, const uint8_t *data, rb_size_t length) {
+    rb_size_t written = 0;
+    uint8_t *span;
+    // At most two passes: up to the end of storage, then from the start.
+    for (uint8_t pass = 0; pass < 2 && written < length; ++pass) {
+        rb_size_t run = ring_buffer_write_span(rb, &span);
+        if (run == 0) break;
+        if (run > length - written) run = length - written;
+        memcpy(span, data + written, run);
+        ring_buffer_write_commit(rb, run);
+        written += run;
+    }
+    return written;
+}
+
+rb_size_t ring_buffer_read_multi(ring_buffer_t *rb, uint8_t *buffer, rb_size_t length) {
+    rb_size_t bytes_read = 0;
+    const uint8_t *span;
+    for (uint8_t pass = 0; pass < 2 && bytes_read < length; ++pass) {
+        rb_size_t run = ring_buffer_read_span(rb, &span);
+        if (run == 0) break;
+        if (run > length - bytes_read) run = length - bytes_read;
+        memcpy(buffer + bytes_read, span, run);
+        ring_buffer_read_commit(rb, run);
+        bytes_read += run;
+    }
+    return bytes_read;
+}
+
+rb_size_t ring_buffer_read_span(const ring_buffer_t *rb, const uint8_t **data) {
+    rb_index_t head = rb->head;
+    rb_index_t tail = rb->tail;
+    RB_BARRIER();
+    *data = &rb->buffer[tail];
+    if (head >= tail) {
+        return (rb_size_t)(head - tail);
+    }
+    return rb_capacity(rb) - tail; // Run up to the end of storage
+}
+
+void ring_buffer_read_commit(ring_buffer_t *rb, rb_size_t length) {
+    RB_BARRIER();
+    rb->tail = (rb_index_t)(rb->tail + length) & rb->mask;
+}
+
+rb_size_t ring_buffer_write_span(ring_buffer_t *rb, uint8_t **data) {
+    rb_index_t head = rb->head;
+    rb_size_t space = rb->mask - rb_used(rb, head, rb->tail);
+    rb_size_t to_end = rb_capacity(rb) - head;
+    *data = &rb->buffer[head];
+    return (space < to_end) ? space : to_end;
+}
+
+void ring_buffer_write_commit(ring_buffer_t *rb, rb_size_t length) {
+    RB_BARRIER();
+    rb->head = (rb_index_t)(rb->head + length) & rb->mask;
+}
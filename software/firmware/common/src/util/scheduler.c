@@ -0,0 +1,177 @@
+/**
+ * @file scheduler.c
+ * @brief Cooperative task scheduler implementation.
+ * Shared by both firmware trees; uses the tree's hal/timer for time.
+ */
+
+#include "util/scheduler.h"
+#include "hal/timer.h"
+#include "util/logger.h"
+#include <stddef.h> // For NULL
+
+// --- Internal Data Structures ---
+
+typedef struct {
+    task_fn_t fn;
+    const char *name;
+    uint32_t next_run_ms;
+    uint16_t period_ms;
+    uint8_t priority;
+    bool enabled;
+    volatile bool pending; // Set by scheduler_signal(), possibly from an ISR
+    uint16_t worst_us;
+    uint16_t last_us;
+    uint16_t overruns;
+    uint32_t run_count;
+} sched_task_t;
+
+static sched_task_t tasks[SCHEDULER_MAX_TASKS];
+static uint8_t task_count = 0;
+
+// --- Internal Helper Functions ---
+
+// Wrap-safe "deadline has passed" check.
+static inline bool time_reached(uint32_t now, uint32_t deadline) {
+    return (int32_t)(now - deadline) >= 0;
+}
+
+static bool task_is_due(const sched_task_t *t, uint32_t now) {
+    if (!t->enabled) return false;
+    if (t->pending) return true;
+    return t->period_ms != 0 && time_reached(now, t->next_run_ms);
+}
+
+// Runs one task and updates its timing statistics.
+static void run_task(sched_task_t *t, uint32_t now) {
+    t->pending = false; // Clear first so a signal raised while running is not lost
+
+    if (t->period_ms != 0 && time_reached(now, t->next_run_ms)) {
+        if (time_reached(now, t->next_run_ms + t->period_ms)) {
+            t->overruns++;
+            t->next_run_ms = now + t->period_ms; // Too far behind: resynchronise
+        } else {
+            t->next_run_ms += t->period_ms;      // Keep a fixed cadence
+        }
+    }
+
+    uint32_t start_us = hal_timer_micros();
+    t->fn();
+    uint32_t elapsed_us = hal_timer_micros() - start_us;
+
+    t->last_us = (elapsed_us > UINT16_MAX) ? UINT16_MAX : (uint16_t)elapsed_us;
+    if (t->last_us > t->worst_us) {
+        t->worst_us = t->last_us;
+    }
+    t->run_count++;
+}
+
+// --- Public API Implementation ---
+
+void scheduler_init(void) {
+    task_count = 0;
+}
+
+task_id_t scheduler_add_task(const char *name, task_fn_t fn, uint16_t period_ms, uint8_t priority) {
+    if (!fn || task_count >= SCHEDULER_MAX_TASKS) {
+        log_error("Scheduler: Cannot add task %s", name ? name : "?");
+        return SCHEDULER_INVALID_TASK;
+    }
+
+    sched_task_t *t = &tasks[task_count];
+    t->fn = fn;
+    t->name = name;
+    t->period_ms = period_ms;
+    t->priority = priority;
+    t->next_run_ms = hal_timer_millis() + period_ms;
+    t->enabled = true;
+    t->pending = false;
+    t->worst_us = 0;
+    t->last_us = 0;
+    t->overruns = 0;
+    t->run_count = 0;
+
+    log_debug("Scheduler: Added task %s (period %u ms, prio %u)", name, period_ms, priority);
+    return task_count++;
+}
+
+void scheduler_signal(task_id_t id) {
+    if (id < task_count) {
+        tasks[id].pending = true;
+    }
+}
+
+void scheduler_set_enabled(task_id_t id, bool enabled) {
+    if (id >= task_count) return;
+    if (enabled && !tasks[id].enabled) {
+        tasks[id].next_run_ms = hal_timer_millis() + tasks[id].period_ms;
+    }
+    tasks[id].enabled = enabled;
+}
+
+void scheduler_set_period(task_id_t id, uint16_t period_ms) {
+    if (id >= task_count || tasks[id].period_ms == period_ms) return;
+    tasks[id].period_ms = period_ms;
+    tasks[id].next_run_ms = hal_timer_millis() + period_ms;
+}
+
+bool scheduler_run_once(void) {
+    uint32_t now = hal_timer_millis();
+    sched_task_t *best = NULL;
+
+    for (uint8_t i = 0; i < task_count; ++i) {
+        sched_task_t *t = &tasks[i];
+        if (task_is_due(t, now) && (!best || t->priority < best->priority)) {
+            best = t; // Ties go to the task registered first
+        }
+    }
+
+    if (!best) {
+        return false;
+    }
+    run_task(best, now);
+    return true;
+}
+
+uint32_t scheduler_ms_until_next(void) {
+    uint32_t now = hal_timer_millis();
+    uint32_t soonest = UINT32_MAX;
+
+    for (uint8_t i = 0; i < task_count; ++i) {
+        const sched_task_t *t = &tasks[i];
+        if (!t->enabled) continue;
+        if (task_is_due(t, now)) return 0;
+        if (t->period_ms != 0) {
+            uint32_t wait = t->next_run_ms - now;
+            if (wait < soonest) soonest = wait;
+        }
+    }
+    return soonest;
+}
+
+bool scheduler_get_stats(task_id_t id, task_stats_t *stats) {
+    if (id >= task_count || !stats) return false;
+    const sched_task_t *t = &tasks[id];
+    stats->name = t->name;
+    stats->period_ms = t->period_ms;
+    stats->worst_us = t->worst_us;
+    stats->last_us = t->last_us;
+    stats->overruns = t->overruns;
+    stats->run_count = t->run_count;
+    return true;
+}
+
+void scheduler_reset_stats(void) {
+    for (uint8_t i = 0; i < task_count; ++i) {
+        tasks[i].worst_us = 0;
+        tasks[i].overruns = 0;
+        tasks[i].run_count = 0;
+    }
+}
+
+void scheduler_log_stats(void) {
+    for (uint8_t i = 0; i < task_count; ++i) {
+        const sched_task_t *t = &tasks[i];
+        log_info("Task %s: runs=%lu worst=%uus last=%uus overruns=%u",
+                 t->name, t->run_count, t->worst_us, t->last_us, t->overruns);
+    }
+}
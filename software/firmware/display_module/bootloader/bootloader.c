@@ -0,0 +1,292 @@
+/**
+ * @file bootloader.c
+ * @brief Firmware update bootloader for the Display Module (2 KB boot section).
+ *
+ * Receives an application image as BLE_MSG_BOOT_* frames on the BLE UART
+ * (ble_protocol.h) and programs it into the application section. The boot
+ * section is no-read-while-write flash, so this code keeps running while an
+ * application page is erased and written: with two page buffers, one page is
+ * programmed while the next arrives, and the link never waits for the flash.
+ * Each page is read back against its buffer before it is acknowledged, and
+ * the image CRC is checked against flash before the application is started.
+ *
+ * Built separately (make bootloader) and linked at OTA_BOOT_START. It uses no
+ * interrupts and none of the application's HAL: USART0 and Timer1 are polled.
+ * See modules/ota.h for when it keeps control after a reset.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h> // For memcpy, memset
+#include <avr/io.h>
+#include <avr/boot.h>
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+#include <avr/wdt.h>
+#include <util/crc16.h> // For _crc_xmodem_update
+#include "config.h"
+#include "ble_protocol.h"
+#include "modules/ota.h"
+
+_Static_assert(SPM_PAGESIZE == BLE_OTA_PAGE_SIZE, "BLE_OTA_PAGE_SIZE must be the flash page size");
+_Static_assert(BLE_OTA_PAGE_SIZE % BLE_OTA_CHUNK == 0, "DATA frames must not straddle pages");
+_Static_assert(BLE_OTA_WINDOW_PAGES == 2, "One buffer programming, one receiving");
+
+// --- Defines ---
+#define TX_BUFFER_SIZE  16 // Two ACK frames
+#define TIMER_HZ        (F_CPU / 1024UL) // Timer1 with the /1024 prescaler
+#define WAIT_OVERFLOWS  ((uint8_t)(((uint32_t)OTA_BOOT_WAIT_S * TIMER_HZ) >> 16)) // ~4.2 s each
+
+typedef enum {
+    PROG_IDLE,
+    PROG_ERASE, // Page erase running
+    PROG_WRITE  // Page write running
+} prog_state_t;
+
+// --- Internal State ---
+static ble_parser_t parser;
+static uint8_t tx_buf[TX_BUFFER_SIZE];
+static uint8_t tx_head = 0;
+static uint8_t tx_tail = 0;
+
+static uint8_t pages[2][BLE_OTA_PAGE_SIZE];
+static uint8_t rx_page = 0;        // Buffer receiving; the other one is programming
+static uint8_t rx_fill = 0;        // Bytes in the receiving buffer
+static bool rx_full = false;       // Receiving buffer waits for the programmer
+static uint16_t rx_addr = 0;       // Application address of the receiving buffer
+static uint8_t prog_state = PROG_IDLE;
+static uint16_t prog_addr = 0;     // Application address of the page programming
+static uint16_t written = 0;       // Bytes programmed and verified
+static uint16_t image_len = 0;
+static bool started = false;       // BEGIN accepted
+static bool resync_sent = false;   // SEQUENCE sent; further stray frames stay unanswered
+static uint8_t boot_flag = 0xFF;   // OTA_FLAG_ADDR as last read or written
+static uint8_t wait_overflows = 0; // Timer1 overflows without a BEGIN since entry or the last BEGIN
+
+// --- Internal Helper Functions ---
+
+static void uart_init(void) {
+    uint16_t ubrr = (uint16_t)((F_CPU + 4UL * BLE_UART_BAUD) / (8UL * BLE_UART_BAUD) - 1); // As hal/uart.c
+    UBRR0H = (uint8_t)(ubrr >> 8);
+    UBRR0L = (uint8_t)ubrr;
+    UCSR0A = _BV(U2X0);
+    UCSR0B = _BV(RXEN0) | _BV(TXEN0);
+    UCSR0C = _BV(UCSZ01) | _BV(UCSZ00); // 8N1
+}
+
+// Moves one queued byte to the UART if it can take it. Never waits, so the
+// receiver is polled often enough at 115200 baud.
+static void uart_poll_tx(void) {
+    if (tx_tail != tx_head && (UCSR0A & _BV(UDRE0))) {
+        UDR0 = tx_buf[tx_tail];
+        tx_tail = (uint8_t)((tx_tail + 1) % TX_BUFFER_SIZE);
+    }
+}
+
+static void send_ack(uint16_t offset, uint8_t status) {
+    uint8_t payload[BLE_OTA_ACK_LEN];
+    uint8_t frame[BLE_OTA_ACK_LEN + BLE_PROTO_OVERHEAD];
+    ble_put_u16(&payload[0], (offset < image_len || !started) ? offset : image_len); // Padding is not image
+    payload[2] = status;
+    uint8_t n = (uint8_t)ble_frame_encode(frame, sizeof(frame), BLE_MSG_BOOT_ACK, payload, sizeof(payload));
+    uint8_t space = (uint8_t)((tx_tail + TX_BUFFER_SIZE - tx_head - 1) % TX_BUFFER_SIZE);
+    if (n > space) return; // The sender times out and asks again
+    for (uint8_t i = 0; i < n; ++i) {
+        tx_buf[tx_head] = frame[i];
+        tx_head = (uint8_t)((tx_head + 1) % TX_BUFFER_SIZE);
+    }
+}
+
+static void tx_drain(void) {
+    while (tx_tail != tx_head) uart_poll_tx();
+    UCSR0A |= _BV(TXC0); // Clear, then wait for the last stop bit
+    while (!(UCSR0A & _BV(TXC0))) {
+    }
+}
+
+static void restart(void) {
+    wdt_enable(WDTO_15MS); // A clean reset; the flag decides what runs next
+    for (;;) {
+    }
+}
+
+// Loads the page into the SPM buffer and starts erasing its flash page.
+static void prog_start(const uint8_t *page, uint16_t addr) {
+    eeprom_busy_wait(); // SPM is blocked while the EEPROM writes
+    for (uint8_t i = 0; i < BLE_OTA_PAGE_SIZE; i += 2) {
+        boot_page_fill(addr + i, page[i] | ((uint16_t)page[i + 1] << 8));
+    }
+    boot_page_erase(addr);
+    prog_addr = addr;
+    prog_state = PROG_ERASE;
+}
+
+// Advances the programming state machine without waiting on the flash.
+static void prog_poll(void) {
+    if (prog_state == PROG_IDLE || boot_spm_busy()) return;
+    if (prog_state == PROG_ERASE) {
+        boot_page_write(prog_addr);
+        prog_state = PROG_WRITE;
+        return;
+    }
+    boot_rww_enable(); // The application section reads back again
+    prog_state = PROG_IDLE;
+    if (memcmp_P(pages[rx_page ^ 1], (const void *)(uintptr_t)prog_addr, BLE_OTA_PAGE_SIZE) != 0) {
+        rx_addr = written; // Resend this page and everything after it
+        rx_fill = 0;
+        rx_full = false;
+        send_ack(written, BLE_OTA_VERIFY);
+        return;
+    }
+    written += BLE_OTA_PAGE_SIZE;
+    send_ack(written, BLE_OTA_OK);
+}
+
+// Hands a full receiving buffer to the programmer once it is free.
+static void prog_service(void) {
+    prog_poll();
+    if (rx_full && prog_state == PROG_IDLE) {
+        prog_start(pages[rx_page], rx_addr);
+        rx_page ^= 1;
+        rx_addr += BLE_OTA_PAGE_SIZE;
+        rx_fill = 0;
+        rx_full = false;
+    }
+}
+
+static void prog_finish(void) {
+    while (rx_full || prog_state != PROG_IDLE) {
+        prog_service();
+        uart_poll_tx();
+    }
+}
+
+static void handle_begin(const uint8_t *payload, uint8_t length) {
+    if (length < BLE_OTA_BEGIN_LEN) return;
+    uint16_t len = ble_get_u16(payload);
+    prog_finish();
+    started = false;
+    if (len == 0 || len > OTA_APP_MAX_SIZE) {
+        send_ack(0, BLE_OTA_TOO_LONG);
+        return;
+    }
+    image_len = len;
+    rx_addr = 0;
+    rx_fill = 0;
+    written = 0;
+    resync_sent = false;
+    started = true;
+    eeprom_update_byte((uint8_t *)OTA_FLAG_ADDR, OTA_FLAG_ERASING); // From here the application may be incomplete
+    boot_flag = OTA_FLAG_ERASING; // No more giving up on the phone: the old image is going
+    wait_overflows = 0;
+    send_ack(0, BLE_OTA_OK);
+}
+
+static void handle_data(const uint8_t *payload, uint8_t length) {
+    if (!started || length <= BLE_OTA_DATA_OFS_BYTES || rx_full) {
+        return; // A window overrun is dropped; the sender's timeout recovers
+    }
+    uint16_t offset = ble_get_u16(payload);
+    uint8_t n = length - BLE_OTA_DATA_OFS_BYTES;
+    uint16_t expected = rx_addr + rx_fill;
+    if (offset != expected || n > BLE_OTA_PAGE_SIZE - rx_fill || n > image_len - offset) {
+        if (!resync_sent) {
+            send_ack(expected, BLE_OTA_SEQUENCE);
+            resync_sent = true;
+        }
+        return;
+    }
+    resync_sent = false;
+    memcpy(&pages[rx_page][rx_fill], &payload[BLE_OTA_DATA_OFS_BYTES], n);
+    rx_fill += n;
+    rx_full = (rx_fill == BLE_OTA_PAGE_SIZE);
+}
+
+static void handle_end(const uint8_t *payload, uint8_t length) {
+    if (!started || length < BLE_OTA_END_LEN) return;
+    uint16_t len = ble_get_u16(&payload[0]);
+    uint16_t crc = ble_get_u16(&payload[2]);
+    if (len != image_len || rx_addr + rx_fill != image_len) {
+        send_ack(rx_addr + rx_fill, BLE_OTA_SEQUENCE);
+        return;
+    }
+    if (rx_fill > 0) { // Last page: pad with erased flash
+        memset(&pages[rx_page][rx_fill], 0xFF, BLE_OTA_PAGE_SIZE - rx_fill);
+        rx_full = true;
+    }
+    prog_finish();
+    if (written < image_len) return; // VERIFY already sent
+
+    uint16_t image_crc = 0;
+    for (uint16_t i = 0; i < image_len; ++i) {
+        image_crc = _crc_xmodem_update(image_crc, pgm_read_byte((const uint8_t *)(uintptr_t)i));
+    }
+    if (image_crc != crc) {
+        started = false;
+        send_ack(0, BLE_OTA_CRC);
+        return;
+    }
+    eeprom_update_byte((uint8_t *)OTA_FLAG_ADDR, 0xFF);
+    eeprom_busy_wait();
+    send_ack(image_len, BLE_OTA_DONE);
+    tx_drain();
+    restart();
+}
+
+// --- Main ---
+
+int main(void) {
+    uint8_t reset_flags = MCUSR;
+    MCUSR = 0;
+    wdt_disable(); // Still running after a watchdog reset
+    GPIOR0 = reset_flags;
+
+    boot_flag = eeprom_read_byte((const uint8_t *)OTA_FLAG_ADDR);
+    bool app_present = pgm_read_word(0) != 0xFFFF;
+    if (app_present && boot_flag != OTA_FLAG_REQUESTED && boot_flag != OTA_FLAG_ERASING) {
+        __asm__ __volatile__("jmp 0"); // Straight to the application, nothing touched
+    }
+
+    uart_init();
+    ble_parser_init(&parser);
+    TCCR1A = 0;
+    TCCR1B = _BV(CS12) | _BV(CS10); // /1024: overflows every ~4.2 s
+    TIFR1 = _BV(TOV1);
+    wait_overflows = 0;
+    send_ack(0, BLE_OTA_READY);
+
+    for (;;) {
+        if (UCSR0A & _BV(RXC0)) {
+            if (ble_parser_feed(&parser, UDR0)) {
+                switch (parser.msg_id) {
+                    case BLE_MSG_BOOT_BEGIN:
+                        handle_begin(parser.payload, parser.length);
+                        break;
+                    case BLE_MSG_BOOT_DATA:
+                        handle_data(parser.payload, parser.length);
+                        break;
+                    case BLE_MSG_BOOT_END:
+                        handle_end(parser.payload, parser.length);
+                        break;
+                    default:
+                        break; // Link traffic meant for the application
+                }
+            }
+        }
+        prog_service();
+        uart_poll_tx();
+
+        if (TIFR1 & _BV(TOV1)) {
+            TIFR1 = _BV(TOV1);
+            if (!started) {
+                // Only while the old image is intact: once erasing began, wait for the phone indefinitely
+                if (boot_flag == OTA_FLAG_REQUESTED && app_present && ++wait_overflows >= WAIT_OVERFLOWS) {
+                    eeprom_update_byte((uint8_t *)OTA_FLAG_ADDR, 0xFF); // Nobody came: back to the old image
+                    eeprom_busy_wait();
+                    restart();
+                }
+                send_ack(0, BLE_OTA_READY);
+            }
+        }
+    }
+}
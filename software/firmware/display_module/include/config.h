@@ -17,12 +17,17 @@
 #define BLE_UART_ID         UART_ID_0 // Maps to HW USART0
 #define BLE_UART_BAUD       115200UL  // Baud rate matching Brain Module BLE
 #define BLE_UART_RX_BUFFER_SIZE 128   // Buffer for incoming data from Brain Module
-#define BLE_UART_TX_BUFFER_SIZE 32    // Buffer for outgoing acknowledgements (if any)
+#define BLE_UART_TX_BUFFER_SIZE 64    // Buffer for outgoing acknowledgements and log frames
+#define LINK_DATA_RESERVE_BYTES 8     // TX space logs leave free for acknowledgements (link_mux.h)
+#define LINK_ACK_INTERVAL_MS    250   // BLE_MSG_LINK_ACK period while frames arrive (ble_rx_service())
+#define LINK_STALE_TIMEOUT_MS   2500  // No frame for this long (2.5 heartbeats): data shown dimmed
+#define LINK_LOST_TIMEOUT_MS    10000 // No frame for this long: navigation cleared
+#define LINK_RESYNC_MIN_INTERVAL_MS 200 // Keyframe requests at most this often
 
 // SPI for LCD Communication (Hardware SPI)
 #define LCD_SPI_ID          SPI_ID_0 // Maps to HW SPI
 #define LCD_SPI_MODE        0        // SPI Mode (CPOL=0, CPHA=0 typical for LCDs)
-#define LCD_SPI_CLOCK_SPEED 4000000UL // SPI Clock Speed (e.g., 4 MHz)
+#define LCD_SPI_CLOCK_SPEED 8000000UL // SPI Clock Speed: F_CPU/2, the fastest the 328P supports
 
 // I2C (Hardware TWI) - For potential external sensors via header
 #define EXTERNAL_I2C_ID     I2C_ID_0 // Maps to HW TWI
@@ -34,6 +39,9 @@
 #define UART0_RXD_PIN       PD0 // Pin 2 (QFP32) - BLE UART RX
 #define UART0_TXD_PIN       PD1 // Pin 3 (QFP32) - BLE UART TX
 // PD2, PD3, PD4 potentially available or used for I2C header?
+#define DEBUG_TX_PORT       PORTD // PD7, Pin 11 (QFP32) - Software UART TX for logs (LOG_TO_DEBUG_PIN)
+#define DEBUG_TX_DDR        DDRD
+#define DEBUG_TX_BIT        PD7
 
 // Port C Pins
 #define BATT_CHG_STAT_PIN   PC0 // Pin 23 (QFP32) - MCP73831 Status Output (Input)
@@ -47,6 +55,8 @@
 #define LCD_SCK_PIN         PB5 // Pin 19 (QFP32) - SPI Clock (Output)
 #define LCD_DC_PIN          PB0 // Pin 14 (QFP32) - LCD Data/Command Select (Output)
 #define LCD_RST_PIN         PB1 // Pin 15 (QFP32) - LCD Reset (Output)
+#define LCD_CTRL_PORT       PORTB // CS and DC are written directly on this port (lcd_driver.c)
+#define LCD_CTRL_DDR        DDRB
 
 // --- Module Configuration ---
 
@@ -55,24 +65,61 @@
 #define LCD_HEIGHT          160 // Example LCD height in pixels
 #define LCD_DEFAULT_BG_COLOR 0x0000 // Black background
 #define LCD_DEFAULT_FG_COLOR 0xFFFF // White foreground
+#define ENABLE_DISPLAY_COMPOSITOR 1 // 1 to build the scanline compositor (display_list_*, 256 B line buffer)
+#define DISPLAY_LIST_MAX_ITEMS   10 // Items per composited region (17 B of RAM each)
+
+// Battery Status (Li-Po cell on BATT_SENSE_PIN through a divider: Vbat --- R1 --- (ADC1) --- R2 --- GND).
+// VREF, R1 and R2 are the defaults of settings the phone can change (modules/settings.h).
+#define BATTERY_ADC_VREF_MV 3300UL   // ADC reference voltage (3.3V regulator)
+#define BATTERY_ADC_MAX_VALUE 4092   // Full scale of the oversampled 12-bit reading (hal/adc.h)
+#define BATTERY_ADC_CHANNEL 1        // ADC1 = BATT_SENSE_PIN
+#define BATTERY_SENSE_R1_OHMS 10000UL
+#define BATTERY_SENSE_R2_OHMS 10000UL // 1:1, keeps a full 4.2 V cell below Vref
+#define ADC_FILTER_SHIFT    3        // Moving average over ~8 decimated readings (~128 ms)
+
+// Screen Updater (interval and layout are setting defaults, see modules/settings.h)
+#define SCREEN_UPDATE_INTERVAL_MS 100 // How often to refresh screen elements
+#define SCREEN_DEFAULT_LAYOUT     0   // ui_layout_id_t at start-up: 0 day, 1 night, 2 minimal HUD
 
-// Battery Status
-#define BATTERY_ADC_VREF_MV 3300.0f  // ADC reference voltage (3.3V regulator)
-#define BATTERY_ADC_MAX_VALUE 1023   // 10-bit ADC
-// Voltage divider for battery sense (if used directly, schematic implies charger handles it)
-// #define BATTERY_SENSE_R1_OHMS 10000.0f
-// #define BATTERY_SENSE_R2_OHMS 10000.0f // Example 1:1 divider if Vbat <= Vref
+// Task Scheduler (see tasks_init() in main.c)
+#define SCHEDULER_MAX_TASKS         6    // Size of the static task table
+#define BATTERY_UPDATE_INTERVAL_MS  1000 // Battery status refresh period (setting default)
 
-// Screen Updater
-#define SCREEN_UPDATE_INTERVAL_MS 100 // How often to refresh screen elements
+// Persistent Settings (EEPROM, util/persist.h). The last EEPROM byte is the OTA flag (ota.h).
+#define SETTINGS_EEPROM_BASE    0    // Settings, 2 copies
+#define SETTINGS_SAVE_DELAY_MS  2000 // Saved this long after the last change, so a burst writes once
+
+// Power Management (idle sleep between tasks is always on)
+#define ENABLE_LINK_IDLE_SLEEP      1        // 1 to power down when the Brain Module goes quiet
+#define LINK_IDLE_TIMEOUT_MS        120000UL // No valid frame for 2 minutes (Brain parked or off)
+#define LINK_WAKE_GRACE_MS          10000UL  // Stay up this long after a wake for a frame to arrive
+#define POWER_CHECK_INTERVAL_MS     1000     // Link idle detection period
+#define POWER_STATS_INTERVAL_MS     60000    // Duty-cycle statistics log period
 
-// BLE Receiver Protocol
-#define BLE_MSG_TERMINATOR '\n' // Character indicating end of message from Brain Module
+// BLE Receiver Protocol (must match the Brain Module, see ble_protocol.h)
+#define BLE_PACKET_START_BYTE   0xAA
+#define BLE_PACKET_END_BYTE     0x55
 
 // --- Feature Flags ---
+// The Makefile's build profiles (PROFILE=release|debug|bench) set ENABLE_LOGGING,
+// LOG_LEVEL and ENABLE_PERF_COUNTERS on the command line; these are the defaults.
+#ifndef ENABLE_LOGGING
 #define ENABLE_LOGGING          1      // 1 to enable logging, 0 to disable
+#endif
+#ifndef LOG_LEVEL
 #define LOG_LEVEL               LOG_LEVEL_INFO // Default log level
+#endif
 #define LOG_UART_ID             BLE_UART_ID // Send logs over BLE UART
 #define LOG_UART_BAUD           BLE_UART_BAUD
+#define LOG_TOKENIZED           1      // 1: binary records decoded by host_tools/diagnostics.py, 0: printf text
+#define LOG_QUEUE_SIZE          64     // Tokenized record queue in bytes (power of two)
+#define LOG_TO_DEBUG_PIN        0      // 1: logs go out on DEBUG_TX_BIT (Timer2 software UART), not BLE
+#define LOG_DEBUG_BAUD          38400UL
+#define LOG_BUDGET_BYTES_PER_S  400    // Log bytes per second allowed on the link (0 = no limit)
+#define LOG_BUDGET_BURST_BYTES  128    // Log bytes that may go out at once after a quiet spell
+#ifndef ENABLE_PERF_COUNTERS
+#define ENABLE_PERF_COUNTERS    0      // 1: Timer1 section timing and counters, read with diagnostics.py --stats
+#endif
+#define ENABLE_OTA_BOOTLOADER   1      // 1: BLE_MSG_BOOT_BEGIN restarts into the bootloader (make bootloader, modules/ota.h)
 
 #endif // DISPLAY_CONFIG_H
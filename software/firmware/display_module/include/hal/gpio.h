@@ -29,6 +29,12 @@ typedef enum {
 // Callback function pointer type for GPIO interrupts
 typedef void (*gpio_interrupt_callback_t)(uint8_t pin);
 
+// --- Direct Port Access ---
+// For hot paths on pins whose port is fixed in config.h (the LCD's CS and DC):
+// one SBI/CBI instruction instead of a hal_gpio_write() call.
+#define HAL_GPIO_PORT_HIGH(port, bit) ((port) |= (uint8_t)(1 << (bit)))
+#define HAL_GPIO_PORT_LOW(port, bit)  ((port) &= (uint8_t)~(1 << (bit)))
+
 /**
  * @brief Initializes a specific GPIO pin.
  * @param pin The pin identifier (e.g., LCD_CS_PIN).
@@ -0,0 +1,71 @@
+#ifndef HAL_POWER_H
+#define HAL_POWER_H
+
+/**
+ * @file hal_power.h
+ * @brief Hardware Abstraction Layer for sleep modes and power accounting (Display Module).
+ * IDLE sleep is used between scheduler tasks (UART, Timer0 and pin interrupts
+ * all wake it). Power-down is used while the link is idle, with the watchdog
+ * and PCINT16 (the UART RXD pin) as wake sources.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"
+
+// Why the MCU left power-down sleep.
+typedef enum {
+    POWER_WAKE_WATCHDOG, // Periodic watchdog wake, nothing else happened
+    POWER_WAKE_PIN       // Activity on the RXD pin (the Brain Module is talking)
+} power_wake_t;
+
+// Time accounting since the last hal_power_reset_stats().
+typedef struct {
+    uint32_t total_ms;  // Wall time covered by these statistics
+    uint32_t idle_ms;   // Time spent in IDLE sleep between tasks
+    uint32_t deep_ms;   // Time spent in power-down (link idle)
+    uint32_t wakeups;   // Number of IDLE sleeps entered
+    uint8_t duty_pct;   // Awake (CPU running) share of total_ms, 0..100
+} power_stats_t;
+
+/**
+ * @brief Turns off clocks to unused peripherals and resets the statistics.
+ * Call after the HAL peripherals have been initialized.
+ */
+void hal_power_init(void);
+
+/**
+ * @brief Sleeps in IDLE mode until the next interrupt.
+ * Must be called with interrupts disabled, after checking that no work is due;
+ * interrupts are re-enabled atomically with entering sleep, so a wake event
+ * arriving after the check cannot be missed. Returns with interrupts enabled.
+ */
+void hal_power_idle(void);
+
+/**
+ * @brief Sleeps in power-down mode until a wake pin changes or the watchdog fires.
+ * Timer0 and the UART stop, so the tick is advanced by the watchdog period on
+ * return. The byte whose start bit woke the MCU is lost.
+ * @return The wake reason.
+ */
+power_wake_t hal_power_deep_sleep(void);
+
+/**
+ * @brief Copies the time accounting, computing total_ms and duty_pct.
+ * @param stats Destination structure.
+ */
+void hal_power_get_stats(power_stats_t *stats);
+
+/**
+ * @brief Restarts the time accounting from now.
+ */
+void hal_power_reset_stats(void);
+
+/**
+ * @brief Restarts the MCU through a watchdog reset. Does not return.
+ * The watchdog is switched off again early in start-up (.init3), before
+ * any initialization that could outlast its 15 ms period.
+ */
+void hal_power_reset(void);
+
+#endif // HAL_POWER_H
@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stddef.h> // For size_t
+#include <avr/io.h> // For the inline streaming functions
 #include "config.h" // Include config for SPI IDs
 
 // SPI Interface Identifiers (ATmega328P has one hardware SPI)
@@ -19,7 +20,7 @@ typedef enum {
 /**
  * @brief Initializes the SPI peripheral in master mode.
  * @param spi_id The SPI peripheral identifier (must be SPI_ID_0).
- * @param clock_speed Desired SPI clock frequency (e.g., 4000000 for 4MHz).
+ * @param clock_speed Desired SPI clock frequency; rounded down to F_CPU/2^n (2..128).
  * @param mode SPI mode (0, 1, 2, or 3) defining clock polarity and phase.
  * @param bit_order 0 for MSB first, 1 for LSB first.
  */
@@ -56,6 +57,15 @@ void hal_spi_transfer_multi(spi_id_t spi_id, const uint8_t *tx_buffer, uint8_t *
  */
 void hal_spi_write_multi(spi_id_t spi_id, const uint8_t *tx_buffer, size_t length);
 
+/**
+ * @brief Sends a 16-bit value (MSB first) repeatedly, e.g. one RGB565 color.
+ * Bytes are written back to back from a tight loop with no per-byte call.
+ * @param spi_id The SPI peripheral identifier.
+ * @param value The value to repeat.
+ * @param count Number of repetitions (two bytes each).
+ */
+void hal_spi_write_repeat16(spi_id_t spi_id, uint16_t value, uint32_t count);
+
 /**
  * @brief Receives multiple bytes over SPI, sending dummy bytes (0xFF).
  * Convenience function for read-only operations.
@@ -65,4 +75,31 @@ void hal_spi_write_multi(spi_id_t spi_id, const uint8_t *tx_buffer, size_t lengt
  */
 void hal_spi_read_multi(spi_id_t spi_id, uint8_t *rx_buffer, size_t length);
 
+// --- Streaming (write-only, hardware SPI / SPI_ID_0) ---
+// For data computed byte by byte. Each put waits for the previous byte and
+// returns as soon as the new one is loaded, so the caller prepares the next
+// byte while this one shifts out (16 CPU cycles per byte at F_CPU/2).
+// Received data is discarded. Usage: start, put..., finish.
+
+/** @brief Starts a stream with its first byte. The bus must be idle. */
+static inline void hal_spi_stream_start(uint8_t data) {
+    SPDR = data;
+}
+
+/** @brief Queues the next byte of a stream once the previous one is out. */
+static inline void hal_spi_stream_put(uint8_t data) {
+    while (!(SPSR & (1 << SPIF))) {
+        // Previous byte still shifting out
+    }
+    SPDR = data; // SPSR read with SPIF set + SPDR access clears SPIF
+}
+
+/** @brief Waits for the last byte of a stream and leaves the bus idle. */
+static inline void hal_spi_stream_finish(void) {
+    while (!(SPSR & (1 << SPIF))) {
+        // Last byte still shifting out
+    }
+    (void)SPDR; // Clears SPIF
+}
+
 #endif // HAL_SPI_H
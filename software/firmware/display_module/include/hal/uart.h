@@ -20,6 +20,17 @@ typedef enum {
 // Callback function pointer type for UART RX interrupt
 typedef void (*uart_rx_callback_t)(uart_id_t uart_id, uint8_t data);
 
+// Callback function pointer type for TX-empty notification (called from interrupt context).
+typedef void (*uart_tx_empty_callback_t)(uart_id_t uart_id);
+
+// Line error and buffer counters, accumulated by the RX interrupt.
+typedef struct {
+    uint16_t overrun_errors; // Hardware data overrun (DOR)
+    uint16_t framing_errors; // Stop bit not found (FE)
+    uint16_t parity_errors;  // Parity mismatch (UPE)
+    uint16_t rx_dropped;     // Byte received but the RX ring buffer was full
+} uart_stats_t;
+
 /**
  * @brief Initializes the UART peripheral.
  * @param uart_id The UART peripheral identifier (must be UART_ID_0).
@@ -32,18 +43,41 @@ void hal_uart_init(uart_id_t uart_id, uint32_t baud_rate, uint8_t data_bits, uin
 
 /**
  * @brief Sends a single byte over UART (blocking).
+ * Waits for room in the TX ring buffer; writes UDR0 directly if interrupts are off.
  * @param uart_id The UART peripheral identifier.
  * @param data The byte to send.
  */
 void hal_uart_put_char(uart_id_t uart_id, uint8_t data);
 
 /**
- * @brief Sends a buffer of data over UART (blocking).
+ * @brief Queues a buffer of data for transmission (non-blocking).
  * @param uart_id The UART peripheral identifier.
  * @param buffer Pointer to the data buffer.
  * @param length Number of bytes to send.
+ * @return Number of bytes actually queued (less than length if the buffer filled up).
+ */
+size_t hal_uart_write(uart_id_t uart_id, const uint8_t *buffer, size_t length);
+
+/**
+ * @brief Returns the free space in the TX ring buffer.
+ * @param uart_id The UART peripheral identifier.
+ * @return Number of bytes that can be queued without truncation.
  */
-void hal_uart_write(uart_id_t uart_id, const uint8_t *buffer, size_t length);
+size_t hal_uart_tx_space(uart_id_t uart_id);
+
+/**
+ * @brief Checks whether all queued data has been transmitted.
+ * @param uart_id The UART peripheral identifier.
+ * @return true if nothing is queued or shifting out.
+ */
+bool hal_uart_tx_idle(uart_id_t uart_id);
+
+/**
+ * @brief Registers a callback invoked (in interrupt context) when the transmitter becomes idle.
+ * @param uart_id The UART peripheral identifier.
+ * @param callback The function to call, or NULL to disable the notification.
+ */
+void hal_uart_set_tx_empty_callback(uart_id_t uart_id, uart_tx_empty_callback_t callback);
 
 /**
  * @brief Receives a single byte from UART (blocking or non-blocking).
@@ -69,14 +103,32 @@ bool hal_uart_data_available(uart_id_t uart_id);
 size_t hal_uart_read(uart_id_t uart_id, uint8_t *buffer, size_t length);
 
 /**
- * @brief Enables UART Receive Complete interrupt.
+ * @brief Returns the longest contiguous run of received bytes without copying.
+ * Lets parsers work directly on the RX ring; release the bytes with hal_uart_rx_consume().
+ * @param uart_id The UART peripheral identifier.
+ * @param data Receives a pointer to the oldest unread byte.
+ * @return Number of contiguous bytes available (0 if none). Call again after consuming to get wrapped data.
+ */
+size_t hal_uart_rx_span(uart_id_t uart_id, const uint8_t **data);
+
+/**
+ * @brief Releases bytes obtained with hal_uart_rx_span().
+ * @param uart_id The UART peripheral identifier.
+ * @param length Number of bytes processed; must not exceed the span returned.
+ */
+void hal_uart_rx_consume(uart_id_t uart_id, size_t length);
+
+/**
+ * @brief Registers a per-byte RX callback.
+ * The RX interrupt is always active and fills the ring buffer; the callback
+ * is additionally invoked from interrupt context for each byte.
  * @param uart_id The UART peripheral identifier.
  * @param callback Function to call when a byte is received.
  */
 void hal_uart_enable_rx_interrupt(uart_id_t uart_id, uart_rx_callback_t callback);
 
 /**
- * @brief Disables UART Receive Complete interrupt.
+ * @brief Unregisters the RX callback. Bytes keep flowing into the ring buffer.
  * @param uart_id The UART peripheral identifier.
  */
 void hal_uart_disable_rx_interrupt(uart_id_t uart_id);
@@ -87,4 +139,17 @@ void hal_uart_disable_rx_interrupt(uart_id_t uart_id);
  */
 void hal_uart_flush_rx_buffer(uart_id_t uart_id);
 
+/**
+ * @brief Copies the line error and buffer counters.
+ * @param uart_id The UART peripheral identifier.
+ * @param stats Pointer to the structure receiving the counters.
+ */
+void hal_uart_get_stats(uart_id_t uart_id, uart_stats_t *stats);
+
+/**
+ * @brief Resets the line error and buffer counters to zero.
+ * @param uart_id The UART peripheral identifier.
+ */
+void hal_uart_clear_stats(uart_id_t uart_id);
+
 #endif // HAL_UART_H
@@ -0,0 +1,52 @@
+#ifndef MODULES_BATTERY_STATUS_H
+#define MODULES_BATTERY_STATUS_H
+
+/**
+ * @file battery_status.h
+ * @brief Interface for the Display Module's own battery and charger status.
+ * The cell voltage on BATT_SENSE_PIN is sampled and filtered in the
+ * background (hal/adc.h); battery_status_update() turns the latest reading
+ * into a charge level and reads the charger status pin.
+ */
+
+#include <stdint.h>
+
+// Battery charging states
+typedef enum {
+    BATTERY_STATE_UNKNOWN,
+    BATTERY_STATE_CHARGING,
+    BATTERY_STATE_NOT_CHARGING, // Discharging or idle
+    BATTERY_STATE_CHARGED,      // Charge complete
+    BATTERY_STATE_FAULT
+} battery_charge_state_t;
+
+/**
+ * @brief Configures the charger status pin and starts background voltage sampling.
+ */
+void battery_status_init(void);
+
+/**
+ * @brief Refreshes the charge state and level from the latest reading.
+ * Never waits for a conversion. Call periodically (BATTERY_UPDATE_INTERVAL_MS).
+ */
+void battery_status_update(void);
+
+/**
+ * @brief Returns the charge state from the last update.
+ * @return Current charger state.
+ */
+battery_charge_state_t battery_status_get_charge_state(void);
+
+/**
+ * @brief Returns the charge level from the last update.
+ * @return Level in percent (0..100), from a Li-Po discharge table in flash.
+ */
+uint8_t battery_status_get_level_percent(void);
+
+/**
+ * @brief Returns the cell voltage from the last update.
+ * @return Voltage in millivolts.
+ */
+uint16_t battery_status_get_voltage_mv(void);
+
+#endif // MODULES_BATTERY_STATUS_H
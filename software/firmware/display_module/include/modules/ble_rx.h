@@ -10,19 +10,27 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Link to the Brain Module, driven by the arrival time of valid frames.
+// The Brain sends at least a heartbeat every STATUS_HEARTBEAT_INTERVAL_MS (Brain config.h).
+typedef enum {
+    BLE_LINK_CONNECTING, // No data yet, or resyncing: waiting for a keyframe
+    BLE_LINK_LIVE,       // Frames arriving; the data is current
+    BLE_LINK_STALE,      // Nothing for LINK_STALE_TIMEOUT_MS: the data is frozen
+    BLE_LINK_LOST        // Nothing for LINK_LOST_TIMEOUT_MS: navigation replaced by NAV_MANEUVER_NO_LINK
+} ble_link_state_t;
+
 // Define structure to hold received status data
 typedef struct {
     uint16_t battery_mv;
     uint8_t signal_status; // Corresponds to signal_state_t from Brain Module
     uint8_t speed_kmh;
-    bool updated; // Flag indicating if new data arrived since last check
 } display_status_data_t;
 
 // Define structure to hold received navigation data
 typedef struct {
-    char instruction[64]; // Buffer for navigation instruction string
+    uint8_t maneuver;     // nav_maneuver_t; NAV_MANEUVER_NO_LINK until the first frame
+    uint8_t arg;          // Maneuver argument (roundabout exit number)
     uint16_t distance_m;  // Distance to next maneuver in meters
-    bool updated; // Flag indicating if new data arrived since last check
 } display_nav_data_t;
 
 /**
@@ -35,11 +43,22 @@ void ble_rx_init(void);
 /**
  * @brief Processes a single character received from the BLE UART.
  * This function should be called from the UART RX handler or polling loop.
- * It buffers characters, identifies complete messages, and parses them.
+ * It advances the frame parser and applies each message once its END byte arrives.
  * @param received_char The character received via UART.
  */
 void ble_rx_process_char(uint8_t received_char);
 
+/**
+ * @brief Applies the liveness deadlines and sends what the link is owed:
+ * - BLE_MSG_KEYFRAME_REQUEST when the data may be incomplete (at most every
+ *   LINK_RESYNC_MIN_INTERVAL_MS);
+ * - BLE_MSG_LINK_ACK at once when a frame asked for it (BLE_SEQ_ACK_REQUEST),
+ *   otherwise every LINK_ACK_INTERVAL_MS while sequenced frames arrive.
+ * Call after feeding input and periodically (every LINK_ACK_INTERVAL_MS).
+ * @return true if anything was queued.
+ */
+bool ble_rx_service(void);
+
 /**
  * @brief Checks if new status data has been received and parsed.
  * @return true if new status data is available, false otherwise.
@@ -48,8 +67,8 @@ bool ble_rx_is_status_available(void);
 
 /**
  * @brief Retrieves the latest received status data.
- * Copies the internal status data to the provided structure.
- * Resets the 'updated' flag internally.
+ * Copies a consistent image of the internal status data (a sequence lock, no
+ * interrupts disabled); ble_rx_is_status_available() is false until the next frame.
  * @param data Pointer to a display_status_data_t structure to copy data into.
  * @return true if data was copied (i.e., new data was available), false otherwise.
  */
@@ -63,19 +82,34 @@ bool ble_rx_is_nav_available(void);
 
 /**
  * @brief Retrieves the latest received navigation data.
- * Copies the internal navigation data to the provided structure.
- * Resets the 'updated' flag internally.
+ * Copies a consistent image of the internal navigation data (a sequence lock, no
+ * interrupts disabled); ble_rx_is_nav_available() is false until the next frame.
  * @param data Pointer to a display_nav_data_t structure to copy data into.
  * @return true if data was copied (i.e., new data was available), false otherwise.
  */
 bool ble_rx_get_nav_data(display_nav_data_t *data);
 
 /**
- * @brief Gets the last known connection status based on received data.
- * (Simple implementation might just check if any data arrived recently).
- * @return true if considered connected, false otherwise.
+ * @brief Checks whether the link is LIVE.
  */
 bool ble_rx_is_connected(void);
 
+/**
+ * @brief Gets the link state, as of the last ble_rx_service() or frame.
+ */
+ble_link_state_t ble_rx_get_link_state(void);
+
+/**
+ * @brief Checks whether a firmware update was requested (BLE_MSG_BOOT_BEGIN).
+ * The caller restarts into the bootloader (modules/ota.h).
+ */
+bool ble_rx_update_requested(void);
+
+/**
+ * @brief Gets the time the last valid frame was received.
+ * @return System time in milliseconds (time of ble_rx_init() if none yet).
+ */
+uint32_t ble_rx_get_last_frame_ms(void);
+
 
 #endif // MODULES_BLE_RX_H
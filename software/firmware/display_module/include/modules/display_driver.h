@@ -24,15 +24,31 @@ typedef uint16_t display_color_t;
 #define COLOR_CYAN        0x07FF
 #define COLOR_MAGENTA     0xF81F
 #define COLOR_ORANGE      0xFD20 // Example custom color
+#define COLOR_GRAY        0x8410
 
-// Define font structure (placeholder)
+// Proportional bitmap font; both tables live in flash (PROGMEM)
 typedef struct {
-    const uint8_t *font_data;
-    uint8_t width;
-    uint8_t height;
-    // Add other font properties if needed
+    const uint8_t *glyphs;  // `height` rows per character, one byte per row, MSB = leftmost pixel
+    const uint8_t *widths;  // Glyph width in font pixels (1..8), per character
+    char first;             // First character in the tables
+    char last;              // Last character in the tables
+    uint8_t height;         // Rows per glyph
+    uint8_t spacing;        // Blank font pixels after each glyph
+    uint8_t scale;          // Screen pixels per font pixel, in both directions
 } display_font_t;
 
+// Built-in fonts (lcd_font.c)
+extern const display_font_t display_font_small; // 8 px high: instructions and status text
+extern const display_font_t display_font_large; // 16 px high: the distance readout
+#define DISPLAY_FONT_SMALL_HEIGHT 8
+#define DISPLAY_FONT_LARGE_HEIGHT 16
+
+// Run-length encoded 2 bpp icons (flash). Each byte is one run of pixels:
+// bits 7..6 select a palette entry, bits 5..0 hold the run length minus one.
+// Runs never cross a row, so a row can be replayed mirrored.
+#define DISPLAY_ICON_RUN(index, length) ((uint8_t)(((index) << 6) | ((length) - 1)))
+#define DISPLAY_ICON_PALETTE_SIZE 4
+
 /**
  * @brief Initializes the LCD display hardware and driver.
  * Configures SPI, GPIO pins (CS, DC, RST), and sends initialization commands to the LCD controller.
@@ -115,7 +131,7 @@ void display_fill_circle(int16_t x0, int16_t y0, int16_t r, display_color_t colo
 
 /**
  * @brief Sets the font to use for text rendering.
- * @param font Pointer to the font definition structure.
+ * @param font Pointer to the font definition structure (NULL selects display_font_small).
  */
 void display_set_font(const display_font_t *font);
 
@@ -137,6 +153,27 @@ void display_draw_char(int16_t x, int16_t y, char c);
  */
 void display_draw_string(int16_t x, int16_t y, const char *str);
 
+/**
+ * @brief Measures text in the current font.
+ * @param str Characters to measure (need not be NUL-terminated).
+ * @param len Number of characters.
+ * @return Width in pixels, including the spacing after each glyph.
+ */
+int16_t display_text_width(const char *str, uint8_t len);
+
+/**
+ * @brief Draws a run of characters in one address window.
+ * Glyphs and the spacing between them are written in the current foreground
+ * and background colors, so changed text needs no separate clear.
+ * Characters that would extend past the right edge are dropped.
+ * @param x Top-left X-coordinate of the run.
+ * @param y Top-left Y-coordinate of the run.
+ * @param str Characters to draw (need not be NUL-terminated).
+ * @param len Number of characters.
+ * @return Width drawn in pixels.
+ */
+int16_t display_draw_text_run(int16_t x, int16_t y, const char *str, uint8_t len);
+
 /**
  * @brief Draws a bitmap image onto the display.
  * @param x Top-left X-coordinate for the bitmap.
@@ -148,10 +185,80 @@ void display_draw_string(int16_t x, int16_t y, const char *str);
 void display_draw_bitmap(int16_t x, int16_t y, int16_t w, int16_t h, const display_color_t *bitmap);
 
 /**
- * @brief Refreshes a portion or the entire display from a back buffer (if used).
- * For displays without hardware acceleration, this might not do anything if drawing directly.
+ * @brief Draws a run-length encoded 2 bpp icon in one address window.
+ * Runs are decoded straight into the SPI stream through the palette, so the
+ * icon costs its w x h pixels on the wire and nothing in RAM.
+ * The icon must lie entirely on screen; otherwise nothing is drawn.
+ * @param x Top-left X-coordinate.
+ * @param y Top-left Y-coordinate.
+ * @param w Icon width in pixels.
+ * @param h Icon height in pixels.
+ * @param rle Encoded rows in flash (PROGMEM), see DISPLAY_ICON_RUN().
+ * @param palette Colors for the four palette entries.
+ * @param mirror true to draw the icon flipped left to right.
+ */
+void display_draw_icon(int16_t x, int16_t y, uint8_t w, uint8_t h, const uint8_t *rle,
+                       const display_color_t palette[DISPLAY_ICON_PALETTE_SIZE], bool mirror);
+
+// --- Display List (scanline compositor, ENABLE_DISPLAY_COMPOSITOR) ---
+// Instead of drawing directly, a region can be described as a list of items
+// and composited in one pass: rows are built in a RAM line buffer, later items
+// on top of earlier ones, and streamed into a single window with no overdraw.
+// Items keep pointers to the caller's text and palettes until display_refresh().
+
+#define DISPLAY_LIST_TRANSPARENT (1 << 0) // Text: no background. Icon: palette entry 0 is not drawn.
+#define DISPLAY_LIST_MIRROR      (1 << 1) // Icon: flipped left to right
+
+/**
+ * @brief Starts a new display list for a region, discarding any pending items.
+ * @param x Top-left X-coordinate of the region.
+ * @param y Top-left Y-coordinate of the region.
+ * @param w Region width (at most LCD_WIDTH, the line buffer size).
+ * @param h Region height.
+ * @param background Color of pixels no item covers.
+ */
+void display_list_begin(int16_t x, int16_t y, int16_t w, int16_t h, display_color_t background);
+
+/**
+ * @brief Adds a solid rectangle to the display list.
+ * @return false if the list is full (DISPLAY_LIST_MAX_ITEMS).
+ */
+bool display_list_add_rect(int16_t x, int16_t y, int16_t w, int16_t h, display_color_t color);
+
+/**
+ * @brief Adds a text run in the current font and colors to the display list.
+ * @param x Top-left X-coordinate of the run.
+ * @param y Top-left Y-coordinate of the run.
+ * @param str Characters (need not be NUL-terminated; must stay valid until display_refresh()).
+ * @param len Number of characters.
+ * @param flags DISPLAY_LIST_TRANSPARENT to leave the background of the run untouched.
+ * @return false if the list is full.
+ */
+bool display_list_add_text(int16_t x, int16_t y, const char *str, uint8_t len, uint8_t flags);
+
+/**
+ * @brief Adds a run-length encoded icon (see display_draw_icon()) to the display list.
+ * @param palette Four colors; must stay valid until display_refresh().
+ * @param flags DISPLAY_LIST_TRANSPARENT and/or DISPLAY_LIST_MIRROR.
+ * @return false if the list is full.
+ */
+bool display_list_add_icon(int16_t x, int16_t y, uint8_t w, uint8_t h, const uint8_t *rle,
+                           const display_color_t palette[DISPLAY_ICON_PALETTE_SIZE], uint8_t flags);
+
+/**
+ * @brief Composites the pending display list and streams it to the panel.
+ * The region is sent as one window, one scanline at a time, and the list is
+ * cleared afterwards. Does nothing if no list is pending (or in builds
+ * without the compositor, where all drawing is direct).
  */
 void display_refresh(void);
 
+/**
+ * @brief Puts the LCD controller into or out of sleep.
+ * Frame memory is retained, so the last image reappears on wake without redrawing.
+ * @param on true to wake the panel, false to blank it and enter sleep.
+ */
+void display_set_power(bool on);
+
 
 #endif // MODULES_DISPLAY_DRIVER_H
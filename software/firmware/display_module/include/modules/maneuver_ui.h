@@ -0,0 +1,51 @@
+#ifndef MODULES_MANEUVER_UI_H
+#define MODULES_MANEUVER_UI_H
+
+/**
+ * @file maneuver_ui.h
+ * @brief Presentation of maneuver codes (nav_maneuver.h) on the Display Module.
+ * The Brain Module sends only the maneuver code and its argument; the icon and
+ * the instruction text are looked up here, both from tables in flash.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h> // For size_t
+#include "modules/display_driver.h"
+#include "nav_maneuver.h"
+
+#define MANEUVER_ICON_SIZE 32 // Icons are square, in pixels
+
+/**
+ * @brief Blits the icon for a maneuver (one address window, fully opaque).
+ * Codes without an icon clear the box to the background color.
+ * Roundabouts with an exit number show it in the middle of the ring.
+ * @param x Top-left X-coordinate of the icon box.
+ * @param y Top-left Y-coordinate of the icon box.
+ * @param maneuver A nav_maneuver_t value.
+ * @param arg The maneuver argument (roundabout exit number).
+ * @param fg Color of the arrow and of the exit number.
+ * @param bg Background color of the box.
+ */
+void maneuver_ui_draw_icon(int16_t x, int16_t y, uint8_t maneuver, uint8_t arg,
+                           display_color_t fg, display_color_t bg);
+
+/**
+ * @brief Adds the icon for a maneuver to the pending display list.
+ * Same output as maneuver_ui_draw_icon(), composited by display_refresh().
+ * Only one maneuver icon can be pending per display list.
+ * @return false if the display list is full.
+ */
+bool maneuver_ui_add_icon(int16_t x, int16_t y, uint8_t maneuver, uint8_t arg,
+                          display_color_t fg, display_color_t bg);
+
+/**
+ * @brief Formats the instruction text for a maneuver.
+ * @param maneuver A nav_maneuver_t value.
+ * @param arg The maneuver argument (roundabout exit number).
+ * @param out Buffer receiving the NUL-terminated text.
+ * @param size Size of the buffer.
+ */
+void maneuver_ui_format_text(uint8_t maneuver, uint8_t arg, char *out, size_t size);
+
+#endif // MODULES_MANEUVER_UI_H
@@ -0,0 +1,51 @@
+#ifndef MODULES_OTA_H
+#define MODULES_OTA_H
+
+/**
+ * @file ota.h
+ * @brief Firmware update over the BLE link: hand-over from the application to
+ * the bootloader in the boot section (bootloader/bootloader.c).
+ *
+ * The bootloader owns the reset vector (BOOTRST fuse). On every reset it
+ * reads OTA_FLAG_ADDR in EEPROM:
+ * - OTA_FLAG_REQUESTED: set by ota_enter_bootloader() when a
+ *   BLE_MSG_BOOT_BEGIN arrives. Wait OTA_BOOT_WAIT_S for the update, then run
+ *   the application if nothing came.
+ * - OTA_FLAG_ERASING: set before the first page is erased. The application is
+ *   incomplete, so stay until an image passes its CRC check.
+ * - Anything else (0xFF when erased): run the application at once.
+ * A flashed but never-programmed application (0xFFFF at address 0) also keeps
+ * the bootloader running. The bootloader clears MCUSR and leaves its value in
+ * GPIOR0 for the application.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "config.h"    // For ENABLE_OTA_BOOTLOADER
+#include "hal/eeprom.h" // For HAL_EEPROM_SIZE
+
+#ifndef ENABLE_OTA_BOOTLOADER
+#define ENABLE_OTA_BOOTLOADER 0
+#endif
+
+#define OTA_BOOT_START      0x7800UL // Boot section of 1024 words (BOOTSZ1:0 = 01)
+#define OTA_APP_MAX_SIZE    OTA_BOOT_START // The application must end below the bootloader
+#define OTA_FLAG_ADDR       (HAL_EEPROM_SIZE - 1) // Last EEPROM byte, clear of any stored settings
+#define OTA_FLAG_REQUESTED  0xB1
+#define OTA_FLAG_ERASING    0xB2
+#define OTA_BOOT_WAIT_S     30 // Wait for BLE_MSG_BOOT_BEGIN after a request
+
+#if ENABLE_OTA_BOOTLOADER
+
+/**
+ * @brief Sets OTA_FLAG_REQUESTED and restarts into the bootloader. Does not return.
+ */
+void ota_enter_bootloader(void);
+
+#else // No bootloader fitted: updates need the ISP programmer
+
+static inline void ota_enter_bootloader(void) {}
+
+#endif // ENABLE_OTA_BOOTLOADER
+
+#endif // MODULES_OTA_H
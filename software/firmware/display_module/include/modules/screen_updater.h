@@ -0,0 +1,40 @@
+#ifndef MODULES_SCREEN_UPDATER_H
+#define MODULES_SCREEN_UPDATER_H
+
+/**
+ * @file screen_updater.h
+ * @brief Interface for the Screen Updater module.
+ * The screen is a set of widgets from a layout table (ui_layout.h), each with
+ * its own bounding box and last-rendered value. An update redraws only the widgets whose inputs
+ * changed, so a typical change costs a few hundred bytes of SPI traffic.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Initializes the UI state and paints the full screen once.
+ * Call after display_init().
+ */
+void screen_updater_init(void);
+
+/**
+ * @brief Collects the latest data and redraws the widgets that changed.
+ * Call periodically (SCREEN_UPDATE_INTERVAL_MS).
+ */
+void screen_updater_update(void);
+
+/**
+ * @brief Forces a full repaint on the next update.
+ * Use after the frame memory was lost or overwritten.
+ */
+void screen_updater_invalidate_all(void);
+
+/**
+ * @brief Switches to another layout; the screen is repainted on the next update.
+ * @param layout_id A ui_layout_id_t value (UI_LAYOUT_NIGHT, ...).
+ * @return false if there is no such layout.
+ */
+bool screen_updater_set_layout(uint8_t layout_id);
+
+#endif // MODULES_SCREEN_UPDATER_H
@@ -0,0 +1,60 @@
+#ifndef MODULES_SETTINGS_H
+#define MODULES_SETTINGS_H
+
+/**
+ * @file settings.h
+ * @brief Persistent settings of the Display Module: battery calibration,
+ * layout and refresh periods.
+ *
+ * The values in config.h are the defaults. settings_init() loads the saved
+ * copy from EEPROM (util/persist.h) into RAM once at start-up; modules read
+ * it through settings_get(). The phone changes a value through the Brain,
+ * which relays BLE_MSG_CONFIG_SET for the BLE_CONFIG_DISPLAY_* keys as
+ * BLE_MSG_DISPLAY_CONFIG_SET (ble_protocol.h); the answer goes back as
+ * BLE_MSG_DISPLAY_CONFIG_VALUE. The RAM copy is saved SETTINGS_SAVE_DELAY_MS
+ * after the last change. Modules that derive state from a setting (the
+ * battery scale, the layout) re-read it when settings_get_revision() changes.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint16_t battery_r1_ohms;     // Battery divider, upper resistor
+    uint16_t battery_r2_ohms;     // Battery divider, lower resistor
+    uint16_t battery_vref_mv;     // ADC reference
+    uint16_t screen_interval_ms;  // Screen updater period (read at start-up)
+    uint16_t battery_interval_ms; // Battery status period (read at start-up)
+    uint8_t layout;               // ui_layout_id_t
+} settings_t;
+
+/**
+ * @brief Loads the saved settings, or the config.h defaults if there are none.
+ * Call before the modules that read settings are initialized.
+ */
+void settings_init(void);
+
+/**
+ * @brief Returns the current settings (always valid, the defaults until settings_init()).
+ */
+const settings_t *settings_get(void);
+
+/**
+ * @brief Returns a counter that changes whenever a setting changes.
+ */
+uint8_t settings_get_revision(void);
+
+/**
+ * @brief Handles the relayed BLE_MSG_DISPLAY_CONFIG_SET/GET and answers with
+ * BLE_MSG_DISPLAY_CONFIG_VALUE.
+ * @return true if the frame was a settings message.
+ */
+bool settings_handle_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length, uint32_t now_ms);
+
+/**
+ * @brief Saves changed settings once SETTINGS_SAVE_DELAY_MS has passed since
+ * the last change. Call periodically, along with persist_poll().
+ */
+void settings_poll(uint32_t now_ms);
+
+#endif // MODULES_SETTINGS_H
@@ -0,0 +1,107 @@
+#ifndef MODULES_UI_LAYOUT_H
+#define MODULES_UI_LAYOUT_H
+
+/**
+ * @file ui_layout.h
+ * @brief Screen layouts as tables in flash, drawn by the screen updater.
+ * A layout is a list of background bands and a list of widgets. Each widget
+ * names its type, bounding box, font, colors and the value it shows, so a new
+ * layout is a new table in ui_layout.c and no drawing code changes.
+ *
+ * Widget types:
+ * - TEXT: the string for its source (the maneuver instruction).
+ * - NUMBER: the source value in decimal, then a fixed suffix (" km/h").
+ * - INDICATOR: a solid box, fg while the source is active, bg otherwise.
+ * - ICON: the maneuver icon (maneuver_ui.h), fg on bg.
+ * The updater keeps the string on screen for each TEXT and NUMBER widget, in
+ * the text slot ui_layout_load() assigns it; widgets may come in any order.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "modules/display_driver.h"
+
+#define UI_LAYOUT_MAX_WIDGETS 8  // Widgets per layout (one stale bit each)
+#define UI_LAYOUT_MAX_TEXT    4  // TEXT and NUMBER widgets per layout (25 B of RAM each)
+#define UI_LAYOUT_MAX_BANDS   2  // Backgrounds painted by a full repaint
+#define UI_SUFFIX_MAX         5  // Characters after a NUMBER widget's digits
+
+typedef enum {
+    UI_LAYOUT_DAY,     // Blue navigation area, white text
+    UI_LAYOUT_NIGHT,   // Same places on black, dim colors
+    UI_LAYOUT_MINIMAL, // Icon, distance and speed only, large digits
+    UI_LAYOUT_COUNT
+} ui_layout_id_t;
+
+typedef enum {
+    UI_WIDGET_TEXT,
+    UI_WIDGET_NUMBER,
+    UI_WIDGET_INDICATOR,
+    UI_WIDGET_ICON
+} ui_widget_type_t;
+
+typedef enum {
+    UI_SOURCE_INSTRUCTION,  // TEXT: maneuver instruction
+    UI_SOURCE_DISTANCE,     // NUMBER: metres to the maneuver
+    UI_SOURCE_BATTERY,      // NUMBER: display battery percent, '+' appended while charging
+    UI_SOURCE_SPEED,        // NUMBER: km/h
+    UI_SOURCE_MANEUVER,     // ICON: maneuver code and argument
+    UI_SOURCE_SIGNAL_LEFT,  // INDICATOR: left turn signal lit (or hazard)
+    UI_SOURCE_SIGNAL_RIGHT, // INDICATOR: right turn signal lit (or hazard)
+    UI_SOURCE_LINK          // INDICATOR: Brain Module connected
+} ui_source_t;
+
+typedef struct {
+    int16_t x, y, w, h;
+} ui_rect_t;
+
+typedef struct {
+    ui_rect_t box;
+    uint8_t type;               // ui_widget_type_t
+    uint8_t source;             // ui_source_t
+    const display_font_t *font; // TEXT and NUMBER only
+    display_color_t fg;         // Ink, or the active INDICATOR color
+    display_color_t bg;         // Paper, or the inactive INDICATOR color
+    char suffix[UI_SUFFIX_MAX + 1]; // NUMBER only
+} ui_widget_t;
+
+typedef struct {
+    ui_rect_t rect;
+    display_color_t color;
+} ui_band_t;
+
+typedef struct {
+    const ui_widget_t *widgets; // In flash
+    const ui_band_t *bands;     // In flash
+    uint8_t widget_count;
+    uint8_t text_count;         // TEXT and NUMBER widgets, counted by ui_layout_load()
+    uint8_t band_count;
+    uint8_t text_slot[UI_LAYOUT_MAX_WIDGETS]; // Per widget: its text slot, below text_count (TEXT and NUMBER only)
+} ui_layout_t;
+
+/**
+ * @brief Copies a layout's header out of flash and numbers its text slots.
+ * @param id A ui_layout_id_t value.
+ * @param layout Receives the header.
+ * @return false if there is no such layout, or it has more than
+ *         UI_LAYOUT_MAX_TEXT TEXT and NUMBER widgets.
+ */
+bool ui_layout_load(uint8_t id, ui_layout_t *layout);
+
+/**
+ * @brief Copies one widget of a loaded layout out of flash.
+ * @param layout Header from ui_layout_load().
+ * @param index Widget index, below layout->widget_count.
+ * @param widget Receives the widget.
+ */
+void ui_layout_read_widget(const ui_layout_t *layout, uint8_t index, ui_widget_t *widget);
+
+/**
+ * @brief Copies one background band of a loaded layout out of flash.
+ * @param layout Header from ui_layout_load().
+ * @param index Band index, below layout->band_count.
+ * @param band Receives the band.
+ */
+void ui_layout_read_band(const ui_layout_t *layout, uint8_t index, ui_band_t *band);
+
+#endif // MODULES_UI_LAYOUT_H
@@ -0,0 +1,30 @@
+#ifndef PERF_SECTIONS_H
+#define PERF_SECTIONS_H
+
+/**
+ * @file perf_sections.h
+ * @brief Display Module profiling sections and counters (see util/perf.h).
+ * Report order follows list order; names are what diagnostics.py prints.
+ */
+
+#define PERF_SECTIONS(X) \
+    X(SCREEN_UPDATE,  "screen_update") /* screen_updater_update() */ \
+    X(DISP_CLEAR,     "disp_clear") \
+    X(DISP_PIXEL,     "disp_pixel") \
+    X(DISP_LINE,      "disp_line") \
+    X(DISP_RECT,      "disp_rect") \
+    X(DISP_FILL_RECT, "disp_fill_rect") \
+    X(DISP_CIRCLE,    "disp_circle") \
+    X(DISP_FILL_CIRC, "disp_fill_circ") \
+    X(DISP_TEXT,      "disp_text")     /* display_draw_text_run(), also behind draw_char/draw_string */ \
+    X(DISP_BITMAP,    "disp_bitmap") \
+    X(DISP_ICON,      "disp_icon") \
+    X(DISP_REFRESH,   "disp_refresh")  /* Compositor pass */
+
+#define PERF_COUNTERS(X) \
+    X(MAIN_LOOP,      "main_loop")     /* Super-loop passes in the report window */ \
+    X(BLE_OVERRUN,    "ble_overrun")   /* BLE UART overruns plus RX ring drops, since boot */ \
+    X(BLE_CRC,        "ble_crc")       /* Frames dropped for a bad CRC, since boot */ \
+    X(BLE_FRAMING,    "ble_framing")   /* Frames dropped for a bad length or END, since boot */
+
+#endif // PERF_SECTIONS_H
@@ -1,66 +1,246 @@
 /**
  * @file ble_rx.c
  * @brief BLE Receiver module implementation.
- * Parses incoming UART data from the Brain Module.
+ * Decodes binary frames (see ble_protocol.h) received from the Brain Module,
+ * acknowledges the sequenced ones with BLE_MSG_LINK_ACK and tracks the link
+ * state (see ble_link_state_t). Whenever the data on hand may be incomplete
+ * (first frame after a loss, a gap in the sequence) it asks the Brain for a
+ * keyframe rather than waiting for the periodic one.
+ *
+ * The decoded status and navigation data are published under sequence locks
+ * (util/snapshot.h), so they can be read consistently even if the frames are
+ * decoded in the UART ISR. The decoding side (ble_rx_process_char() and
+ * ble_rx_service()) must stay in one context.
  */
 
 #include "modules/ble_rx.h" // Use the module header file name
+#include "modules/settings.h"
 #include "hal/uart.h"
+#include "hal/timer.h"
 #include "util/logger.h"
-#include <string.h> // For strncmp, sscanf, strcpy
-#include <stdlib.h> // For atoi
+#include "util/perf.h"
+#include "util/snapshot.h"
+#include "ble_protocol.h" // Shared binary frame format
+#include "link_mux.h"
+#include "nav_maneuver.h"
+#include <string.h> // For memset
 
 // --- Internal State ---
 static display_status_data_t current_status_data;
 static display_nav_data_t current_nav_data;
-static bool is_connected = false; // Simple connection status flag
+static snapshot_t status_snapshot; // Guards current_status_data
+static snapshot_t nav_snapshot;    // Guards current_nav_data
+static uint8_t status_read_version = 0; // Consumer side: versions last copied
+static uint8_t nav_read_version = 0;
+static uint8_t link_state = BLE_LINK_CONNECTING; // ble_link_state_t
+static uint32_t last_frame_ms = 0; // Time of the last valid frame (liveness and link-idle detection)
+static bool resync_wanted = false;  // Keyframe request due
+static uint32_t last_resync_ms = 0;
+static bool update_requested = false; // BLE_MSG_BOOT_BEGIN seen
 
-// Receive buffer state
-#define BLE_RX_BUFFER_LEN 128
-static char rx_buffer[BLE_RX_BUFFER_LEN];
-static uint8_t rx_buffer_idx = 0;
+// Frame parser state (fed one byte at a time)
+static ble_parser_t rx_parser;
+
+// Sequenced frames received, as reported in BLE_MSG_LINK_ACK
+#define SEQ_WINDOW 8 // Frames covered by the ACK's recv_mask
+static bool seq_seen = false;
+static uint8_t rx_last_seq = 0;
+static uint8_t rx_seq_mask = 0;
+static uint8_t rx_seq_count = 0;
+static uint8_t frames_since_ack = 0;
+static bool ack_requested = false;
+static uint32_t last_ack_ms = 0;
 
 // --- Internal Helper Functions ---
 
-// Parses a complete message received in rx_buffer
-static void parse_ble_message(const char *message) {
-    log_debug("BLE RX: Parsing: %s", message);
-
-    // Example parsing based on Brain Module formats:
-    // "NAV:Instruction,Distance\n"
-    // "STATUS:Batt_mV,Signals,Speed_kmh\n"
-
-    if (strncmp(message, "NAV:", 4) == 0) {
-        // Parse navigation update
-        char instruction_buf[sizeof(current_nav_data.instruction)] = {0};
-        unsigned int distance = 0;
-        // Use sscanf carefully, check return value
-        int parsed_count = sscanf(message + 4, "%63[^,],%u", instruction_buf, &distance);
-        if (parsed_count == 2) {
-            strncpy(current_nav_data.instruction, instruction_buf, sizeof(current_nav_data.instruction) - 1);
-            current_nav_data.distance_m = (uint16_t)distance;
-            current_nav_data.updated = true;
-            is_connected = true; // Assume connected if data arrives
-            log_info("BLE RX: Parsed Nav - Instr='%s', Dist=%u", current_nav_data.instruction, current_nav_data.distance_m);
-        } else {
-            log_warn("BLE RX: Failed to parse NAV message format");
-        }
-    } else if (strncmp(message, "STATUS:", 7) == 0) {
-        // Parse status update
-        unsigned int batt = 0, signals = 0, speed = 0;
-        int parsed_count = sscanf(message + 7, "%u,%u,%u", &batt, &signals, &speed);
-        if (parsed_count == 3) {
-            current_status_data.battery_mv = (uint16_t)batt;
-            current_status_data.signal_status = (uint8_t)signals;
-            current_status_data.speed_kmh = (uint8_t)speed;
-            current_status_data.updated = true;
-            is_connected = true; // Assume connected if data arrives
-            log_info("BLE RX: Parsed Status - Batt=%u, Sig=%u, Spd=%u", current_status_data.battery_mv, current_status_data.signal_status, current_status_data.speed_kmh);
+// Records the sequence number of a NAV, STATUS or FIELD frame.
+static void note_sequence(const uint8_t *payload, uint8_t length) {
+    if (length <= BLE_SEQ_OFS) return;
+    uint8_t seq = payload[BLE_SEQ_OFS] & BLE_SEQ_MASK;
+    uint8_t ahead = (uint8_t)(seq - rx_last_seq) & BLE_SEQ_MASK;
+    uint8_t back = (uint8_t)(rx_last_seq - seq) & BLE_SEQ_MASK;
+
+    if (seq_seen && ahead > 1 && ahead <= BLE_SEQ_MASK / 2) {
+        resync_wanted = true; // Missed frames may have carried field deltas
+    }
+    if (seq_seen && ahead > 0 && ahead <= BLE_SEQ_MASK / 2) {
+        rx_seq_mask = (ahead < SEQ_WINDOW) ? (uint8_t)((rx_seq_mask << ahead) | 1) : 1;
+        rx_last_seq = seq;
+    } else if (seq_seen && back < SEQ_WINDOW) {
+        rx_seq_mask |= (uint8_t)(1U << back); // Late, or a duplicate
+    } else {
+        rx_seq_mask = 1; // First frame, or the Brain restarted its count
+        rx_last_seq = seq;
+        seq_seen = true;
+    }
+    rx_seq_count++;
+    if (frames_since_ack < UINT8_MAX) frames_since_ack++;
+    if (payload[BLE_SEQ_OFS] & BLE_SEQ_ACK_REQUEST) {
+        ack_requested = true;
+    }
+}
+
+// Applies a BLE_MSG_NAV_UPDATE payload.
+static void handle_nav_update(const uint8_t *payload, uint8_t length) {
+    if (length < BLE_NAV_LEN) {
+        log_warn("BLE RX: Short NAV frame (%u bytes)", length);
+        return;
+    }
+    snapshot_write_begin(&nav_snapshot);
+    current_nav_data.distance_m = ble_get_u16(&payload[BLE_NAV_OFS_DISTANCE]);
+    current_nav_data.maneuver = payload[BLE_NAV_OFS_MANEUVER];
+    current_nav_data.arg = payload[BLE_NAV_OFS_ARG];
+    snapshot_write_end(&nav_snapshot, true);
+    log_debug("BLE RX: Nav - Maneuver=%u/%u, Dist=%u", current_nav_data.maneuver, current_nav_data.arg, current_nav_data.distance_m);
+}
+
+// Applies a BLE_MSG_STATUS_UPDATE payload.
+static void handle_status_update(const uint8_t *payload, uint8_t length) {
+    if (length < BLE_STATUS_LEN) {
+        log_warn("BLE RX: Short STATUS frame (%u bytes)", length);
+        return;
+    }
+    snapshot_write_begin(&status_snapshot);
+    current_status_data.battery_mv = ble_get_u16(&payload[BLE_STATUS_OFS_BATTERY]);
+    current_status_data.signal_status = payload[BLE_STATUS_OFS_SIGNAL];
+    current_status_data.speed_kmh = payload[BLE_STATUS_OFS_SPEED];
+    snapshot_write_end(&status_snapshot, true);
+    log_debug("BLE RX: Status - Batt=%u, Sig=%u, Spd=%u", current_status_data.battery_mv, current_status_data.signal_status, current_status_data.speed_kmh);
+}
+
+// Applies a BLE_MSG_FIELD_UPDATE payload: a mask byte followed by only the changed fields.
+static void handle_field_update(const uint8_t *payload, uint8_t length) {
+    if (length < BLE_FIELD_OFS_DATA) {
+        log_warn("BLE RX: Empty FIELD frame");
+        return;
+    }
+    uint8_t mask = payload[BLE_FIELD_OFS_MASK];
+    uint8_t pos = BLE_FIELD_OFS_DATA;
+
+    // Validate the length against the mask before touching any field.
+    uint8_t expected = BLE_FIELD_OFS_DATA;
+    if (mask & BLE_FIELD_BATTERY) expected += 2;
+    if (mask & BLE_FIELD_SIGNAL) expected += 1;
+    if (mask & BLE_FIELD_SPEED) expected += 1;
+    if (length < expected) {
+        log_warn("BLE RX: Short FIELD frame (mask 0x%02X, %u bytes)", mask, length);
+        return;
+    }
+
+    snapshot_write_begin(&status_snapshot);
+    if (mask & BLE_FIELD_BATTERY) {
+        current_status_data.battery_mv = ble_get_u16(&payload[pos]);
+        pos += 2;
+    }
+    if (mask & BLE_FIELD_SIGNAL) {
+        current_status_data.signal_status = payload[pos++];
+    }
+    if (mask & BLE_FIELD_SPEED) {
+        current_status_data.speed_kmh = payload[pos++];
+    }
+    snapshot_write_end(&status_snapshot, true);
+    log_debug("BLE RX: Fields 0x%02X applied", mask);
+}
+
+// Snapshots the receive error counts and queues a STATS report for the host.
+static void handle_stats_request(const uint8_t *payload, uint8_t length) {
+#if ENABLE_PERF_COUNTERS
+    uart_stats_t uart;
+    hal_uart_get_stats(BLE_UART_ID, &uart);
+    perf_counter_set(PERF_COUNTER_BLE_OVERRUN, (uint32_t)uart.overrun_errors + uart.rx_dropped);
+    perf_counter_set(PERF_COUNTER_BLE_CRC, rx_parser.crc_errors);
+    perf_counter_set(PERF_COUNTER_BLE_FRAMING, rx_parser.framing_errors);
+#endif
+    perf_report_start(length > 0 && (payload[0] & BLE_STATS_FLAG_RESET));
+}
+
+static void set_link_state(uint8_t state) {
+    if (state == link_state) return;
+    log_info("BLE RX: Link %u -> %u", link_state, state);
+    link_state = state;
+}
+
+// Any frame keeps the link alive; only a keyframe (STATUS_UPDATE, followed by
+// a NAV_UPDATE) makes it LIVE after CONNECTING or LOST.
+static void note_frame(uint8_t msg_id) {
+    last_frame_ms = hal_timer_millis();
+    if (link_state == BLE_LINK_STALE) {
+        set_link_state(BLE_LINK_LIVE); // Gaps are caught by note_sequence()
+    } else if (link_state != BLE_LINK_LIVE) {
+        if (msg_id == BLE_MSG_STATUS_UPDATE) {
+            set_link_state(BLE_LINK_LIVE);
         } else {
-             log_warn("BLE RX: Failed to parse STATUS message format");
+            set_link_state(BLE_LINK_CONNECTING);
+            resync_wanted = true;
         }
-    } else {
-        log_warn("BLE RX: Unknown message format: %s", message);
+    }
+}
+
+// Applies the liveness deadlines.
+static void check_liveness(uint32_t now) {
+    uint32_t silent = now - last_frame_ms;
+    if (link_state == BLE_LINK_LIVE && silent >= LINK_STALE_TIMEOUT_MS) {
+        set_link_state(BLE_LINK_STALE); // Values kept, shown dimmed
+    } else if (link_state == BLE_LINK_STALE && silent >= LINK_LOST_TIMEOUT_MS) {
+        set_link_state(BLE_LINK_LOST);
+        snapshot_write_begin(&nav_snapshot);
+        current_nav_data.maneuver = NAV_MANEUVER_NO_LINK; // Stale guidance is worse than none
+        current_nav_data.arg = 0;
+        snapshot_write_end(&nav_snapshot, true);
+    }
+}
+
+// Sends a keyframe request if one is wanted and the last one is not too recent.
+static bool send_resync(uint32_t now) {
+    if (!resync_wanted || now - last_resync_ms < LINK_RESYNC_MIN_INTERVAL_MS) {
+        return false;
+    }
+    uint8_t frame[BLE_PROTO_OVERHEAD];
+    size_t frame_len = ble_frame_encode(frame, sizeof(frame), BLE_MSG_KEYFRAME_REQUEST, NULL, 0);
+    if (!link_mux_send(LINK_CHANNEL_DATA, frame, frame_len)) {
+        return false;
+    }
+    resync_wanted = false;
+    last_resync_ms = now;
+    log_debug("BLE RX: Keyframe requested");
+    return true;
+}
+
+// Dispatches a complete, CRC-checked frame by message ID.
+static void dispatch_frame(const ble_parser_t *frame) {
+    note_frame(frame->msg_id);
+    switch (frame->msg_id) {
+        case BLE_MSG_NAV_UPDATE:
+            note_sequence(frame->payload, frame->length);
+            handle_nav_update(frame->payload, frame->length);
+            break;
+        case BLE_MSG_STATUS_UPDATE:
+            note_sequence(frame->payload, frame->length);
+            handle_status_update(frame->payload, frame->length);
+            break;
+        case BLE_MSG_FIELD_UPDATE:
+            note_sequence(frame->payload, frame->length);
+            handle_field_update(frame->payload, frame->length);
+            break;
+        case BLE_MSG_HEARTBEAT:
+            note_sequence(frame->payload, frame->length);
+            break;
+        case BLE_MSG_BOOT_BEGIN:
+            update_requested = true; // The bootloader answers the repeated BEGIN
+            break;
+        case BLE_MSG_STATS_REQUEST:
+            handle_stats_request(frame->payload, frame->length);
+            break;
+        case BLE_MSG_DISPLAY_CONFIG_SET:
+        case BLE_MSG_DISPLAY_CONFIG_GET:
+            settings_handle_frame(frame->msg_id, frame->payload, frame->length, last_frame_ms);
+            break;
+        case BLE_MSG_LOG:
+        case BLE_MSG_STATS:
+            break; // Brain diagnostics, for a host listening on the link
+        default:
+            log_warn("BLE RX: Unknown message ID 0x%02X", frame->msg_id);
+            break;
     }
 }
 
@@ -70,66 +250,88 @@ void ble_rx_init(void) {
     log_info("BLE Receiver: Initializing...");
     memset(&current_status_data, 0, sizeof(current_status_data));
     memset(&current_nav_data, 0, sizeof(current_nav_data));
-    strcpy(current_nav_data.instruction, "Connecting..."); // Default initial message
-    current_status_data.updated = false;
-    current_nav_data.updated = false;
-    rx_buffer_idx = 0;
-    is_connected = false;
+    current_nav_data.maneuver = NAV_MANEUVER_NO_LINK; // Shown as "Connecting..."
+    snapshot_init(&status_snapshot);
+    snapshot_init(&nav_snapshot);
+    status_read_version = 0;
+    nav_read_version = 0;
+    ble_parser_init(&rx_parser);
+    link_state = BLE_LINK_CONNECTING;
+    last_frame_ms = hal_timer_millis();
+    resync_wanted = false;
+    last_resync_ms = last_frame_ms - LINK_RESYNC_MIN_INTERVAL_MS;
+    seq_seen = false;
+    rx_seq_count = 0;
+    frames_since_ack = 0;
+    ack_requested = false;
+    last_ack_ms = last_frame_ms;
     // UART for BLE is initialized in main/hardware_init
     log_info("BLE Receiver: Initialized.");
 }
 
 void ble_rx_process_char(uint8_t received_char) {
-    // Buffer incoming characters until a terminator is found.
-    if (received_char == BLE_MSG_TERMINATOR) {
-        // End of message detected
-        if (rx_buffer_idx > 0) { // Ignore empty messages
-            rx_buffer[rx_buffer_idx] = '\0'; // Null-terminate the string
-            parse_ble_message(rx_buffer);
-        }
-        rx_buffer_idx = 0; // Reset buffer index for next message
-    } else if (rx_buffer_idx < (BLE_RX_BUFFER_LEN - 1)) {
-        // Add character to buffer if space available
-        // Ignore non-printable characters? (Optional)
-        if (received_char >= ' ' && received_char <= '~') {
-             rx_buffer[rx_buffer_idx++] = (char)received_char;
-        }
-    } else {
-        // Buffer overflow, discard current message and reset
-        log_warn("BLE RX: Buffer overflow, discarding message.");
-        rx_buffer_idx = 0;
+    // Advance the frame state machine; fields are applied as soon as the END byte arrives.
+    if (ble_parser_feed(&rx_parser, received_char)) {
+        dispatch_frame(&rx_parser);
+    }
+}
+
+bool ble_rx_service(void) {
+    uint32_t now = hal_timer_millis();
+    check_liveness(now);
+    bool sent = send_resync(now);
+    if (frames_since_ack == 0 || (!ack_requested && now - last_ack_ms < LINK_ACK_INTERVAL_MS)) {
+        return sent;
+    }
+
+    uint8_t payload[BLE_LINK_ACK_LEN] = { rx_last_seq, rx_seq_mask, rx_seq_count };
+    uint8_t frame[BLE_LINK_ACK_LEN + BLE_PROTO_OVERHEAD];
+    size_t frame_len = ble_frame_encode(frame, sizeof(frame), BLE_MSG_LINK_ACK, payload, sizeof(payload));
+    if (!link_mux_send(LINK_CHANNEL_DATA, frame, frame_len)) {
+        return sent; // TX buffer full; the next call retries with the newer state
     }
+    frames_since_ack = 0;
+    ack_requested = false;
+    last_ack_ms = now;
+    return true;
 }
 
 bool ble_rx_is_status_available(void) {
-    return current_status_data.updated;
+    return snapshot_version(&status_snapshot) != status_read_version;
 }
 
 bool ble_rx_get_status_data(display_status_data_t *data) {
-    if (!data || !current_status_data.updated) {
+    if (!data || !ble_rx_is_status_available()) {
         return false;
     }
-    memcpy(data, &current_status_data, sizeof(display_status_data_t));
-    current_status_data.updated = false; // Clear flag after reading
+    status_read_version = snapshot_read(&status_snapshot, data, &current_status_data, sizeof(display_status_data_t));
     return true;
 }
 
 bool ble_rx_is_nav_available(void) {
-    return current_nav_data.updated;
+    return snapshot_version(&nav_snapshot) != nav_read_version;
 }
 
 bool ble_rx_get_nav_data(display_nav_data_t *data) {
-     if (!data || !current_nav_data.updated) {
+    if (!data || !ble_rx_is_nav_available()) {
         return false;
     }
-    memcpy(data, &current_nav_data, sizeof(display_nav_data_t));
-    current_nav_data.updated = false; // Clear flag after reading
+    nav_read_version = snapshot_read(&nav_snapshot, data, &current_nav_data, sizeof(display_nav_data_t));
     return true;
 }
 
 bool ble_rx_is_connected(void) {
-    // Simple connection check: assume disconnected if no data received for a while?
-    // Or rely solely on the flag set when messages are parsed.
-    // Add timeout logic here if needed.
-    return is_connected;
+    return link_state == BLE_LINK_LIVE;
+}
+
+ble_link_state_t ble_rx_get_link_state(void) {
+    return (ble_link_state_t)link_state;
+}
+
+bool ble_rx_update_requested(void) {
+    return update_requested;
+}
+
+uint32_t ble_rx_get_last_frame_ms(void) {
+    return last_frame_ms;
 }
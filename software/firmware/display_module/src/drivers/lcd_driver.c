@@ -8,70 +8,89 @@
 #include "hal/spi.h"
 #include "hal/gpio.h"
 #include "util/logger.h"
+#include "util/perf.h"
+#include <avr/pgmspace.h> // For the font and icon tables
 #include <util/delay.h> // For delays during initialization/commands
 #include <string.h>     // For strlen in draw_string
 
 // --- Internal Defines & State ---
+#define LCD_CMD_CASET 0x2A // Column address set: x0 (u16) | x1 (u16)
+#define LCD_CMD_RASET 0x2B // Row address set: y0 (u16) | y1 (u16)
+#define LCD_CMD_RAMWR 0x2C // Memory write: pixels follow, from the window start
+
 static display_color_t current_fg_color = COLOR_WHITE;
 static display_color_t current_bg_color = COLOR_BLACK;
-// static const display_font_t *current_font = NULL; // Add if implementing fonts
+static const display_font_t *current_font = &display_font_small;
+
+// Last window sent to the controller, which keeps CASET/RASET until reset.
+// -1 in win_x0 / win_y0 means unknown.
+static int16_t win_x0 = -1, win_x1 = -1;
+static int16_t win_y0 = -1, win_y1 = -1;
 
 // --- Low-Level LCD Communication ---
+// CS and DC are written directly on LCD_CTRL_PORT. A transaction keeps CS low
+// from the first command to the last pixel and only DC changes in between;
+// DC is switched once the previous byte has left the shift register.
 
 // Select the LCD chip
 static inline void lcd_select(void) {
-    hal_gpio_write(LCD_CS_PIN, false); // Active low chip select
+    HAL_GPIO_PORT_LOW(LCD_CTRL_PORT, LCD_CS_PIN); // Active low chip select
 }
 
 // Deselect the LCD chip
 static inline void lcd_deselect(void) {
-    hal_gpio_write(LCD_CS_PIN, true);
+    HAL_GPIO_PORT_HIGH(LCD_CTRL_PORT, LCD_CS_PIN);
 }
 
-// Send a command byte to the LCD
-static void lcd_write_command(uint8_t cmd) {
-    hal_gpio_write(LCD_DC_PIN, false); // D/C pin low for command
-    lcd_select();
-    hal_spi_transfer_byte(LCD_SPI_ID, cmd);
-    lcd_deselect();
+// Sends a command and its parameters within the open transaction. Leaves DC
+// high, so pixel data may follow straight away.
+static void lcd_command(uint8_t cmd, const uint8_t *params, uint8_t len) {
+    HAL_GPIO_PORT_LOW(LCD_CTRL_PORT, LCD_DC_PIN); // Command
+    hal_spi_stream_start(cmd);
+    hal_spi_stream_finish();
+    HAL_GPIO_PORT_HIGH(LCD_CTRL_PORT, LCD_DC_PIN); // Parameters / data
+    if (len > 0) {
+        hal_spi_write_multi(LCD_SPI_ID, params, len);
+    }
 }
 
-// Send a data byte to the LCD
-static void lcd_write_data(uint8_t data) {
-    hal_gpio_write(LCD_DC_PIN, true); // D/C pin high for data
+// Sends one command with its parameters as a transaction of its own
+static void lcd_write_command(uint8_t cmd, const uint8_t *params, uint8_t len) {
     lcd_select();
-    hal_spi_transfer_byte(LCD_SPI_ID, data);
+    lcd_command(cmd, params, len);
     lcd_deselect();
 }
 
-// Send multiple data bytes
-static void lcd_write_data_multi(const uint8_t *data, size_t len) {
-    hal_gpio_write(LCD_DC_PIN, true); // D/C pin high for data
-    lcd_select();
-    hal_spi_write_multi(LCD_SPI_ID, data, len);
-    lcd_deselect();
+// Forgets the window after anything that may have reset the controller
+static void lcd_invalidate_window(void) {
+    win_x0 = -1;
+    win_y0 = -1;
 }
 
-// Send a 16-bit color value
-static void lcd_write_color(display_color_t color) {
-    uint8_t color_bytes[2] = {(uint8_t)(color >> 8), (uint8_t)color};
-    lcd_write_data_multi(color_bytes, 2);
+// Sends an address range command unless the controller already holds it
+static void lcd_set_range(uint8_t cmd, int16_t *cur0, int16_t *cur1, int16_t v0, int16_t v1) {
+    if (*cur0 == v0 && *cur1 == v1) {
+        return;
+    }
+    uint8_t range[4] = {(uint8_t)(v0 >> 8), (uint8_t)v0, (uint8_t)(v1 >> 8), (uint8_t)v1};
+    lcd_command(cmd, range, sizeof(range));
+    *cur0 = v0;
+    *cur1 = v1;
 }
 
-// Set the drawing window (address window)
-static void lcd_set_window(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
-    // Send Column Address Set command (e.g., 0x2A)
-    lcd_write_command(0x2A); // Example command
-    uint8_t col_data[4] = {(uint8_t)(x0 >> 8), (uint8_t)x0, (uint8_t)(x1 >> 8), (uint8_t)x1};
-    lcd_write_data_multi(col_data, 4);
-
-    // Send Row Address Set command (e.g., 0x2B)
-    lcd_write_command(0x2B); // Example command
-    uint8_t row_data[4] = {(uint8_t)(y0 >> 8), (uint8_t)y0, (uint8_t)(y1 >> 8), (uint8_t)y1};
-    lcd_write_data_multi(row_data, 4);
+// Opens a window and leaves the panel selected in data mode for pixel streaming.
+// Pixels fill the window row by row; finish with lcd_end_pixels(). CASET and
+// RASET go out only when they change; RAMWR always does, as it rewinds the
+// write position to the window start.
+static void lcd_begin_pixels(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    lcd_select();
+    lcd_set_range(LCD_CMD_CASET, &win_x0, &win_x1, x0, x1);
+    lcd_set_range(LCD_CMD_RASET, &win_y0, &win_y1, y0, y1);
+    lcd_command(LCD_CMD_RAMWR, NULL, 0);
+}
 
-    // Send Memory Write command (e.g., 0x2C) to prepare for pixel data
-    lcd_write_command(0x2C); // Example command
+static inline void lcd_end_pixels(void) {
+    lcd_deselect();
 }
 
 // --- Public API Implementation ---
@@ -83,7 +102,8 @@ void display_init(void) {
     hal_gpio_init(LCD_CS_PIN, GPIO_MODE_OUTPUT_PP);
     hal_gpio_init(LCD_DC_PIN, GPIO_MODE_OUTPUT_PP);
     hal_gpio_init(LCD_RST_PIN, GPIO_MODE_OUTPUT_PP);
-    hal_gpio_write(LCD_CS_PIN, true); // Deselect initially
+    LCD_CTRL_DDR |= (uint8_t)((1 << LCD_CS_PIN) | (1 << LCD_DC_PIN)); // Driven directly from here on
+    lcd_deselect(); // Deselect initially
 
     // Initialize SPI peripheral
     hal_spi_init(LCD_SPI_ID, LCD_SPI_CLOCK_SPEED, LCD_SPI_MODE, 0); // MSB first
@@ -96,13 +116,14 @@ void display_init(void) {
 
     // Send LCD initialization commands (specific to the LCD controller chip)
     log_info("LCD Driver: Sending initialization sequence...");
-    lcd_write_command(0x01); // Example: Software Reset
+    static const uint8_t pixel_format = 0x55; // 16-bit/pixel (RGB565)
+    lcd_invalidate_window();
+    lcd_write_command(0x01, NULL, 0); // Example: Software Reset
     _delay_ms(150);
-    lcd_write_command(0x11); // Example: Sleep Out
+    lcd_write_command(0x11, NULL, 0); // Example: Sleep Out
     _delay_ms(255);
-    lcd_write_command(0x3A); // Example: Pixel Format Set
-    lcd_write_data(0x55);    // 16-bit/pixel (RGB565)
-    lcd_write_command(0x29); // Example: Display ON
+    lcd_write_command(0x3A, &pixel_format, 1); // Example: Pixel Format Set
+    lcd_write_command(0x29, NULL, 0); // Example: Display ON
     _delay_ms(100);
 
     // Set default colors and clear screen
@@ -114,21 +135,11 @@ void display_init(void) {
 }
 
 void display_clear(display_color_t color) {
+    PERF_SCOPE(DISP_CLEAR);
     log_debug("LCD: Clearing screen to 0x%04X", color);
-    lcd_set_window(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
-
-    // Prepare color bytes (assuming RGB565)
-    uint8_t hi = color >> 8;
-    uint8_t lo = color & 0xFF;
-
-    hal_gpio_write(LCD_DC_PIN, true); // Data mode
-    lcd_select();
-    // Write color data repeatedly for all pixels
-    for (uint32_t i = 0; i < (uint32_t)LCD_WIDTH * LCD_HEIGHT; ++i) {
-        hal_spi_transfer_byte(LCD_SPI_ID, hi);
-        hal_spi_transfer_byte(LCD_SPI_ID, lo);
-    }
-    lcd_deselect();
+    lcd_begin_pixels(0, 0, LCD_WIDTH - 1, LCD_HEIGHT - 1);
+    hal_spi_write_repeat16(LCD_SPI_ID, color, (uint32_t)LCD_WIDTH * LCD_HEIGHT); // RGB565, MSB first
+    lcd_end_pixels();
 }
 
 void display_set_foreground_color(display_color_t color) {
@@ -140,30 +151,156 @@ void display_set_background_color(display_color_t color) {
 }
 
 void display_draw_pixel(int16_t x, int16_t y, display_color_t color) {
+    PERF_SCOPE(DISP_PIXEL);
     if (x < 0 || x >= LCD_WIDTH || y < 0 || y >= LCD_HEIGHT) return; // Bounds check
     log_debug("LCD: Draw Pixel (%d, %d) Color=0x%04X", x, y, color);
-    lcd_set_window(x, y, x, y);
-    lcd_write_color(color);
+    lcd_begin_pixels(x, y, x, y);
+    hal_spi_stream_start((uint8_t)(color >> 8));
+    hal_spi_stream_put((uint8_t)color);
+    hal_spi_stream_finish();
+    lcd_end_pixels();
+}
+
+// --- Span Helpers ---
+// Every primitive clips once up front: either the whole shape is on screen and
+// its spans go out unchecked, or each span is clipped before its window opens.
+
+// Writes a solid w x h block as one window burst. No clipping.
+static void lcd_span(int16_t x, int16_t y, int16_t w, int16_t h, display_color_t color) {
+    lcd_begin_pixels(x, y, x + w - 1, y + h - 1);
+    hal_spi_write_repeat16(LCD_SPI_ID, color, (uint32_t)w * h);
+    lcd_end_pixels();
+}
+
+static void lcd_span_clipped(int16_t x, int16_t y, int16_t w, int16_t h, display_color_t color, bool clip) {
+    if (!clip) {
+        lcd_span(x, y, w, h, color);
+        return;
+    }
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > LCD_WIDTH) w = LCD_WIDTH - x;
+    if (y + h > LCD_HEIGHT) h = LCD_HEIGHT - y;
+    if (w > 0 && h > 0) {
+        lcd_span(x, y, w, h, color);
+    }
+}
+
+// Classifies a box against the screen: false if it is entirely off screen,
+// otherwise *clip tells whether its spans need clipping.
+static bool lcd_box_visible(int16_t x0, int16_t y0, int16_t x1, int16_t y1, bool *clip) {
+    if (x1 < 0 || y1 < 0 || x0 >= LCD_WIDTH || y0 >= LCD_HEIGHT) return false;
+    *clip = x0 < 0 || y0 < 0 || x1 >= LCD_WIDTH || y1 >= LCD_HEIGHT;
+    return true;
+}
+
+#define OUT_LEFT   0x1
+#define OUT_RIGHT  0x2
+#define OUT_TOP    0x4
+#define OUT_BOTTOM 0x8
+
+static uint8_t lcd_outcode(int16_t x, int16_t y) {
+    uint8_t code = 0;
+    if (x < 0) code |= OUT_LEFT;
+    else if (x >= LCD_WIDTH) code |= OUT_RIGHT;
+    if (y < 0) code |= OUT_TOP;
+    else if (y >= LCD_HEIGHT) code |= OUT_BOTTOM;
+    return code;
+}
+
+// Cohen-Sutherland: trims a line to the screen. Returns false if nothing is visible.
+static bool lcd_clip_line(int16_t *x0, int16_t *y0, int16_t *x1, int16_t *y1) {
+    uint8_t code0 = lcd_outcode(*x0, *y0);
+    uint8_t code1 = lcd_outcode(*x1, *y1);
+    while (code0 | code1) {
+        if (code0 & code1) return false; // Both ends beyond the same edge
+        uint8_t code = code0 ? code0 : code1;
+        int32_t dx = (int32_t)*x1 - *x0;
+        int32_t dy = (int32_t)*y1 - *y0;
+        int32_t x, y;
+        if (code & OUT_BOTTOM) {
+            y = LCD_HEIGHT - 1;
+            x = *x0 + dx * (y - *y0) / dy;
+        } else if (code & OUT_TOP) {
+            y = 0;
+            x = *x0 + dx * (y - *y0) / dy;
+        } else if (code & OUT_RIGHT) {
+            x = LCD_WIDTH - 1;
+            y = *y0 + dy * (x - *x0) / dx;
+        } else {
+            x = 0;
+            y = *y0 + dy * (x - *x0) / dx;
+        }
+        if (code == code0) {
+            *x0 = (int16_t)x; *y0 = (int16_t)y;
+            code0 = lcd_outcode(*x0, *y0);
+        } else {
+            *x1 = (int16_t)x; *y1 = (int16_t)y;
+            code1 = lcd_outcode(*x1, *y1);
+        }
+    }
+    return true;
 }
 
 void display_draw_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, display_color_t color) {
-    // Basic line drawing algorithm (e.g., Bresenham's) would be implemented here.
-    // For placeholder, just draw start/end pixels.
+    PERF_SCOPE(DISP_LINE);
     log_debug("LCD: Draw Line (%d,%d) to (%d,%d)", x0, y0, x1, y1);
-    display_draw_pixel(x0, y0, color);
-    display_draw_pixel(x1, y1, color);
+    if (!lcd_clip_line(&x0, &y0, &x1, &y1)) return;
+
+    // Bresenham. Pixels that share the minor coordinate form a run, and each
+    // run goes out as one span: a horizontal or vertical line is one burst.
+    int16_t dx = (x1 > x0) ? x1 - x0 : x0 - x1;
+    int16_t dy = (y1 > y0) ? y0 - y1 : y1 - y0; // Negative
+    int8_t sx = (x0 < x1) ? 1 : -1;
+    int8_t sy = (y0 < y1) ? 1 : -1;
+    int16_t err = dx + dy;
+    bool x_major = dx >= -dy;
+    int16_t run_x = x0, run_y = y0; // First pixel of the current run
+
+    while (1) {
+        bool last = (x0 == x1 && y0 == y1);
+        bool step_x = false, step_y = false;
+        if (!last) {
+            int16_t e2 = 2 * err; // Coordinates are on screen, so this cannot overflow
+            if (e2 >= dy) { err += dy; step_x = true; }
+            if (e2 <= dx) { err += dx; step_y = true; }
+        }
+        if (last || (x_major ? step_y : step_x)) {
+            if (x_major) {
+                lcd_span((run_x < x0) ? run_x : x0, y0, ((x0 > run_x) ? x0 - run_x : run_x - x0) + 1, 1, color);
+            } else {
+                lcd_span(x0, (run_y < y0) ? run_y : y0, 1, ((y0 > run_y) ? y0 - run_y : run_y - y0) + 1, color);
+            }
+            if (last) break;
+            run_x = step_x ? x0 + sx : x0;
+            run_y = step_y ? y0 + sy : y0;
+        }
+        if (step_x) x0 += sx;
+        if (step_y) y0 += sy;
+    }
 }
 
 void display_draw_rect(int16_t x, int16_t y, int16_t w, int16_t h, display_color_t color) {
-    // Draw the four lines of the rectangle.
+    PERF_SCOPE(DISP_RECT);
     log_debug("LCD: Draw Rect (%d,%d) W=%d H=%d", x, y, w, h);
-    // display_draw_line(x, y, x + w - 1, y, color);
-    // display_draw_line(x, y + h - 1, x + w - 1, y + h - 1, color);
-    // display_draw_line(x, y, x, y + h - 1, color);
-    // display_draw_line(x + w - 1, y, x + w - 1, y + h - 1, color);
+    bool clip;
+    if (w <= 0 || h <= 0 || !lcd_box_visible(x, y, x + w - 1, y + h - 1, &clip)) return;
+
+    // Four spans: top and bottom full width, the sides between them
+    lcd_span_clipped(x, y, w, 1, color, clip);
+    if (h > 1) {
+        lcd_span_clipped(x, y + h - 1, w, 1, color, clip);
+    }
+    if (h > 2) {
+        lcd_span_clipped(x, y + 1, 1, h - 2, color, clip);
+        if (w > 1) {
+            lcd_span_clipped(x + w - 1, y + 1, 1, h - 2, color, clip);
+        }
+    }
 }
 
 void display_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, display_color_t color) {
+    PERF_SCOPE(DISP_FILL_RECT);
     if (x >= LCD_WIDTH || y >= LCD_HEIGHT || w <= 0 || h <= 0) return;
     // Clip coordinates
     if (x < 0) { w += x; x = 0; }
@@ -173,76 +310,474 @@ void display_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, display_color
     if (w <= 0 || h <= 0) return;
 
     log_debug("LCD: Fill Rect (%d,%d) W=%d H=%d Color=0x%04X", x, y, w, h, color);
-    lcd_set_window(x, y, x + w - 1, y + h - 1);
+    lcd_span(x, y, w, h, color);
+}
 
-    uint8_t hi = color >> 8;
-    uint8_t lo = color & 0xFF;
-    uint32_t num_pixels = (uint32_t)w * h;
+// A pair of spans mirrored about the center: offsets a..b on both sides.
+// With a == 0 the two halves meet, so one span covers both.
+static void mirrored_hspan(int16_t cx, int16_t y, int16_t a, int16_t b, display_color_t color, bool clip) {
+    if (a == 0) {
+        lcd_span_clipped(cx - b, y, 2 * b + 1, 1, color, clip);
+    } else {
+        lcd_span_clipped(cx - b, y, b - a + 1, 1, color, clip);
+        lcd_span_clipped(cx + a, y, b - a + 1, 1, color, clip);
+    }
+}
 
-    hal_gpio_write(LCD_DC_PIN, true); // Data mode
-    lcd_select();
-    for (uint32_t i = 0; i < num_pixels; ++i) {
-        hal_spi_transfer_byte(LCD_SPI_ID, hi);
-        hal_spi_transfer_byte(LCD_SPI_ID, lo);
+static void mirrored_vspan(int16_t x, int16_t cy, int16_t a, int16_t b, display_color_t color, bool clip) {
+    if (a == 0) {
+        lcd_span_clipped(x, cy - b, 1, 2 * b + 1, color, clip);
+    } else {
+        lcd_span_clipped(x, cy - b, 1, b - a + 1, color, clip);
+        lcd_span_clipped(x, cy + a, 1, b - a + 1, color, clip);
     }
-    lcd_deselect();
 }
 
 void display_draw_circle(int16_t x0, int16_t y0, int16_t r, display_color_t color) {
-    // Circle drawing algorithm (e.g., Midpoint circle algorithm) implementation.
+    PERF_SCOPE(DISP_CIRCLE);
     log_debug("LCD: Draw Circle (%d,%d) R=%d", x0, y0, r);
+    bool clip;
+    if (r < 0 || !lcd_box_visible(x0 - r, y0 - r, x0 + r, y0 + r, &clip)) return;
+
+    // Midpoint circle over one octant (x = 0..y). Steps where y stays the same
+    // form a run: horizontal spans at rows y0 +/- y and, mirrored across the
+    // diagonal, vertical spans at columns x0 +/- y.
+    int16_t x = 0, y = r;
+    int16_t d = 1 - r;
+    int16_t run_start = 0;
+    while (x <= y) {
+        bool y_steps = (d >= 0);
+        if (y_steps || x + 1 > y) { // Run ends: y changes next, or the octant is done
+            mirrored_hspan(x0, y0 - y, run_start, x, color, clip);
+            if (y > 0) mirrored_hspan(x0, y0 + y, run_start, x, color, clip);
+            int16_t v_end = (x == y) ? x - 1 : x; // The diagonal pixel is already in the row span
+            if (v_end >= run_start) {
+                mirrored_vspan(x0 - y, y0, run_start, v_end, color, clip);
+                if (y > 0) mirrored_vspan(x0 + y, y0, run_start, v_end, color, clip);
+            }
+            run_start = x + 1;
+        }
+        if (y_steps) {
+            d += 2 * (x - y) + 5;
+            y--;
+        } else {
+            d += 2 * x + 3;
+        }
+        x++;
+    }
 }
 
 void display_fill_circle(int16_t x0, int16_t y0, int16_t r, display_color_t color) {
-    // Filled circle algorithm implementation.
+    PERF_SCOPE(DISP_FILL_CIRC);
     log_debug("LCD: Fill Circle (%d,%d) R=%d", x0, y0, r);
+    bool clip;
+    if (r < 0 || !lcd_box_visible(x0 - r, y0 - r, x0 + r, y0 + r, &clip)) return;
+
+    // Midpoint circle drawn as horizontal spans, each row exactly once:
+    // rows y0 +/- x (half-width y) on every step, and rows y0 +/- y
+    // (half-width x) once per run, before y moves past them.
+    int16_t x = 0, y = r;
+    int16_t d = 1 - r;
+    while (x <= y) {
+        mirrored_hspan(x0, y0 - x, 0, y, color, clip);
+        if (x > 0) mirrored_hspan(x0, y0 + x, 0, y, color, clip);
+
+        bool y_steps = (d >= 0);
+        if (y_steps && y > x) { // Row y0 +/- y is final and not covered by the x rows
+            mirrored_hspan(x0, y0 - y, 0, x, color, clip);
+            mirrored_hspan(x0, y0 + y, 0, x, color, clip);
+        }
+        if (y_steps) {
+            d += 2 * (x - y) + 5;
+            y--;
+        } else {
+            d += 2 * x + 3;
+        }
+        x++;
+    }
 }
 
 void display_set_font(const display_font_t *font) {
-    // Store the pointer to the font definition.
-    // current_font = font;
+    current_font = font ? font : &display_font_small;
     log_debug("LCD: Set Font");
 }
 
+// Unknown characters render as the first glyph (a space in the built-in font).
+static uint8_t glyph_index(const display_font_t *font, char c) {
+    return (c < font->first || c > font->last) ? 0 : (uint8_t)(c - font->first);
+}
+
+// Advance of a glyph in font pixels: its width plus the spacing after it.
+static uint8_t glyph_advance(const display_font_t *font, uint8_t index) {
+    return pgm_read_byte(&font->widths[index]) + font->spacing;
+}
+
+int16_t display_text_width(const char *str, uint8_t len) {
+    int16_t width = 0;
+    for (uint8_t i = 0; i < len; ++i) {
+        width += glyph_advance(current_font, glyph_index(current_font, str[i]));
+    }
+    return width * current_font->scale;
+}
+
+int16_t display_draw_text_run(int16_t x, int16_t y, const char *str, uint8_t len) {
+    PERF_SCOPE(DISP_TEXT);
+    const display_font_t *font = current_font;
+    int16_t height = font->height * font->scale;
+    if (x < 0 || y < 0 || y + height > LCD_HEIGHT || !str) return 0;
+
+    // Keep only the glyphs that fit before the right edge
+    int16_t width = 0;
+    uint8_t count = 0;
+    while (count < len) {
+        int16_t advance = glyph_advance(font, glyph_index(font, str[count])) * font->scale;
+        if (x + width + advance > LCD_WIDTH) break;
+        width += advance;
+        count++;
+    }
+    if (count == 0) return 0;
+
+    log_debug("LCD: Text Run %u chars at (%d,%d)", count, x, y);
+    lcd_begin_pixels(x, y, x + width - 1, y + height - 1);
+
+    uint8_t fg_hi = current_fg_color >> 8, fg_lo = current_fg_color & 0xFF;
+    uint8_t bg_hi = current_bg_color >> 8, bg_lo = current_bg_color & 0xFF;
+
+    // The window is filled row by row, so each row crosses every glyph of the run.
+    // Glyph bits for the next pixel are decoded while the current byte shifts out.
+    bool started = false;
+    for (uint8_t row = 0; row < font->height; ++row) {
+        for (uint8_t rep = 0; rep < font->scale; ++rep) { // Each font row is drawn `scale` times
+            for (uint8_t i = 0; i < count; ++i) {
+                uint8_t index = glyph_index(font, str[i]);
+                uint8_t bits = pgm_read_byte(&font->glyphs[(uint16_t)index * font->height + row]);
+                uint8_t columns = glyph_advance(font, index); // Bits past the glyph width are clear
+                for (uint8_t col = 0; col < columns; ++col) {
+                    bool on = bits & (0x80 >> col);
+                    for (uint8_t sx = 0; sx < font->scale; ++sx) {
+                        if (started) {
+                            hal_spi_stream_put(on ? fg_hi : bg_hi);
+                        } else {
+                            hal_spi_stream_start(on ? fg_hi : bg_hi);
+                            started = true;
+                        }
+                        hal_spi_stream_put(on ? fg_lo : bg_lo);
+                    }
+                }
+            }
+        }
+    }
+    hal_spi_stream_finish();
+    lcd_end_pixels();
+    return width;
+}
+
 void display_draw_char(int16_t x, int16_t y, char c) {
-    // Render character using the current font data and colors.
-    log_debug("LCD: Draw Char '%c' at (%d,%d)", c, x, y);
-    // Requires font data and rendering logic.
-    // Example: Draw a placeholder rectangle for the char
-    // display_fill_rect(x, y, 6, 8, current_fg_color); // Assuming 6x8 font
+    display_draw_text_run(x, y, &c, 1);
 }
 
 void display_draw_string(int16_t x, int16_t y, const char *str) {
     log_debug("LCD: Draw String \"%s\" at (%d,%d)", str, x, y);
-    int16_t current_x = x;
-    while (*str) {
-        display_draw_char(current_x, y, *str++);
-        current_x += 6; // Advance X by font width (assuming 6px wide)
-        // Add checks for line wrapping if needed
-        if (current_x >= LCD_WIDTH) break;
-    }
+    size_t len = strlen(str);
+    display_draw_text_run(x, y, str, (len > UINT8_MAX) ? UINT8_MAX : (uint8_t)len); // Clipped at the right edge
 }
 
 void display_draw_bitmap(int16_t x, int16_t y, int16_t w, int16_t h, const display_color_t *bitmap) {
+    PERF_SCOPE(DISP_BITMAP);
     if (x >= LCD_WIDTH || y >= LCD_HEIGHT || w <= 0 || h <= 0 || !bitmap) return;
-    // Clip coordinates
-    // ... (clipping logic similar to fill_rect) ...
+    // Clip coordinates; the source keeps its full stride
+    int16_t stride = w;
+    int16_t src_x = 0, src_y = 0;
+    if (x < 0) { src_x = -x; w += x; x = 0; }
+    if (y < 0) { src_y = -y; h += y; y = 0; }
+    if (x + w > LCD_WIDTH) w = LCD_WIDTH - x;
+    if (y + h > LCD_HEIGHT) h = LCD_HEIGHT - y;
+    if (w <= 0 || h <= 0) return;
 
     log_debug("LCD: Draw Bitmap (%d,%d) W=%d H=%d", x, y, w, h);
-    lcd_set_window(x, y, x + w - 1, y + h - 1);
+    lcd_begin_pixels(x, y, x + w - 1, y + h - 1);
+
+    // Stream line by line in panel byte order (RGB565, MSB first); the next
+    // pixel is fetched from the line while the current byte shifts out.
+    const display_color_t *line = bitmap + (uint32_t)src_y * stride + src_x;
+    hal_spi_stream_start((uint8_t)(line[0] >> 8));
+    hal_spi_stream_put((uint8_t)line[0]);
+    int16_t col = 1;
+    for (int16_t row = 0; row < h; ++row, line += stride, col = 0) {
+        for (; col < w; ++col) {
+            display_color_t c = line[col];
+            hal_spi_stream_put((uint8_t)(c >> 8));
+            hal_spi_stream_put((uint8_t)c);
+        }
+    }
+    hal_spi_stream_finish();
+    lcd_end_pixels();
+}
+
+// First run byte of the next icon row.
+static const uint8_t *icon_row_end(const uint8_t *rle, uint8_t w) {
+    for (uint8_t covered = 0; covered < w; ++rle) {
+        covered += (pgm_read_byte(rle) & 0x3F) + 1;
+    }
+    return rle;
+}
 
-    uint32_t num_pixels = (uint32_t)w * h;
-    const uint8_t *bitmap_bytes = (const uint8_t*)bitmap;
+void display_draw_icon(int16_t x, int16_t y, uint8_t w, uint8_t h, const uint8_t *rle,
+                       const display_color_t palette[DISPLAY_ICON_PALETTE_SIZE], bool mirror) {
+    PERF_SCOPE(DISP_ICON);
+    if (x < 0 || y < 0 || x + w > LCD_WIDTH || y + h > LCD_HEIGHT || w == 0 || h == 0 || !rle) return;
+
+    log_debug("LCD: Draw Icon (%d,%d) W=%u H=%u", x, y, w, h);
+    lcd_begin_pixels(x, y, x + w - 1, y + h - 1);
+
+    // Each row's runs are found first, then replayed forwards or backwards.
+    // A run is read from flash once; its pixels are the same two bytes repeated.
+    bool started = false;
+    for (uint8_t row = 0; row < h; ++row) {
+        const uint8_t *end = icon_row_end(rle, w);
+        uint8_t runs = (uint8_t)(end - rle);
+        for (uint8_t i = 0; i < runs; ++i) {
+            uint8_t code = pgm_read_byte(mirror ? end - 1 - i : rle + i);
+            display_color_t c = palette[code >> 6];
+            uint8_t hi = c >> 8, lo = c & 0xFF;
+            for (uint8_t n = (code & 0x3F) + 1; n > 0; --n) {
+                if (started) {
+                    hal_spi_stream_put(hi);
+                } else {
+                    hal_spi_stream_start(hi);
+                    started = true;
+                }
+                hal_spi_stream_put(lo);
+            }
+        }
+        rle = end;
+    }
+    hal_spi_stream_finish();
+    lcd_end_pixels();
+}
 
-    hal_gpio_write(LCD_DC_PIN, true); // Data mode
-    lcd_select();
-    // Send bitmap data (2 bytes per pixel for RGB565)
-    hal_spi_write_multi(LCD_SPI_ID, bitmap_bytes, num_pixels * 2);
-    lcd_deselect();
+#if ENABLE_DISPLAY_COMPOSITOR
+
+// --- Display List Compositor ---
+// Items are composited one scanline at a time into line_buf, in list order
+// (later items on top), and each finished row is streamed into one window
+// covering the whole region, so every pixel goes out exactly once.
+
+typedef enum {
+    LIST_ITEM_RECT,
+    LIST_ITEM_TEXT,
+    LIST_ITEM_ICON
+} list_item_kind_t;
+
+typedef struct {
+    int16_t x, y;
+    uint8_t w, h;
+    uint8_t kind;  // list_item_kind_t
+    uint8_t flags; // DISPLAY_LIST_* flags
+    union {
+        struct {
+            display_color_t color;
+        } rect;
+        struct {
+            const char *str;
+            const display_font_t *font;
+            display_color_t fg, bg;
+            uint8_t len;
+        } text;
+        struct {
+            const uint8_t *rle;             // Start of row `row`; advances as rows are composited
+            const display_color_t *palette;
+            uint8_t row;
+        } icon;
+    };
+} list_item_t;
+
+static list_item_t list_items[DISPLAY_LIST_MAX_ITEMS];
+static uint8_t list_count = 0;
+static int16_t list_x = 0, list_y = 0, list_w = 0, list_h = 0;
+static display_color_t list_bg = COLOR_BLACK;
+static display_color_t line_buf[LCD_WIDTH]; // One scanline: 256 bytes
+
+// Claims the next list slot for an item with the given box, or NULL if the
+// list is full. Items outside the region still take a slot but are skipped.
+static list_item_t *list_add(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t kind, uint8_t flags) {
+    if (list_count == DISPLAY_LIST_MAX_ITEMS) {
+        log_warn("LCD: Display list full");
+        return NULL;
+    }
+    list_item_t *item = &list_items[list_count++];
+    item->x = x;
+    item->y = y;
+    item->w = (w <= 0) ? 0 : (w > LCD_WIDTH) ? LCD_WIDTH : (uint8_t)w;
+    item->h = (h <= 0) ? 0 : (h > LCD_HEIGHT) ? LCD_HEIGHT : (uint8_t)h;
+    item->kind = kind;
+    item->flags = flags;
+    return item;
+}
+
+// Sets n pixels of the scanline starting at screen column x, clipped to the region.
+static void line_fill(int16_t x, int16_t n, display_color_t color) {
+    int16_t x0 = x - list_x;
+    int16_t x1 = x0 + n;
+    if (x0 < 0) x0 = 0;
+    if (x1 > list_w) x1 = list_w;
+    while (x0 < x1) {
+        line_buf[x0++] = color;
+    }
+}
+
+static void compose_text(const list_item_t *item, int16_t line) {
+    const display_font_t *font = item->text.font;
+    uint8_t row = (uint8_t)((line - item->y) / font->scale);
+    bool opaque = !(item->flags & DISPLAY_LIST_TRANSPARENT);
+    int16_t x = item->x;
+    for (uint8_t i = 0; i < item->text.len; ++i) {
+        uint8_t index = glyph_index(font, item->text.str[i]);
+        uint8_t bits = pgm_read_byte(&font->glyphs[(uint16_t)index * font->height + row]);
+        uint8_t columns = glyph_advance(font, index);
+        for (uint8_t col = 0; col < columns; ++col, x += font->scale) {
+            bool on = bits & (0x80 >> col);
+            if (on || opaque) {
+                line_fill(x, font->scale, on ? item->text.fg : item->text.bg);
+            }
+        }
+    }
+}
+
+static void compose_icon(list_item_t *item, int16_t line) {
+    uint8_t row = (uint8_t)(line - item->y);
+    while (item->icon.row < row) { // Rows above the region are skipped once
+        item->icon.rle = icon_row_end(item->icon.rle, item->w);
+        item->icon.row++;
+    }
+    const uint8_t *rle = item->icon.rle;
+    const uint8_t *end = icon_row_end(rle, item->w);
+    bool mirror = item->flags & DISPLAY_LIST_MIRROR;
+    bool skip_zero = item->flags & DISPLAY_LIST_TRANSPARENT;
+    int16_t x = item->x;
+    uint8_t runs = (uint8_t)(end - rle);
+    for (uint8_t i = 0; i < runs; ++i) {
+        uint8_t code = pgm_read_byte(mirror ? end - 1 - i : rle + i);
+        uint8_t n = (code & 0x3F) + 1;
+        if ((code >> 6) != 0 || !skip_zero) {
+            line_fill(x, n, item->icon.palette[code >> 6]);
+        }
+        x += n;
+    }
+    item->icon.rle = end;
+    item->icon.row++;
+}
+
+void display_list_begin(int16_t x, int16_t y, int16_t w, int16_t h, display_color_t background) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > LCD_WIDTH) w = LCD_WIDTH - x;
+    if (y + h > LCD_HEIGHT) h = LCD_HEIGHT - y;
+    list_x = x;
+    list_y = y;
+    list_w = (w > 0) ? w : 0;
+    list_h = (h > 0) ? h : 0;
+    list_bg = background;
+    list_count = 0;
+}
+
+bool display_list_add_rect(int16_t x, int16_t y, int16_t w, int16_t h, display_color_t color) {
+    list_item_t *item = list_add(x, y, w, h, LIST_ITEM_RECT, 0);
+    if (!item) return false;
+    item->rect.color = color;
+    return true;
+}
+
+bool display_list_add_text(int16_t x, int16_t y, const char *str, uint8_t len, uint8_t flags) {
+    if (!str) return false;
+    list_item_t *item = list_add(x, y, display_text_width(str, len),
+                                 current_font->height * current_font->scale, LIST_ITEM_TEXT, flags);
+    if (!item) return false;
+    item->text.str = str;
+    item->text.font = current_font;
+    item->text.fg = current_fg_color;
+    item->text.bg = current_bg_color;
+    item->text.len = len;
+    return true;
+}
+
+bool display_list_add_icon(int16_t x, int16_t y, uint8_t w, uint8_t h, const uint8_t *rle,
+                           const display_color_t palette[DISPLAY_ICON_PALETTE_SIZE], uint8_t flags) {
+    if (!rle || !palette) return false;
+    list_item_t *item = list_add(x, y, w, h, LIST_ITEM_ICON, flags);
+    if (!item) return false;
+    item->icon.rle = rle;
+    item->icon.palette = palette;
+    item->icon.row = 0;
+    return true;
 }
 
 void display_refresh(void) {
-    // If using a framebuffer/backbuffer, copy its contents to the display here.
-    // For direct drawing, this function might not be needed.
+    PERF_SCOPE(DISP_REFRESH);
+    if (list_w == 0 || list_h == 0) {
+        list_count = 0;
+        return;
+    }
+    log_debug("LCD: Composite %u items into (%d,%d) W=%d H=%d", list_count, list_x, list_y, list_w, list_h);
+    lcd_begin_pixels(list_x, list_y, list_x + list_w - 1, list_y + list_h - 1);
+
+    bool started = false;
+    for (int16_t line = list_y; line < list_y + list_h; ++line) {
+        for (int16_t i = 0; i < list_w; ++i) {
+            line_buf[i] = list_bg;
+        }
+        for (uint8_t n = 0; n < list_count; ++n) {
+            list_item_t *item = &list_items[n];
+            if (line < item->y || line >= item->y + item->h) continue;
+            switch (item->kind) {
+                case LIST_ITEM_RECT:
+                    line_fill(item->x, item->w, item->rect.color);
+                    break;
+                case LIST_ITEM_TEXT:
+                    compose_text(item, line);
+                    break;
+                case LIST_ITEM_ICON:
+                    compose_icon(item, line);
+                    break;
+            }
+        }
+
+        // The row goes out while the window is still open, MSB first
+        uint16_t i = 0;
+        if (!started) {
+            hal_spi_stream_start((uint8_t)(line_buf[0] >> 8));
+            hal_spi_stream_put((uint8_t)line_buf[0]);
+            started = true;
+            i = 1;
+        }
+        for (; i < (uint16_t)list_w; ++i) {
+            hal_spi_stream_put((uint8_t)(line_buf[i] >> 8));
+            hal_spi_stream_put((uint8_t)line_buf[i]);
+        }
+    }
+    hal_spi_stream_finish();
+    lcd_end_pixels();
+    list_count = 0;
+    list_w = list_h = 0;
+}
+
+#else
+
+void display_refresh(void) {
+    // Without the compositor everything is drawn directly; nothing is pending.
     log_debug("LCD: Refresh (No-op in direct draw mode)");
 }
+
+#endif // ENABLE_DISPLAY_COMPOSITOR
+
+void display_set_power(bool on) {
+    if (on) {
+        lcd_write_command(0x11, NULL, 0); // Sleep Out
+        _delay_ms(120);                   // Controller needs 120 ms before the next command
+        lcd_write_command(0x29, NULL, 0); // Display ON
+    } else {
+        lcd_write_command(0x28, NULL, 0); // Display OFF
+        lcd_write_command(0x10, NULL, 0); // Sleep In (frame memory and registers retained)
+    }
+    log_info("LCD: Power %s", on ? "on" : "off");
+}
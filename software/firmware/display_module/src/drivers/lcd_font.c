@@ -0,0 +1,236 @@
+/**
+ * @file lcd_font.c
+ * @brief Built-in proportional bitmap font (printable ASCII), stored in flash.
+ * One 5x8 design (7 rows above the baseline, 1 descender row) serves both
+ * sizes: the large font draws every font pixel as a 2x2 block.
+ */
+
+#include "modules/display_driver.h"
+#include <avr/pgmspace.h>
+
+// Glyph rows, 8 per character from ' ' to '~': one byte per row, MSB = leftmost pixel
+static const uint8_t font_glyphs[] PROGMEM = {
+    // ' '
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '!'
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x80, 0x00,
+    // '"'
+    0xA0, 0xA0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '#'
+    0x50, 0x50, 0xF8, 0x50, 0xF8, 0x50, 0x50, 0x00,
+    // '$'
+    0x20, 0x78, 0xA0, 0x70, 0x28, 0xF0, 0x20, 0x00,
+    // '%'
+    0xC0, 0xC8, 0x10, 0x20, 0x40, 0x98, 0x18, 0x00,
+    // '&'
+    0x60, 0x90, 0xA0, 0x40, 0xA8, 0x90, 0x68, 0x00,
+    // '\''
+    0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '('
+    0x20, 0x40, 0x80, 0x80, 0x80, 0x40, 0x20, 0x00,
+    // ')'
+    0x80, 0x40, 0x20, 0x20, 0x20, 0x40, 0x80, 0x00,
+    // '*'
+    0x00, 0x20, 0xA8, 0x70, 0xA8, 0x20, 0x00, 0x00,
+    // '+'
+    0x00, 0x20, 0x20, 0xF8, 0x20, 0x20, 0x00, 0x00,
+    // ','
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x40, 0x80,
+    // '-'
+    0x00, 0x00, 0x00, 0xF0, 0x00, 0x00, 0x00, 0x00,
+    // '.'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00,
+    // '/'
+    0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00, 0x00,
+    // '0'
+    0x70, 0x88, 0x98, 0xA8, 0xC8, 0x88, 0x70, 0x00,
+    // '1'
+    0x20, 0x60, 0x20, 0x20, 0x20, 0x20, 0x70, 0x00,
+    // '2'
+    0x70, 0x88, 0x08, 0x10, 0x20, 0x40, 0xF8, 0x00,
+    // '3'
+    0xF8, 0x10, 0x20, 0x10, 0x08, 0x88, 0x70, 0x00,
+    // '4'
+    0x10, 0x30, 0x50, 0x90, 0xF8, 0x10, 0x10, 0x00,
+    // '5'
+    0xF8, 0x80, 0xF0, 0x08, 0x08, 0x88, 0x70, 0x00,
+    // '6'
+    0x30, 0x40, 0x80, 0xF0, 0x88, 0x88, 0x70, 0x00,
+    // '7'
+    0xF8, 0x08, 0x10, 0x20, 0x40, 0x40, 0x40, 0x00,
+    // '8'
+    0x70, 0x88, 0x88, 0x70, 0x88, 0x88, 0x70, 0x00,
+    // '9'
+    0x70, 0x88, 0x88, 0x78, 0x08, 0x10, 0x60, 0x00,
+    // ':'
+    0x00, 0x00, 0x80, 0x00, 0x00, 0x80, 0x00, 0x00,
+    // ';'
+    0x00, 0x00, 0x40, 0x00, 0x00, 0x40, 0x40, 0x80,
+    // '<'
+    0x10, 0x20, 0x40, 0x80, 0x40, 0x20, 0x10, 0x00,
+    // '='
+    0x00, 0x00, 0xF0, 0x00, 0xF0, 0x00, 0x00, 0x00,
+    // '>'
+    0x80, 0x40, 0x20, 0x10, 0x20, 0x40, 0x80, 0x00,
+    // '?'
+    0x70, 0x88, 0x08, 0x10, 0x20, 0x00, 0x20, 0x00,
+    // '@'
+    0x70, 0x88, 0xB8, 0xA8, 0xB8, 0x80, 0x70, 0x00,
+    // 'A'
+    0x70, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88, 0x00,
+    // 'B'
+    0xF0, 0x88, 0x88, 0xF0, 0x88, 0x88, 0xF0, 0x00,
+    // 'C'
+    0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70, 0x00,
+    // 'D'
+    0xE0, 0x90, 0x88, 0x88, 0x88, 0x90, 0xE0, 0x00,
+    // 'E'
+    0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8, 0x00,
+    // 'F'
+    0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0x80, 0x00,
+    // 'G'
+    0x70, 0x88, 0x80, 0xB8, 0x88, 0x88, 0x78, 0x00,
+    // 'H'
+    0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88, 0x00,
+    // 'I'
+    0xE0, 0x40, 0x40, 0x40, 0x40, 0x40, 0xE0, 0x00,
+    // 'J'
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x90, 0x60, 0x00,
+    // 'K'
+    0x88, 0x90, 0xA0, 0xC0, 0xA0, 0x90, 0x88, 0x00,
+    // 'L'
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xF0, 0x00,
+    // 'M'
+    0x88, 0xD8, 0xA8, 0xA8, 0x88, 0x88, 0x88, 0x00,
+    // 'N'
+    0x88, 0x88, 0xC8, 0xA8, 0x98, 0x88, 0x88, 0x00,
+    // 'O'
+    0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00,
+    // 'P'
+    0xF0, 0x88, 0x88, 0xF0, 0x80, 0x80, 0x80, 0x00,
+    // 'Q'
+    0x70, 0x88, 0x88, 0x88, 0xA8, 0x90, 0x68, 0x00,
+    // 'R'
+    0xF0, 0x88, 0x88, 0xF0, 0xA0, 0x90, 0x88, 0x00,
+    // 'S'
+    0x78, 0x80, 0x80, 0x70, 0x08, 0x08, 0xF0, 0x00,
+    // 'T'
+    0xF8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00,
+    // 'U'
+    0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00,
+    // 'V'
+    0x88, 0x88, 0x88, 0x88, 0x88, 0x50, 0x20, 0x00,
+    // 'W'
+    0x88, 0x88, 0x88, 0xA8, 0xA8, 0xA8, 0x50, 0x00,
+    // 'X'
+    0x88, 0x88, 0x50, 0x20, 0x50, 0x88, 0x88, 0x00,
+    // 'Y'
+    0x88, 0x88, 0x50, 0x20, 0x20, 0x20, 0x20, 0x00,
+    // 'Z'
+    0xF8, 0x08, 0x10, 0x20, 0x40, 0x80, 0xF8, 0x00,
+    // '['
+    0xE0, 0x80, 0x80, 0x80, 0x80, 0x80, 0xE0, 0x00,
+    // '\\'
+    0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00, 0x00,
+    // ']'
+    0xE0, 0x20, 0x20, 0x20, 0x20, 0x20, 0xE0, 0x00,
+    // '^'
+    0x20, 0x50, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // '_'
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8,
+    // '`'
+    0x80, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    // 'a'
+    0x00, 0x00, 0x70, 0x08, 0x78, 0x88, 0x78, 0x00,
+    // 'b'
+    0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0xF0, 0x00,
+    // 'c'
+    0x00, 0x00, 0x70, 0x80, 0x80, 0x80, 0x70, 0x00,
+    // 'd'
+    0x08, 0x08, 0x68, 0x98, 0x88, 0x88, 0x78, 0x00,
+    // 'e'
+    0x00, 0x00, 0x70, 0x88, 0xF8, 0x80, 0x70, 0x00,
+    // 'f'
+    0x30, 0x40, 0xF0, 0x40, 0x40, 0x40, 0x40, 0x00,
+    // 'g'
+    0x00, 0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x70,
+    // 'h'
+    0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0x88, 0x00,
+    // 'i'
+    0x00, 0x80, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00,
+    // 'j'
+    0x00, 0x20, 0x00, 0x20, 0x20, 0x20, 0xA0, 0x40,
+    // 'k'
+    0x80, 0x80, 0x90, 0xA0, 0xC0, 0xA0, 0x90, 0x00,
+    // 'l'
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x40, 0x00,
+    // 'm'
+    0x00, 0x00, 0xD0, 0xA8, 0xA8, 0xA8, 0xA8, 0x00,
+    // 'n'
+    0x00, 0x00, 0xB0, 0xC8, 0x88, 0x88, 0x88, 0x00,
+    // 'o'
+    0x00, 0x00, 0x70, 0x88, 0x88, 0x88, 0x70, 0x00,
+    // 'p'
+    0x00, 0x00, 0xF0, 0x88, 0x88, 0xF0, 0x80, 0x80,
+    // 'q'
+    0x00, 0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x08,
+    // 'r'
+    0x00, 0x00, 0xB0, 0xC0, 0x80, 0x80, 0x80, 0x00,
+    // 's'
+    0x00, 0x00, 0x78, 0x80, 0x70, 0x08, 0xF0, 0x00,
+    // 't'
+    0x40, 0x40, 0xF0, 0x40, 0x40, 0x40, 0x30, 0x00,
+    // 'u'
+    0x00, 0x00, 0x88, 0x88, 0x88, 0x98, 0x68, 0x00,
+    // 'v'
+    0x00, 0x00, 0x88, 0x88, 0x88, 0x50, 0x20, 0x00,
+    // 'w'
+    0x00, 0x00, 0x88, 0x88, 0xA8, 0xA8, 0x50, 0x00,
+    // 'x'
+    0x00, 0x00, 0x88, 0x50, 0x20, 0x50, 0x88, 0x00,
+    // 'y'
+    0x00, 0x00, 0x88, 0x88, 0x88, 0x78, 0x08, 0x70,
+    // 'z'
+    0x00, 0x00, 0xF8, 0x10, 0x20, 0x40, 0xF8, 0x00,
+    // '{'
+    0x20, 0x40, 0x40, 0x80, 0x40, 0x40, 0x20, 0x00,
+    // '|'
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00,
+    // '}'
+    0x80, 0x40, 0x40, 0x20, 0x40, 0x40, 0x80, 0x00,
+    // '~'
+    0x00, 0x00, 0x40, 0xA8, 0x10, 0x00, 0x00, 0x00,
+};
+
+// Glyph widths in font pixels (the advance adds the font's spacing)
+static const uint8_t font_widths[] PROGMEM = {
+    3, 1, 3, 5, 5, 5, 5, 1, 3, 3, 5, 5, 2, 4, 1, 5,  // sp ! " # $ % & ' ( ) * + , - . /
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 1, 2, 4, 4, 4, 5,  // 0 1 2 3 4 5 6 7 8 9 : ; < = > ?
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 4, 5, 4, 5, 5, 5,  // @ A B C D E F G H I J K L M N O
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 3, 5, 3, 5, 5,  // P Q R S T U V W X Y Z [ \ ] ^ _
+    2, 5, 5, 4, 5, 5, 4, 5, 5, 1, 3, 4, 2, 5, 5, 5,  // ` a b c d e f g h i j k l m n o
+    5, 5, 4, 5, 4, 5, 5, 5, 5, 5, 5, 3, 1, 3, 5,  // p q r s t u v w x y z { | } ~
+};
+
+_Static_assert(sizeof(font_glyphs) == ('~' - ' ' + 1) * 8, "Glyph table size");
+_Static_assert(sizeof(font_widths) == '~' - ' ' + 1, "Width table size");
+
+const display_font_t display_font_small = {
+    .glyphs = font_glyphs,
+    .widths = font_widths,
+    .first = ' ',
+    .last = '~',
+    .height = 8,
+    .spacing = 1,
+    .scale = 1,
+};
+
+const display_font_t display_font_large = {
+    .glyphs = font_glyphs,
+    .widths = font_widths,
+    .first = ' ',
+    .last = '~',
+    .height = 8,
+    .spacing = 1,
+    .scale = 2,
+};
@@ -0,0 +1,164 @@
+/**
+ * @file power.c
+ * @brief Power HAL implementation for ATmega328P (Display Module).
+ * Provides IDLE sleep between scheduler tasks, power-down sleep while the
+ * BLE link is idle, and bookkeeping of how much time the CPU actually spends awake.
+ */
+
+#include "hal/power.h"
+#include "hal/timer.h"
+#include "util/logger.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <avr/power.h>
+#include <avr/wdt.h>
+
+// --- Configuration ---
+#define POWER_WDT_PERIOD_MS 8000UL // Watchdog wake interval while the link is idle (WDP3|WDP0)
+
+// --- Internal State ---
+static uint32_t stats_start_ms = 0;
+static uint32_t idle_ms = 0;
+static uint16_t idle_us_remainder = 0; // Sub-millisecond idle time carried between sleeps
+static uint32_t deep_ms = 0;
+static uint32_t idle_wakeups = 0;
+static volatile bool pin_wake = false; // Set by the wake-pin ISRs during power-down
+
+// --- Helper Functions ---
+
+// Watchdog in interrupt-only mode (no reset), used as the deep-sleep wake timer.
+static void wdt_start_interrupt(void) {
+    __asm__ __volatile__("wdr");
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = _BV(WDIE) | _BV(WDP3) | _BV(WDP0); // ~8 s
+}
+
+static void wdt_stop(void) {
+    __asm__ __volatile__("wdr");
+    MCUSR &= (uint8_t)~_BV(WDRF);
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = 0;
+}
+
+// A watchdog reset leaves the watchdog running: stop it before main() (and
+// the LCD power-up delays) so it cannot fire again.
+static void wdt_init(void) __attribute__((naked, used, section(".init3")));
+static void wdt_init(void) {
+    wdt_stop();
+}
+
+// --- Public API Implementation ---
+
+void hal_power_init(void) {
+    // The Display Module uses USART0, SPI, ADC and Timer0 only.
+    power_twi_disable();
+    power_timer1_disable();
+    power_timer2_disable();
+    hal_power_reset_stats();
+    log_info("Power: Unused peripherals off (TWI, Timer1, Timer2)");
+}
+
+void hal_power_idle(void) {
+    uint32_t start_us = hal_timer_micros();
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sei();       // The instruction after SEI always executes, so no wake-up is lost
+    sleep_cpu();
+    sleep_disable();
+
+    // Typically under 1 ms (the tick always wakes us), so avoid a 32-bit division.
+    uint32_t slept_us = hal_timer_micros() - start_us + idle_us_remainder;
+    while (slept_us >= 1000) {
+        slept_us -= 1000;
+        idle_ms++;
+    }
+    idle_us_remainder = (uint16_t)slept_us;
+    idle_wakeups++;
+}
+
+power_wake_t hal_power_deep_sleep(void) {
+    cli();
+    uint8_t saved_pcmsk2 = PCMSK2;
+    uint8_t saved_pcicr = PCICR;
+    pin_wake = false;
+    uint8_t saved_adcsra = ADCSRA;
+    ADCSRA &= (uint8_t)~_BV(ADEN); // Background sampling stops with Timer0 anyway; the enabled ADC still draws current
+
+    // The USART is clocked off in power-down, but a start bit on RXD (PCINT16) still wakes us.
+    PCMSK2 |= _BV(PCINT16);
+    PCIFR = _BV(PCIF2);
+    PCICR |= _BV(PCIE2);
+    wdt_start_interrupt();
+
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+#if defined(BODS)
+    sleep_bod_disable(); // Brown-out detector off while asleep
+#endif
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    cli();
+    wdt_stop();
+    ADCSRA = saved_adcsra;
+    PCMSK2 = saved_pcmsk2;
+    PCICR = saved_pcicr;
+    bool woke_by_pin = pin_wake;
+    if (!woke_by_pin) {
+        // Timer0 was stopped; account for the full watchdog period.
+        hal_timer_advance_ms(POWER_WDT_PERIOD_MS);
+        deep_ms += POWER_WDT_PERIOD_MS;
+    }
+    sei();
+
+    return woke_by_pin ? POWER_WAKE_PIN : POWER_WAKE_WATCHDOG;
+}
+
+void hal_power_get_stats(power_stats_t *stats) {
+    if (!stats) return;
+    stats->total_ms = hal_timer_millis() - stats_start_ms;
+    stats->idle_ms = idle_ms;
+    stats->deep_ms = deep_ms;
+    stats->wakeups = idle_wakeups;
+
+    uint32_t asleep_ms = idle_ms + deep_ms;
+    if (stats->total_ms == 0) {
+        stats->duty_pct = 100;
+    } else if (asleep_ms >= stats->total_ms) {
+        stats->duty_pct = 0;
+    } else {
+        uint32_t awake_ms = stats->total_ms - asleep_ms;
+        uint32_t one_pct = stats->total_ms / 100; // Avoids a 64-bit multiply on long uptimes
+        uint32_t pct = one_pct ? awake_ms / one_pct : (awake_ms * 100) / stats->total_ms;
+        stats->duty_pct = (pct > 100) ? 100 : (uint8_t)pct;
+    }
+}
+
+void hal_power_reset_stats(void) {
+    stats_start_ms = hal_timer_millis();
+    idle_ms = 0;
+    idle_us_remainder = 0;
+    deep_ms = 0;
+    idle_wakeups = 0;
+}
+
+void hal_power_reset(void) {
+    cli();
+    wdt_enable(WDTO_15MS);
+    for (;;) {
+        // Wait for the watchdog
+    }
+}
+
+// --- Interrupt Service Routines (power-down wake sources) ---
+
+ISR(PCINT2_vect) {
+    pin_wake = true;
+}
+
+ISR(WDT_vect) {
+    // Wake only; hal_power_deep_sleep() accounts for the elapsed time.
+}
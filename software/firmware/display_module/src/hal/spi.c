@@ -1,12 +1,35 @@
 /**
  * @file spi.c
  * @brief SPI HAL implementation for ATmega328P (Display Module).
+ * Master mode only. Bulk writes keep the next byte ready while the current
+ * one shifts out, so the bus runs with only a few idle cycles between bytes.
  */
 
 #include "hal/spi.h"
 #include "util/logger.h"
+#include <avr/io.h>
 #include <stddef.h> // For NULL
 
+// Hardware SPI pins on Port B (SS must be an output to stay in master mode)
+#define SPI_SS_BIT   PB2
+#define SPI_MOSI_BIT PB3
+#define SPI_SCK_BIT  PB5
+
+// --- Helper Functions ---
+
+// Selects the fastest prescaler that does not exceed the requested clock.
+// Returns the SPR1:SPR0 bits in the low two bits and SPI2X in bit 2.
+static uint8_t spi_clock_bits(uint32_t clock_speed, uint8_t *divider) {
+    // Prescalers 2, 4, 8, ... 128 with their SPI2X/SPR1/SPR0 encodings
+    static const uint8_t bits[7] = { 0x4, 0x0, 0x5, 0x1, 0x6, 0x2, 0x3 };
+    uint8_t i = 0;
+    while (i < 6 && (F_CPU >> (i + 1)) > clock_speed) {
+        i++;
+    }
+    *divider = (uint8_t)(2U << i);
+    return bits[i];
+}
+
 // --- Public API Implementation ---
 
 void hal_spi_init(spi_id_t spi_id, uint32_t clock_speed, uint8_t mode, uint8_t bit_order) {
@@ -14,36 +37,31 @@ void hal_spi_init(spi_id_t spi_id, uint32_t clock_speed, uint8_t mode, uint8_t b
         log_error("SPI: Invalid ID %d for init", spi_id);
         return;
     }
-    log_info("SPI: Init ID %d, Speed %lu Hz, Mode %d, Order %d", spi_id, clock_speed, mode, bit_order);
-
-    // Configure GPIO pins for MOSI, SCK, SS as outputs. MISO as input.
-    // (Handled by specific driver using the SPI, e.g., LCD driver sets CS)
-    // hal_gpio_init(LCD_MOSI_PIN, GPIO_MODE_OUTPUT_PP);
-    // hal_gpio_init(LCD_SCK_PIN, GPIO_MODE_OUTPUT_PP);
-    // hal_gpio_init(LCD_MISO_PIN, GPIO_MODE_INPUT); // MISO is input
-
-    // Configure SPI hardware registers (SPCR, SPSR).
-    // Set clock rate (SPR0, SPR1, SPI2X bits).
-    // Set SPI mode (CPOL, CPHA bits).
-    // Set bit order (DORD bit).
-    // Enable SPI in master mode (SPE=1, MSTR=1).
-}
 
-uint8_t hal_spi_transfer_byte(spi_id_t spi_id, uint8_t data) {
-    if (spi_id != SPI_ID_0) return 0;
+    // MOSI, SCK and SS as outputs; MISO is forced to input by the SPI block.
+    DDRB |= (1 << SPI_SS_BIT) | (1 << SPI_MOSI_BIT) | (1 << SPI_SCK_BIT);
 
-    // Load data into SPI data register (SPDR).
-    // SPDR = data;
+    uint8_t divider;
+    uint8_t clock_bits = spi_clock_bits(clock_speed, &divider);
+    SPCR = (1 << SPE) | (1 << MSTR) |
+           (bit_order ? (1 << DORD) : 0) |
+           ((mode & 0x2) ? (1 << CPOL) : 0) |
+           ((mode & 0x1) ? (1 << CPHA) : 0) |
+           (clock_bits & 0x3);
+    SPSR = (clock_bits & 0x4) ? (1 << SPI2X) : 0;
 
-    // Wait for transmission complete flag (SPIF in SPSR).
-    // while (!(SPSR & (1 << SPIF)));
+    log_info("SPI: Init ID %d, Speed %lu Hz (F_CPU/%u), Mode %d, Order %d",
+             spi_id, F_CPU / divider, divider, mode, bit_order);
+}
 
-    // Read received data from SPDR.
-    // uint8_t received_data = SPDR;
-    uint8_t received_data = data ^ 0xFF; // Simulate received data
+uint8_t hal_spi_transfer_byte(spi_id_t spi_id, uint8_t data) {
+    if (spi_id != SPI_ID_0) return 0;
 
-    log_debug("SPI: Transfer Byte: Sent=0x%02X, Rcvd=0x%02X", data, received_data);
-    return received_data;
+    SPDR = data;
+    while (!(SPSR & (1 << SPIF))) {
+        // Wait for transmission complete
+    }
+    return SPDR;
 }
 
 void hal_spi_transfer_multi(spi_id_t spi_id, const uint8_t *tx_buffer, uint8_t *rx_buffer, size_t length) {
@@ -59,8 +77,32 @@ void hal_spi_transfer_multi(spi_id_t spi_id, const uint8_t *tx_buffer, uint8_t *
 }
 
 void hal_spi_write_multi(spi_id_t spi_id, const uint8_t *tx_buffer, size_t length) {
-    // Call transfer multi, discarding received data.
-    hal_spi_transfer_multi(spi_id, tx_buffer, NULL, length);
+    if (spi_id != SPI_ID_0 || length == 0) return;
+    if (!tx_buffer) {
+        hal_spi_transfer_multi(spi_id, NULL, NULL, length); // Dummy bytes
+        return;
+    }
+
+    // Received data is discarded, so the next byte can be loaded as soon as SPIF rises.
+    hal_spi_stream_start(*tx_buffer++);
+    while (--length) {
+        hal_spi_stream_put(*tx_buffer++);
+    }
+    hal_spi_stream_finish();
+}
+
+void hal_spi_write_repeat16(spi_id_t spi_id, uint16_t value, uint32_t count) {
+    if (spi_id != SPI_ID_0 || count == 0) return;
+
+    uint8_t hi = (uint8_t)(value >> 8);
+    uint8_t lo = (uint8_t)value;
+    hal_spi_stream_start(hi);
+    hal_spi_stream_put(lo);
+    while (--count) {
+        hal_spi_stream_put(hi);
+        hal_spi_stream_put(lo);
+    }
+    hal_spi_stream_finish();
 }
 
 void hal_spi_read_multi(spi_id_t spi_id, uint8_t *rx_buffer, size_t length) {
@@ -1,23 +1,34 @@
 /**
  * @file uart.c
  * @brief UART HAL implementation for ATmega328P (Display Module).
- * Primarily used for BLE communication. Uses ring buffers.
+ * Primarily used for BLE communication. Uses ring buffers filled and drained
+ * by the USART0 RX-complete and UDRE interrupts, so the main loop never blocks.
+ * The rings are SPSC (one ISR, one main-loop side), so no interrupt locking is needed.
  */
 
 #include "hal/uart.h"
 #include "util/ring_buffer.h"
 #include "util/logger.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h> // For ATOMIC_BLOCK
 #include <stddef.h> // For NULL
+#include <string.h> // For memset
 
 // --- Configuration ---
 // Buffer sizes defined in config.h (BLE_UART_RX_BUFFER_SIZE, etc.)
+_Static_assert(RING_BUFFER_SIZE_VALID(BLE_UART_RX_BUFFER_SIZE) && RING_BUFFER_SIZE_VALID(BLE_UART_TX_BUFFER_SIZE),
+               "UART buffer sizes must be powers of two (2..256)");
 
 // --- Internal Data Structures ---
 static uint8_t hw_uart0_rx_buf_data[BLE_UART_RX_BUFFER_SIZE];
 static ring_buffer_t hw_uart0_rx_rb;
 static uint8_t hw_uart0_tx_buf_data[BLE_UART_TX_BUFFER_SIZE];
 static ring_buffer_t hw_uart0_tx_rb;
-static uart_rx_callback_t hw_uart0_rx_callback = NULL;
+static volatile uart_rx_callback_t hw_uart0_rx_callback = NULL;
+static volatile uart_tx_empty_callback_t hw_uart0_tx_empty_callback = NULL;
+static volatile bool hw_uart0_tx_active = false; // Set while bytes are queued or shifting out
+static volatile uart_stats_t hw_uart0_stats;
 
 // --- Helper Functions ---
 static ring_buffer_t* get_rx_rb(uart_id_t uart_id) {
@@ -30,6 +41,35 @@ static ring_buffer_t* get_tx_rb(uart_id_t uart_id) {
     return NULL;
 }
 
+// Program USART0 for the requested baud rate and frame format (double-speed mode).
+static void hw_uart0_configure(uint32_t baud_rate, uint8_t data_bits, uint8_t stop_bits, uint8_t parity) {
+    uint16_t ubrr = (uint16_t)((F_CPU + 4UL * baud_rate) / (8UL * baud_rate) - 1); // Rounded, U2X0 = 1
+    UBRR0H = (uint8_t)(ubrr >> 8);
+    UBRR0L = (uint8_t)ubrr;
+    UCSR0A = _BV(U2X0);
+
+    uint8_t ucsrc = 0;
+    switch (data_bits) {
+        case 5:  break;
+        case 6:  ucsrc |= _BV(UCSZ00); break;
+        case 7:  ucsrc |= _BV(UCSZ01); break;
+        default: ucsrc |= _BV(UCSZ01) | _BV(UCSZ00); break; // 8 data bits
+    }
+    if (stop_bits == 2) ucsrc |= _BV(USBS0);
+    if (parity == 1) ucsrc |= _BV(UPM01);                     // Even
+    else if (parity == 2) ucsrc |= _BV(UPM01) | _BV(UPM00);   // Odd
+    UCSR0C = ucsrc;
+
+    // RX and TX-complete interrupts always on; UDRE is enabled on demand.
+    UCSR0B = _BV(RXEN0) | _BV(TXEN0) | _BV(RXCIE0) | _BV(TXCIE0);
+}
+
+// Start the UDRE interrupt so queued bytes begin draining.
+static inline void hw_uart0_kick_tx(void) {
+    hw_uart0_tx_active = true;
+    UCSR0B |= _BV(UDRIE0);
+}
+
 // --- Public API Implementation ---
 
 void hal_uart_init(uart_id_t uart_id, uint32_t baud_rate, uint8_t data_bits, uint8_t stop_bits, uint8_t parity) {
@@ -37,30 +77,61 @@ void hal_uart_init(uart_id_t uart_id, uint32_t baud_rate, uint8_t data_bits, uin
         log_error("UART: Invalid ID %d for init", uart_id);
         return;
     }
-    log_info("UART: Init ID %d, Baud %lu", uart_id, baud_rate);
 
-    // Initialize ring buffers
-    ring_buffer_init(&hw_uart0_rx_rb, hw_uart0_rx_buf_data, BLE_UART_RX_BUFFER_SIZE);
-    ring_buffer_init(&hw_uart0_tx_rb, hw_uart0_tx_buf_data, BLE_UART_TX_BUFFER_SIZE);
-    hw_uart0_rx_callback = NULL;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // Initialize ring buffers
+        ring_buffer_init(&hw_uart0_rx_rb, hw_uart0_rx_buf_data, BLE_UART_RX_BUFFER_SIZE);
+        ring_buffer_init(&hw_uart0_tx_rb, hw_uart0_tx_buf_data, BLE_UART_TX_BUFFER_SIZE);
+        hw_uart0_rx_callback = NULL;
+        hw_uart0_tx_empty_callback = NULL;
+        hw_uart0_tx_active = false;
+        memset((void *)&hw_uart0_stats, 0, sizeof(hw_uart0_stats));
 
-    // Configure hardware UART0 registers (UBRR0, UCSR0A/B/C).
-    // Set baud rate, frame format (8N1), enable RX/TX.
+        hw_uart0_configure(baud_rate, data_bits, stop_bits, parity);
+    }
+    log_info("UART: Init ID %d, Baud %lu", uart_id, baud_rate);
 }
 
 void hal_uart_put_char(uart_id_t uart_id, uint8_t data) {
     if (uart_id != UART_ID_0) return;
-    // Blocking write: Wait for UDRE0 flag, then write to UDR0.
-    log_debug("UART: Put Char ID %d: 0x%02X", uart_id, data);
-    // Or, add to TX ring buffer and enable UDRIE0 interrupt.
+
+    if (!(SREG & _BV(SREG_I))) {
+        // Interrupts are off: the UDRE ISR cannot drain the ring, write directly.
+        loop_until_bit_is_set(UCSR0A, UDRE0);
+        UDR0 = data;
+        return;
+    }
+
+    while (!ring_buffer_write(&hw_uart0_tx_rb, data)) {
+        hw_uart0_kick_tx(); // Make sure the ring is draining
+    }
+    hw_uart0_kick_tx();
 }
 
-void hal_uart_write(uart_id_t uart_id, const uint8_t *buffer, size_t length) {
-    if (uart_id != UART_ID_0) return;
-    // Send multiple bytes using hal_uart_put_char or TX ring buffer.
-    for (size_t i = 0; i < length; ++i) {
-        hal_uart_put_char(uart_id, buffer[i]);
+size_t hal_uart_write(uart_id_t uart_id, const uint8_t *buffer, size_t length) {
+    ring_buffer_t *rb = get_tx_rb(uart_id);
+    if (!rb || !buffer || length == 0) return 0;
+
+    rb_size_t queued = ring_buffer_write_multi(rb, buffer, (rb_size_t)length);
+    if (queued > 0) {
+        hw_uart0_kick_tx();
     }
+    return queued;
+}
+
+size_t hal_uart_tx_space(uart_id_t uart_id) {
+    ring_buffer_t *rb = get_tx_rb(uart_id);
+    return rb ? ring_buffer_space_remaining(rb) : 0;
+}
+
+bool hal_uart_tx_idle(uart_id_t uart_id) {
+    if (uart_id != UART_ID_0) return true;
+    return !hw_uart0_tx_active;
+}
+
+void hal_uart_set_tx_empty_callback(uart_id_t uart_id, uart_tx_empty_callback_t callback) {
+    if (uart_id != UART_ID_0) return;
+    hw_uart0_tx_empty_callback = callback;
 }
 
 int16_t hal_uart_get_char(uart_id_t uart_id) {
@@ -70,7 +141,6 @@ int16_t hal_uart_get_char(uart_id_t uart_id) {
     if (rb && ring_buffer_read(rb, &data)) {
         return data;
     }
-    // Optional: Blocking read if buffer empty (check RXC0 flag, read UDR0).
     return -1; // No data available
 }
 
@@ -79,35 +149,41 @@ bool hal_uart_data_available(uart_id_t uart_id) {
     ring_buffer_t* rb = get_rx_rb(uart_id);
     // Check if RX ring buffer is not empty.
     return (rb && !ring_buffer_is_empty(rb));
-    // Or check hardware RXC0 flag if not using buffers.
 }
 
 size_t hal_uart_read(uart_id_t uart_id, uint8_t *buffer, size_t length) {
     if (uart_id != UART_ID_0) return 0;
     ring_buffer_t* rb = get_rx_rb(uart_id);
-    size_t bytes_read = 0;
-    if (rb) {
-        // Read multiple bytes from RX ring buffer.
-        while (bytes_read < length && ring_buffer_read(rb, &buffer[bytes_read])) {
-            bytes_read++;
-        }
+    rb_size_t bytes_read = 0;
+    if (rb && buffer) {
+        bytes_read = ring_buffer_read_multi(rb, buffer, (rb_size_t)length);
     }
     return bytes_read;
 }
 
+size_t hal_uart_rx_span(uart_id_t uart_id, const uint8_t **data) {
+    ring_buffer_t* rb = get_rx_rb(uart_id);
+    if (!rb || !data) return 0;
+    return ring_buffer_read_span(rb, data);
+}
+
+void hal_uart_rx_consume(uart_id_t uart_id, size_t length) {
+    ring_buffer_t* rb = get_rx_rb(uart_id);
+    if (rb) {
+        ring_buffer_read_commit(rb, (rb_size_t)length);
+    }
+}
+
 void hal_uart_enable_rx_interrupt(uart_id_t uart_id, uart_rx_callback_t callback) {
     if (uart_id != UART_ID_0) return;
     log_debug("UART: Enable RX Int ID %d", uart_id);
-    hw_uart0_rx_callback = callback;
-    // Enable hardware RX Complete interrupt (RXCIE0 in UCSR0B).
-    // Ensure global interrupts enabled elsewhere.
+    hw_uart0_rx_callback = callback; // RXCIE0 itself stays enabled
 }
 
 void hal_uart_disable_rx_interrupt(uart_id_t uart_id) {
-     if (uart_id != UART_ID_0) return;
+    if (uart_id != UART_ID_0) return;
     log_debug("UART: Disable RX Int ID %d", uart_id);
     hw_uart0_rx_callback = NULL;
-    // Disable hardware RX Complete interrupt (RXCIE0 in UCSR0B).
 }
 
 void hal_uart_flush_rx_buffer(uart_id_t uart_id) {
@@ -116,8 +192,68 @@ void hal_uart_flush_rx_buffer(uart_id_t uart_id) {
     if (rb) {
         ring_buffer_clear(rb);
     }
-    // May need to read UDR0 hardware register to clear flags.
 }
 
-// ISR(USART_RX_vect) would read UDR0, write to hw_uart0_rx_rb, call callback.
-// ISR(USART_UDRE_vect) would read from hw_uart0_tx_rb, write to UDR0.
+void hal_uart_get_stats(uart_id_t uart_id, uart_stats_t *stats) {
+    if (uart_id != UART_ID_0 || !stats) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stats->overrun_errors = hw_uart0_stats.overrun_errors;
+        stats->framing_errors = hw_uart0_stats.framing_errors;
+        stats->parity_errors = hw_uart0_stats.parity_errors;
+        stats->rx_dropped = hw_uart0_stats.rx_dropped;
+    }
+}
+
+void hal_uart_clear_stats(uart_id_t uart_id) {
+    if (uart_id != UART_ID_0) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        memset((void *)&hw_uart0_stats, 0, sizeof(hw_uart0_stats));
+    }
+}
+
+// --- Interrupt Service Routines (USART0) ---
+
+// RX complete: read status before data (reading UDR0 clears the error flags).
+ISR(USART_RX_vect) {
+    uint8_t status = UCSR0A;
+    uint8_t data = UDR0;
+
+    if (status & _BV(DOR0)) hw_uart0_stats.overrun_errors++;
+    if (status & _BV(FE0)) {
+        hw_uart0_stats.framing_errors++;
+        return; // Corrupt byte, do not deliver
+    }
+    if (status & _BV(UPE0)) {
+        hw_uart0_stats.parity_errors++;
+        return;
+    }
+
+    if (!ring_buffer_write(&hw_uart0_rx_rb, data)) {
+        hw_uart0_stats.rx_dropped++;
+    }
+    uart_rx_callback_t cb = hw_uart0_rx_callback;
+    if (cb) {
+        cb(UART_ID_0, data);
+    }
+}
+
+// Data register empty: feed the next queued byte, or stop when the ring is drained.
+ISR(USART_UDRE_vect) {
+    uint8_t data;
+    if (ring_buffer_read(&hw_uart0_tx_rb, &data)) {
+        UDR0 = data;
+    } else {
+        UCSR0B &= (uint8_t)~_BV(UDRIE0);
+    }
+}
+
+// TX complete: the shift register ran dry at the end of a burst.
+ISR(USART_TX_vect) {
+    if (ring_buffer_is_empty(&hw_uart0_tx_rb)) {
+        hw_uart0_tx_active = false;
+        uart_tx_empty_callback_t cb = hw_uart0_tx_empty_callback;
+        if (cb) {
+            cb(UART_ID_0);
+        }
+    }
+}
@@ -6,34 +6,53 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <util/delay.h>
+#include <avr/interrupt.h> // For sei()
 
 // Include HAL headers
 #include "hal/gpio.h"
 #include "hal/uart.h"
 #include "hal/spi.h"
 // #include "hal/i2c.h" // Include if I2C is used
-// #include "hal/timer.h"
+#include "hal/timer.h"
+#include "hal/power.h"
 
 // Include Module headers/drivers
 #include "modules/display_driver.h"
 #include "modules/ble_rx.h"
 #include "modules/battery_status.h" // Assuming header exists
 #include "modules/screen_updater.h" // Assuming header exists
+#include "modules/ota.h"
+#include "modules/settings.h"
 
 // Include Utilities
 #include "util/logger.h"
 #include "util/ring_buffer.h"
+#include "util/scheduler.h"
+#include "util/perf.h"
+#include "util/persist.h"
 #include "config.h"
 
 // --- Private Function Prototypes ---
 static void hardware_init(void);
 static void modules_init(void);
+static void tasks_init(void);
 static void main_loop(void);
 static void process_ble_input(void);
+static void service_link_ack(void);
 static void update_system_status(void);
+static void check_link_idle(void);
+static void enter_link_idle_sleep(void);
+static void log_power_stats(void);
+static void ble_rx_notify(uart_id_t uart_id, uint8_t data);
+static void follow_settings(void);
 
 // --- Global Variables / State ---
-volatile uint32_t system_ticks_ms = 0; // Assume updated by a timer ISR
+static task_id_t ble_task = SCHEDULER_INVALID_TASK; // Signaled from the UART RX interrupt
+static task_id_t screen_task = SCHEDULER_INVALID_TASK;  // Periods follow the screen_interval_ms and
+static task_id_t battery_task = SCHEDULER_INVALID_TASK; // battery_interval_ms settings
+static uint8_t settings_revision = 0; // Settings revision the task periods were taken from
+static bool link_idle = false; // Set by check_link_idle(), handled by main_loop()
+static uint32_t last_wake_ms = 0; // When link-idle sleep last ended
 
 /**
  * @brief Main function - entry point.
@@ -69,12 +88,17 @@ static void hardware_init(void) {
     // Initialize I2C if needed for external sensors via header
     // hal_i2c_init(EXTERNAL_I2C_ID, I2C_CLOCK_SPEED);
 
-    // Initialize Timers for periodic tasks
-    // hal_timer_init(...);
-    // hal_timer_start(...);
+    // Start the 1 ms system tick used by the scheduler
+    hal_timer_init();
 
-    // Enable global interrupts if needed
-    // sei();
+    // Gate clocks to unused peripherals and start duty-cycle accounting
+    hal_power_init();
+
+    // Free-running Timer1 for section timing (bench builds only, see util/perf.h)
+    perf_init();
+
+    // Enable global interrupts: the UART HAL is interrupt driven
+    sei();
 
     log_debug("Hardware initialization complete.");
 }
@@ -85,6 +109,7 @@ static void hardware_init(void) {
 static void modules_init(void) {
     // Logger first
     logger_init();
+    settings_init(); // Before the modules that read calibration and layout from it
 
     // Initialize drivers and modules
     display_init(); // Initializes LCD hardware (SPI, GPIOs)
@@ -92,52 +117,154 @@ static void modules_init(void) {
     battery_status_init(); // Initializes battery monitoring (GPIO, ADC)
     screen_updater_init(); // Initializes UI state
 
+    tasks_init();
+
     log_debug("Application modules initialization complete.");
 }
 
+/**
+ * @brief Registers the periodic and event-driven work with the scheduler.
+ */
+static void tasks_init(void) {
+    scheduler_init();
+    // BLE input only runs when the RX interrupt has delivered bytes.
+    ble_task = scheduler_add_task("ble_rx", process_ble_input, 0, TASK_PRIORITY_HIGH);
+    // Screen updater checks for data changes and redraws if needed
+    screen_task = scheduler_add_task("screen", screen_updater_update, settings_get()->screen_interval_ms, TASK_PRIORITY_NORMAL);
+    scheduler_add_task("ack", service_link_ack, LINK_ACK_INTERVAL_MS, TASK_PRIORITY_NORMAL);
+    battery_task = scheduler_add_task("battery", update_system_status, settings_get()->battery_interval_ms, TASK_PRIORITY_LOW);
+    settings_revision = settings_get_revision();
+    scheduler_add_task("power", check_link_idle, POWER_CHECK_INTERVAL_MS, TASK_PRIORITY_IDLE);
+    scheduler_add_task("pstats", log_power_stats, POWER_STATS_INTERVAL_MS, TASK_PRIORITY_IDLE);
+
+    hal_uart_enable_rx_interrupt(BLE_UART_ID, ble_rx_notify);
+}
+
 /**
  * @brief Main application loop.
+ * All work runs as scheduler tasks; the loop dispatches whatever is due and
+ * sleeps whenever nothing is.
  */
 static void main_loop(void) {
-    uint32_t last_screen_update_ms = 0;
-    uint32_t last_battery_update_ms = 0;
-
     while (1) {
-        // Update system time (simulation)
-        // system_ticks_ms++;
-        // _delay_ms(1);
-
-        // 1. Process incoming BLE data
-        process_ble_input();
-
-        // 2. Update system status (Battery) periodically
-        uint32_t now = system_ticks_ms; // Use actual timer value
-        if (now - last_battery_update_ms >= 1000) { // Update battery status every second
-            update_system_status();
-            last_battery_update_ms = now;
+        PERF_COUNT(MAIN_LOOP);
+        if (scheduler_run_once()) {
+            continue;
+        }
+        if (logger_service() || perf_report_service()) {
+            continue; // Queued log records and STATS replies go out only when no task is due
         }
 
-        // 3. Update screen content periodically
-        if (now - last_screen_update_ms >= SCREEN_UPDATE_INTERVAL_MS) {
-            screen_updater_update(); // Checks for data changes and redraws if needed
-            last_screen_update_ms = now;
+        if (link_idle) {
+            enter_link_idle_sleep();
+            continue;
         }
 
-        // 4. Low power mode?
-        // sleep_cpu();
+        // Nothing due: IDLE until the next interrupt (1 ms tick or UART RX).
+        cli();
+        if (scheduler_ms_until_next() > 0) {
+            hal_power_idle(); // Returns with interrupts enabled
+        } else {
+            sei();
+        }
     }
 }
 
+// UART RX interrupt hook: wake the BLE input task.
+static void ble_rx_notify(uart_id_t uart_id, uint8_t data) {
+    (void)uart_id;
+    (void)data;
+    scheduler_signal(ble_task);
+}
+
 /**
  * @brief Processes incoming characters from the BLE UART.
  */
 static void process_ble_input(void) {
-    while (hal_uart_data_available(BLE_UART_ID)) {
-        int16_t data = hal_uart_get_char(BLE_UART_ID);
-        if (data != -1) {
-            ble_rx_process_char((uint8_t)data); // Pass character to BLE receiver module
+    const uint8_t *data;
+    size_t len;
+    // Parse straight out of the RX ring; wrapped data arrives as a second span.
+    while ((len = hal_uart_rx_span(BLE_UART_ID, &data)) > 0) {
+        for (size_t i = 0; i < len; ++i) {
+            ble_rx_process_char(data[i]); // Pass character to BLE receiver module
         }
+        hal_uart_rx_consume(BLE_UART_ID, len);
     }
+    ble_rx_service(); // Immediate ACKs for critical frames
+    settings_poll(hal_timer_millis());
+    follow_settings();
+    persist_poll(); // Settings changed over the link go out to EEPROM a byte at a time
+    if (ble_rx_update_requested()) {
+        ota_enter_bootloader(); // Does not return when the bootloader is enabled
+    }
+}
+
+/**
+ * @brief Reschedules the tasks whose period is a setting, once it has changed.
+ */
+static void follow_settings(void) {
+    uint8_t revision = settings_get_revision();
+    if (revision == settings_revision) return;
+    settings_revision = revision;
+    scheduler_set_period(screen_task, settings_get()->screen_interval_ms);
+    scheduler_set_period(battery_task, settings_get()->battery_interval_ms);
+}
+
+/**
+ * @brief Sends the periodic BLE_MSG_LINK_ACK while the Brain Module's frames
+ * arrive, and finishes settings saves once the link goes quiet.
+ */
+static void service_link_ack(void) {
+    ble_rx_service();
+    settings_poll(hal_timer_millis());
+    persist_poll();
+}
+
+/**
+ * @brief Flags link-idle sleep once no frame has arrived for LINK_IDLE_TIMEOUT_MS.
+ */
+static void check_link_idle(void) {
+#if ENABLE_LINK_IDLE_SLEEP
+    uint32_t now = hal_timer_millis();
+    // After a wake, allow a few keyframe intervals before giving up on the link again.
+    if (now - ble_rx_get_last_frame_ms() >= LINK_IDLE_TIMEOUT_MS && now - last_wake_ms >= LINK_WAKE_GRACE_MS) {
+        link_idle = true;
+    }
+#endif
+}
+
+/**
+ * @brief Blanks the LCD and powers down until the Brain Module transmits again.
+ * The first byte is lost to the wake-up; the parser resynchronises on the next frame.
+ */
+static void enter_link_idle_sleep(void) {
+    log_info("Power: Link idle, entering power-down");
+    logger_flush();
+    uint32_t start = hal_timer_millis();
+    while (!hal_uart_tx_idle(LOG_UART_ID) && hal_timer_millis() - start < 20) {
+        // Give the last log line a moment to leave the UART
+    }
+    display_set_power(false);
+
+    while (hal_power_deep_sleep() == POWER_WAKE_WATCHDOG) {
+        // Still quiet
+    }
+
+    link_idle = false;
+    last_wake_ms = hal_timer_millis();
+    display_set_power(true);
+    log_info("Power: Link activity, resuming");
+}
+
+/**
+ * @brief Logs the awake share of CPU time since the last report.
+ */
+static void log_power_stats(void) {
+    power_stats_t stats;
+    hal_power_get_stats(&stats);
+    log_info("Power: awake %u%%, idle %lu ms, asleep %lu ms, %lu wakeups in %lu ms",
+             stats.duty_pct, stats.idle_ms, stats.deep_ms, stats.wakeups, stats.total_ms);
+    hal_power_reset_stats();
 }
 
 /**
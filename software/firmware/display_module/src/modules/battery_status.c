@@ -1,24 +1,47 @@
 /**
  * @file battery_status.c
  * @brief Module for monitoring battery and charging status on the Display Module.
- * Reads charger status pin and potentially battery voltage via ADC.
+ * Reads the charger status pin and the cell voltage, which the ADC HAL
+ * samples in the background on BATT_SENSE_PIN (ADC1).
  */
 
-#include "modules/battery_status.h" // Use the module header file name (assuming it exists)
+#include "modules/battery_status.h" // Use the module header file name
+#include "modules/settings.h"
+#include "hal/adc.h"
 #include "hal/gpio.h"
-// #include "hal/adc.h" // Include if using ADC for direct voltage reading
 #include "util/logger.h"
+#include "util/fixed.h"
+#include "util/soc_table.h"
 #include "config.h"
+#include <avr/pgmspace.h>
+
+// --- Defines ---
+// Single Li-Po cell under light load at 0%, 10%, ... 100% charge
+static const uint16_t soc_table_mv[] PROGMEM = {
+    3270, 3690, 3730, 3770, 3800, 3840, 3870, 3950, 4020, 4110, 4200
+};
+#define SOC_TABLE_POINTS (sizeof(soc_table_mv) / sizeof(soc_table_mv[0]))
 
 // --- Internal State ---
 static battery_charge_state_t current_charge_state = BATTERY_STATE_UNKNOWN;
 static uint8_t current_level_percent = 0; // Estimated battery percentage
-
-// --- Assumed ADC HAL functions (if reading voltage directly) ---
-// void hal_adc_init(void);
-// void hal_adc_pin_init(uint8_t pin);
-// uint16_t hal_adc_read_blocking(uint8_t channel);
-// ---
+static uint16_t current_voltage_mv = 0;
+static uint16_t mv_per_count_q8 = 0; // Cell millivolts per ADC count (~1.61 mV with the defaults)
+static uint8_t scale_revision = 0;
+
+// --- Internal Helper Functions ---
+
+// Recomputes the scale after the divider or reference settings change.
+static uint16_t scale_q8(void) {
+    uint8_t revision = settings_get_revision();
+    if (mv_per_count_q8 == 0 || revision != scale_revision) {
+        const settings_t *s = settings_get();
+        mv_per_count_q8 = soc_divider_mv_per_count_q8(s->battery_r1_ohms, s->battery_r2_ohms, s->battery_vref_mv,
+                                                      BATTERY_ADC_MAX_VALUE);
+        scale_revision = revision;
+    }
+    return mv_per_count_q8;
+}
 
 // --- Public API Implementation ---
 
@@ -26,10 +49,8 @@ void battery_status_init(void) {
     log_info("Battery Status: Initializing...");
     // Configure the charger status pin as input (likely with pull-up if open-drain)
     hal_gpio_init(BATT_CHG_STAT_PIN, GPIO_MODE_INPUT_PULLUP);
-
-    // Initialize ADC if reading voltage directly
-    // hal_adc_init();
-    // hal_adc_pin_init(BATT_SENSE_PIN);
+    hal_gpio_init(BATT_SENSE_PIN, GPIO_MODE_ANALOG);
+    hal_adc_start(BATTERY_ADC_CHANNEL); // Primes the filter, so the first update is valid
 
     // Perform initial read
     battery_status_update();
@@ -52,22 +73,11 @@ void battery_status_update(void) {
     }
     log_debug("Battery Status: CHG_STAT Pin = %d -> State = %d", charge_stat_pin_high, current_charge_state);
 
-    // Read battery voltage via ADC (if implemented)
-    // uint16_t raw_adc = hal_adc_read_blocking(ADC_CHANNEL_FOR_BATT_SENSE);
-    // Convert raw ADC to millivolts using divider ratio and Vref
-    // float voltage_mv = ((float)raw_adc / BATTERY_ADC_MAX_VALUE) * BATTERY_ADC_VREF_MV * DIVIDER_RATIO;
-    // Estimate percentage based on voltage (using Li-Po curve)
-    // current_level_percent = voltage_to_lipo_percent(voltage_mv);
-
-    // Placeholder percentage update (simulate discharge/charge)
-    if (current_charge_state == BATTERY_STATE_CHARGING) {
-        if (current_level_percent < 100) current_level_percent += 1;
-    } else {
-        if (current_level_percent > 0) current_level_percent -= 1;
-    }
-    if (current_level_percent > 100) current_level_percent = 100; // Clamp
-    log_debug("Battery Status: Estimated Level = %d%%", current_level_percent);
-
+    // The filtered reading is already there: scale it and look up the charge level.
+    uint16_t raw_adc = hal_adc_get_filtered();
+    current_voltage_mv = fixed_sat_u16(fixed_mul_q8(raw_adc, scale_q8()));
+    current_level_percent = soc_table_percent(soc_table_mv, SOC_TABLE_POINTS, current_voltage_mv);
+    log_debug("Battery Status: Raw=%u -> %u mV, Level = %d%%", raw_adc, current_voltage_mv, current_level_percent);
 }
 
 battery_charge_state_t battery_status_get_charge_state(void) {
@@ -79,26 +89,6 @@ uint8_t battery_status_get_level_percent(void) {
     return current_level_percent;
 }
 
-// Placeholder header file content (modules/battery_status.h) would look like:
-/*
-#ifndef MODULES_BATTERY_STATUS_H
-#define MODULES_BATTERY_STATUS_H
-
-#include <stdint.h>
-
-// Battery charging states
-typedef enum {
-    BATTERY_STATE_UNKNOWN,
-    BATTERY_STATE_CHARGING,
-    BATTERY_STATE_NOT_CHARGING, // Discharging or idle
-    BATTERY_STATE_CHARGED,      // Charge complete
-    BATTERY_STATE_FAULT
-} battery_charge_state_t;
-
-void battery_status_init(void);
-void battery_status_update(void); // Call periodically
-battery_charge_state_t battery_status_get_charge_state(void);
-uint8_t battery_status_get_level_percent(void);
-
-#endif // MODULES_BATTERY_STATUS_H
-*/
+uint16_t battery_status_get_voltage_mv(void) {
+    return current_voltage_mv;
+}
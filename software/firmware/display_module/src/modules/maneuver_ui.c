@@ -0,0 +1,328 @@
+/**
+ * @file maneuver_ui.c
+ * @brief Maneuver icon atlas and instruction text (see maneuver_ui.h).
+ * The atlas holds one 32x32 icon per distinct shape, 2 bpp and run-length
+ * encoded (DISPLAY_ICON_RUN) back to back in flash. Right-hand maneuvers
+ * reuse the left-hand icon mirrored, so the whole atlas is ~1.3 KB.
+ * Palette: 0 background, 1 arrow, 2 road (unused branch, grayed), 3 alert.
+ */
+
+#include "modules/maneuver_ui.h"
+#include "util/logger.h"
+#include "config.h"
+#include <avr/pgmspace.h>
+#include <string.h> // For strlen
+
+// --- Icon Atlas ---
+
+typedef enum {
+    ICON_STRAIGHT,
+    ICON_SLIGHT_LEFT,
+    ICON_LEFT,
+    ICON_SHARP_LEFT,
+    ICON_KEEP_LEFT,
+    ICON_UTURN,
+    ICON_ROUNDABOUT,
+    ICON_MERGE,
+    ICON_DEPART,
+    ICON_ARRIVE,
+    ICON_OFF_ROUTE,
+    ICON_NO_FIX,
+    ICON_COUNT,
+    ICON_BLANK = 0x7F // No icon: the box is cleared
+} icon_id_t;
+
+#define ICON_MIRROR 0x80 // Flag in icon_for_maneuver[]: draw flipped left to right
+
+// Rows of 32 pixels, runs never crossing a row
+static const uint8_t icon_rle[] PROGMEM = {
+    // ICON_STRAIGHT (92 bytes)
+    0x1F, 0x1F, 0x0E, 0x41, 0x0E, 0x0D, 0x43, 0x0D, 0x0C, 0x45, 0x0C, 0x0B,
+    0x47, 0x0B, 0x0A, 0x49, 0x0A, 0x09, 0x4B, 0x09, 0x08, 0x4D, 0x08, 0x0D,
+    0x43, 0x0D, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C,
+    0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C,
+    0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C,
+    0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C,
+    0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C,
+    0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0D, 0x43, 0x0D,
+    // ICON_SLIGHT_LEFT (96 bytes)
+    0x1F, 0x1F, 0x1F, 0x04, 0x4A, 0x0F, 0x04, 0x49, 0x10, 0x04, 0x48, 0x11,
+    0x04, 0x47, 0x12, 0x04, 0x47, 0x12, 0x04, 0x48, 0x11, 0x04, 0x49, 0x10,
+    0x04, 0x4A, 0x0F, 0x04, 0x42, 0x01, 0x46, 0x0E, 0x04, 0x41, 0x03, 0x46,
+    0x0D, 0x04, 0x40, 0x05, 0x46, 0x0C, 0x0C, 0x46, 0x0B, 0x0D, 0x46, 0x0A,
+    0x0E, 0x45, 0x0A, 0x0F, 0x45, 0x09, 0x0F, 0x45, 0x09, 0x0F, 0x45, 0x09,
+    0x0F, 0x45, 0x09, 0x0F, 0x45, 0x09, 0x0F, 0x45, 0x09, 0x0F, 0x45, 0x09,
+    0x0F, 0x45, 0x09, 0x0F, 0x45, 0x09, 0x0F, 0x45, 0x09, 0x0F, 0x45, 0x09,
+    0x0F, 0x45, 0x09, 0x0F, 0x45, 0x09, 0x0F, 0x45, 0x09, 0x10, 0x43, 0x0A,
+    // ICON_LEFT (88 bytes)
+    0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x08, 0x40, 0x15, 0x07,
+    0x41, 0x15, 0x06, 0x42, 0x15, 0x05, 0x43, 0x15, 0x04, 0x4E, 0x0B, 0x03,
+    0x51, 0x09, 0x02, 0x52, 0x09, 0x02, 0x53, 0x08, 0x03, 0x52, 0x08, 0x04,
+    0x51, 0x08, 0x05, 0x43, 0x06, 0x45, 0x08, 0x06, 0x42, 0x06, 0x45, 0x08,
+    0x07, 0x41, 0x06, 0x45, 0x08, 0x08, 0x40, 0x06, 0x45, 0x08, 0x10, 0x45,
+    0x08, 0x10, 0x45, 0x08, 0x10, 0x45, 0x08, 0x10, 0x45, 0x08, 0x10, 0x45,
+    0x08, 0x10, 0x45, 0x08, 0x10, 0x45, 0x08, 0x10, 0x45, 0x08, 0x10, 0x45,
+    0x08, 0x11, 0x43, 0x09,
+    // ICON_SHARP_LEFT (114 bytes)
+    0x1F, 0x1F, 0x1F, 0x1F, 0x12, 0x43, 0x08, 0x11, 0x44, 0x08, 0x10, 0x46,
+    0x07, 0x0F, 0x47, 0x07, 0x0E, 0x48, 0x07, 0x0D, 0x49, 0x07, 0x0C, 0x4A,
+    0x07, 0x04, 0x40, 0x05, 0x4B, 0x07, 0x04, 0x41, 0x03, 0x4C, 0x07, 0x04,
+    0x42, 0x01, 0x46, 0x00, 0x45, 0x07, 0x04, 0x43, 0x00, 0x45, 0x01, 0x45,
+    0x07, 0x04, 0x49, 0x02, 0x45, 0x07, 0x04, 0x48, 0x03, 0x45, 0x07, 0x04,
+    0x46, 0x05, 0x45, 0x07, 0x04, 0x47, 0x04, 0x45, 0x07, 0x04, 0x48, 0x03,
+    0x45, 0x07, 0x04, 0x49, 0x02, 0x45, 0x07, 0x04, 0x4A, 0x01, 0x45, 0x07,
+    0x11, 0x45, 0x07, 0x11, 0x45, 0x07, 0x11, 0x45, 0x07, 0x11, 0x45, 0x07,
+    0x11, 0x45, 0x07, 0x11, 0x45, 0x07, 0x11, 0x45, 0x07, 0x11, 0x45, 0x07,
+    0x11, 0x45, 0x07, 0x12, 0x43, 0x08,
+    // ICON_KEEP_LEFT (118 bytes)
+    0x1F, 0x1F, 0x16, 0x83, 0x04, 0x15, 0x84, 0x04, 0x15, 0x84, 0x04, 0x05,
+    0x4A, 0x03, 0x85, 0x04, 0x05, 0x49, 0x04, 0x84, 0x05, 0x05, 0x48, 0x04,
+    0x85, 0x05, 0x05, 0x47, 0x05, 0x84, 0x06, 0x05, 0x47, 0x04, 0x85, 0x06,
+    0x05, 0x48, 0x03, 0x84, 0x07, 0x05, 0x49, 0x01, 0x85, 0x07, 0x05, 0x4A,
+    0x00, 0x84, 0x08, 0x05, 0x42, 0x01, 0x46, 0x84, 0x08, 0x05, 0x41, 0x03,
+    0x46, 0x82, 0x09, 0x05, 0x40, 0x05, 0x46, 0x81, 0x09, 0x0D, 0x45, 0x80,
+    0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45,
+    0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45,
+    0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45,
+    0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45, 0x0A, 0x0F, 0x43, 0x0B,
+    // ICON_UTURN (128 bytes)
+    0x1F, 0x1F, 0x1F, 0x0A, 0x47, 0x0C, 0x08, 0x4B, 0x0A, 0x07, 0x4D, 0x09,
+    0x06, 0x4F, 0x08, 0x06, 0x4F, 0x08, 0x05, 0x45, 0x05, 0x45, 0x07, 0x05,
+    0x44, 0x07, 0x44, 0x07, 0x05, 0x44, 0x07, 0x44, 0x07, 0x05, 0x44, 0x07,
+    0x44, 0x07, 0x04, 0x45, 0x07, 0x45, 0x06, 0x04, 0x45, 0x07, 0x45, 0x06,
+    0x04, 0x45, 0x07, 0x45, 0x06, 0x04, 0x45, 0x07, 0x45, 0x06, 0x04, 0x45,
+    0x07, 0x45, 0x06, 0x04, 0x45, 0x07, 0x45, 0x06, 0x04, 0x45, 0x07, 0x45,
+    0x06, 0x05, 0x43, 0x08, 0x45, 0x06, 0x00, 0x4D, 0x03, 0x45, 0x06, 0x01,
+    0x4B, 0x04, 0x45, 0x06, 0x02, 0x49, 0x05, 0x45, 0x06, 0x03, 0x47, 0x06,
+    0x45, 0x06, 0x04, 0x45, 0x07, 0x45, 0x06, 0x05, 0x43, 0x08, 0x45, 0x06,
+    0x06, 0x41, 0x09, 0x45, 0x06, 0x12, 0x45, 0x06, 0x12, 0x45, 0x06, 0x12,
+    0x45, 0x06, 0x12, 0x45, 0x06, 0x13, 0x43, 0x07,
+    // ICON_ROUNDABOUT (125 bytes)
+    0x1F, 0x0E, 0x41, 0x0E, 0x0D, 0x43, 0x0D, 0x0C, 0x45, 0x0C, 0x0B, 0x47,
+    0x0B, 0x0A, 0x49, 0x0A, 0x09, 0x4B, 0x09, 0x09, 0x82, 0x49, 0x08, 0x08,
+    0x83, 0x4A, 0x07, 0x07, 0x84, 0x00, 0x4A, 0x06, 0x07, 0x82, 0x02, 0x43,
+    0x00, 0x45, 0x06, 0x06, 0x83, 0x08, 0x45, 0x05, 0x06, 0x82, 0x0A, 0x44,
+    0x05, 0x06, 0x82, 0x0A, 0x44, 0x05, 0x06, 0x82, 0x0A, 0x44, 0x05, 0x06,
+    0x82, 0x0A, 0x44, 0x05, 0x06, 0x82, 0x0A, 0x44, 0x05, 0x06, 0x82, 0x0A,
+    0x44, 0x05, 0x06, 0x83, 0x08, 0x45, 0x05, 0x07, 0x82, 0x07, 0x45, 0x06,
+    0x07, 0x84, 0x02, 0x48, 0x06, 0x08, 0x84, 0x49, 0x07, 0x09, 0x83, 0x48,
+    0x08, 0x0B, 0x80, 0x48, 0x09, 0x0C, 0x46, 0x0B, 0x0C, 0x45, 0x0C, 0x0C,
+    0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C,
+    0x45, 0x0C, 0x0D, 0x43, 0x0D,
+    // ICON_MERGE (124 bytes)
+    0x1F, 0x1F, 0x10, 0x41, 0x0C, 0x0F, 0x43, 0x0B, 0x0E, 0x45, 0x0A, 0x0D,
+    0x47, 0x09, 0x0C, 0x49, 0x08, 0x0B, 0x4B, 0x07, 0x0A, 0x4D, 0x06, 0x0F,
+    0x43, 0x0B, 0x0E, 0x45, 0x0A, 0x0E, 0x45, 0x0A, 0x0E, 0x45, 0x0A, 0x0C,
+    0x81, 0x45, 0x0A, 0x0B, 0x82, 0x45, 0x0A, 0x0A, 0x83, 0x45, 0x0A, 0x09,
+    0x84, 0x45, 0x0A, 0x08, 0x85, 0x45, 0x0A, 0x07, 0x86, 0x45, 0x0A, 0x06,
+    0x86, 0x00, 0x45, 0x0A, 0x05, 0x86, 0x01, 0x45, 0x0A, 0x04, 0x86, 0x02,
+    0x45, 0x0A, 0x03, 0x86, 0x03, 0x45, 0x0A, 0x03, 0x85, 0x04, 0x45, 0x0A,
+    0x02, 0x85, 0x05, 0x45, 0x0A, 0x02, 0x85, 0x05, 0x45, 0x0A, 0x02, 0x85,
+    0x05, 0x45, 0x0A, 0x02, 0x85, 0x05, 0x45, 0x0A, 0x02, 0x85, 0x05, 0x45,
+    0x0A, 0x02, 0x85, 0x05, 0x45, 0x0A, 0x02, 0x85, 0x05, 0x45, 0x0A, 0x03,
+    0x83, 0x07, 0x43, 0x0B,
+    // ICON_DEPART (90 bytes)
+    0x1F, 0x1F, 0x0E, 0x41, 0x0E, 0x0D, 0x43, 0x0D, 0x0C, 0x45, 0x0C, 0x0B,
+    0x47, 0x0B, 0x0A, 0x49, 0x0A, 0x09, 0x4B, 0x09, 0x08, 0x4D, 0x08, 0x0D,
+    0x43, 0x0D, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C,
+    0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C,
+    0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C,
+    0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0C, 0x45, 0x0C, 0x0B,
+    0x47, 0x0B, 0x0B, 0x47, 0x0B, 0x0B, 0x47, 0x0B, 0x0B, 0x47, 0x0B, 0x0C,
+    0x45, 0x0C, 0x0D, 0x43, 0x0D, 0x1F,
+    // ICON_ARRIVE (105 bytes)
+    0x1F, 0x1F, 0x07, 0x81, 0xC0, 0x14, 0x06, 0x82, 0xC3, 0x11, 0x06, 0x82,
+    0xC6, 0x0E, 0x06, 0x82, 0xC8, 0x0C, 0x06, 0x82, 0xCB, 0x09, 0x06, 0x82,
+    0xCD, 0x07, 0x06, 0x82, 0xD0, 0x04, 0x06, 0x82, 0xCD, 0x07, 0x06, 0x82,
+    0xCB, 0x09, 0x06, 0x82, 0xC8, 0x0C, 0x06, 0x82, 0xC6, 0x0E, 0x06, 0x82,
+    0xC3, 0x11, 0x06, 0x82, 0xC0, 0x14, 0x06, 0x83, 0x14, 0x06, 0x83, 0x14,
+    0x06, 0x83, 0x14, 0x06, 0x83, 0x14, 0x06, 0x83, 0x14, 0x06, 0x83, 0x14,
+    0x06, 0x83, 0x14, 0x06, 0x83, 0x14, 0x06, 0x83, 0x14, 0x06, 0x83, 0x14,
+    0x06, 0x83, 0x14, 0x06, 0x83, 0x14, 0x06, 0x83, 0x14, 0x06, 0x83, 0x14,
+    0x06, 0x83, 0x14, 0x06, 0x83, 0x14, 0x07, 0x81, 0x15,
+    // ICON_OFF_ROUTE (96 bytes)
+    0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x05, 0xC3, 0x0B, 0xC3, 0x05, 0x05,
+    0xC4, 0x09, 0xC4, 0x05, 0x05, 0xC5, 0x07, 0xC5, 0x05, 0x05, 0xC6, 0x05,
+    0xC6, 0x05, 0x06, 0xC6, 0x03, 0xC6, 0x06, 0x07, 0xC6, 0x01, 0xC6, 0x07,
+    0x08, 0xCD, 0x08, 0x09, 0xCB, 0x09, 0x0A, 0xC9, 0x0A, 0x0B, 0xC7, 0x0B,
+    0x0B, 0xC7, 0x0B, 0x0A, 0xC9, 0x0A, 0x09, 0xCB, 0x09, 0x08, 0xCD, 0x08,
+    0x07, 0xC6, 0x01, 0xC6, 0x07, 0x06, 0xC6, 0x03, 0xC6, 0x06, 0x05, 0xC6,
+    0x05, 0xC6, 0x05, 0x05, 0xC5, 0x07, 0xC5, 0x05, 0x05, 0xC4, 0x09, 0xC4,
+    0x05, 0x05, 0xC3, 0x0B, 0xC3, 0x05, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F,
+    // ICON_NO_FIX (124 bytes)
+    0x1F, 0x0E, 0x81, 0x0E, 0x0D, 0x83, 0x0D, 0x0D, 0x83, 0x0D, 0x0D, 0x83,
+    0x0D, 0x0D, 0x83, 0x0D, 0x0B, 0x87, 0x0B, 0x09, 0x8B, 0x09, 0x08, 0x8D,
+    0x08, 0x07, 0x83, 0x02, 0x81, 0x02, 0x83, 0x07, 0x06, 0x83, 0x09, 0x83,
+    0x06, 0x06, 0x82, 0x0B, 0x82, 0x06, 0x05, 0x82, 0x0D, 0x82, 0x05, 0x05,
+    0x82, 0x0D, 0x82, 0x05, 0x01, 0x86, 0x0D, 0x86, 0x01, 0x00, 0x88, 0x0B,
+    0x88, 0x00, 0x00, 0x88, 0x0B, 0x88, 0x00, 0x01, 0x86, 0x0D, 0x86, 0x01,
+    0x05, 0x82, 0x0D, 0x82, 0x05, 0x05, 0x82, 0x0D, 0x82, 0x05, 0x06, 0x82,
+    0x0B, 0x82, 0x06, 0x06, 0x83, 0x09, 0x83, 0x06, 0x07, 0x83, 0x02, 0x81,
+    0x02, 0x83, 0x07, 0x08, 0x8D, 0x08, 0x09, 0x8B, 0x09, 0x0B, 0x87, 0x0B,
+    0x0D, 0x83, 0x0D, 0x0D, 0x83, 0x0D, 0x0D, 0x83, 0x0D, 0x0D, 0x83, 0x0D,
+    0x0E, 0x81, 0x0E, 0x1F,
+};
+
+static const uint16_t icon_offsets[ICON_COUNT + 1] PROGMEM = {
+    0, 92, 188, 276, 390, 508, 636, 761, 885, 975, 1080, 1176, 1300
+};
+
+// Icon per route maneuver (nav_maneuver_t 0..NAV_MANEUVER_ARRIVE)
+static const uint8_t icon_for_maneuver[] PROGMEM = {
+    [NAV_MANEUVER_NONE]         = ICON_STRAIGHT,
+    [NAV_MANEUVER_DEPART]       = ICON_DEPART,
+    [NAV_MANEUVER_STRAIGHT]     = ICON_STRAIGHT,
+    [NAV_MANEUVER_SLIGHT_LEFT]  = ICON_SLIGHT_LEFT,
+    [NAV_MANEUVER_LEFT]         = ICON_LEFT,
+    [NAV_MANEUVER_SHARP_LEFT]   = ICON_SHARP_LEFT,
+    [NAV_MANEUVER_SLIGHT_RIGHT] = ICON_SLIGHT_LEFT | ICON_MIRROR,
+    [NAV_MANEUVER_RIGHT]        = ICON_LEFT | ICON_MIRROR,
+    [NAV_MANEUVER_SHARP_RIGHT]  = ICON_SHARP_LEFT | ICON_MIRROR,
+    [NAV_MANEUVER_KEEP_LEFT]    = ICON_KEEP_LEFT,
+    [NAV_MANEUVER_KEEP_RIGHT]   = ICON_KEEP_LEFT | ICON_MIRROR,
+    [NAV_MANEUVER_UTURN]        = ICON_UTURN,
+    [NAV_MANEUVER_ROUNDABOUT]   = ICON_ROUNDABOUT,
+    [NAV_MANEUVER_MERGE]        = ICON_MERGE,
+    [NAV_MANEUVER_ARRIVE]       = ICON_ARRIVE,
+};
+#define ROUTE_MANEUVER_COUNT (sizeof(icon_for_maneuver) / sizeof(icon_for_maneuver[0]))
+
+// Exit number position inside the roundabout ring
+#define ROUNDABOUT_DIGIT_X 13
+#define ROUNDABOUT_DIGIT_Y 11
+
+// --- Instruction Text ---
+
+#define MANEUVER_TEXT_MAX 17 // Longest entry plus NUL
+
+static const char maneuver_text[][MANEUVER_TEXT_MAX] PROGMEM = {
+    [NAV_MANEUVER_NONE]         = "Continue",
+    [NAV_MANEUVER_DEPART]       = "Depart",
+    [NAV_MANEUVER_STRAIGHT]     = "Go straight",
+    [NAV_MANEUVER_SLIGHT_LEFT]  = "Bear left",
+    [NAV_MANEUVER_LEFT]         = "Turn left",
+    [NAV_MANEUVER_SHARP_LEFT]   = "Sharp left",
+    [NAV_MANEUVER_SLIGHT_RIGHT] = "Bear right",
+    [NAV_MANEUVER_RIGHT]        = "Turn right",
+    [NAV_MANEUVER_SHARP_RIGHT]  = "Sharp right",
+    [NAV_MANEUVER_KEEP_LEFT]    = "Keep left",
+    [NAV_MANEUVER_KEEP_RIGHT]   = "Keep right",
+    [NAV_MANEUVER_UTURN]        = "Make a U-turn",
+    [NAV_MANEUVER_ROUNDABOUT]   = "Roundabout exit ",
+    [NAV_MANEUVER_MERGE]        = "Merge",
+    [NAV_MANEUVER_ARRIVE]       = "Arrive",
+};
+
+_Static_assert(sizeof(maneuver_text) / sizeof(maneuver_text[0]) == ROUTE_MANEUVER_COUNT,
+               "every route maneuver needs an icon and a text");
+
+#if ENABLE_DISPLAY_COMPOSITOR
+// Display list items point here until display_refresh()
+static display_color_t list_palette[DISPLAY_ICON_PALETTE_SIZE];
+static char list_digit;
+#endif
+
+// --- Helper Functions ---
+
+static void load_palette(display_color_t *palette, display_color_t fg, display_color_t bg) {
+    palette[0] = bg;
+    palette[1] = fg;
+    palette[2] = COLOR_GRAY;
+    palette[3] = COLOR_RED;
+}
+
+static uint8_t icon_lookup(uint8_t maneuver) {
+    if (maneuver < ROUTE_MANEUVER_COUNT) {
+        return pgm_read_byte(&icon_for_maneuver[maneuver]);
+    }
+    switch (maneuver) {
+        case NAV_MANEUVER_OFF_ROUTE:
+            return ICON_OFF_ROUTE;
+        case NAV_MANEUVER_NO_FIX:
+            return ICON_NO_FIX;
+        default:
+            return ICON_BLANK; // No route, no link, or a code this build does not know
+    }
+}
+
+// --- Public API Implementation ---
+
+void maneuver_ui_draw_icon(int16_t x, int16_t y, uint8_t maneuver, uint8_t arg,
+                           display_color_t fg, display_color_t bg) {
+    uint8_t entry = icon_lookup(maneuver);
+    uint8_t icon = entry & (uint8_t)~ICON_MIRROR;
+    if (icon >= ICON_COUNT) {
+        display_fill_rect(x, y, MANEUVER_ICON_SIZE, MANEUVER_ICON_SIZE, bg);
+        return;
+    }
+
+    display_color_t palette[DISPLAY_ICON_PALETTE_SIZE];
+    load_palette(palette, fg, bg);
+    const uint8_t *rle = &icon_rle[pgm_read_word(&icon_offsets[icon])];
+    display_draw_icon(x, y, MANEUVER_ICON_SIZE, MANEUVER_ICON_SIZE, rle, palette, (entry & ICON_MIRROR) != 0);
+    log_debug("ManeuverUI: Icon %u for maneuver %u", icon, maneuver);
+
+    if (maneuver == NAV_MANEUVER_ROUNDABOUT && arg > 0 && arg < 10) {
+        char digit = (char)('0' + arg);
+        display_set_font(&display_font_small);
+        display_set_foreground_color(fg);
+        display_set_background_color(bg);
+        display_draw_text_run(x + ROUNDABOUT_DIGIT_X, y + ROUNDABOUT_DIGIT_Y, &digit, 1);
+    }
+}
+
+#if ENABLE_DISPLAY_COMPOSITOR
+bool maneuver_ui_add_icon(int16_t x, int16_t y, uint8_t maneuver, uint8_t arg,
+                          display_color_t fg, display_color_t bg) {
+    uint8_t entry = icon_lookup(maneuver);
+    uint8_t icon = entry & (uint8_t)~ICON_MIRROR;
+    if (icon >= ICON_COUNT) {
+        return display_list_add_rect(x, y, MANEUVER_ICON_SIZE, MANEUVER_ICON_SIZE, bg);
+    }
+
+    load_palette(list_palette, fg, bg);
+    const uint8_t *rle = &icon_rle[pgm_read_word(&icon_offsets[icon])];
+    bool ok = display_list_add_icon(x, y, MANEUVER_ICON_SIZE, MANEUVER_ICON_SIZE, rle, list_palette,
+                                    (entry & ICON_MIRROR) ? DISPLAY_LIST_MIRROR : 0);
+
+    if (maneuver == NAV_MANEUVER_ROUNDABOUT && arg > 0 && arg < 10) {
+        list_digit = (char)('0' + arg);
+        display_set_font(&display_font_small);
+        display_set_foreground_color(fg);
+        display_set_background_color(bg);
+        ok = display_list_add_text(x + ROUNDABOUT_DIGIT_X, y + ROUNDABOUT_DIGIT_Y, &list_digit, 1, 0) && ok;
+    }
+    return ok;
+}
+#endif
+
+void maneuver_ui_format_text(uint8_t maneuver, uint8_t arg, char *out, size_t size) {
+    if (!out || size == 0) return;
+
+    PGM_P text;
+    switch (maneuver) {
+        case NAV_MANEUVER_NO_LINK:
+            text = PSTR("Connecting...");
+            break;
+        case NAV_MANEUVER_NO_FIX:
+            text = PSTR("Waiting for GPS fix...");
+            break;
+        case NAV_MANEUVER_NO_ROUTE:
+            text = PSTR("No route loaded");
+            break;
+        case NAV_MANEUVER_OFF_ROUTE:
+            text = PSTR("Off route");
+            break;
+        default:
+            text = maneuver_text[(maneuver < ROUTE_MANEUVER_COUNT) ? maneuver : NAV_MANEUVER_NONE];
+            break;
+    }
+    strncpy_P(out, text, size - 1);
+    out[size - 1] = '\0';
+
+    size_t len = strlen(out);
+    if (maneuver == NAV_MANEUVER_ROUNDABOUT && arg > 0 && arg < 10 && len + 1 < size) {
+        out[len] = (char)('0' + arg);
+        out[len + 1] = '\0';
+    }
+}
@@ -0,0 +1,35 @@
+/**
+ * @file ota.c
+ * @brief Hand-over to the firmware update bootloader (see ota.h).
+ */
+
+#include "modules/ota.h"
+
+#if ENABLE_OTA_BOOTLOADER
+
+#include "hal/eeprom.h"
+#include "hal/power.h"
+#include "hal/uart.h"
+#include "hal/timer.h"
+#include "util/logger.h"
+
+// --- Public API Implementation ---
+
+void ota_enter_bootloader(void) {
+    log_info("OTA: Update requested, restarting into the bootloader");
+    logger_flush();
+    uint32_t start = hal_timer_millis();
+    while (!hal_uart_tx_idle(BLE_UART_ID) && hal_timer_millis() - start < 20) {
+        // Let the log line leave before the reset cuts it off
+    }
+
+    while (!hal_eeprom_write_byte(OTA_FLAG_ADDR, OTA_FLAG_REQUESTED)) {
+        // A settings write may still be in progress
+    }
+    while (!hal_eeprom_is_ready()) {
+        // The reset must not cut the write short
+    }
+    hal_power_reset();
+}
+
+#endif // ENABLE_OTA_BOOTLOADER
@@ -3,163 +3,461 @@
  * @brief Module responsible for updating the LCD screen content.
  * Retrieves data from other modules (BLE RX, Battery Status) and uses the
  * display driver to render the UI elements.
+ *
+ * The screen is drawn from the active layout table (ui_layout.h): each widget
+ * has a fixed bounding box, a data source and the source value it last
+ * rendered. An update redraws only the widgets whose value changed:
+ * - Text and number widgets keep the string on screen and rewrite only what moved: the
+ *   text between the unchanged prefix and suffix, as one opaque text run (one
+ *   address window, no clear). If that changes the width, the rest of the
+ *   string is redrawn and the leftover tail cleared.
+ * - Indicator widgets queue a fill for their box. Queued fills of the same color
+ *   are merged whenever their union is exactly covered by them (one contains
+ *   the other, or they line up edge to edge), so the fewest windows are
+ *   opened and no pixel outside a changed widget is touched.
+ * - The maneuver icon is an opaque blit from the flash atlas (maneuver_ui.h),
+ *   redrawn only when the maneuver code or its argument changes.
+ * A speed change from 42 to 43 km/h rewrites one 6x8 glyph: ~100 bytes.
+ * A full repaint is composited band by band (display_list_*), so the
+ * background and the widgets on it go out in a single pass.
+ *
+ * While the link is not LIVE (ble_rx.h) the last values stay on screen with
+ * the ink of every Brain-fed widget dimmed halfway to its paper; a change of
+ * link state repaints the whole screen.
  */
 
-#include "modules/screen_updater.h" // Use the module header file name (assuming it exists)
+#include "modules/screen_updater.h"
 #include "modules/display_driver.h"
 #include "modules/ble_rx.h"
+#include "modules/maneuver_ui.h"
+#include "modules/ui_layout.h"
 #include "modules/battery_status.h" // Assuming header exists
+#include "modules/settings.h"
 #include "util/logger.h"
+#include "util/perf.h"
 #include "config.h"
-#include <stdio.h> // For sprintf
+#include <avr/pgmspace.h>
+#include <string.h> // For memcpy, memmove, memset, strncpy
+
+// --- Defines ---
+#define TEXT_MAX_CHARS        24 // Longest text kept per widget (clipped to the box)
+#define SCREEN_MAX_FILLS      6  // Fills queued per update
+#define KEY_CHARGING          0x8000 // UI_SOURCE_BATTERY: flag above the percent
+
+#ifndef SCREEN_DEFAULT_LAYOUT
+#define SCREEN_DEFAULT_LAYOUT UI_LAYOUT_DAY
+#endif
+
+// Use signal_state_t enum values (assuming they match Brain Module)
+enum { SIG_OFF, SIG_LEFT, SIG_RIGHT, SIG_HAZARD };
+
+typedef ui_rect_t screen_rect_t;
+
+_Static_assert(UI_LAYOUT_MAX_WIDGETS <= 8, "stale_mask holds one bit per widget");
+
+typedef struct {
+    screen_rect_t rect;
+    display_color_t color;
+} screen_fill_t;
 
 // --- Internal State ---
 static display_nav_data_t last_nav_data;
 static display_status_data_t last_status_data;
 static battery_charge_state_t last_charge_state;
 static uint8_t last_battery_percent;
+static uint8_t last_link_state;                            // ble_link_state_t
+static ui_layout_t layout;                                 // Header of the active layout (ui_layout.h)
+static uint8_t active_layout_id;                           // Its ui_layout_id_t
 
-// --- UI Drawing Functions ---
+// What is on screen
+static char shown_text[UI_LAYOUT_MAX_TEXT][TEXT_MAX_CHARS + 1]; // By layout.text_slot
+static uint16_t shown_key[UI_LAYOUT_MAX_WIDGETS];          // Source value each widget last rendered
+static uint8_t stale_mask = 0;                             // Widgets that must redraw regardless of key
+static bool full_repaint = true;
+static uint8_t settings_revision;                          // Layout setting last applied
+
+// Fills queued for the current update, in paint order
+static screen_fill_t fills[SCREEN_MAX_FILLS];
+static uint8_t fill_count = 0;
+
+// --- Region Helpers ---
+
+static uint32_t rect_area(const screen_rect_t *r) {
+    return (uint32_t)r->w * r->h;
+}
+
+static bool rect_intersects(const screen_rect_t *a, const screen_rect_t *b) {
+    return a->x < b->x + b->w && b->x < a->x + a->w && a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+static uint32_t rect_overlap_area(const screen_rect_t *a, const screen_rect_t *b) {
+    if (!rect_intersects(a, b)) return 0;
+    int16_t w = ((a->x + a->w < b->x + b->w) ? a->x + a->w : b->x + b->w) - ((a->x > b->x) ? a->x : b->x);
+    int16_t h = ((a->y + a->h < b->y + b->h) ? a->y + a->h : b->y + b->h) - ((a->y > b->y) ? a->y : b->y);
+    return (uint32_t)w * h;
+}
+
+static screen_rect_t rect_union(const screen_rect_t *a, const screen_rect_t *b) {
+    int16_t x0 = (a->x < b->x) ? a->x : b->x;
+    int16_t y0 = (a->y < b->y) ? a->y : b->y;
+    int16_t x1 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+    int16_t y1 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+    screen_rect_t u = { x0, y0, x1 - x0, y1 - y0 };
+    return u;
+}
+
+// A merged fill is painted later than the one it absorbed, so it must not
+// cover a fill of another color; merging never changes a pixel's final color.
+static bool union_is_clear(const screen_rect_t *u, display_color_t color) {
+    for (uint8_t i = 0; i < fill_count; ++i) {
+        if (fills[i].color != color && rect_intersects(u, &fills[i].rect)) return false;
+    }
+    return true;
+}
+
+static void remove_fill(uint8_t index) {
+    fill_count--;
+    memmove(&fills[index], &fills[index + 1], (fill_count - index) * sizeof(fills[0]));
+}
+
+// Queues a fill, merging it with queued fills of the same color. Two fills
+// merge only when their bounding box contains no pixel outside both.
+static void queue_fill(screen_rect_t rect, display_color_t color) {
+    uint8_t i = 0;
+    while (i < fill_count) {
+        screen_rect_t u = rect_union(&fills[i].rect, &rect);
+        if (fills[i].color == color &&
+            rect_area(&u) + rect_overlap_area(&fills[i].rect, &rect) == rect_area(&fills[i].rect) + rect_area(&rect) &&
+            union_is_clear(&u, color)) {
+            rect = u;
+            remove_fill(i);
+            i = 0; // The grown rectangle may now reach fills it missed before
+        } else {
+            i++;
+        }
+    }
+    if (fill_count == SCREEN_MAX_FILLS) { // Paint the oldest now to make room; order is preserved
+        display_fill_rect(fills[0].rect.x, fills[0].rect.y, fills[0].rect.w, fills[0].rect.h, fills[0].color);
+        remove_fill(0);
+    }
+    fills[fill_count].rect = rect;
+    fills[fill_count].color = color;
+    fill_count++;
+}
+
+static void flush_fills(void) {
+    for (uint8_t i = 0; i < fill_count; ++i) {
+        display_fill_rect(fills[i].rect.x, fills[i].rect.y, fills[i].rect.w, fills[i].rect.h, fills[i].color);
+    }
+    fill_count = 0;
+}
+
+// --- Widget Values ---
+
+// Writes value in decimal; returns the digit count. Subtracts powers of ten
+// instead of dividing (no divide instruction on the AVR).
+static uint8_t format_u16(char *out, uint16_t value) {
+    static const uint16_t powers[] PROGMEM = { 10000, 1000, 100, 10 };
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < sizeof(powers) / sizeof(powers[0]); ++i) {
+        uint16_t p = pgm_read_word(&powers[i]);
+        char digit = '0';
+        while (value >= p) {
+            value -= p;
+            digit++;
+        }
+        if (digit != '0' || n > 0) out[n++] = digit; // No leading zeros
+    }
+    out[n++] = (char)('0' + value);
+    out[n] = '\0';
+    return n;
+}
+
+// Current value of a widget's source; a widget redraws only when it changes.
+static uint16_t source_key(uint8_t source) {
+    uint8_t sig = last_status_data.signal_status;
+    switch (source) {
+        case UI_SOURCE_INSTRUCTION:
+        case UI_SOURCE_MANEUVER:
+            return (uint16_t)last_nav_data.maneuver | ((uint16_t)last_nav_data.arg << 8);
+        case UI_SOURCE_DISTANCE:
+            return last_nav_data.distance_m;
+        case UI_SOURCE_BATTERY:
+            return last_battery_percent | ((last_charge_state == BATTERY_STATE_CHARGING) ? KEY_CHARGING : 0);
+        case UI_SOURCE_SPEED:
+            return last_status_data.speed_kmh;
+        case UI_SOURCE_SIGNAL_LEFT:
+            return sig == SIG_LEFT || sig == SIG_HAZARD;
+        case UI_SOURCE_SIGNAL_RIGHT:
+            return sig == SIG_RIGHT || sig == SIG_HAZARD;
+        case UI_SOURCE_LINK:
+            return last_link_state == BLE_LINK_LIVE;
+        default:
+            return 0;
+    }
+}
 
-// Draws the navigation arrow area
-static void draw_navigation_area(void) {
-    log_debug("ScreenUpdater: Drawing Nav Area");
-    // Clear area
-    display_fill_rect(0, 0, LCD_WIDTH, LCD_HEIGHT / 2, COLOR_BLUE); // Example background
+// Builds the string of a TEXT or NUMBER widget from its source value.
+static void format_text(const ui_widget_t *w, uint16_t key, char *out, size_t size) {
+    if (w->type == UI_WIDGET_TEXT) {
+        maneuver_ui_format_text((uint8_t)key, (uint8_t)(key >> 8), out, size);
+        return;
+    }
+    bool charging = (w->source == UI_SOURCE_BATTERY) && (key & KEY_CHARGING);
+    if (w->source == UI_SOURCE_BATTERY) key &= (uint16_t)~KEY_CHARGING;
+    uint8_t n = format_u16(out, key); // At most 5 digits: fits with the suffix
+    strncpy(&out[n], w->suffix, size - 1 - n);
+    out[size - 1] = '\0';
+    n = (uint8_t)strlen(out);
+    if (charging && (size_t)n + 1 < size) { // '+' while charging
+        out[n] = '+';
+        out[n + 1] = '\0';
+    }
+}
+
+// Ink of a widget: dimmed while its data may be out of date.
+static display_color_t widget_fg(const ui_widget_t *w) {
+    if (last_link_state == BLE_LINK_LIVE || w->source == UI_SOURCE_BATTERY) {
+        return w->fg; // Battery is measured locally
+    }
+    // 50% blend in RGB565: halve each channel (drop its low bit), then add
+    return (display_color_t)(((w->fg >> 1) & 0x7BEF) + ((w->bg >> 1) & 0x7BEF));
+}
 
-    // Draw instruction text
-    display_set_foreground_color(COLOR_WHITE);
-    display_set_background_color(COLOR_BLUE);
-    // display_set_font(&font_large); // Set appropriate font
-    display_draw_string(5, 10, last_nav_data.instruction);
+static display_color_t indicator_color(const ui_widget_t *w, uint16_t key) {
+    return key ? widget_fg(w) : w->bg;
+}
 
-    // Draw distance text
-    char dist_str[20];
-    snprintf(dist_str, sizeof(dist_str), "%u m", last_nav_data.distance_m);
-    // display_set_font(&font_medium);
-    display_draw_string(5, 30, dist_str);
+// --- UI Drawing Functions ---
 
-    // Draw turn arrow icon (placeholder)
-    // This would involve drawing lines or a bitmap based on instruction
-    display_draw_line(LCD_WIDTH / 2, 50, LCD_WIDTH / 2 + 20, 60, COLOR_YELLOW);
-    display_draw_line(LCD_WIDTH / 2, 70, LCD_WIDTH / 2 + 20, 60, COLOR_YELLOW);
+// Truncates text to the glyphs that fit in max_width (current font).
+static uint8_t fit_text(char *text, int16_t max_width) {
+    uint8_t len = 0;
+    int16_t width = 0;
+    while (text[len]) {
+        width += display_text_width(&text[len], 1);
+        if (width > max_width) break;
+        len++;
+    }
+    text[len] = '\0';
+    return len;
 }
 
-// Draws the status bar area
-static void draw_status_area(void) {
-    log_debug("ScreenUpdater: Drawing Status Area");
-    // Clear area
-    display_fill_rect(0, LCD_HEIGHT - 20, LCD_WIDTH, 20, COLOR_BLACK); // Status bar background
+// Rewrites the part of the string that differs from what is on screen: for a
+// number, the digits that changed.
+static bool draw_text_widget(uint8_t id, const ui_widget_t *w, uint16_t key) {
+    char text[TEXT_MAX_CHARS + 1];
+    format_text(w, key, text, sizeof(text));
+    display_set_font(w->font);
+    uint8_t len = fit_text(text, w->box.w);
 
-    // Draw Battery Icon/Percentage
-    char batt_str[10];
-    snprintf(batt_str, sizeof(batt_str), "%d%%", last_battery_percent);
-    if (last_charge_state == BATTERY_STATE_CHARGING) {
-        strcat(batt_str, "+"); // Add indicator for charging
+    char *shown = shown_text[layout.text_slot[id]];
+    uint8_t shown_len = (uint8_t)strlen(shown);
+    uint8_t prefix = 0;
+    while (prefix < len && prefix < shown_len && text[prefix] == shown[prefix]) prefix++;
+    if (prefix == len && prefix == shown_len) return false;
+    uint8_t suffix = 0;
+    while (suffix < len - prefix && suffix < shown_len - prefix &&
+           text[len - 1 - suffix] == shown[shown_len - 1 - suffix]) {
+        suffix++;
     }
-    display_set_foreground_color(COLOR_GREEN);
-    display_set_background_color(COLOR_BLACK);
-    // display_set_font(&font_small);
-    display_draw_string(5, LCD_HEIGHT - 15, batt_str);
-    // Draw battery icon outline/fill based on percentage
 
-    // Draw Signal Indicators
-    display_color_t left_color = COLOR_WHITE;
-    display_color_t right_color = COLOR_WHITE;
-    // Use signal_state_t enum values (assuming they match Brain Module)
-    enum { SIG_OFF, SIG_LEFT, SIG_RIGHT, SIG_HAZARD };
-    if (last_status_data.signal_status == SIG_LEFT || last_status_data.signal_status == SIG_HAZARD) {
-        left_color = COLOR_ORANGE;
+    int16_t x = w->box.x + display_text_width(text, prefix);
+    int16_t new_mid = display_text_width(&text[prefix], len - prefix - suffix);
+    int16_t old_mid = display_text_width(&shown[prefix], shown_len - prefix - suffix);
+    display_set_foreground_color(widget_fg(w));
+    display_set_background_color(w->bg);
+    if (new_mid == old_mid) {
+        // Same width: the suffix has not moved
+        display_draw_text_run(x, w->box.y, &text[prefix], len - prefix - suffix);
+    } else {
+        int16_t end = x + display_draw_text_run(x, w->box.y, &text[prefix], len - prefix);
+        int16_t old_end = w->box.x + display_text_width(shown, shown_len);
+        if (old_end > end) {
+            display_fill_rect(end, w->box.y, old_end - end, w->box.h, w->bg);
+        }
     }
-    if (last_status_data.signal_status == SIG_RIGHT || last_status_data.signal_status == SIG_HAZARD) {
-        right_color = COLOR_ORANGE;
+    memcpy(shown, text, len + 1);
+    return true;
+}
+
+#if ENABLE_DISPLAY_COMPOSITOR
+// Paints a band and every widget in it as one composited pass: one window,
+// each pixel sent once, so a full repaint does not flash the background.
+static void compose_band(const ui_band_t *band) {
+    display_list_begin(band->rect.x, band->rect.y, band->rect.w, band->rect.h, band->color);
+    for (uint8_t id = 0; id < layout.widget_count; ++id) {
+        ui_widget_t w;
+        ui_layout_read_widget(&layout, id, &w);
+        if (!rect_intersects(&w.box, &band->rect)) continue;
+
+        uint16_t key = source_key(w.source);
+        shown_key[id] = key;
+        switch (w.type) {
+            case UI_WIDGET_TEXT:
+            case UI_WIDGET_NUMBER: {
+                char *text = shown_text[layout.text_slot[id]]; // Stays valid until display_refresh()
+                format_text(&w, key, text, TEXT_MAX_CHARS + 1);
+                display_set_font(w.font);
+                uint8_t len = fit_text(text, w.box.w);
+                display_set_foreground_color(widget_fg(&w));
+                display_set_background_color(w.bg);
+                display_list_add_text(w.box.x, w.box.y, text, len, 0);
+                break;
+            }
+            case UI_WIDGET_INDICATOR:
+                display_list_add_rect(w.box.x, w.box.y, w.box.w, w.box.h, indicator_color(&w, key));
+                break;
+            case UI_WIDGET_ICON:
+                maneuver_ui_add_icon(w.box.x, w.box.y, (uint8_t)key, (uint8_t)(key >> 8), widget_fg(&w), w.bg);
+                break;
+        }
     }
-    // Draw left arrow indicator
-    display_fill_rect(LCD_WIDTH / 2 - 20, LCD_HEIGHT - 15, 10, 10, left_color);
-    // Draw right arrow indicator
-    display_fill_rect(LCD_WIDTH / 2 + 10, LCD_HEIGHT - 15, 10, 10, right_color);
+    display_refresh();
+}
+#endif
 
+// Redraws every widget whose source value differs from what it last rendered.
+static void render(void) {
+    ui_band_t band;
+    if (full_repaint) {
+        log_debug("ScreenUpdater: Full repaint");
+        full_repaint = false;
+#if ENABLE_DISPLAY_COMPOSITOR
+        for (uint8_t i = 0; i < layout.band_count; ++i) {
+            ui_layout_read_band(&layout, i, &band);
+            compose_band(&band);
+        }
+        stale_mask = 0;
+        return;
+#else
+        for (uint8_t i = 0; i < layout.band_count; ++i) {
+            ui_layout_read_band(&layout, i, &band);
+            queue_fill(band.rect, band.color);
+        }
+        memset(shown_text, 0, sizeof(shown_text)); // Text boxes now show plain background
+        stale_mask = (uint8_t)((1U << layout.widget_count) - 1);
+#endif
+    }
 
-    // Draw Speed
-    char speed_str[15];
-    snprintf(speed_str, sizeof(speed_str), "%u km/h", last_status_data.speed_kmh);
-    display_set_foreground_color(COLOR_WHITE);
-    display_draw_string(LCD_WIDTH - 50, LCD_HEIGHT - 15, speed_str);
+    // Pass 1: indicators queue their fills; text and icons are drawn over them
+    uint8_t due = 0;
+    for (uint8_t id = 0; id < layout.widget_count; ++id) {
+        uint16_t key = source_key(pgm_read_byte(&layout.widgets[id].source)); // Only unchanged widgets skip the copy
+        if (key == shown_key[id] && !(stale_mask & (1U << id))) continue;
 
-    // Draw BLE connection status icon (placeholder)
-    display_fill_rect(LCD_WIDTH - 10, LCD_HEIGHT - 15, 5, 10, ble_rx_is_connected() ? COLOR_BLUE : COLOR_RED);
+        shown_key[id] = key;
+        if (pgm_read_byte(&layout.widgets[id].type) == UI_WIDGET_INDICATOR) {
+            ui_widget_t w;
+            ui_layout_read_widget(&layout, id, &w);
+            queue_fill(w.box, indicator_color(&w, key));
+        } else {
+            due |= (uint8_t)(1U << id);
+        }
+    }
+    stale_mask = 0;
+    flush_fills();
 
+    // Pass 2: icons (opaque, no fill of their own) and text
+    uint8_t runs = 0;
+    for (uint8_t id = 0; due != 0; ++id, due >>= 1) {
+        if (!(due & 1)) continue;
+        ui_widget_t w;
+        ui_layout_read_widget(&layout, id, &w);
+        if (w.type == UI_WIDGET_ICON) {
+            uint16_t key = shown_key[id];
+            maneuver_ui_draw_icon(w.box.x, w.box.y, (uint8_t)key, (uint8_t)(key >> 8), widget_fg(&w), w.bg);
+        } else if (draw_text_widget(id, &w, shown_key[id])) {
+            runs++;
+        }
+    }
+    log_debug("ScreenUpdater: %u text runs redrawn", runs);
 }
 
 // --- Public API Implementation ---
 
 void screen_updater_init(void) {
     log_info("Screen Updater: Initializing...");
+    active_layout_id = settings_get()->layout;
+    if (!ui_layout_load(active_layout_id, &layout)) {
+        active_layout_id = SCREEN_DEFAULT_LAYOUT;
+        ui_layout_load(active_layout_id, &layout);
+    }
+    settings_revision = settings_get_revision();
     // Initialize internal state with default values
-    ble_rx_get_nav_data(&last_nav_data); // Get initial default nav message
+    last_nav_data.maneuver = NAV_MANEUVER_NO_LINK; // Until the first NAV frame arrives
+    ble_rx_get_nav_data(&last_nav_data);
     ble_rx_get_status_data(&last_status_data);
     last_battery_percent = battery_status_get_level_percent();
     last_charge_state = battery_status_get_charge_state();
+    last_link_state = ble_rx_get_link_state();
     // Display driver should be initialized before this
+    full_repaint = true;
+    render();
     log_info("Screen Updater: Initialized.");
 }
 
+void screen_updater_invalidate_all(void) {
+    full_repaint = true;
+}
+
+bool screen_updater_set_layout(uint8_t layout_id) {
+    if (!ui_layout_load(layout_id, &layout)) {
+        log_warn("ScreenUpdater: Layout %u not available", layout_id);
+        return false;
+    }
+    active_layout_id = layout_id;
+    log_info("ScreenUpdater: Layout %u", layout_id);
+    full_repaint = true; // Applied on the next update
+    return true;
+}
+
 void screen_updater_update(void) {
-    // This function is called periodically or when data changes.
+    // This function is called periodically; only changed widgets are redrawn.
+    PERF_SCOPE(SCREEN_UPDATE);
 
-    bool screen_needs_update = false;
+    if (settings_revision != settings_get_revision()) {
+        settings_revision = settings_get_revision();
+        if (settings_get()->layout != active_layout_id) {
+            screen_updater_set_layout(settings_get()->layout); // Changed over the link
+        }
+    }
+
+    bool inputs_changed = full_repaint;
 
     // Check for new data from BLE Receiver
     display_nav_data_t new_nav_data;
     if (ble_rx_get_nav_data(&new_nav_data)) {
-        // Compare with last data to see if redraw is needed
-        if (strcmp(last_nav_data.instruction, new_nav_data.instruction) != 0 ||
-            last_nav_data.distance_m != new_nav_data.distance_m) {
-            memcpy(&last_nav_data, &new_nav_data, sizeof(last_nav_data));
-            screen_needs_update = true; // Redraw navigation area
-            log_debug("ScreenUpdater: Nav data changed.");
-        }
+        memcpy(&last_nav_data, &new_nav_data, sizeof(last_nav_data));
+        inputs_changed = true;
     }
 
     display_status_data_t new_status_data;
     if (ble_rx_get_status_data(&new_status_data)) {
-         if (memcmp(&last_status_data, &new_status_data, sizeof(last_status_data)) != 0) {
-             memcpy(&last_status_data, &new_status_data, sizeof(last_status_data));
-             screen_needs_update = true; // Redraw status area
-             log_debug("ScreenUpdater: Status data changed.");
-         }
+        memcpy(&last_status_data, &new_status_data, sizeof(last_status_data));
+        inputs_changed = true;
     }
 
-    // Check for changes in battery status (polled separately)
+    // Check for changes in battery and link status (polled separately)
     uint8_t new_batt_percent = battery_status_get_level_percent();
     battery_charge_state_t new_charge_state = battery_status_get_charge_state();
     if (new_batt_percent != last_battery_percent || new_charge_state != last_charge_state) {
         last_battery_percent = new_batt_percent;
         last_charge_state = new_charge_state;
-        screen_needs_update = true; // Redraw status area
-        log_debug("ScreenUpdater: Battery status changed.");
+        inputs_changed = true;
+    }
+    uint8_t link_state = ble_rx_get_link_state();
+    if (link_state != last_link_state) {
+        log_info("ScreenUpdater: Link state %u", link_state);
+        last_link_state = link_state;
+        full_repaint = true; // Every Brain-fed widget changes ink
+        inputs_changed = true;
     }
 
-    // If any data changed, redraw relevant parts of the screen
-    if (screen_needs_update) {
-        log_info("ScreenUpdater: Updating screen...");
-        // Redraw specific areas based on which data changed, or redraw all for simplicity
-        draw_navigation_area();
-        draw_status_area();
-        // display_refresh(); // Call if using a framebuffer
+    // Widgets compare against what they last rendered, so unchanged ones cost nothing
+    if (inputs_changed) {
+        render();
     } else {
         log_debug("ScreenUpdater: No changes detected, skipping redraw.");
     }
 }
-
-
-// Placeholder header file content (modules/screen_updater.h) would look like:
-/*
-#ifndef MODULES_SCREEN_UPDATER_H
-#define MODULES_SCREEN_UPDATER_H
-
-void screen_updater_init(void);
-void screen_updater_update(void); // Call periodically or on data change
-
-#endif // MODULES_SCREEN_UPDATER_H
-*/
@@ -0,0 +1,225 @@
+/**
+ * @file settings.c
+ * @brief Persistent settings in EEPROM, changed through the Brain (see settings.h).
+ *
+ * As on the Brain, each setting is a row of setting_table, indexed by its
+ * ble_config_key_t without BLE_CONFIG_KEY_DISPLAY: where it sits in settings_t
+ * and the range a SET must respect. A loaded copy is checked against the same
+ * ranges, so a value a newer table rejects falls back to its default.
+ */
+
+#include "modules/settings.h"
+#include "modules/ota.h"       // For OTA_FLAG_ADDR
+#include "modules/ui_layout.h" // For UI_LAYOUT_COUNT
+#include "util/persist.h"
+#include "util/logger.h"
+#include "ble_protocol.h" // For BLE_MSG_DISPLAY_CONFIG_*, ble_config_key_t
+#include "link_mux.h"
+#include "config.h"
+#include <avr/pgmspace.h>
+#include <stddef.h> // For offsetof
+#include <string.h> // For memcpy
+
+// --- Defines ---
+#ifndef SETTINGS_SAVE_DELAY_MS
+#define SETTINGS_SAVE_DELAY_MS 2000
+#endif
+#define SETTINGS_VERSION 1 // Bump when settings_t changes layout
+#define SETTINGS_SLOTS   2
+
+_Static_assert(sizeof(settings_t) <= PERSIST_MAX_LENGTH, "settings_t too large for a persist record");
+_Static_assert(SETTINGS_EEPROM_BASE + PERSIST_SIZE(sizeof(settings_t), SETTINGS_SLOTS) <= OTA_FLAG_ADDR,
+               "Settings overlap the OTA flag in EEPROM");
+
+#define SETTINGS_DEFAULTS {                                 \
+    .battery_r1_ohms = BATTERY_SENSE_R1_OHMS,               \
+    .battery_r2_ohms = BATTERY_SENSE_R2_OHMS,               \
+    .battery_vref_mv = BATTERY_ADC_VREF_MV,                 \
+    .screen_interval_ms = SCREEN_UPDATE_INTERVAL_MS,        \
+    .battery_interval_ms = BATTERY_UPDATE_INTERVAL_MS,      \
+    .layout = SCREEN_DEFAULT_LAYOUT,                        \
+}
+
+typedef struct {
+    uint8_t offset; // In settings_t
+    uint8_t size;   // 1 or 2 bytes
+    uint16_t min;
+    uint16_t max;
+} setting_info_t;
+
+#define SETTING(field, lo, hi) { offsetof(settings_t, field), sizeof(((settings_t *)0)->field), lo, hi }
+#define KEY_INDEX(key) ((uint8_t)((key) & ~BLE_CONFIG_KEY_DISPLAY))
+
+// The battery scale needs R2 >= 100; the screen period keeps the UI responsive.
+static const setting_info_t setting_table[] PROGMEM = {
+    [KEY_INDEX(BLE_CONFIG_DISPLAY_BATTERY_R1_OHMS)] = SETTING(battery_r1_ohms, 0, 65535),
+    [KEY_INDEX(BLE_CONFIG_DISPLAY_BATTERY_R2_OHMS)] = SETTING(battery_r2_ohms, 100, 65535),
+    [KEY_INDEX(BLE_CONFIG_DISPLAY_BATTERY_VREF_MV)] = SETTING(battery_vref_mv, 1000, 5500),
+    [KEY_INDEX(BLE_CONFIG_DISPLAY_LAYOUT)]          = SETTING(layout, 0, UI_LAYOUT_COUNT - 1),
+    [KEY_INDEX(BLE_CONFIG_DISPLAY_SCREEN_MS)]       = SETTING(screen_interval_ms, 20, 1000),
+    [KEY_INDEX(BLE_CONFIG_DISPLAY_BATTERY_MS)]      = SETTING(battery_interval_ms, 250, 60000),
+};
+#define SETTING_COUNT (sizeof(setting_table) / sizeof(setting_table[0]))
+
+// --- Internal State ---
+static const settings_t defaults PROGMEM = SETTINGS_DEFAULTS;
+static settings_t current = SETTINGS_DEFAULTS;
+static uint8_t revision = 0;
+static bool dirty = false; // Changed since the last save
+static uint32_t changed_ms = 0;
+static persist_record_t record = {
+    .base = SETTINGS_EEPROM_BASE,
+    .length = sizeof(settings_t),
+    .slots = SETTINGS_SLOTS,
+    .version = SETTINGS_VERSION,
+};
+
+// --- Internal Helper Functions ---
+
+static bool lookup(uint8_t key, setting_info_t *info) {
+    if (!(key & BLE_CONFIG_KEY_DISPLAY) || KEY_INDEX(key) >= SETTING_COUNT) return false;
+    memcpy_P(info, &setting_table[KEY_INDEX(key)], sizeof(*info));
+    return info->size != 0; // Gaps in the table are unknown keys
+}
+
+static uint16_t read_field(const settings_t *s, const setting_info_t *info) {
+    const uint8_t *p = (const uint8_t *)s + info->offset;
+    uint16_t value = p[0];
+    if (info->size == 2) {
+        memcpy(&value, p, sizeof(value));
+    }
+    return value;
+}
+
+static void write_field(settings_t *s, const setting_info_t *info, uint16_t value) {
+    uint8_t *p = (uint8_t *)s + info->offset;
+    if (info->size == 2) {
+        memcpy(p, &value, sizeof(value));
+    } else {
+        p[0] = (uint8_t)value;
+    }
+}
+
+// Replaces out-of-range values with their defaults; returns how many were replaced.
+static uint8_t sanitize(settings_t *s) {
+    settings_t fallback;
+    memcpy_P(&fallback, &defaults, sizeof(fallback));
+    uint8_t replaced = 0;
+    for (uint8_t index = 0; index < SETTING_COUNT; ++index) {
+        setting_info_t info;
+        if (!lookup(index | BLE_CONFIG_KEY_DISPLAY, &info)) continue;
+        uint16_t value = read_field(s, &info);
+        if (value < info.min || value > info.max) {
+            write_field(s, &info, read_field(&fallback, &info));
+            replaced++;
+        }
+    }
+    return replaced;
+}
+
+static void mark_changed(uint32_t now_ms) {
+    revision++;
+    dirty = true;
+    changed_ms = now_ms;
+}
+
+// Best effort: with the link TX full the answer is dropped and the phone asks again.
+static void send_value(uint8_t key, uint16_t value, uint8_t status) {
+    uint8_t payload[BLE_CONFIG_VALUE_LEN];
+    uint8_t frame[BLE_PROTO_OVERHEAD + BLE_CONFIG_VALUE_LEN];
+    payload[0] = key;
+    ble_put_u16(&payload[1], value);
+    payload[3] = status;
+    size_t frame_len = ble_frame_encode(frame, sizeof(frame), BLE_MSG_DISPLAY_CONFIG_VALUE, payload, sizeof(payload));
+    link_mux_send(LINK_CHANNEL_DATA, frame, frame_len);
+}
+
+static void handle_set(const uint8_t *payload, uint8_t length, uint32_t now_ms) {
+    if (length < BLE_CONFIG_SET_LEN) {
+        send_value(length ? payload[0] : BLE_CONFIG_KEY_DISPLAY, 0, BLE_CONFIG_INVALID);
+        return;
+    }
+    uint8_t key = payload[0];
+    uint16_t value = ble_get_u16(&payload[1]);
+    if (key == BLE_CONFIG_DISPLAY_DEFAULTS) {
+        memcpy_P(&current, &defaults, sizeof(current));
+        mark_changed(now_ms);
+        send_value(key, 0, BLE_CONFIG_OK);
+        log_info("Settings: Defaults restored");
+        return;
+    }
+
+    setting_info_t info;
+    if (!lookup(key, &info)) {
+        send_value(key, 0, BLE_CONFIG_UNKNOWN);
+        return;
+    }
+    if (value < info.min || value > info.max) {
+        send_value(key, read_field(&current, &info), BLE_CONFIG_RANGE);
+        return;
+    }
+    if (value != read_field(&current, &info)) {
+        write_field(&current, &info, value);
+        mark_changed(now_ms);
+        log_info("Settings: Key 0x%02X = %u", key, value);
+    }
+    send_value(key, value, BLE_CONFIG_OK);
+}
+
+static void handle_get(const uint8_t *payload, uint8_t length) {
+    if (length < BLE_CONFIG_GET_LEN) {
+        send_value(BLE_CONFIG_KEY_DISPLAY, 0, BLE_CONFIG_INVALID);
+        return;
+    }
+    setting_info_t info;
+    if (!lookup(payload[0], &info)) {
+        send_value(payload[0], 0, BLE_CONFIG_UNKNOWN);
+        return;
+    }
+    send_value(payload[0], read_field(&current, &info), BLE_CONFIG_OK);
+}
+
+// --- Public API Implementation ---
+
+void settings_init(void) {
+    dirty = false;
+    if (!persist_load(&record, &current)) {
+        memcpy_P(&current, &defaults, sizeof(current));
+        log_info("Settings: No saved settings, using defaults");
+    } else {
+        uint8_t replaced = sanitize(&current);
+        log_info("Settings: Loaded copy %u (%u out of range, defaulted)", record.seq, replaced);
+    }
+    revision++;
+}
+
+const settings_t *settings_get(void) {
+    return &current;
+}
+
+uint8_t settings_get_revision(void) {
+    return revision;
+}
+
+bool settings_handle_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length, uint32_t now_ms) {
+    switch (msg_id) {
+        case BLE_MSG_DISPLAY_CONFIG_SET:
+            handle_set(payload, length, now_ms);
+            return true;
+        case BLE_MSG_DISPLAY_CONFIG_GET:
+            handle_get(payload, length);
+            return true;
+        default:
+            return false;
+    }
+}
+
+void settings_poll(uint32_t now_ms) {
+    if (!dirty || now_ms - changed_ms < SETTINGS_SAVE_DELAY_MS) {
+        return;
+    }
+    if (persist_save(&record, &current)) { // Busy with another record: retried on the next poll
+        dirty = false;
+        log_info("Settings: Saved (copy %u)", record.seq);
+    }
+}
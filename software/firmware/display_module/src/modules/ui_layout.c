@@ -0,0 +1,131 @@
+/**
+ * @file ui_layout.c
+ * @brief The screen layouts (see ui_layout.h), all in flash.
+ */
+
+#include "modules/ui_layout.h"
+#include "modules/maneuver_ui.h" // For MANEUVER_ICON_SIZE
+#include "config.h"
+#include <avr/pgmspace.h>
+#include <stddef.h> // For NULL
+
+// --- Defines ---
+#define NAV_AREA_HEIGHT   (LCD_HEIGHT / 2)
+#define STATUS_BAR_HEIGHT 20
+#define STATUS_BAR_Y      (LCD_HEIGHT - STATUS_BAR_HEIGHT)
+#define STATUS_ROW_Y      (LCD_HEIGHT - 15)
+#define ICON_X            ((LCD_WIDTH - MANEUVER_ICON_SIZE) / 2)
+#define COLOR_DIM         0x2104 // Dark gray, for unlit marks at night
+
+#define UI_TEXT(x, y, w, font, font_h, source, fg, bg) \
+    { { (x), (y), (w), (font_h) }, UI_WIDGET_TEXT, (source), &(font), (fg), (bg), "" }
+#define UI_NUMBER(x, y, w, font, font_h, source, suffix, fg, bg) \
+    { { (x), (y), (w), (font_h) }, UI_WIDGET_NUMBER, (source), &(font), (fg), (bg), suffix }
+#define UI_INDICATOR(x, y, w, h, source, on, off) \
+    { { (x), (y), (w), (h) }, UI_WIDGET_INDICATOR, (source), NULL, (on), (off), "" }
+#define UI_ICON(x, y, source, fg, bg) \
+    { { (x), (y), MANEUVER_ICON_SIZE, MANEUVER_ICON_SIZE }, UI_WIDGET_ICON, (source), NULL, (fg), (bg), "" }
+
+#define UI_COUNT(table) ((uint8_t)(sizeof(table) / sizeof((table)[0])))
+#define UI_LAYOUT(widgets, bands) \
+    { (widgets), (bands), UI_COUNT(widgets), 0, UI_COUNT(bands), { 0 } }
+// The text widget limit is checked by ui_layout_load(): flash tables are not constant expressions.
+#define UI_LAYOUT_CHECK(widgets, bands)                                                       \
+    _Static_assert(UI_COUNT(widgets) <= UI_LAYOUT_MAX_WIDGETS, #widgets ": too many widgets"); \
+    _Static_assert(UI_COUNT(bands) <= UI_LAYOUT_MAX_BANDS, #bands ": too many bands")
+
+// --- Day ---
+static const ui_band_t day_bands[] PROGMEM = {
+    { { 0, 0, LCD_WIDTH, NAV_AREA_HEIGHT }, COLOR_BLUE },
+    { { 0, STATUS_BAR_Y, LCD_WIDTH, STATUS_BAR_HEIGHT }, COLOR_BLACK },
+};
+
+static const ui_widget_t day_widgets[] PROGMEM = {
+    UI_TEXT(5, 10, LCD_WIDTH - 10, display_font_small, DISPLAY_FONT_SMALL_HEIGHT, UI_SOURCE_INSTRUCTION,
+            COLOR_WHITE, COLOR_BLUE),
+    UI_NUMBER(5, 26, LCD_WIDTH - 10, display_font_large, DISPLAY_FONT_LARGE_HEIGHT, UI_SOURCE_DISTANCE, " m",
+              COLOR_WHITE, COLOR_BLUE),
+    UI_NUMBER(2, STATUS_ROW_Y, 32, display_font_small, DISPLAY_FONT_SMALL_HEIGHT, UI_SOURCE_BATTERY, "%",
+              COLOR_GREEN, COLOR_BLACK),                                   // "100%+"
+    UI_NUMBER(LCD_WIDTH - 60, STATUS_ROW_Y, 52, display_font_small, DISPLAY_FONT_SMALL_HEIGHT, UI_SOURCE_SPEED,
+              " km/h", COLOR_WHITE, COLOR_BLACK),                          // "255 km/h"
+    UI_ICON(ICON_X, 46, UI_SOURCE_MANEUVER, COLOR_YELLOW, COLOR_BLUE),
+    UI_INDICATOR(40, STATUS_ROW_Y, 10, 10, UI_SOURCE_SIGNAL_LEFT, COLOR_ORANGE, COLOR_WHITE),
+    UI_INDICATOR(54, STATUS_ROW_Y, 10, 10, UI_SOURCE_SIGNAL_RIGHT, COLOR_ORANGE, COLOR_WHITE),
+    UI_INDICATOR(LCD_WIDTH - 8, STATUS_ROW_Y, 5, 10, UI_SOURCE_LINK, COLOR_BLUE, COLOR_RED),
+};
+UI_LAYOUT_CHECK(day_widgets, day_bands);
+
+// --- Night: the day layout on black, nothing brighter than the signals ---
+static const ui_band_t night_bands[] PROGMEM = {
+    { { 0, 0, LCD_WIDTH, NAV_AREA_HEIGHT }, COLOR_BLACK },
+    { { 0, STATUS_BAR_Y, LCD_WIDTH, STATUS_BAR_HEIGHT }, COLOR_BLACK },
+};
+
+static const ui_widget_t night_widgets[] PROGMEM = {
+    UI_TEXT(5, 10, LCD_WIDTH - 10, display_font_small, DISPLAY_FONT_SMALL_HEIGHT, UI_SOURCE_INSTRUCTION,
+            COLOR_GRAY, COLOR_BLACK),
+    UI_NUMBER(5, 26, LCD_WIDTH - 10, display_font_large, DISPLAY_FONT_LARGE_HEIGHT, UI_SOURCE_DISTANCE, " m",
+              COLOR_RED, COLOR_BLACK),
+    UI_NUMBER(2, STATUS_ROW_Y, 32, display_font_small, DISPLAY_FONT_SMALL_HEIGHT, UI_SOURCE_BATTERY, "%",
+              COLOR_GRAY, COLOR_BLACK),
+    UI_NUMBER(LCD_WIDTH - 60, STATUS_ROW_Y, 52, display_font_small, DISPLAY_FONT_SMALL_HEIGHT, UI_SOURCE_SPEED,
+              " km/h", COLOR_GRAY, COLOR_BLACK),
+    UI_ICON(ICON_X, 46, UI_SOURCE_MANEUVER, COLOR_RED, COLOR_BLACK),
+    UI_INDICATOR(40, STATUS_ROW_Y, 10, 10, UI_SOURCE_SIGNAL_LEFT, COLOR_ORANGE, COLOR_DIM),
+    UI_INDICATOR(54, STATUS_ROW_Y, 10, 10, UI_SOURCE_SIGNAL_RIGHT, COLOR_ORANGE, COLOR_DIM),
+    UI_INDICATOR(LCD_WIDTH - 8, STATUS_ROW_Y, 5, 10, UI_SOURCE_LINK, COLOR_DIM, COLOR_RED),
+};
+UI_LAYOUT_CHECK(night_widgets, night_bands);
+
+// --- Minimal HUD: icon, distance and speed on black; marks only when needed ---
+static const ui_band_t minimal_bands[] PROGMEM = {
+    { { 0, 0, LCD_WIDTH, LCD_HEIGHT }, COLOR_BLACK },
+};
+
+static const ui_widget_t minimal_widgets[] PROGMEM = {
+    UI_NUMBER(5, 60, LCD_WIDTH - 10, display_font_large, DISPLAY_FONT_LARGE_HEIGHT, UI_SOURCE_DISTANCE, " m",
+              COLOR_WHITE, COLOR_BLACK),
+    UI_NUMBER(5, 100, LCD_WIDTH - 10, display_font_large, DISPLAY_FONT_LARGE_HEIGHT, UI_SOURCE_SPEED, " km/h",
+              COLOR_WHITE, COLOR_BLACK),
+    UI_ICON(ICON_X, 16, UI_SOURCE_MANEUVER, COLOR_WHITE, COLOR_BLACK),
+    UI_INDICATOR(0, LCD_HEIGHT - 10, 20, 10, UI_SOURCE_SIGNAL_LEFT, COLOR_ORANGE, COLOR_BLACK),
+    UI_INDICATOR(LCD_WIDTH - 20, LCD_HEIGHT - 10, 20, 10, UI_SOURCE_SIGNAL_RIGHT, COLOR_ORANGE, COLOR_BLACK),
+    UI_INDICATOR(LCD_WIDTH - 4, 0, 4, 4, UI_SOURCE_LINK, COLOR_BLACK, COLOR_RED), // Red corner while disconnected
+};
+UI_LAYOUT_CHECK(minimal_widgets, minimal_bands);
+
+static const ui_layout_t layouts[UI_LAYOUT_COUNT] PROGMEM = {
+    [UI_LAYOUT_DAY]     = UI_LAYOUT(day_widgets, day_bands),
+    [UI_LAYOUT_NIGHT]   = UI_LAYOUT(night_widgets, night_bands),
+    [UI_LAYOUT_MINIMAL] = UI_LAYOUT(minimal_widgets, minimal_bands),
+};
+
+// --- Public API Implementation ---
+
+bool ui_layout_load(uint8_t id, ui_layout_t *layout) {
+    if (id >= UI_LAYOUT_COUNT || !layout) return false;
+    ui_layout_t loaded;
+    memcpy_P(&loaded, &layouts[id], sizeof(loaded));
+    loaded.text_count = 0;
+    for (uint8_t i = 0; i < loaded.widget_count; ++i) {
+        uint8_t type = pgm_read_byte(&loaded.widgets[i].type);
+        if (type != UI_WIDGET_TEXT && type != UI_WIDGET_NUMBER) {
+            loaded.text_slot[i] = 0; // Unused
+        } else if (loaded.text_count < UI_LAYOUT_MAX_TEXT) {
+            loaded.text_slot[i] = loaded.text_count++;
+        } else {
+            return false; // The caller's layout stays as it was
+        }
+    }
+    *layout = loaded;
+    return true;
+}
+
+void ui_layout_read_widget(const ui_layout_t *layout, uint8_t index, ui_widget_t *widget) {
+    memcpy_P(widget, &layout->widgets[index], sizeof(*widget));
+}
+
+void ui_layout_read_band(const ui_layout_t *layout, uint8_t index, ui_band_t *band) {
+    memcpy_P(band, &layout->bands[index], sizeof(*band));
+}
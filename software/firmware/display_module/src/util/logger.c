@@ -1,12 +1,17 @@
 /**
  * @file logger.c
  * @brief Simple logging utility for the Display Module.
- * Sends log messages over the BLE UART interface.
+ * Sends log messages on the log channel of the link (link_mux.h).
+ * Text output (LOG_TOKENIZED 0); tokenized records are queued by common/src/util/log_queue.c.
  */
 
 #include "util/logger.h"
 #include "hal/uart.h"
+#include "link_mux.h"
 #include "config.h"
+#if LOG_TO_DEBUG_PIN
+#include "hal/debug_uart.h"
+#endif
 #include <stdio.h>
 #include <stdarg.h>
 #include <string.h>
@@ -15,28 +20,49 @@
 
 #define LOG_BUFFER_SIZE 128
 static bool logger_initialized = false;
+static uint16_t lines_dropped = 0; // Lines refused by the link since the last summary
 
-// Sends the string over the log UART.
+// Opens the log output: the debug pin software UART or LOG_UART_ID.
+static void log_output_init(void) {
+#if LOG_TO_DEBUG_PIN
+    hal_debug_uart_init(LOG_DEBUG_BAUD);
+#else
+    hal_uart_init(LOG_UART_ID, LOG_UART_BAUD, 8, 1, 0);
+#endif
+}
+
+// Sends the string on the log channel; refused lines are summarized later.
 static void log_send_string(const char *str) {
     if (!logger_initialized) {
        // Attempt basic init as fallback, but logger_init should be called first.
-       hal_uart_init(LOG_UART_ID, LOG_UART_BAUD, 8, 1, 0);
+       // Mark initialized first: hal_uart_init() logs, which would recurse here.
        logger_initialized = true;
+       log_output_init();
+    }
+    if (lines_dropped != 0) {
+        char note[40];
+        int n = snprintf(note, sizeof(note), "[WRN] %u log lines dropped\r\n", lines_dropped);
+        if (!link_mux_send(LINK_CHANNEL_LOG, (const uint8_t*)note, (size_t)n)) {
+            if (lines_dropped != UINT16_MAX) lines_dropped++;
+            return;
+        }
+        lines_dropped = 0;
+    }
+    if (!link_mux_send(LINK_CHANNEL_LOG, (const uint8_t*)str, strlen(str)) && lines_dropped != UINT16_MAX) {
+        lines_dropped++;
     }
-    hal_uart_write(LOG_UART_ID, (const uint8_t*)str, strlen(str));
 }
 
 void logger_init(void) {
-    // Initialize the UART used for logging.
-    hal_uart_init(LOG_UART_ID, LOG_UART_BAUD, 8, 1, 0);
+    // Initialize the output used for logging.
+    log_output_init();
     logger_initialized = true;
+    log_queue_init(); // Tokenized records queue up from here on
     log_send_string("\r\n--- Display Logger Initialized ---\r\n");
 }
 
 void log_message(log_level_t level, const char *file, int line, const char *format, ...) {
-    if (level < LOG_LEVEL) {
-        return; // Skip message if below configured level
-    }
+    // Levels below LOG_LEVEL are compiled out by the log_* macros
 
     char buffer[LOG_BUFFER_SIZE];
     char *buf_ptr = buffer;
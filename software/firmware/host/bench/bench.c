@@ -0,0 +1,95 @@
+/**
+ * @file bench.c
+ * @brief Tick sources and result formatting for the bench programs.
+ */
+
+#include "bench.h"
+#include <stdio.h>
+
+#if defined(__AVR__)
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+// --- Internal State ---
+static volatile uint16_t overflows = 0;
+
+ISR(TIMER1_OVF_vect) {
+    overflows++;
+}
+
+void bench_init(void) {
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10); // clk/1: one tick per CPU cycle
+    TIMSK1 = _BV(TOIE1);
+    sei();
+}
+
+uint64_t bench_ticks(void) {
+    uint16_t low, high;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        low = TCNT1;
+        high = overflows;
+        if ((TIFR1 & _BV(TOV1)) && low < 0x8000) high++;
+    }
+    return ((uint32_t)high << 16) | low; // 32 bits: stages must stay under 268 s
+}
+
+uint64_t bench_ns(void) {
+    return bench_ticks() * 1000000000ULL / F_CPU;
+}
+
+const char *bench_tick_name(void) {
+    return "AVR cycles";
+}
+
+#else // Host
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+void bench_init(void) {}
+
+uint64_t bench_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t bench_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return bench_ns();
+#endif
+}
+
+const char *bench_tick_name(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return "TSC cycles";
+#else
+    return "ns";
+#endif
+}
+
+#endif // __AVR__
+
+void bench_start(bench_time_t *t) {
+    t->ns = bench_ns();
+    t->ticks = bench_ticks();
+}
+
+void bench_stop(bench_time_t *t) {
+    t->ticks = bench_ticks() - t->ticks;
+    t->ns = bench_ns() - t->ns;
+}
+
+void bench_report(const char *name, const char *unit, uint32_t units, const bench_time_t *t) {
+    double per_unit = units ? (double)t->ticks / units : 0.0;
+    double rate = t->ns ? units * 1e9 / (double)t->ns : 0.0;
+    printf("%-16s %8lu %-6s %12.1f us %10.1f cyc/%-6s %12.0f %s/s\n", name, (unsigned long)units, unit,
+           t->ns / 1000.0, per_unit, unit, rate, unit);
+}
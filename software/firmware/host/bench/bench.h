@@ -0,0 +1,48 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/**
+ * @file bench.h
+ * @brief Timing and reporting helpers shared by the bench programs.
+ *
+ * On the host, bench_ticks() is the x86 time-stamp counter (or nanoseconds on
+ * other CPUs); under simavr it is the AVR's own cycle count from Timer1 at
+ * clk/1, so the same report gives real ATmega328P cycles.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+    uint64_t ticks; // bench_ticks() delta
+    uint64_t ns;    // Wall time (derived from ticks on the AVR)
+} bench_time_t;
+
+/** @brief Prepares the tick source. */
+void bench_init(void);
+
+/** @brief Current tick count (cycles). */
+uint64_t bench_ticks(void);
+
+/** @brief Current time in nanoseconds. */
+uint64_t bench_ns(void);
+
+/** @brief Starts a measurement. */
+void bench_start(bench_time_t *t);
+
+/** @brief Ends a measurement started with bench_start(). */
+void bench_stop(bench_time_t *t);
+
+/**
+ * @brief Prints one result line: total time and cost per unit.
+ * @param name Stage name.
+ * @param unit Unit of work ("byte", "frame", ...).
+ * @param units Number of units processed.
+ * @param t Measurement.
+ */
+void bench_report(const char *name, const char *unit, uint32_t units, const bench_time_t *t);
+
+/** @brief Name of the tick source, for the report header. */
+const char *bench_tick_name(void);
+
+#endif // BENCH_H
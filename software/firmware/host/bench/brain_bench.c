@@ -0,0 +1,340 @@
+/**
+ * @file brain_bench.c
+ * @brief Replays an NMEA trace through the Brain Module's GPS parser,
+ * navigation and BLE encoder on the simulated HAL.
+ *
+ * Stages:
+ * - nmea_parse: the whole trace through gps_process_char(), nothing else.
+ * - pipeline: the trace again at its own pace (time follows the fix
+ *   timestamps), with nav_logic_update() every NAV_UPDATE_INTERVAL_MS and
+ *   status_publisher_update() every STATUS_PUBLISH_INTERVAL_MS, as the
+ *   scheduler would run them, against a route built from the trace itself.
+ * - ble_encode / ble_decode: status frames through the encoder and back
+ *   through the frame parser.
+ *
+ * Usage: brain_bench <trace.nmea> [ble_capture_out]
+ * The capture holds every byte the Brain sent on the BLE UART, timestamped
+ * (see display_bench.c), for replay on the display side.
+ *
+ * Built for the AVR (make sim), the trace is compiled in from trace_data.h
+ * and the report goes to USART0, which simavr prints.
+ */
+
+#include "bench.h"
+#include "host_sim.h"
+#include "modules/gps.h"
+#include "modules/nav_logic.h"
+#include "modules/route_store.h"
+#include "modules/status_publisher.h"
+#include "modules/ble_uart.h"
+#include "hal/timer.h"
+#include "hal/uart.h"
+#include "ble_protocol.h"
+#include "nav_maneuver.h"
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+
+// --- Defines ---
+#define ROUTE_TARGET_POINTS 40   // Route points taken from the trace
+#define SIM_STEP_MS         10   // Scheduler emulation resolution
+#define CODEC_FRAMES        2048 // Frames per codec stage
+#define CODEC_KEEP_FRAMES   32   // Encoded frames replayed by the decoder stage
+#define CAPTURE_MAGIC       "HVCAP1"
+
+// --- Trace Source ---
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include "trace_data.h" // Generated by make sim: trace_data[] in flash, TRACE_DATA_LEN
+
+static uint32_t trace_len = TRACE_DATA_LEN;
+static inline uint8_t trace_byte(uint32_t i) { return pgm_read_byte(&trace_data[i]); }
+
+static int uart_putchar(char c, FILE *stream) {
+    (void)stream;
+    if (c == '\n') uart_putchar('\r', stream);
+    while (!(UCSR0A & _BV(UDRE0))) {}
+    UDR0 = (uint8_t)c;
+    return 0;
+}
+static FILE uart_stdout = FDEV_SETUP_STREAM(uart_putchar, NULL, _FDEV_SETUP_WRITE);
+#else
+#include <stdlib.h>
+
+static uint8_t *trace = NULL;
+static uint32_t trace_len = 0;
+static inline uint8_t trace_byte(uint32_t i) { return trace[i]; }
+#endif
+
+// --- Internal State ---
+static FILE *capture = NULL;
+static uint32_t ble_frames = 0;
+static uint32_t ble_bytes = 0;
+
+// --- Helper Functions ---
+
+static uint32_t fix_time_ms(const gps_data_t *fix) {
+    return ((fix->hour * 60UL + fix->minute) * 60UL + fix->second) * 1000UL + fix->millisecond;
+}
+
+// Counts the frames in the bytes sent on the BLE UART and appends them to the capture.
+static void drain_ble(void) {
+    const uint8_t *data;
+    size_t len = host_uart_take_tx(BLE_UART_ID, &data);
+    if (len == 0) return;
+    for (size_t i = 0; i < len; ++i) {
+        if (data[i] == BLE_PACKET_START_BYTE) ble_frames++; // Upper bound: payload bytes may match
+    }
+    ble_bytes += len;
+    if (capture) {
+        uint8_t header[6];
+        ble_put_u32(&header[0], hal_timer_millis());
+        ble_put_u16(&header[4], (uint16_t)len);
+        fwrite(header, 1, sizeof(header), capture);
+        fwrite(data, 1, len, capture);
+    }
+}
+
+static void send_phone_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length) {
+    route_store_handle_frame(msg_id, payload, length);
+    for (uint8_t i = 0; i < BLE_PROTO_MAX_PAYLOAD && i <= length; ++i) {
+        route_store_poll(); // One EEPROM byte per poll on the target
+    }
+    drain_ble();
+}
+
+// Turns every n-th fix of the trace into a route and loads it like the phone would.
+static uint16_t load_route_from_trace(void) {
+    uint32_t fixes = 0;
+    gps_data_t fix;
+    gps_init();
+    for (uint32_t i = 0; i < trace_len; ++i) {
+        gps_process_char(trace_byte(i));
+        if (gps_is_data_available() && gps_get_data(&fix)) fixes++;
+    }
+    if (fixes < 2) return 0;
+
+    uint32_t step = (fixes + ROUTE_TARGET_POINTS - 1) / ROUTE_TARGET_POINTS;
+    uint16_t count = (uint16_t)((fixes - 1) / step + 1);
+    uint8_t payload[BLE_PROTO_MAX_PAYLOAD];
+    ble_put_u16(&payload[0], count);
+    ble_put_u16(&payload[2], 0x4242); // route_id
+    send_phone_frame(BLE_MSG_ROUTE_BEGIN, payload, BLE_ROUTE_BEGIN_LEN);
+
+    uint16_t sent = 0, in_frame = 0;
+    uint32_t n = 0;
+    gps_init();
+    for (uint32_t i = 0; i < trace_len && sent < count; ++i) {
+        gps_process_char(trace_byte(i));
+        if (!gps_is_data_available() || !gps_get_data(&fix)) continue;
+        if (n++ % step != 0) continue;
+
+        if (in_frame == 0) ble_put_u16(&payload[BLE_ROUTE_PTS_OFS_FIRST], sent);
+        uint8_t *pt = &payload[BLE_ROUTE_PTS_OFS_DATA + in_frame * BLE_ROUTE_PT_LEN];
+        ble_put_u32(&pt[BLE_ROUTE_PT_OFS_LAT], (uint32_t)fix.latitude_e6);
+        ble_put_u32(&pt[BLE_ROUTE_PT_OFS_LON], (uint32_t)fix.longitude_e6);
+        pt[BLE_ROUTE_PT_OFS_MANEUVER] = (sent == 0) ? NAV_MANEUVER_DEPART :
+                                        (sent == count - 1) ? NAV_MANEUVER_ARRIVE :
+                                        (sent % 3 == 0) ? NAV_MANEUVER_LEFT :
+                                        (sent % 3 == 1) ? NAV_MANEUVER_RIGHT : NAV_MANEUVER_NONE;
+        pt[BLE_ROUTE_PT_OFS_ARG] = 0;
+        sent++;
+        if (++in_frame == BLE_ROUTE_PTS_PER_FRAME || sent == count) {
+            send_phone_frame(BLE_MSG_ROUTE_POINTS, payload,
+                             (uint8_t)(BLE_ROUTE_PTS_OFS_DATA + in_frame * BLE_ROUTE_PT_LEN));
+            in_frame = 0;
+        }
+    }
+    ble_put_u16(&payload[0], count);
+    send_phone_frame(BLE_MSG_ROUTE_END, payload, BLE_ROUTE_END_LEN);
+    return route_store_get_count();
+}
+
+// Runs the periodic tasks until the simulated clock reaches target_ms.
+static void run_until(uint32_t target_ms, bench_time_t *nav_time, uint32_t *nav_calls,
+                      bench_time_t *pub_time, uint32_t *pub_calls) {
+    while ((int32_t)(target_ms - hal_timer_millis()) >= SIM_STEP_MS) {
+        hal_timer_advance_ms(SIM_STEP_MS);
+        uint32_t now = hal_timer_millis();
+        if (now % NAV_UPDATE_INTERVAL_MS == 0) {
+            bench_time_t t;
+            nav_logic_set_speed(gps_get_speed_kmh_x10());
+            bench_start(&t);
+            nav_logic_update();
+            bench_stop(&t);
+            nav_time->ticks += t.ticks;
+            nav_time->ns += t.ns;
+            (*nav_calls)++;
+        }
+        if (now % STATUS_PUBLISH_INTERVAL_MS == 0) {
+            bench_time_t t;
+            status_publisher_set_speed((uint8_t)(gps_get_speed_kmh_x10() / 10));
+            bench_start(&t);
+            status_publisher_update(now);
+            bench_stop(&t);
+            pub_time->ticks += t.ticks;
+            pub_time->ns += t.ns;
+            (*pub_calls)++;
+        }
+        drain_ble();
+    }
+}
+
+// --- Stages ---
+
+static void stage_parse(void) {
+    uint32_t fixes = 0;
+    gps_data_t fix;
+    bench_time_t t;
+    gps_init();
+    bench_start(&t);
+    for (uint32_t i = 0; i < trace_len; ++i) {
+        gps_process_char(trace_byte(i));
+        if (gps_is_data_available()) {
+            gps_get_data(&fix);
+            fixes++;
+        }
+    }
+    bench_stop(&t);
+    bench_report("nmea_parse", "byte", trace_len, &t);
+    printf("%-16s %8lu fixes\n", "", (unsigned long)fixes);
+}
+
+static void stage_pipeline(void) {
+    bench_time_t total, nav = { 0, 0 }, pub = { 0, 0 };
+    uint32_t nav_calls = 0, pub_calls = 0;
+    uint32_t base_ms = 0, first_fix_ms = 0;
+    bool have_base = false;
+    gps_data_t fix;
+
+    gps_init();
+    nav_logic_init();
+    status_publisher_init();
+    status_publisher_set_battery(3900);
+    ble_frames = ble_bytes = 0;
+
+    bench_start(&total);
+    for (uint32_t i = 0; i < trace_len; ++i) {
+        gps_process_char(trace_byte(i));
+        if (!gps_is_data_available()) continue;
+
+        bool valid = gps_get_data(&fix);
+        uint32_t fix_ms = fix_time_ms(&fix);
+        if (!have_base) {
+            base_ms = hal_timer_millis();
+            first_fix_ms = fix_ms;
+            have_base = true;
+        }
+        run_until(base_ms + (fix_ms - first_fix_ms), &nav, &nav_calls, &pub, &pub_calls);
+        nav_logic_set_gps_data(valid ? &fix : NULL);
+    }
+    bench_stop(&total);
+
+    bench_report("pipeline", "byte", trace_len, &total);
+    bench_report("nav_update", "call", nav_calls, &nav);
+    bench_report("status_publish", "call", pub_calls, &pub);
+    printf("%-16s %8lu frames, %lu bytes on BLE over %lu ms simulated\n", "ble_out",
+           (unsigned long)ble_frames, (unsigned long)ble_bytes, (unsigned long)(hal_timer_millis() - base_ms));
+}
+
+static void stage_codec(void) {
+    static uint8_t stream[CODEC_KEEP_FRAMES * (BLE_STATUS_LEN + BLE_PROTO_OVERHEAD)];
+    size_t stream_len = 0;
+    bench_time_t t;
+
+    bench_start(&t);
+    for (uint16_t i = 0; i < CODEC_FRAMES; ++i) {
+        ble_uart_send_status_update(3700 + (i & 0xFF), (uint8_t)(i & 3), (uint8_t)(i % 60));
+        const uint8_t *data;
+        size_t len = host_uart_take_tx(BLE_UART_ID, &data);
+        if (stream_len + len <= sizeof(stream)) {
+            memcpy(&stream[stream_len], data, len); // Keep some frames for the decoder
+            stream_len += len;
+        }
+    }
+    bench_stop(&t);
+    bench_report("ble_encode", "frame", CODEC_FRAMES, &t);
+
+    ble_parser_t parser;
+    uint32_t frames = 0;
+    ble_parser_init(&parser);
+    bench_start(&t);
+    for (uint16_t pass = 0; pass < CODEC_FRAMES / CODEC_KEEP_FRAMES; ++pass) {
+        for (size_t i = 0; i < stream_len; ++i) {
+            if (ble_parser_feed(&parser, stream[i])) frames++;
+        }
+    }
+    bench_stop(&t);
+    bench_report("ble_decode", "frame", frames, &t);
+}
+
+// --- Main ---
+
+int main(int argc, char **argv) {
+#if defined(__AVR__)
+    (void)argc;
+    (void)argv;
+    UBRR0 = 8; // 115200 baud at 16 MHz (U2X off); simavr ignores the rate
+    UCSR0B = _BV(TXEN0);
+    stdout = &uart_stdout;
+#else
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace.nmea> [ble_capture_out]\n", argv[0]);
+        return 2;
+    }
+    FILE *f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    trace_len = (uint32_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    trace = malloc(trace_len ? trace_len : 1);
+    if (!trace || fread(trace, 1, trace_len, f) != trace_len) {
+        fprintf(stderr, "%s: read failed\n", argv[1]);
+        return 1;
+    }
+    fclose(f);
+#endif
+
+    bench_init();
+    hal_timer_init();
+    ble_uart_init();
+    route_store_init();
+    ble_uart_set_frame_handler(route_store_handle_frame);
+
+    printf("Brain Module bench: %lu trace bytes, times in %s\n", (unsigned long)trace_len, bench_tick_name());
+    stage_parse();
+
+    printf("%-16s %8u points\n", "route_load", load_route_from_trace());
+    for (const char *s = "CONNECT\r\n"; *s; ++s) {
+        ble_uart_process_char((uint8_t)*s); // The BLE module reports a phone link
+    }
+    drain_ble();
+
+#if !defined(__AVR__)
+    if (argc > 2) {
+        capture = fopen(argv[2], "wb");
+        if (!capture) {
+            perror(argv[2]);
+            return 1;
+        }
+        fwrite(CAPTURE_MAGIC, 1, strlen(CAPTURE_MAGIC), capture);
+    }
+#endif
+    stage_pipeline();
+    if (capture) fclose(capture);
+
+    stage_codec();
+    printf("%-16s %8lu log calls\n", "logger", (unsigned long)host_log_count());
+
+#if defined(__AVR__)
+    cli();
+    sleep_mode(); // simavr ends the run when the CPU sleeps with interrupts off
+#endif
+    return 0;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file display_bench.c
+ * @brief Replays a BLE capture through the Display Module's frame receiver and
+ * screen updater, with the LCD on the byte-counting SPI backend.
+ *
+ * Stages:
+ * - ble_rx: every captured byte through ble_rx_process_char(), nothing else.
+ * - screen: the capture at its own pace, screen_updater_update() every
+ *   SCREEN_UPDATE_INTERVAL_MS and ble_rx_service() every LINK_ACK_INTERVAL_MS,
+ *   as the scheduler would run them. Reports the
+ *   cost per update and the SPI traffic per frame that drew anything.
+ *
+ * Usage: display_bench <capture>
+ * The capture is either the timestamped file written by brain_bench
+ * ("HVCAP1", then records of ms (u32) | length (u16) | bytes) or a raw byte
+ * stream, which is paced at BLE_UART_BAUD.
+ */
+
+#include "bench.h"
+#include "host_sim.h"
+#include "modules/display_driver.h"
+#include "modules/ble_rx.h"
+#include "modules/battery_status.h"
+#include "modules/screen_updater.h"
+#include "hal/timer.h"
+#include "ble_protocol.h"
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Defines ---
+#define CAPTURE_MAGIC     "HVCAP1"
+#define CAPTURE_MAGIC_LEN 6
+#define RAW_BYTES_PER_MS  ((BLE_UART_BAUD / 10 + 999) / 1000) // 8N1 line rate
+
+// --- Internal State ---
+typedef struct {
+    const uint8_t *bytes;
+    size_t length;
+    size_t pos;
+    bool timestamped;
+} capture_t;
+
+typedef struct {
+    bench_time_t time;
+    uint32_t updates;
+    uint32_t frames;       // Updates that sent anything to the LCD
+    uint64_t spi_bytes;
+    uint64_t cs_asserts;
+    uint32_t max_frame_bytes;
+} screen_stats_t;
+
+// --- Helper Functions ---
+
+// Returns the next chunk of the capture and the time it arrived at.
+static bool next_chunk(capture_t *c, uint32_t *at_ms, const uint8_t **data, size_t *len) {
+    if (c->pos >= c->length) return false;
+    if (!c->timestamped) {
+        *at_ms = (uint32_t)(c->pos / RAW_BYTES_PER_MS);
+        *data = &c->bytes[c->pos];
+        *len = RAW_BYTES_PER_MS;
+        if (*len > c->length - c->pos) *len = c->length - c->pos;
+        c->pos += *len;
+        return true;
+    }
+    if (c->length - c->pos < 6) return false;
+    *at_ms = ble_get_u32(&c->bytes[c->pos]);
+    *len = ble_get_u16(&c->bytes[c->pos + 4]);
+    c->pos += 6;
+    if (*len > c->length - c->pos) *len = c->length - c->pos;
+    *data = &c->bytes[c->pos];
+    c->pos += *len;
+    return true;
+}
+
+static void screen_update(screen_stats_t *s) {
+    bench_time_t t;
+    host_spi_reset_stats();
+    bench_start(&t);
+    screen_updater_update();
+    bench_stop(&t);
+
+    host_spi_stats_t spi;
+    host_spi_get_stats(&spi);
+    s->time.ticks += t.ticks;
+    s->time.ns += t.ns;
+    s->updates++;
+    if (spi.bytes > 0) {
+        s->frames++;
+        s->spi_bytes += spi.bytes;
+        s->cs_asserts += spi.cs_asserts;
+        if (spi.bytes > s->max_frame_bytes) s->max_frame_bytes = spi.bytes;
+    }
+}
+
+// Runs the periodic display tasks until the simulated clock reaches target_ms.
+static void run_until(uint32_t target_ms, screen_stats_t *s) {
+    while ((int32_t)(target_ms - hal_timer_millis()) > 0) {
+        hal_timer_advance_ms(1);
+        uint32_t now = hal_timer_millis();
+        if (now % SCREEN_UPDATE_INTERVAL_MS == 0) screen_update(s);
+        if (now % BATTERY_UPDATE_INTERVAL_MS == 0) battery_status_update();
+        if (now % LINK_ACK_INTERVAL_MS == 0) ble_rx_service(); // Link state deadlines
+    }
+}
+
+// --- Stages ---
+
+static void stage_ble_rx(capture_t c) {
+    bench_time_t t;
+    uint32_t bytes = 0, at_ms;
+    const uint8_t *data;
+    size_t len;
+
+    ble_rx_init();
+    bench_start(&t);
+    while (next_chunk(&c, &at_ms, &data, &len)) {
+        for (size_t i = 0; i < len; ++i) ble_rx_process_char(data[i]);
+        bytes += (uint32_t)len;
+    }
+    bench_stop(&t);
+    bench_report("ble_rx", "byte", bytes, &t);
+}
+
+static void stage_screen(capture_t c) {
+    screen_stats_t s;
+    uint32_t at_ms;
+    const uint8_t *data;
+    size_t len;
+
+    memset(&s, 0, sizeof(s));
+    ble_rx_init();
+    screen_updater_init();
+    while (next_chunk(&c, &at_ms, &data, &len)) {
+        run_until(at_ms, &s);
+        for (size_t i = 0; i < len; ++i) ble_rx_process_char(data[i]);
+    }
+    run_until(hal_timer_millis() + SCREEN_UPDATE_INTERVAL_MS, &s); // Draw the last frame
+
+    bench_report("screen_update", "call", s.updates, &s.time);
+    printf("%-16s %8lu frames drawn, SPI %.0f bytes/frame avg, %lu max, %.1f transactions/frame\n", "spi",
+           (unsigned long)s.frames, s.frames ? (double)s.spi_bytes / s.frames : 0.0,
+           (unsigned long)s.max_frame_bytes, s.frames ? (double)s.cs_asserts / s.frames : 0.0);
+}
+
+// --- Main ---
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <capture>\n", argv[0]);
+        return 2;
+    }
+    FILE *f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    size_t length = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *bytes = malloc(length ? length : 1);
+    if (!bytes || fread(bytes, 1, length, f) != length) {
+        fprintf(stderr, "%s: read failed\n", argv[1]);
+        return 1;
+    }
+    fclose(f);
+
+    capture_t capture = { bytes, length, 0, false };
+    if (length >= CAPTURE_MAGIC_LEN && memcmp(bytes, CAPTURE_MAGIC, CAPTURE_MAGIC_LEN) == 0) {
+        capture.timestamped = true;
+        capture.pos = CAPTURE_MAGIC_LEN;
+    }
+
+    bench_init();
+    hal_timer_init();
+    display_init();
+    battery_status_init();
+
+    printf("Display Module bench: %lu capture bytes (%s), times in %s\n", (unsigned long)length,
+           capture.timestamped ? "timestamped" : "raw", bench_tick_name());
+    stage_ble_rx(capture);
+    stage_screen(capture);
+    printf("%-16s %8lu log calls\n", "logger", (unsigned long)host_log_count());
+    free(bytes);
+    return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+/**
+ * @file host_sim.h
+ * @brief Controls and counters of the simulated HAL used by the bench programs.
+ *
+ * - Time only moves when the bench calls hal_timer_advance_ms().
+ * - UART transmit data is captured per UART until the bench takes it.
+ * - SPI and GPIO writes are counted, not performed.
+ * - EEPROM is a RAM array and is always ready.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint32_t bytes;        // Bytes clocked out (commands, parameters and pixels)
+    uint32_t transfers;    // hal_spi_* calls and stream starts
+    uint32_t cs_asserts;   // LCD chip-select falling edges (one per transaction)
+    uint32_t gpio_writes;  // All hal_gpio_write() calls and direct port writes
+} host_spi_stats_t;
+
+/**
+ * @brief Returns and clears the bytes transmitted on a UART since the last call.
+ * @param uart_id UART to read (as uart_id_t).
+ * @param data Receives a pointer to the bytes, valid until the next UART write.
+ * @return Number of bytes.
+ */
+size_t host_uart_take_tx(int uart_id, const uint8_t **data);
+
+/** @brief Copies the SPI/GPIO counters. */
+void host_spi_get_stats(host_spi_stats_t *stats);
+
+/** @brief Clears the SPI/GPIO counters. */
+void host_spi_reset_stats(void);
+
+/** @brief Number of log calls that reached the logger. */
+uint32_t host_log_count(void);
+
+#endif // HOST_SIM_H
@@ -0,0 +1,13 @@
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+/**
+ * @file interrupt.h
+ * @brief Host build: there are no interrupts; ISRs become plain functions.
+ */
+
+#define ISR(vector, ...) void vector(void); void vector(void)
+#define sei() do { } while (0)
+#define cli() do { } while (0)
+
+#endif // HOST_AVR_INTERRUPT_H
@@ -0,0 +1,58 @@
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+/**
+ * @file io.h
+ * @brief Host build: stands in for avr-libc's <avr/io.h>.
+ * Registers are plain variables (src/host_regs.c) so firmware headers and
+ * inline HAL helpers compile; nothing reads them back as hardware.
+ * SPSR always shows SPIF so polling loops fall straight through.
+ */
+
+#include <stdint.h>
+
+#define _BV(bit) (1U << (bit))
+
+#define HOST_REG8_(name) extern volatile uint8_t name;
+#define HOST_REG16_(name) extern volatile uint16_t name;
+
+HOST_REG8_(PORTB) HOST_REG8_(PORTC) HOST_REG8_(PORTD)
+HOST_REG8_(DDRB) HOST_REG8_(DDRC) HOST_REG8_(DDRD)
+HOST_REG8_(PINB) HOST_REG8_(PINC) HOST_REG8_(PIND)
+HOST_REG8_(SPCR) HOST_REG8_(SPDR)
+HOST_REG8_(TCCR1A) HOST_REG8_(TCCR1B) HOST_REG8_(TIMSK1) HOST_REG8_(TIFR1) HOST_REG16_(TCNT1)
+HOST_REG8_(GPIOR0) HOST_REG8_(SREG)
+
+#define SPSR 0x80 // SPIF set: every transfer has "completed"
+#define SPIF 7
+#define SPE  6
+#define MSTR 4
+#define TOV1 0
+#define TOIE1 0
+#define CS10 0
+
+// Pin numbers used by the config.h pin maps
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+#endif // HOST_AVR_IO_H
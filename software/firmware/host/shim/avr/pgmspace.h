@@ -0,0 +1,27 @@
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+/**
+ * @file pgmspace.h
+ * @brief Host build: flash tables are ordinary const data.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <avr/io.h> // As in avr-libc
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr)  (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr)   (*(const void * const *)(addr))
+
+#define memcpy_P  memcpy
+#define strlen_P  strlen
+#define strnlen_P strnlen
+#define strncpy_P strncpy
+
+#endif // HOST_AVR_PGMSPACE_H
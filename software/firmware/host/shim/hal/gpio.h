@@ -0,0 +1,19 @@
+#ifndef HOST_HAL_GPIO_H
+#define HOST_HAL_GPIO_H
+
+/**
+ * @file gpio.h
+ * @brief Host build: the display's hal/gpio.h with the direct port macros
+ * routed through src/host_spi.c, so LCD transactions are still counted.
+ */
+
+#include_next "hal/gpio.h"
+#undef HAL_GPIO_PORT_HIGH
+#undef HAL_GPIO_PORT_LOW
+
+void host_gpio_port_write(volatile uint8_t *port, uint8_t bit, bool state);
+
+#define HAL_GPIO_PORT_HIGH(port, bit) host_gpio_port_write(&(port), (bit), true)
+#define HAL_GPIO_PORT_LOW(port, bit)  host_gpio_port_write(&(port), (bit), false)
+
+#endif // HOST_HAL_GPIO_H
@@ -0,0 +1,22 @@
+#ifndef HOST_HAL_SPI_H
+#define HOST_HAL_SPI_H
+
+/**
+ * @file spi.h
+ * @brief Host build: the display's hal/spi.h with the inline streaming
+ * helpers routed to the byte-counting backend in src/host_spi.c.
+ */
+
+#define hal_spi_stream_start  hal_spi_stream_start_avr_
+#define hal_spi_stream_put    hal_spi_stream_put_avr_
+#define hal_spi_stream_finish hal_spi_stream_finish_avr_
+#include_next "hal/spi.h"
+#undef hal_spi_stream_start
+#undef hal_spi_stream_put
+#undef hal_spi_stream_finish
+
+void hal_spi_stream_start(uint8_t data);
+void hal_spi_stream_put(uint8_t data);
+void hal_spi_stream_finish(void);
+
+#endif // HOST_HAL_SPI_H
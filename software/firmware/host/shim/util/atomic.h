@@ -0,0 +1,13 @@
+#ifndef HOST_UTIL_ATOMIC_H
+#define HOST_UTIL_ATOMIC_H
+
+/**
+ * @file atomic.h
+ * @brief Host build: single-threaded, so an atomic block is just a block.
+ */
+
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 0
+#define ATOMIC_BLOCK(type) for (int atomic_once_ = 1; atomic_once_; atomic_once_ = 0)
+
+#endif // HOST_UTIL_ATOMIC_H
@@ -0,0 +1,12 @@
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+/**
+ * @file delay.h
+ * @brief Host build: busy-wait delays take no time.
+ */
+
+#define _delay_ms(ms) ((void)(ms))
+#define _delay_us(us) ((void)(us))
+
+#endif // HOST_UTIL_DELAY_H
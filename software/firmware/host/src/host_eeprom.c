@@ -0,0 +1,41 @@
+/**
+ * @file host_eeprom.c
+ * @brief Host build: EEPROM HAL backed by RAM, erased (0xFF) at start and
+ * never busy.
+ */
+
+#include "hal/eeprom.h"
+#include <string.h>
+
+// --- Internal State ---
+static uint8_t eeprom[HAL_EEPROM_SIZE];
+static bool erased = false;
+
+// --- Helper Functions ---
+
+static void ensure_erased(void) {
+    if (!erased) {
+        memset(eeprom, 0xFF, sizeof(eeprom));
+        erased = true;
+    }
+}
+
+// --- Public API Implementation ---
+
+void hal_eeprom_read(uint16_t address, void *data, uint16_t length) {
+    ensure_erased();
+    if (!data || address >= HAL_EEPROM_SIZE) return;
+    if (length > HAL_EEPROM_SIZE - address) length = HAL_EEPROM_SIZE - address;
+    memcpy(data, &eeprom[address], length);
+}
+
+bool hal_eeprom_is_ready(void) {
+    return true;
+}
+
+bool hal_eeprom_write_byte(uint16_t address, uint8_t value) {
+    ensure_erased();
+    if (address >= HAL_EEPROM_SIZE) return false;
+    eeprom[address] = value;
+    return true;
+}
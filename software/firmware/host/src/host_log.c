@@ -0,0 +1,40 @@
+/**
+ * @file host_log.c
+ * @brief Host build: logger that only counts calls, so benchmarks measure
+ * the firmware rather than the terminal. Stands in for util/logger.c and
+ * log_queue.c.
+ */
+
+#include "util/logger.h"
+#include "host_sim.h"
+
+// --- Internal State ---
+static uint32_t calls = 0;
+
+// --- Public API Implementation ---
+
+void logger_init(void) {}
+
+void log_message(log_level_t level, const char *file, int line, const char *format, ...) {
+    (void)level; (void)file; (void)line; (void)format;
+    calls++;
+}
+
+void log_tokenized(uint16_t token, uint16_t arg_info, ...) {
+    (void)token; (void)arg_info;
+    calls++;
+}
+
+bool logger_service(void) {
+    return false;
+}
+
+void logger_flush(void) {}
+
+void log_char(char c) {
+    (void)c;
+}
+
+uint32_t host_log_count(void) {
+    return calls;
+}
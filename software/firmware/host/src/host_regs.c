@@ -0,0 +1,14 @@
+/**
+ * @file host_regs.c
+ * @brief Host build: storage for the register stand-ins declared in <avr/io.h>.
+ */
+
+#include <avr/io.h>
+
+volatile uint8_t PORTB, PORTC, PORTD;
+volatile uint8_t DDRB, DDRC, DDRD;
+volatile uint8_t PINB, PINC, PIND;
+volatile uint8_t SPCR, SPDR;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1;
+volatile uint16_t TCNT1;
+volatile uint8_t GPIOR0, SREG;
@@ -0,0 +1,138 @@
+/**
+ * @file host_spi.c
+ * @brief Host build: SPI, GPIO and ADC HAL for the Display Module that count
+ * what would go to the LCD instead of sending it.
+ */
+
+#include "hal/spi.h"
+#include "hal/gpio.h"
+#include "hal/adc.h"
+#include "host_sim.h"
+#include "config.h"
+#include <string.h>
+
+// --- Defines ---
+#define HOST_ADC_READING 2356 // ~3.8 V cell through the 1:1 divider (BATTERY_* in config.h)
+
+// --- Internal State ---
+static host_spi_stats_t stats;
+
+// --- SPI ---
+
+void hal_spi_init(spi_id_t spi_id, uint32_t clock_speed, uint8_t mode, uint8_t bit_order) {
+    (void)spi_id; (void)clock_speed; (void)mode; (void)bit_order;
+}
+
+uint8_t hal_spi_transfer_byte(spi_id_t spi_id, uint8_t data) {
+    (void)spi_id; (void)data;
+    stats.bytes++;
+    stats.transfers++;
+    return 0xFF;
+}
+
+void hal_spi_transfer_multi(spi_id_t spi_id, const uint8_t *tx_buffer, uint8_t *rx_buffer, size_t length) {
+    (void)spi_id; (void)tx_buffer;
+    if (rx_buffer) memset(rx_buffer, 0xFF, length);
+    stats.bytes += length;
+    stats.transfers++;
+}
+
+void hal_spi_write_multi(spi_id_t spi_id, const uint8_t *tx_buffer, size_t length) {
+    (void)spi_id; (void)tx_buffer;
+    stats.bytes += length;
+    stats.transfers++;
+}
+
+void hal_spi_write_repeat16(spi_id_t spi_id, uint16_t value, uint32_t count) {
+    (void)spi_id; (void)value;
+    stats.bytes += count * 2;
+    stats.transfers++;
+}
+
+void hal_spi_read_multi(spi_id_t spi_id, uint8_t *rx_buffer, size_t length) {
+    (void)spi_id;
+    if (rx_buffer) memset(rx_buffer, 0xFF, length);
+    stats.bytes += length;
+    stats.transfers++;
+}
+
+void hal_spi_stream_start(uint8_t data) {
+    (void)data;
+    stats.bytes++;
+    stats.transfers++;
+}
+
+void hal_spi_stream_put(uint8_t data) {
+    (void)data;
+    stats.bytes++;
+}
+
+void hal_spi_stream_finish(void) {}
+
+// --- GPIO ---
+
+void hal_gpio_init(uint8_t pin, gpio_mode_t mode) {
+    (void)pin; (void)mode;
+}
+
+void hal_gpio_write(uint8_t pin, bool state) {
+    stats.gpio_writes++;
+    if (pin == LCD_CS_PIN && !state) {
+        stats.cs_asserts++;
+    }
+}
+
+void host_gpio_port_write(volatile uint8_t *port, uint8_t bit, bool state) {
+    if (state) {
+        *port |= (uint8_t)(1 << bit);
+    } else {
+        *port &= (uint8_t)~(1 << bit);
+    }
+    stats.gpio_writes++;
+    if (port == &LCD_CTRL_PORT && bit == LCD_CS_PIN && !state) {
+        stats.cs_asserts++;
+    }
+}
+
+bool hal_gpio_read(uint8_t pin) {
+    (void)pin;
+    return true; // Charger status open-drain idles high: not charging
+}
+
+void hal_gpio_toggle(uint8_t pin) {
+    (void)pin;
+    stats.gpio_writes++;
+}
+
+bool hal_gpio_configure_interrupt(uint8_t pin, gpio_interrupt_edge_t edge, gpio_interrupt_callback_t callback) {
+    (void)pin; (void)edge; (void)callback;
+    return false;
+}
+
+void hal_gpio_enable_interrupt(uint8_t pin) {
+    (void)pin;
+}
+
+void hal_gpio_disable_interrupt(uint8_t pin) {
+    (void)pin;
+}
+
+// --- ADC ---
+
+void hal_adc_start(uint8_t channel) {
+    (void)channel;
+}
+
+uint16_t hal_adc_get_filtered(void) {
+    return HOST_ADC_READING;
+}
+
+// --- Bench Counters ---
+
+void host_spi_get_stats(host_spi_stats_t *out) {
+    if (out) *out = stats;
+}
+
+void host_spi_reset_stats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,28 @@
+/**
+ * @file host_timer.c
+ * @brief Host build: simulated system tick. Time moves only through
+ * hal_timer_advance_ms(), so replays are deterministic.
+ */
+
+#include "hal/timer.h"
+
+// --- Internal State ---
+static uint32_t millis = 0;
+
+// --- Public API Implementation ---
+
+void hal_timer_init(void) {
+    millis = 0;
+}
+
+uint32_t hal_timer_millis(void) {
+    return millis;
+}
+
+uint32_t hal_timer_micros(void) {
+    return millis * 1000UL;
+}
+
+void hal_timer_advance_ms(uint32_t ms) {
+    millis += ms;
+}
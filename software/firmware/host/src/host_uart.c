@@ -0,0 +1,119 @@
+/**
+ * @file host_uart.c
+ * @brief Host build: UART HAL that captures transmitted bytes for the bench.
+ * The transmit buffer is the capture, so link_mux sees real free space.
+ * Received data is pushed by the bench straight into the parsers, so the
+ * receive side is always empty.
+ */
+
+#include "hal/uart.h"
+#include "host_sim.h"
+#include <string.h>
+
+// --- Defines ---
+#ifndef HOST_UART_CAPTURE_BYTES
+#define HOST_UART_CAPTURE_BYTES 4096 // Per UART; the bench drains it with host_uart_take_tx()
+#endif
+
+// --- Internal State ---
+typedef struct {
+    uint8_t data[HOST_UART_CAPTURE_BYTES];
+    size_t length;
+} tx_capture_t;
+
+static tx_capture_t tx[UART_ID_MAX];
+
+// --- Public API Implementation ---
+
+void hal_uart_init(uart_id_t uart_id, uint32_t baud_rate, uint8_t data_bits, uint8_t stop_bits, uint8_t parity) {
+    (void)uart_id; (void)baud_rate; (void)data_bits; (void)stop_bits; (void)parity;
+}
+
+#ifdef GPS_UART_ID // Brain Module only
+void hal_uart_set_baud(uart_id_t uart_id, uint32_t baud_rate) {
+    (void)uart_id; (void)baud_rate;
+}
+#endif
+
+size_t hal_uart_write(uart_id_t uart_id, const uint8_t *buffer, size_t length) {
+    if (uart_id >= UART_ID_MAX || !buffer) return 0;
+    tx_capture_t *c = &tx[uart_id];
+    if (length > HOST_UART_CAPTURE_BYTES - c->length) {
+        length = HOST_UART_CAPTURE_BYTES - c->length; // Bench did not drain in time
+    }
+    memcpy(&c->data[c->length], buffer, length);
+    c->length += length;
+    return length;
+}
+
+void hal_uart_put_char(uart_id_t uart_id, uint8_t data) {
+    hal_uart_write(uart_id, &data, 1);
+}
+
+size_t hal_uart_tx_space(uart_id_t uart_id) {
+    return (uart_id < UART_ID_MAX) ? HOST_UART_CAPTURE_BYTES - tx[uart_id].length : 0;
+}
+
+bool hal_uart_tx_idle(uart_id_t uart_id) {
+    (void)uart_id;
+    return true;
+}
+
+void hal_uart_set_tx_empty_callback(uart_id_t uart_id, uart_tx_empty_callback_t callback) {
+    (void)uart_id; (void)callback;
+}
+
+int16_t hal_uart_get_char(uart_id_t uart_id) {
+    (void)uart_id;
+    return -1;
+}
+
+bool hal_uart_data_available(uart_id_t uart_id) {
+    (void)uart_id;
+    return false;
+}
+
+size_t hal_uart_read(uart_id_t uart_id, uint8_t *buffer, size_t length) {
+    (void)uart_id; (void)buffer; (void)length;
+    return 0;
+}
+
+size_t hal_uart_rx_span(uart_id_t uart_id, const uint8_t **data) {
+    (void)uart_id;
+    if (data) *data = NULL;
+    return 0;
+}
+
+void hal_uart_rx_consume(uart_id_t uart_id, size_t length) {
+    (void)uart_id; (void)length;
+}
+
+void hal_uart_enable_rx_interrupt(uart_id_t uart_id, uart_rx_callback_t callback) {
+    (void)uart_id; (void)callback;
+}
+
+void hal_uart_disable_rx_interrupt(uart_id_t uart_id) {
+    (void)uart_id;
+}
+
+void hal_uart_flush_rx_buffer(uart_id_t uart_id) {
+    (void)uart_id;
+}
+
+void hal_uart_get_stats(uart_id_t uart_id, uart_stats_t *stats) {
+    (void)uart_id;
+    if (stats) memset(stats, 0, sizeof(*stats));
+}
+
+void hal_uart_clear_stats(uart_id_t uart_id) {
+    (void)uart_id;
+}
+
+size_t host_uart_take_tx(int uart_id, const uint8_t **data) {
+    if (uart_id < 0 || uart_id >= UART_ID_MAX) return 0;
+    tx_capture_t *c = &tx[uart_id];
+    size_t length = c->length;
+    if (data) *data = c->data;
+    c->length = 0;
+    return length;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file link_test.c
+ * @brief Brain Module link state: the CONNECT/DISCONNECT lines of the BLE
+ * module and the display's ACKs decide what status_publisher sends.
+ */
+
+#include "test.h"
+#include "host_sim.h"
+#include "modules/ble_uart.h"
+#include "modules/link_quality.h"
+#include "modules/settings.h"
+#include "modules/status_publisher.h"
+#include "hal/timer.h"
+#include "hal/uart.h"
+#include "ble_protocol.h"
+#include "config.h"
+#include <string.h>
+
+// --- Defines ---
+#define STEP_MS 10
+
+// --- Internal State ---
+static ble_parser_t parser;
+static uint32_t frames[256]; // Sent frames per message id since the last take_frames()
+static uint32_t now = 0;
+
+// --- Helper Functions ---
+
+static void module_line(const char *line) {
+    for (const char *s = line; *s; ++s) ble_uart_process_char((uint8_t)*s);
+}
+
+static void take_frames(void) {
+    memset(frames, 0, sizeof(frames));
+    const uint8_t *data;
+    size_t n = host_uart_take_tx(BLE_UART_ID, &data);
+    for (size_t i = 0; i < n; ++i) {
+        if (ble_parser_feed(&parser, data[i])) frames[parser.msg_id]++;
+    }
+}
+
+static uint32_t total_frames(void) {
+    uint32_t total = 0;
+    for (int i = 0; i < 256; ++i) total += frames[i];
+    return total;
+}
+
+// Runs the publisher as the scheduler would for ms milliseconds.
+static void run_ms(uint32_t ms) {
+    for (uint32_t t = 0; t < ms; t += STEP_MS) {
+        hal_timer_advance_ms(STEP_MS);
+        now += STEP_MS;
+        status_publisher_update(now);
+    }
+}
+
+// Acknowledges the frames sent so far, as the display would; recv_mask
+// bit n set = the nth latest frame arrived.
+static void display_ack_mask(uint8_t recv_mask) {
+    static uint8_t rx_count = 0;
+    uint8_t ack[BLE_LINK_ACK_LEN];
+    ack[0] = (uint8_t)(link_quality_next_seq(false) - 1) & BLE_SEQ_MASK;
+    ack[1] = recv_mask;
+    ack[2] = ++rx_count;
+    link_quality_on_ack(ack, sizeof(ack), now);
+}
+
+static void display_ack(void) {
+    display_ack_mask(0xFF);
+}
+
+static uint16_t retransmits(void) {
+    link_quality_stats_t stats;
+    link_quality_get_stats(&stats);
+    return stats.retransmits;
+}
+
+// --- Main ---
+
+int main(void) {
+    hal_timer_init();
+    settings_init();
+    ble_uart_init();
+    link_quality_init();
+    status_publisher_init();
+    ble_parser_init(&parser);
+    take_frames();
+
+    // Nothing goes out before the module reports a connection
+    run_ms(2000);
+    take_frames();
+    CHECK(total_frames() == 0);
+
+    // CONNECT: keyframe (status and nav) at once
+    module_line("CONNECT\r\n");
+    run_ms(STEP_MS);
+    take_frames();
+    CHECK(frames[BLE_MSG_STATUS_UPDATE] == 1);
+    CHECK(frames[BLE_MSG_NAV_UPDATE] == 1);
+    CHECK(ble_uart_is_connected());
+    display_ack();
+    CHECK(link_quality_is_connected(true, now));
+
+    // DISCONNECT contains "CONNECT": it must still drop the link
+    module_line("DISCONNECT\r\n");
+    CHECK(!ble_uart_is_connected());
+    CHECK(!link_quality_is_connected(false, now));
+    status_publisher_set_speed(42);
+    status_publisher_set_battery(3600);
+    status_publisher_set_nav(1, 0, 500);
+    run_ms(10000);
+    take_frames();
+    CHECK(total_frames() == 0);
+
+    // Reconnected radio, display silent since it last acknowledged: only
+    // heartbeat probes until an ACK comes back, then a keyframe
+    module_line("+CONNECT OK\r\n");
+    CHECK(ble_uart_is_connected());
+    run_ms(5000);
+    take_frames();
+    CHECK(frames[BLE_MSG_HEARTBEAT] > 0);
+    CHECK(total_frames() == frames[BLE_MSG_HEARTBEAT]);
+    display_ack();
+    run_ms(STEP_MS);
+    take_frames();
+    CHECK(frames[BLE_MSG_STATUS_UPDATE] == 1);
+    CHECK(frames[BLE_MSG_NAV_UPDATE] == 1);
+
+    // A new maneuver lost every time: resent LINK_RETRANSMIT_MAX times, and
+    // only resends that went out are counted
+    status_publisher_set_nav(2, 0, 400);
+    run_ms(STEP_MS);
+    take_frames();
+    CHECK(frames[BLE_MSG_NAV_UPDATE] == 1);
+    for (int i = 0; i < LINK_RETRANSMIT_MAX + 2; ++i) {
+        display_ack_mask(0x00);
+        run_ms(STEP_MS);
+        take_frames();
+        CHECK(frames[BLE_MSG_NAV_UPDATE] == (i < LINK_RETRANSMIT_MAX ? 1U : 0U));
+    }
+    CHECK(retransmits() == LINK_RETRANSMIT_MAX);
+    display_ack();
+
+    // ACKs stop with the radio still up: publishing stops after the window
+    run_ms(LINK_ALIVE_TIMEOUT_MS + 1000);
+    status_publisher_set_speed(7);
+    run_ms(2000);
+    take_frames();
+    CHECK(frames[BLE_MSG_FIELD_UPDATE] == 0);
+    CHECK(frames[BLE_MSG_STATUS_UPDATE] == 0);
+
+    return TEST_DONE("link_test");
+}
@@ -0,0 +1,134 @@
+/**
+ * @file nav_test.c
+ * @brief Brain Module dead reckoning: guidance coasts on the estimate for
+ * NAV_DR_MAX_COAST_MS after the last valid fix and then reports NO_FIX,
+ * whether the receiver reports the loss or simply goes silent.
+ */
+
+#include "test.h"
+#include "modules/gps.h"
+#include "modules/nav_logic.h"
+#include "modules/route_store.h"
+#include "modules/settings.h"
+#include "modules/status_publisher.h"
+#include "hal/timer.h"
+#include "ble_protocol.h"
+#include "nav_maneuver.h"
+#include "config.h"
+#include <string.h>
+
+// --- Defines ---
+#define START_LAT_E6   48000000L
+#define START_LON_E6   11000000L
+#define ROUTE_STEP_E6  10000L    // ~1.1 km north per route point
+#define SPEED_KMH_X10  360       // 10 m/s
+#define FIX_STEP_E6    90L       // ~10 m north per second
+#define FIX_MS         1000
+
+// --- Internal State ---
+static uint32_t now = 0;
+static int32_t rider_lat_e6 = START_LAT_E6;
+
+// --- Helper Functions ---
+
+static void send_phone_frame(uint8_t msg_id, const uint8_t *payload, uint8_t length) {
+    route_store_handle_frame(msg_id, payload, length);
+    for (uint8_t i = 0; i < BLE_PROTO_MAX_PAYLOAD && i <= length; ++i) {
+        route_store_poll(); // One EEPROM byte per poll
+    }
+}
+
+// Three points due north: depart, turn left, arrive.
+static void load_route(void) {
+    static const uint8_t maneuvers[3] = { NAV_MANEUVER_DEPART, NAV_MANEUVER_LEFT, NAV_MANEUVER_ARRIVE };
+    uint8_t payload[BLE_PROTO_MAX_PAYLOAD];
+    ble_put_u16(&payload[0], 3);
+    ble_put_u16(&payload[2], 0x4242); // route_id
+    send_phone_frame(BLE_MSG_ROUTE_BEGIN, payload, BLE_ROUTE_BEGIN_LEN);
+
+    ble_put_u16(&payload[BLE_ROUTE_PTS_OFS_FIRST], 0);
+    for (uint8_t i = 0; i < 3; ++i) {
+        uint8_t *pt = &payload[BLE_ROUTE_PTS_OFS_DATA + i * BLE_ROUTE_PT_LEN];
+        ble_put_u32(&pt[BLE_ROUTE_PT_OFS_LAT], (uint32_t)(START_LAT_E6 + i * ROUTE_STEP_E6));
+        ble_put_u32(&pt[BLE_ROUTE_PT_OFS_LON], (uint32_t)START_LON_E6);
+        pt[BLE_ROUTE_PT_OFS_MANEUVER] = maneuvers[i];
+        pt[BLE_ROUTE_PT_OFS_ARG] = 0;
+    }
+    send_phone_frame(BLE_MSG_ROUTE_POINTS, payload, BLE_ROUTE_PTS_OFS_DATA + 3 * BLE_ROUTE_PT_LEN);
+
+    ble_put_u16(&payload[0], 3);
+    send_phone_frame(BLE_MSG_ROUTE_END, payload, BLE_ROUTE_END_LEN);
+}
+
+static void feed_fix(bool valid) {
+    gps_data_t fix;
+    memset(&fix, 0, sizeof(fix));
+    fix.latitude_e6 = rider_lat_e6;
+    fix.longitude_e6 = START_LON_E6;
+    fix.speed_kmh_x10 = SPEED_KMH_X10;
+    fix.course_deg_x100 = 0;
+    fix.fix_valid = valid;
+    fix.fix_quality = valid ? 1 : 0;
+    nav_logic_set_gps_data(valid ? &fix : NULL);
+}
+
+// Runs the nav task for ms milliseconds. With fixes, one arrives every
+// FIX_MS and the rider moves on; without, the receiver says nothing.
+static void ride_ms(uint32_t ms, bool fixes) {
+    for (uint32_t t = 0; t < ms; t += NAV_UPDATE_INTERVAL_MS) {
+        hal_timer_advance_ms(NAV_UPDATE_INTERVAL_MS);
+        now += NAV_UPDATE_INTERVAL_MS;
+        if (now % FIX_MS == 0) {
+            rider_lat_e6 += FIX_STEP_E6;
+            if (fixes) feed_fix(true);
+        }
+        nav_logic_set_speed(SPEED_KMH_X10);
+        nav_logic_update();
+    }
+}
+
+static bool guiding(void) {
+    uint8_t m = nav_logic_get_maneuver();
+    return m != NAV_MANEUVER_NO_FIX && m != NAV_MANEUVER_NO_ROUTE;
+}
+
+// --- Main ---
+
+int main(void) {
+    hal_timer_init();
+    settings_init();
+    route_store_init();
+    load_route();
+    CHECK(route_store_get_count() == 3);
+    nav_logic_init();
+    status_publisher_init();
+
+    // Guidance on a steady stream of fixes
+    ride_ms(5000, true);
+    CHECK(guiding());
+    CHECK(nav_logic_get_maneuver() == NAV_MANEUVER_LEFT);
+
+    // Receiver goes silent: no invalid fix, just nothing. The estimate
+    // coasts through the window and then expires.
+    ride_ms(NAV_DR_MAX_COAST_MS - FIX_MS, false);
+    CHECK(guiding());
+    ride_ms(FIX_MS, false);
+    CHECK(nav_logic_get_maneuver() == NAV_MANEUVER_NO_FIX);
+    ride_ms(5000, false);
+    CHECK(nav_logic_get_maneuver() == NAV_MANEUVER_NO_FIX);
+
+    // The next fix brings guidance back
+    feed_fix(true);
+    ride_ms(NAV_UPDATE_INTERVAL_MS, false);
+    CHECK(guiding());
+
+    // The receiver reports the loss
+    ride_ms(FIX_MS, true);
+    feed_fix(false);
+    ride_ms(NAV_DR_MAX_COAST_MS - 2 * FIX_MS, false);
+    CHECK(guiding());
+    ride_ms(2 * FIX_MS, false);
+    CHECK(nav_logic_get_maneuver() == NAV_MANEUVER_NO_FIX);
+
+    return TEST_DONE("nav_test");
+}
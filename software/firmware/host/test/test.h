@@ -0,0 +1,25 @@
+#ifndef TEST_H
+#define TEST_H
+
+/**
+ * @file test.h
+ * @brief Minimal checks for the host test programs (make test).
+ * A failed CHECK prints its location and the run exits non-zero at
+ * TEST_DONE(); the remaining checks still run.
+ */
+
+#include <stdio.h>
+
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define TEST_DONE(name) \
+    (printf("%-16s %s\n", name, test_failures ? "FAILED" : "ok"), test_failures ? 1 : 0)
+
+#endif // TEST_H
@@ -0,0 +1,30 @@
+#!/usr/bin/env python3
+"""Turn the start of an NMEA trace into a C header for the simavr bench build.
+
+    embed_trace.py <trace.nmea> <max_bytes> > trace_data.h
+
+The trace is cut after the last complete line that fits in max_bytes, since
+it has to share the ATmega328P's 32 KB of flash with the firmware.
+"""
+
+import sys
+
+
+def main():
+    path, limit = sys.argv[1], int(sys.argv[2])
+    with open(path, "rb") as f:
+        data = f.read(limit)
+    if len(data) == limit and b"\n" in data:
+        data = data[:data.rindex(b"\n") + 1]
+    out = sys.stdout
+    out.write("// Generated by tools/embed_trace.py from %s; do not edit.\n" % path)
+    out.write("#include <avr/pgmspace.h>\n#include <stdint.h>\n\n")
+    out.write("#define TRACE_DATA_LEN %dUL\n" % len(data))
+    out.write("static const uint8_t trace_data[] PROGMEM = {\n")
+    for i in range(0, len(data), 16):
+        out.write("    " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",\n")
+    out.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Generate a synthetic NMEA ride for the host benchmarks.
+
+Writes GGA and RMC at 1 Hz (GSA every 5 s) for a ride of straight legs joined
+by turns, at town speeds. Every 97th sentence has a corrupted checksum so the
+error path is exercised as well. Output is deterministic.
+
+    gen_ride.py [seconds] > data/ride.nmea
+"""
+
+import math
+import sys
+
+START_LAT, START_LON = 47.376900, 8.541700
+LEGS = [  # (seconds, heading change per second in degrees, speed km/h)
+    (40, 0.0, 28), (6, 15.0, 18), (60, 0.0, 35), (5, -18.0, 15),
+    (45, 0.0, 30), (8, 22.5, 12), (50, 0.0, 40), (4, -22.5, 20),
+    (42, 0.0, 25),
+]
+EARTH_M_PER_DEG = 111320.0
+
+
+def checksum(body):
+    c = 0
+    for ch in body.encode("ascii"):
+        c ^= ch
+    return c
+
+
+def coord(value, is_lat):
+    hemi = ("N" if value >= 0 else "S") if is_lat else ("E" if value >= 0 else "W")
+    value = abs(value)
+    deg = int(value)
+    minutes = (value - deg) * 60.0
+    return ("%02d%07.4f" if is_lat else "%03d%07.4f") % (deg, minutes), hemi
+
+
+def main():
+    seconds = int(sys.argv[1]) if len(sys.argv) > 1 else sum(leg[0] for leg in LEGS)
+    lat, lon, heading = START_LAT, START_LON, 90.0
+    schedule = []
+    for duration, turn, speed in LEGS:
+        schedule += [(turn, speed)] * duration
+    sentence_no = 0
+    out = sys.stdout
+    for t in range(seconds):
+        turn, speed = schedule[t % len(schedule)]
+        heading = (heading + turn) % 360.0
+        step = speed / 3.6
+        lat += step * math.cos(math.radians(heading)) / EARTH_M_PER_DEG
+        lon += step * math.sin(math.radians(heading)) / (EARTH_M_PER_DEG * math.cos(math.radians(lat)))
+
+        hh, mm, ss = 10 + t // 3600, (t // 60) % 60, t % 60
+        stamp = "%02d%02d%02d.00" % (hh, mm, ss)
+        la, lah = coord(lat, True)
+        lo, loh = coord(lon, False)
+        bodies = [
+            "GPGGA,%s,%s,%s,%s,%s,1,08,0.9,408.%d,M,47.0,M,," % (stamp, la, lah, lo, loh, t % 10),
+            "GPRMC,%s,A,%s,%s,%s,%s,%.2f,%.1f,140326,,,A" % (stamp, la, lah, lo, loh, speed / 1.852, heading),
+        ]
+        if t % 5 == 0:
+            bodies.append("GPGSA,A,3,04,05,09,12,17,21,24,29,,,,,1.8,0.9,1.5")
+        for body in bodies:
+            sentence_no += 1
+            c = checksum(body)
+            if sentence_no % 97 == 0:
+                c ^= 0x5A  # Corrupted on purpose
+            out.write("$%s*%02X\r\n" % (body, c))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,371 @@
+#!/usr/bin/env python3
+"""Decode Halo Vision log output.
+
+Both firmware trees log over the BLE UART. With LOG_TOKENIZED set in config.h
+each log call sends a BLE_MSG_LOG frame holding only a 16-bit token and the raw
+argument bytes; the format strings stay in the .logfmt section of the ELF
+(see firmware/common/include/util/logger.h). This tool reads that section and
+turns the frames back into text. Anything outside a frame (text mode logs,
+the logger banner) is passed through unchanged.
+
+With ENABLE_PERF_COUNTERS set, --stats sends a BLE_MSG_STATS_REQUEST and
+prints the section timings and counters the module sends back (util/perf.h).
+Stats reports seen in a capture are printed as well.
+
+With ENABLE_RIDE_TRACE set on the Brain Module, --trace starts or stops an
+input capture to the external memory, or a playback of it (ride_trace.h);
+the log then shows its progress.
+
+Examples:
+    diagnostics.py brain_module.elf --port /dev/ttyUSB0
+    diagnostics.py brain_module.elf --input capture.bin
+    diagnostics.py brain_module.elf --dump
+    diagnostics.py brain_module.elf --port /dev/ttyUSB0 --stats --reset
+    diagnostics.py brain_module.elf --port /dev/ttyUSB0 --trace play --speed 4
+"""
+
+import argparse
+import re
+import struct
+import sys
+import time
+
+# --- Protocol constants (firmware/common/include/ble_protocol.h, config.h) ---
+START_BYTE = 0xAA
+END_BYTE = 0x55
+MAX_PAYLOAD = 48
+MSG_TRACE_CONTROL = 0x7C
+MSG_STATS_REQUEST = 0x7D
+MSG_STATS = 0x7E
+MSG_LOG = 0x7F
+STATS_FLAG_RESET = 0x01
+STATS_HEADER, STATS_SECTION, STATS_COUNTER = 0, 1, 2
+TOKEN_DROPPED = 0xFFFF
+TRACE_COMMANDS = {"stop": 0, "capture": 1, "play": 2}
+
+LEVEL_NAMES = {"D": "DBG", "I": "INF", "W": "WRN", "E": "ERR"}
+EM_AVR = 83
+
+# printf conversion: flags, width, precision, length modifier, conversion
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|z|t|j)?([diuxXocspn%])")
+
+
+def crc8(data):
+    """CRC-8/CCITT (poly 0x07, init 0x00), as ble_crc8_update()."""
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def encode_frame(msg_id, payload=b""):
+    """Builds one protocol frame, as ble_frame_encode()."""
+    body = bytes([msg_id, len(payload)]) + payload
+    return bytes([START_BYTE]) + body + bytes([crc8(body), END_BYTE])
+
+
+class LogDictionary:
+    """Token -> (level, location, format) table read from an ELF's .logfmt section."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            elf = f.read()
+        if elf[:4] != b"\x7fELF":
+            raise ValueError(f"{path}: not an ELF file")
+        is64 = elf[4] == 2
+        endian = "<" if elf[5] == 1 else ">"
+        machine = struct.unpack_from(endian + "H", elf, 18)[0]
+        if machine == EM_AVR:
+            self.int_size, self.long_size, self.ptr_size = 2, 4, 2
+        elif is64:
+            self.int_size, self.long_size, self.ptr_size = 4, 8, 8  # Host build (LP64)
+        else:
+            self.int_size, self.long_size, self.ptr_size = 4, 4, 4
+
+        if is64:
+            shoff = struct.unpack_from(endian + "Q", elf, 0x28)[0]
+            shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x3A)
+            section = lambda i: struct.unpack_from(endian + "IIQQQQ", elf, shoff + i * shentsize)
+        else:
+            shoff = struct.unpack_from(endian + "I", elf, 0x20)[0]
+            shentsize, shnum, shstrndx = struct.unpack_from(endian + "HHH", elf, 0x2E)
+            section = lambda i: struct.unpack_from(endian + "IIIIII", elf, shoff + i * shentsize)
+
+        names = section(shstrndx)
+        self.data = None
+        for i in range(shnum):
+            name_ofs, _, _, addr, offset, size = section(i)
+            start = names[4] + name_ofs
+            if elf[start:elf.index(b"\0", start)] == b".logfmt":
+                self.base = addr
+                self.data = elf[offset:offset + size]
+                break
+        if self.data is None:
+            raise ValueError(f"{path}: no .logfmt section (built with LOG_TOKENIZED 0?)")
+
+    def lookup(self, token):
+        """Returns (level, location, format) for a token, or None."""
+        ofs = token - self.base
+        if not 0 <= ofs < len(self.data):
+            return None
+        end = self.data.find(b"\0", ofs)
+        desc = self.data[ofs:end if end >= 0 else len(self.data)].decode("ascii", "replace")
+        parts = desc.split("|", 2)
+        if len(parts) != 3:
+            return None
+        return parts[0], parts[1], parts[2]
+
+    def entries(self):
+        """Yields (token, descriptor) for every string in the section."""
+        ofs = 0
+        while ofs < len(self.data):
+            end = self.data.find(b"\0", ofs)
+            if end < 0:
+                end = len(self.data)
+            if end > ofs:
+                yield self.base + ofs, self.data[ofs:end].decode("ascii", "replace")
+            ofs = end + 1
+
+
+def format_record(fmt, args, sizes):
+    """Applies a printf format to packed little-endian arguments."""
+    int_size, long_size, ptr_size = sizes
+    pos = 0
+    out = []
+    last = 0
+    for m in CONVERSION.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        flags, width, prec, length, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        if conv == "s":
+            if pos < len(args) and pos + 1 + args[pos] <= len(args):
+                n = args[pos]
+                value = args[pos + 1:pos + 1 + n].decode("latin-1")
+                pos += 1 + n
+            else:
+                out.append("?")
+                pos = len(args)
+                continue
+        else:
+            if conv == "p" or length in ("z", "t"):
+                size = ptr_size
+            elif length == "ll" or length == "j":
+                size = 8
+            elif length == "l":
+                size = long_size
+            else:
+                size = int_size  # char and short arrive promoted to int
+            if pos + size > len(args):
+                out.append("?")  # Record truncated by the firmware
+                pos = len(args)
+                continue
+            value = int.from_bytes(args[pos:pos + size], "little", signed=conv in "di")
+            pos += size
+            if conv == "c":
+                value = chr(value & 0xFF)
+            elif conv == "p":
+                conv, flags = "x", "#"
+            elif conv == "u":
+                conv = "d"
+        spec = "%" + flags + (width or "") + ("." + prec if prec else "") + conv
+        out.append(spec % value)
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def decode_log(dictionary, payload):
+    """Turns one BLE_MSG_LOG payload into a log line."""
+    if len(payload) < 2:
+        return "[???] (short log record)"
+    token = payload[0] | (payload[1] << 8)
+    if token == TOKEN_DROPPED and len(payload) >= 4:
+        return "[WRN] (logger) %d log records dropped" % (payload[2] | (payload[3] << 8))
+    entry = dictionary.lookup(token) if dictionary else None
+    if entry is None:
+        return "[???] (unknown token 0x%04X) %s" % (token, payload[2:].hex())
+    level, location, fmt = entry
+    sizes = (dictionary.int_size, dictionary.long_size, dictionary.ptr_size)
+    return "[%s] (%s) %s" % (LEVEL_NAMES.get(level, "???"), location, format_record(fmt, payload[2:], sizes))
+
+
+class StatsReport:
+    """Collects the BLE_MSG_STATS frames of one report (HEADER, SECTIONs, COUNTERs)."""
+
+    def __init__(self):
+        self.header = None
+        self.sections = {}
+        self.counters = {}
+
+    def add(self, payload):
+        """Adds one frame; returns True once the report is complete."""
+        if not payload:
+            return False
+        kind = payload[0]
+        if kind == STATS_HEADER and len(payload) >= 11:
+            window_ms, n_sections, n_counters, cpu_hz = struct.unpack_from("<IBBI", payload, 1)
+            self.header = (window_ms, n_sections, n_counters, cpu_hz)
+            self.sections.clear()
+            self.counters.clear()
+        elif self.header is None:
+            return False  # Joined mid-report: wait for the next header
+        elif kind == STATS_SECTION and len(payload) >= 18:
+            index, count, lo, hi, avg = struct.unpack_from("<BIIII", payload, 1)
+            self.sections[index] = (payload[18:].decode("ascii", "replace"), count, lo, hi, avg)
+        elif kind == STATS_COUNTER and len(payload) >= 6:
+            index, value = struct.unpack_from("<BI", payload, 1)
+            self.counters[index] = (payload[6:].decode("ascii", "replace"), value)
+        _, n_sections, n_counters, _ = self.header
+        return len(self.sections) == n_sections and len(self.counters) == n_counters
+
+    def format(self):
+        window_ms, _, _, cpu_hz = self.header
+        us = lambda cycles: cycles * 1e6 / cpu_hz
+        lines = ["--- stats over %.1f s (cycles at %.1f MHz) ---" % (window_ms / 1000.0, cpu_hz / 1e6),
+                 "%-16s %10s %10s %10s %10s %10s" % ("section", "count", "min", "avg", "max", "max us")]
+        for index in sorted(self.sections):
+            name, count, lo, hi, avg = self.sections[index]
+            lines.append("%-16s %10d %10d %10d %10d %10.1f" % (name, count, lo, avg, hi, us(hi)))
+        lines.append("%-16s %10s %10s" % ("counter", "value", "per s"))
+        for index in sorted(self.counters):
+            name, value = self.counters[index]
+            rate = value * 1000.0 / window_ms if window_ms else 0.0
+            lines.append("%-16s %10d %10.1f" % (name, value, rate))
+        return lines
+
+
+class StreamDecoder:
+    """Splits the UART byte stream into frames and text, like ble_parser_feed()."""
+
+    def __init__(self, dictionary, show_frames=False):
+        self.dictionary = dictionary
+        self.show_frames = show_frames
+        self.pending = bytearray()  # Bytes not yet known to be a frame or text
+        self.text = bytearray()
+        self.stats = StatsReport()
+        self.stats_done = 0  # Complete stats reports seen so far
+
+    def feed(self, data):
+        self.pending += data
+        lines = []
+        while self.pending:
+            if self.pending[0] != START_BYTE:
+                self._text_byte(self.pending.pop(0), lines)
+                continue
+            if len(self.pending) < 3:
+                break
+            length = self.pending[2]
+            if length > MAX_PAYLOAD:
+                self._text_byte(self.pending.pop(0), lines)
+                continue
+            total = 3 + length + 2
+            if len(self.pending) < total:
+                break
+            frame = bytes(self.pending[:total])
+            msg_id = frame[1]
+            if frame[-1] != END_BYTE or crc8(frame[1:3 + length]) != frame[3 + length]:
+                self._text_byte(self.pending.pop(0), lines)  # Not a frame: resync
+                continue
+            del self.pending[:total]
+            payload = frame[3:3 + length]
+            if msg_id == MSG_LOG:
+                lines.append(decode_log(self.dictionary, payload))
+            elif msg_id == MSG_STATS:
+                if self.stats.add(payload):
+                    lines.extend(self.stats.format())
+                    self.stats = StatsReport()
+                    self.stats_done += 1
+            elif self.show_frames:
+                lines.append("<frame 0x%02X> %s" % (msg_id, payload.hex()))
+        return lines
+
+    def _text_byte(self, byte, lines):
+        if byte == 0x0A:
+            line = self.text.decode("latin-1").rstrip("\r")
+            if line:
+                lines.append(line)
+            self.text.clear()
+        elif byte == 0x0D or 0x20 <= byte < 0x7F or byte == 0x09:
+            self.text.append(byte)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode Halo Vision tokenized logs.")
+    parser.add_argument("elf", nargs="?",
+                        help="Firmware ELF the device is running (brain_module.elf or display_module.elf); "
+                             "without it log records show as unknown tokens")
+    source = parser.add_mutually_exclusive_group()
+    source.add_argument("--port", help="Serial port to read, e.g. /dev/ttyUSB0 (needs pyserial)")
+    source.add_argument("--input", help="File with captured UART bytes ('-' for stdin, the default)")
+    parser.add_argument("--baud", type=int, default=115200, help="Serial baud rate (default: 115200)")
+    parser.add_argument("--frames", action="store_true", help="Also show non-log protocol frames")
+    parser.add_argument("--dump", action="store_true", help="Print the token table and exit")
+    parser.add_argument("--stats", action="store_true",
+                        help="Request a profiling report (needs --port), print it and exit")
+    parser.add_argument("--reset", action="store_true", help="With --stats: clear the results after the report")
+    parser.add_argument("--timeout", type=float, default=10.0, help="Seconds to wait for the report (default: 10)")
+    parser.add_argument("--trace", choices=sorted(TRACE_COMMANDS),
+                        help="Brain Module: start a ride trace capture or playback, or stop it (needs --port)")
+    parser.add_argument("--speed", type=int, default=1,
+                        help="With --trace play: 1 = real time, N = N times faster, 0 = flat out (default: 1)")
+    args = parser.parse_args()
+
+    if args.stats and not args.port:
+        parser.error("--stats needs --port")
+    if args.trace and not args.port:
+        parser.error("--trace needs --port")
+    if not 0 <= args.speed <= 255:
+        parser.error("--speed must be 0..255")
+    if args.dump and not args.elf:
+        parser.error("--dump needs the ELF")
+
+    dictionary = None
+    if args.elf:
+        try:
+            dictionary = LogDictionary(args.elf)
+        except (OSError, ValueError) as e:
+            sys.exit(f"error: {e}")
+
+    if args.dump:
+        for token, desc in dictionary.entries():
+            print("0x%04X  %s" % (token, desc))
+        return
+
+    if args.port:
+        try:
+            import serial
+        except ImportError:
+            sys.exit("error: --port needs pyserial (pip install pyserial)")
+        stream = serial.Serial(args.port, args.baud, timeout=0.1)
+        read = lambda: stream.read(256)
+        if args.trace:
+            stream.write(encode_frame(MSG_TRACE_CONTROL, bytes([TRACE_COMMANDS[args.trace], args.speed])))
+        if args.stats:
+            stream.write(encode_frame(MSG_STATS_REQUEST, bytes([STATS_FLAG_RESET if args.reset else 0])))
+    else:
+        stream = sys.stdin.buffer if args.input in (None, "-") else open(args.input, "rb")
+        read = lambda: stream.read1(256) if hasattr(stream, "read1") else stream.read(256)
+
+    decoder = StreamDecoder(dictionary, args.frames)
+    deadline = time.monotonic() + args.timeout
+    try:
+        while True:
+            data = read()
+            if not data and not args.port:
+                break
+            for line in decoder.feed(data):
+                print(line, flush=True)
+            if args.stats and decoder.stats_done:
+                break
+            if args.stats and time.monotonic() > deadline:
+                sys.exit("error: no stats report (built with ENABLE_PERF_COUNTERS 0?)")
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,276 @@
+#!/usr/bin/env python3
+"""Update the Display Module firmware over the BLE link.
+
+Sends an application image (the Intel HEX file `make` writes) to the
+Display Module's bootloader (firmware/display_module/bootloader/bootloader.c).
+By default the port is the Brain Module's link, and the Brain relays each
+BLE_MSG_OTA_* frame to the display as BLE_MSG_BOOT_* (ble_protocol.h). With
+--direct the port is the display's own UART and the BOOT frames go straight
+to it.
+
+The flow:
+  1. BEGIN, repeated until the bootloader answers OK. The first one restarts
+     the display application into the bootloader, which announces READY.
+  2. DATA frames of 32 bytes, in order, with at most two flash pages beyond
+     the last acknowledged offset in flight: the bootloader programs one page
+     while the next arrives. SEQUENCE and VERIFY answers, and timeouts,
+     rewind to the offset the bootloader asks for.
+  3. END with the CRC-16/XMODEM of the image. The bootloader checks it
+     against flash, answers DONE and starts the new image.
+
+The bootloader must be installed once with the ISP programmer
+(make flash-bootloader in firmware/display_module).
+
+Examples:
+    flash_firmware.py display_module.hex --port /dev/ttyUSB0
+    flash_firmware.py display_module.hex --port /dev/ttyUSB1 --direct
+    flash_firmware.py display_module.hex --info
+"""
+
+import argparse
+import sys
+import time
+
+from diagnostics import END_BYTE, MAX_PAYLOAD, START_BYTE, crc8, encode_frame
+
+# --- Protocol constants (firmware/common/include/ble_protocol.h, display_module/include/modules/ota.h) ---
+MSG_OTA_BEGIN, MSG_OTA_DATA, MSG_OTA_END, MSG_OTA_ACK = 0x20, 0x21, 0x22, 0x23
+OTA_RELAY_BIT = 0x08  # BOOT_x = OTA_x | OTA_RELAY_BIT
+PAGE_SIZE = 128
+CHUNK = 32
+WINDOW_PAGES = 2
+APP_MAX_SIZE = 0x7800  # OTA_BOOT_START
+BOOT_WAIT_S = 30  # OTA_BOOT_WAIT_S: the bootloader gives up on BEGIN after this
+ACK_TIMEOUT_S = 0.5  # A window is ~30 ms on the wire; the rest is relay latency
+
+STATUS_NAMES = ["READY", "OK", "SEQUENCE", "VERIFY", "TOO_LONG", "CRC", "DONE"]
+READY, OK, SEQUENCE, VERIFY, TOO_LONG, CRC, DONE = range(len(STATUS_NAMES))
+
+
+class UpdateError(Exception):
+    pass
+
+
+def read_hex(path):
+    """Returns the image in an Intel HEX file, from address 0, gaps as 0xFF."""
+    memory = {}
+    base = 0
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            line = line.strip()
+            if not line:
+                continue
+            if not line.startswith(":"):
+                raise ValueError(f"{path}:{number}: not an Intel HEX record")
+            record = bytes.fromhex(line[1:])
+            if len(record) < 5 or len(record) != 5 + record[0] or sum(record) & 0xFF:
+                raise ValueError(f"{path}:{number}: bad record length or checksum")
+            count, address, kind, data = record[0], (record[1] << 8) | record[2], record[3], record[4:-1]
+            if kind == 0x00:
+                for i, byte in enumerate(data):
+                    memory[base + address + i] = byte
+            elif kind == 0x01:
+                break
+            elif kind == 0x02:
+                base = ((data[0] << 8) | data[1]) << 4
+            elif kind == 0x04:
+                base = ((data[0] << 8) | data[1]) << 16
+            # 0x03 and 0x05 (start address) do not matter to the bootloader
+    if not memory:
+        raise ValueError(f"{path}: no data")
+    end = max(memory) + 1
+    if end > APP_MAX_SIZE:
+        raise ValueError(f"{path}: image ends at 0x{end:04X}, past the bootloader at 0x{APP_MAX_SIZE:04X}")
+    return bytes(memory.get(a, 0xFF) for a in range(end))
+
+
+def crc16_xmodem(data):
+    """CRC-16/XMODEM (poly 0x1021, init 0), as avr-libc's _crc_xmodem_update()."""
+    crc = 0
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+class FrameReader:
+    """Splits the UART byte stream into (msg_id, payload) frames, like ble_parser_feed()."""
+
+    def __init__(self):
+        self.pending = bytearray()
+
+    def feed(self, data):
+        self.pending += data
+        frames = []
+        while self.pending:
+            if self.pending[0] != START_BYTE:
+                del self.pending[0]
+                continue
+            if len(self.pending) < 3:
+                break
+            length = self.pending[2]
+            if length > MAX_PAYLOAD:
+                del self.pending[0]
+                continue
+            total = 3 + length + 2
+            if len(self.pending) < total:
+                break
+            frame = bytes(self.pending[:total])
+            if frame[-1] != END_BYTE or crc8(frame[1:3 + length]) != frame[3 + length]:
+                del self.pending[0]  # Not a frame: resync
+                continue
+            del self.pending[:total]
+            frames.append((frame[1], frame[3:3 + length]))
+        return frames
+
+
+class Updater:
+    def __init__(self, stream, image, direct, verbose):
+        self.stream = stream
+        self.image = image
+        self.relay_bit = OTA_RELAY_BIT if direct else 0
+        self.ack_id = MSG_OTA_ACK | self.relay_bit  # BLE_MSG_OTA_ACK, or BLE_MSG_BOOT_ACK when direct
+        self.verbose = verbose
+        self.reader = FrameReader()
+        self.acks = []
+
+    def send(self, msg_id, payload=b""):
+        self.stream.write(encode_frame(msg_id | self.relay_bit, payload))
+
+    def wait_ack(self, timeout):
+        """Returns (offset, status) of the next ACK, or None after timeout seconds."""
+        deadline = time.monotonic() + timeout
+        while not self.acks:
+            if time.monotonic() > deadline:
+                return None
+            for msg_id, payload in self.reader.feed(self.stream.read(64)):
+                if msg_id == self.ack_id and len(payload) >= 3:
+                    self.acks.append((payload[0] | (payload[1] << 8), payload[2]))
+                elif self.verbose:
+                    print("<frame 0x%02X> %s" % (msg_id, payload.hex()))
+        ack = self.acks.pop(0)
+        if self.verbose:
+            print("ACK %s @ %d" % (STATUS_NAMES[ack[1]] if ack[1] < len(STATUS_NAMES) else ack[1], ack[0]))
+        return ack
+
+    def begin(self):
+        length = len(self.image).to_bytes(2, "little")
+        deadline = time.monotonic() + BOOT_WAIT_S + 10
+        while time.monotonic() < deadline:
+            self.send(MSG_OTA_BEGIN, length)
+            ack = self.wait_ack(0.5)
+            while ack:
+                if ack[1] == OK:
+                    return
+                if ack[1] == TOO_LONG:
+                    raise UpdateError("image too long for the application section")
+                if ack[1] == READY:
+                    print("Bootloader running")
+                ack = self.wait_ack(0.05)
+        raise UpdateError("no answer from the bootloader (installed? display in range?)")
+
+    def transfer(self, start=0):
+        """Sends the image from start; returns once every full page is acknowledged
+        and the rest is sent (a partial last page is programmed on END)."""
+        size = len(self.image)
+        full_pages = size - size % PAGE_SIZE
+        acked = start
+        next_ofs = start
+        retries = 0
+        last_report = 0
+        while True:
+            limit = min(size, (acked // PAGE_SIZE + WINDOW_PAGES) * PAGE_SIZE)
+            while next_ofs < limit:
+                chunk = self.image[next_ofs:next_ofs + CHUNK]
+                self.send(MSG_OTA_DATA, next_ofs.to_bytes(2, "little") + chunk)
+                next_ofs += len(chunk)
+            if acked >= full_pages and next_ofs >= size:
+                return
+            ack = self.wait_ack(ACK_TIMEOUT_S)
+            if ack is None:
+                retries += 1
+                if retries > 10:
+                    raise UpdateError("bootloader stopped answering at offset %d" % acked)
+                next_ofs = acked  # Resend the window; a SEQUENCE answer corrects us
+                continue
+            offset, status = ack
+            if status == OK:
+                retries = 0
+                acked = max(acked, offset)
+                next_ofs = max(next_ofs, acked)
+            elif status in (SEQUENCE, VERIFY):
+                retries += 1
+                if retries > 10:
+                    raise UpdateError("too many resends at offset %d" % offset)
+                acked = min(acked, offset)
+                next_ofs = offset
+            else:
+                raise UpdateError("unexpected %s during transfer" % STATUS_NAMES[status])
+            if acked * 10 // size != last_report:
+                last_report = acked * 10 // size
+                print("%3d%%  %5d / %d bytes" % (acked * 100 // size, acked, size), flush=True)
+
+    def end(self):
+        payload = len(self.image).to_bytes(2, "little") + crc16_xmodem(self.image).to_bytes(2, "little")
+        for _ in range(5):
+            self.send(MSG_OTA_END, payload)
+            ack = self.wait_ack(2.0)
+            while ack and ack[1] == OK:  # Late answers to resent DATA
+                ack = self.wait_ack(2.0)
+            if ack is None:
+                continue
+            offset, status = ack
+            if status == DONE:
+                return
+            if status == CRC:
+                raise UpdateError("image CRC mismatch in flash; run the update again")
+            if status in (SEQUENCE, VERIFY):
+                self.transfer(offset)
+        raise UpdateError("no DONE from the bootloader")
+
+    def run(self):
+        started = time.monotonic()
+        self.begin()
+        self.transfer()
+        self.end()
+        print("Done: %d bytes in %.1f s, display restarting" % (len(self.image), time.monotonic() - started))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Update the Halo Vision Display Module firmware over the link.")
+    parser.add_argument("hex", help="Application image (display_module.hex)")
+    parser.add_argument("--port", help="Serial port of the Brain Module link, e.g. /dev/ttyUSB0 (needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200, help="Serial baud rate (default: 115200)")
+    parser.add_argument("--direct", action="store_true",
+                        help="The port is the Display Module's UART: no Brain Module relay")
+    parser.add_argument("--info", action="store_true", help="Print the image size and CRC and exit")
+    parser.add_argument("--verbose", action="store_true", help="Show every ACK and other frames")
+    args = parser.parse_args()
+
+    try:
+        image = read_hex(args.hex)
+    except (OSError, ValueError) as e:
+        sys.exit(f"error: {e}")
+    pages = (len(image) + PAGE_SIZE - 1) // PAGE_SIZE
+    print("%s: %d bytes, %d pages, CRC 0x%04X" % (args.hex, len(image), pages, crc16_xmodem(image)))
+    if args.info:
+        return
+    if not args.port:
+        parser.error("--port is required (or --info)")
+
+    try:
+        import serial
+    except ImportError:
+        sys.exit("error: --port needs pyserial (pip install pyserial)")
+    stream = serial.Serial(args.port, args.baud, timeout=0.02)
+    try:
+        Updater(stream, image, args.direct, args.verbose).run()
+    except UpdateError as e:
+        sys.exit(f"error: {e}")
+    except KeyboardInterrupt:
+        sys.exit("interrupted; the display stays in its bootloader until an update completes")
+
+
+if __name__ == "__main__":
+    main()